@@ -42,6 +42,34 @@ BENCHMARK(BM_EltwiseMultMod)
 
 //=================================================================
 
+// Compares moduli just below 2^60, 2^62 and 2^64; moduli of at least 2^62 use
+// Montgomery multiplication. The limbs counter reports the number of limbs of
+// an RNS modulus Q with log Q = 1760. See BM_FwdNTTModulusBits.
+// state[0] is the degree
+// state[1] is the modulus bit-width, i.e. the modulus is less than 2^state[1]
+static void BM_EltwiseMultModModulusBits(benchmark::State& state) {  //  NOLINT
+  size_t input_size = state.range(0);
+  size_t bit_width = state.range(1);
+  uint64_t modulus = GeneratePrimes(1, bit_width - 1, false, 1024)[0];
+
+  auto input1 = GenerateInsecureUniformIntRandomValues(input_size, 0, modulus);
+  auto input2 = GenerateInsecureUniformIntRandomValues(input_size, 0, modulus);
+  AlignedVector64<uint64_t> output(input_size, 2);
+
+  for (auto _ : state) {
+    EltwiseMultMod(output.data(), input1.data(), input2.data(), input_size,
+                   modulus, 1);
+  }
+  state.counters["limbs"] =
+      static_cast<double>((1760 + bit_width - 1) / bit_width);
+}
+
+BENCHMARK(BM_EltwiseMultModModulusBits)
+    ->Unit(benchmark::kMicrosecond)
+    ->ArgsProduct({{1024, 4096, 16384}, {60, 62, 64}});
+
+//=================================================================
+
 // state[0] is the degree
 static void BM_EltwiseMultModNative(benchmark::State& state) {  //  NOLINT
   size_t input_size = state.range(0);
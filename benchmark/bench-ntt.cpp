@@ -3,20 +3,154 @@
 
 #include <benchmark/benchmark.h>
 
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
 #include <vector>
 
+#include "hexl/eltwise/eltwise-fma-mod.hpp"
+#include "hexl/eltwise/eltwise-mult-mod.hpp"
+#include "hexl/eltwise/eltwise-reduce-mod.hpp"
 #include "hexl/logging/logging.hpp"
+#include "hexl/ntt/ntt-32.hpp"
+#include "hexl/ntt/ntt-mixed-radix.hpp"
+#include "hexl/ntt/ntt-registry.hpp"
 #include "hexl/ntt/ntt.hpp"
 #include "hexl/number-theory/number-theory.hpp"
 #include "hexl/util/aligned-allocator.hpp"
+#include "hexl/util/util.hpp"
+#include "ntt/fwd-ntt-avx2.hpp"
 #include "ntt/fwd-ntt-avx512.hpp"
+#include "ntt/inv-ntt-avx2.hpp"
 #include "ntt/inv-ntt-avx512.hpp"
+#include "ntt/ntt-four-step.hpp"
 #include "ntt/ntt-internal.hpp"
+#include "util/cpu-features.hpp"
 #include "util/util-internal.hpp"
 
 namespace intel {
 namespace hexl {
 
+// Reports a model of the bytes moved between the L1 cache and the next cache
+// level by a transform of size ntt_size traversed depth-first down to blocks
+// of base_ntt_size: each pass over a block larger than the base size streams
+// the data through L1 once, as does each stage of base-size blocks that do
+// not fit in L1. The twiddle factors and their pre-conditioned values are
+// loaded once.
+static void SetNTTBytesMovedCounters(benchmark::State& state,  //  NOLINT
+                                     uint64_t ntt_size,
+                                     uint64_t base_ntt_size) {
+  uint64_t passes = 0;
+  uint64_t block_size = ntt_size;
+  while (block_size > base_ntt_size) {
+    block_size >>= (block_size >= 4 * base_ntt_size) ? 2 : 1;
+    ++passes;
+  }
+  passes += (block_size <= NTT::DefaultBaseNTTSize()) ? 1 : Log2(block_size);
+
+  double bytes_moved = static_cast<double>((2 * passes + 2) * ntt_size *
+                                           sizeof(uint64_t));
+  state.counters["passes"] = static_cast<double>(passes);
+  state.counters["bytes_moved"] = bytes_moved;
+  state.counters["bytes_per_second"] = benchmark::Counter(
+      bytes_moved, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// Table construction
+
+//=================================================================
+
+// state[0] is the degree
+// state[1] is the number of bits in the modulus
+static void BM_NTTConstruction(benchmark::State& state) {  //  NOLINT
+  size_t ntt_size = state.range(0);
+  size_t modulus = GeneratePrimes(1, state.range(1), true, ntt_size)[0];
+
+  for (auto _ : state) {
+    NTT ntt(ntt_size, modulus);
+    benchmark::DoNotOptimize(ntt.GetTableMemoryBytes());
+  }
+}
+
+BENCHMARK(BM_NTTConstruction)
+    ->Unit(benchmark::kMicrosecond)
+    ->ArgsProduct({{4096, 16384, 65536, 131072}, {30, 50}});
+
+// Constructs an NTT and then builds all of its tables
+static void BM_NTTConstructionAllTables(benchmark::State& state) {  //  NOLINT
+  size_t ntt_size = state.range(0);
+  size_t modulus = GeneratePrimes(1, state.range(1), true, ntt_size)[0];
+
+  for (auto _ : state) {
+    NTT ntt(ntt_size, modulus);
+    ntt.GetPrecon32RootOfUnityPowers();
+    ntt.GetPrecon64RootOfUnityPowers();
+    ntt.GetAVX512Precon32RootOfUnityPowers();
+    ntt.GetAVX512Precon52RootOfUnityPowers();
+    ntt.GetAVX512Precon64RootOfUnityPowers();
+    ntt.GetPrecon32InvRootOfUnityPowers();
+    ntt.GetPrecon52InvRootOfUnityPowers();
+    ntt.GetPrecon64InvRootOfUnityPowers();
+    benchmark::DoNotOptimize(ntt.GetTableMemoryBytes());
+  }
+}
+
+BENCHMARK(BM_NTTConstructionAllTables)
+    ->Unit(benchmark::kMicrosecond)
+    ->ArgsProduct({{4096, 16384, 65536, 131072}, {30, 50}});
+
+// Loads an NTT stored by NTT::Serialize, for comparison with construction
+static void BM_NTTDeserialize(benchmark::State& state) {  //  NOLINT
+  size_t ntt_size = state.range(0);
+  size_t modulus = GeneratePrimes(1, state.range(1), true, ntt_size)[0];
+
+  std::stringstream stream;
+  NTT(ntt_size, modulus).Serialize(stream);
+  std::string bytes = stream.str();
+  AlignedVector64<uint64_t> buffer(bytes.size() / sizeof(uint64_t));
+  std::memcpy(buffer.data(), bytes.data(), bytes.size());
+
+  for (auto _ : state) {
+    NTT ntt = NTT::Deserialize(buffer.data(), bytes.size());
+    benchmark::DoNotOptimize(ntt.GetTableMemoryBytes());
+  }
+}
+
+BENCHMARK(BM_NTTDeserialize)
+    ->Unit(benchmark::kMicrosecond)
+    ->ArgsProduct({{4096, 16384, 65536, 131072}, {30, 50}});
+
+// Looks up NTTs in a registry from concurrent threads, cycling through the
+// moduli of an RNS basis as in KeySwitch
+// state[0] is 1 to use NTTRegistry::GetCached, 0 to use NTTRegistry::Get
+static void BM_NTTRegistryLookup(benchmark::State& state) {  //  NOLINT
+  static const size_t num_moduli = 8;
+  static const uint64_t ntt_size = 4096;
+  static NTTRegistry registry;
+  static const std::vector<uint64_t> moduli =
+      GeneratePrimes(num_moduli, 50, true, ntt_size);
+  if (state.thread_index() == 0) {
+    registry.Prewarm(ntt_size, moduli);
+  }
+  bool cached = state.range(0) != 0;
+
+  size_t i = 0;
+  for (auto _ : state) {
+    uint64_t modulus = moduli[i++ % num_moduli];
+    std::shared_ptr<NTT> ntt = cached ? registry.GetCached(ntt_size, modulus)
+                                      : registry.Get(ntt_size, modulus);
+    benchmark::DoNotOptimize(ntt.get());
+  }
+}
+
+BENCHMARK(BM_NTTRegistryLookup)
+    ->Unit(benchmark::kNanosecond)
+    ->Args({0})
+    ->Args({1})
+    ->ThreadRange(1, 64)
+    ->UseRealTime();
+
 // Forward transforms
 
 //=================================================================
@@ -112,6 +246,65 @@ BENCHMARK(BM_FwdNTTNativeRadix4Copy)
 
 //=================================================================
 
+// state[0] is the degree
+// state[1] is the base NTT size; 0 uses the default, and the degree itself
+// disables the depth-first traversal
+static void BM_FwdNTTNativeBlocked(benchmark::State& state) {  //  NOLINT
+  size_t ntt_size = state.range(0);
+  size_t modulus = GeneratePrimes(1, 62, true, ntt_size)[0];
+
+  auto input = GenerateInsecureUniformIntRandomValues(ntt_size, 0, modulus);
+  NTT ntt(ntt_size, modulus);
+
+  size_t base_ntt_size = NTT::GetBaseNTTSize();
+  NTT::SetBaseNTTSize(state.range(1));
+  for (auto _ : state) {
+    ForwardTransformToBitReverseRadix4(
+        input.data(), input.data(), ntt_size, modulus,
+        ntt.GetRootOfUnityPowers().data(),
+        ntt.GetPrecon64RootOfUnityPowers().data(), 2, 1);
+  }
+  SetNTTBytesMovedCounters(state, ntt_size, NTT::GetBaseNTTSize());
+  NTT::SetBaseNTTSize(base_ntt_size);
+}
+
+BENCHMARK(BM_FwdNTTNativeBlocked)
+    ->Unit(benchmark::kMicrosecond)
+    ->Args({1 << 16, 0})
+    ->Args({1 << 16, 1 << 16})
+    ->Args({1 << 17, 0})
+    ->Args({1 << 17, 1 << 17});
+
+//=================================================================
+
+// state[0] is the degree
+// state[1] is the base NTT size; 0 uses the default, and the degree itself
+// disables the depth-first traversal
+static void BM_FwdNTTBlocked(benchmark::State& state) {  //  NOLINT
+  size_t ntt_size = state.range(0);
+  size_t modulus = GeneratePrimes(1, 45, true, ntt_size)[0];
+
+  auto input = GenerateInsecureUniformIntRandomValues(ntt_size, 0, modulus);
+  NTT ntt(ntt_size, modulus);
+
+  size_t base_ntt_size = NTT::GetBaseNTTSize();
+  NTT::SetBaseNTTSize(state.range(1));
+  for (auto _ : state) {
+    ntt.ComputeForward(input.data(), input.data(), 1, 1);
+  }
+  SetNTTBytesMovedCounters(state, ntt_size, NTT::GetBaseNTTSize());
+  NTT::SetBaseNTTSize(base_ntt_size);
+}
+
+BENCHMARK(BM_FwdNTTBlocked)
+    ->Unit(benchmark::kMicrosecond)
+    ->Args({1 << 16, 0})
+    ->Args({1 << 16, 1 << 16})
+    ->Args({1 << 17, 0})
+    ->Args({1 << 17, 1 << 17});
+
+//=================================================================
+
 #ifdef HEXL_HAS_AVX512IFMA
 // state[0] is the degree
 static void BM_FwdNTT_AVX512IFMA(benchmark::State& state) {  //  NOLINT
@@ -242,6 +435,72 @@ BENCHMARK(BM_FwdNTT_AVX512DQ_64)
 
 //=================================================================
 
+#ifdef HEXL_HAS_AVX256
+// state[0] is the degree
+// state[1] is the output modulus factor
+static void BM_FwdNTT_AVX2_32(benchmark::State& state) {  //  NOLINT
+  size_t ntt_size = state.range(0);
+  uint64_t output_mod_factor = state.range(1);
+  size_t modulus_bits = 29;
+  size_t modulus = GeneratePrimes(1, modulus_bits, true, ntt_size)[0];
+
+  auto input = GenerateInsecureUniformIntRandomValues(ntt_size, 0, modulus);
+  NTT ntt(ntt_size, modulus);
+
+  const AlignedVector64<uint64_t> root_of_unity =
+      ntt.GetAVX512RootOfUnityPowers();
+  const AlignedVector64<uint64_t> precon_root_of_unity =
+      ntt.GetAVX512Precon32RootOfUnityPowers();
+  for (auto _ : state) {
+    ForwardTransformToBitReverseAVX2<32>(
+        input.data(), input.data(), ntt_size, modulus, root_of_unity.data(),
+        precon_root_of_unity.data(), 4, output_mod_factor);
+  }
+}
+
+BENCHMARK(BM_FwdNTT_AVX2_32)
+    ->Unit(benchmark::kMicrosecond)
+    ->Args({1024, 1})
+    ->Args({1024, 4})
+    ->Args({4096, 1})
+    ->Args({4096, 4})
+    ->Args({16384, 1})
+    ->Args({16384, 4});
+
+// state[0] is the degree
+// state[1] is the output modulus factor
+static void BM_FwdNTT_AVX2_64(benchmark::State& state) {  //  NOLINT
+  size_t ntt_size = state.range(0);
+  uint64_t output_mod_factor = state.range(1);
+  size_t modulus_bits = 55;
+  size_t modulus = GeneratePrimes(1, modulus_bits, true, ntt_size)[0];
+
+  auto input = GenerateInsecureUniformIntRandomValues(ntt_size, 0, modulus);
+  NTT ntt(ntt_size, modulus);
+
+  const AlignedVector64<uint64_t> root_of_unity =
+      ntt.GetAVX512RootOfUnityPowers();
+  const AlignedVector64<uint64_t> precon_root_of_unity =
+      ntt.GetAVX512Precon64RootOfUnityPowers();
+  for (auto _ : state) {
+    ForwardTransformToBitReverseAVX2<64>(
+        input.data(), input.data(), ntt_size, modulus, root_of_unity.data(),
+        precon_root_of_unity.data(), 4, output_mod_factor);
+  }
+}
+
+BENCHMARK(BM_FwdNTT_AVX2_64)
+    ->Unit(benchmark::kMicrosecond)
+    ->Args({1024, 1})
+    ->Args({1024, 4})
+    ->Args({4096, 1})
+    ->Args({4096, 4})
+    ->Args({16384, 1})
+    ->Args({16384, 4});
+#endif
+
+//=================================================================
+
 // state[0] is the degree
 static void BM_FwdNTTInPlace(benchmark::State& state) {  //  NOLINT
   size_t ntt_size = state.range(0);
@@ -259,7 +518,9 @@ BENCHMARK(BM_FwdNTTInPlace)
     ->Unit(benchmark::kMicrosecond)
     ->Args({1024})
     ->Args({4096})
-    ->Args({16384});
+    ->Args({16384})
+    ->Args({1 << 16})
+    ->Args({1 << 20});
 
 //=================================================================
 
@@ -327,6 +588,559 @@ BENCHMARK(BM_InvNTTCopy)
 
 //=================================================================
 
+// state[0] is the degree
+static void BM_FwdNTTFourStep(benchmark::State& state) {  //  NOLINT
+  size_t ntt_size = state.range(0);
+  size_t modulus = GeneratePrimes(1, 50, true, ntt_size)[0];
+
+  auto input = GenerateInsecureUniformIntRandomValues(ntt_size, 0, modulus);
+  FourStepNTT ntt(ntt_size, modulus,
+                  MinimalPrimitiveRoot(2 * ntt_size, modulus));
+
+  for (auto _ : state) {
+    ntt.ComputeForward(input.data(), input.data(), 1, 1);
+  }
+}
+
+BENCHMARK(BM_FwdNTTFourStep)
+    ->Unit(benchmark::kMicrosecond)
+    ->Args({1 << 16})
+    ->Args({1 << 20})
+    ->Args({1 << 22});
+
+//=================================================================
+
+// state[0] is the degree
+static void BM_InvNTTFourStep(benchmark::State& state) {  //  NOLINT
+  size_t ntt_size = state.range(0);
+  size_t modulus = GeneratePrimes(1, 50, true, ntt_size)[0];
+
+  auto input = GenerateInsecureUniformIntRandomValues(ntt_size, 0, modulus);
+  FourStepNTT ntt(ntt_size, modulus,
+                  MinimalPrimitiveRoot(2 * ntt_size, modulus));
+
+  for (auto _ : state) {
+    ntt.ComputeInverse(input.data(), input.data(), 1, 1);
+  }
+}
+
+BENCHMARK(BM_InvNTTFourStep)
+    ->Unit(benchmark::kMicrosecond)
+    ->Args({1 << 16})
+    ->Args({1 << 20})
+    ->Args({1 << 22});
+
+//=================================================================
+
+// state[0] is the degree
+// state[1] is the number of moduli
+// state[2] is the number of threads
+static void BM_FwdNTTRNS(benchmark::State& state) {  //  NOLINT
+  size_t ntt_size = state.range(0);
+  size_t num_moduli = state.range(1);
+  SetNumThreads(state.range(2));
+  auto moduli = GeneratePrimes(num_moduli, 50, true, ntt_size);
+
+  std::vector<NTT> ntts;
+  std::vector<NTT*> ntt_ptrs;
+  for (auto modulus : moduli) {
+    ntts.emplace_back(ntt_size, modulus);
+  }
+  for (auto& ntt : ntts) {
+    ntt_ptrs.push_back(&ntt);
+  }
+  AlignedVector64<uint64_t> input(ntt_size * num_moduli, 1);
+
+  for (auto _ : state) {
+    ComputeForwardRNS(input.data(), input.data(), ntt_ptrs.data(), num_moduli,
+                      1, 1);
+  }
+  SetNumThreads(0);
+}
+
+BENCHMARK(BM_FwdNTTRNS)
+    ->Unit(benchmark::kMicrosecond)
+    ->Args({4096, 8, 1})
+    ->Args({4096, 8, 4})
+    ->Args({16384, 16, 1})
+    ->Args({16384, 16, 4})
+    ->Args({32768, 32, 1})
+    ->Args({32768, 32, 4});
+
+//=================================================================
+
+// state[0] is the degree
+// state[1] is the number of moduli
+// state[2] is the number of threads
+static void BM_InvNTTRNS(benchmark::State& state) {  //  NOLINT
+  size_t ntt_size = state.range(0);
+  size_t num_moduli = state.range(1);
+  SetNumThreads(state.range(2));
+  auto moduli = GeneratePrimes(num_moduli, 50, true, ntt_size);
+
+  std::vector<NTT> ntts;
+  std::vector<NTT*> ntt_ptrs;
+  for (auto modulus : moduli) {
+    ntts.emplace_back(ntt_size, modulus);
+  }
+  for (auto& ntt : ntts) {
+    ntt_ptrs.push_back(&ntt);
+  }
+  AlignedVector64<uint64_t> input(ntt_size * num_moduli, 1);
+
+  for (auto _ : state) {
+    ComputeInverseRNS(input.data(), input.data(), ntt_ptrs.data(), num_moduli,
+                      1, 1);
+  }
+  SetNumThreads(0);
+}
+
+BENCHMARK(BM_InvNTTRNS)
+    ->Unit(benchmark::kMicrosecond)
+    ->Args({4096, 8, 1})
+    ->Args({4096, 8, 4})
+    ->Args({16384, 16, 1})
+    ->Args({16384, 16, 4})
+    ->Args({32768, 32, 1})
+    ->Args({32768, 32, 4});
+
+//=================================================================
+
+// state[0] is the degree
+// state[1] is the number of threads
+static void BM_FwdNTTParallel(benchmark::State& state) {  //  NOLINT
+  size_t ntt_size = state.range(0);
+  SetNumThreads(state.range(1));
+  size_t modulus = GeneratePrimes(1, 50, true, ntt_size)[0];
+  auto input = GenerateInsecureUniformIntRandomValues(ntt_size, 0, modulus);
+  NTT ntt(ntt_size, modulus);
+
+  uint64_t parallel_cutoff = NTT::GetParallelCutoff();
+  NTT::SetParallelCutoff(1 << 16);
+  for (auto _ : state) {
+    ntt.ComputeForward(input.data(), input.data(), 1, 1);
+  }
+  NTT::SetParallelCutoff(parallel_cutoff);
+  SetNumThreads(0);
+}
+
+BENCHMARK(BM_FwdNTTParallel)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime()
+    ->Args({1 << 16, 1})
+    ->Args({1 << 16, 4})
+    ->Args({1 << 18, 1})
+    ->Args({1 << 18, 4});
+
+//=================================================================
+
+// state[0] is the degree
+// state[1] is the number of threads
+static void BM_InvNTTParallel(benchmark::State& state) {  //  NOLINT
+  size_t ntt_size = state.range(0);
+  SetNumThreads(state.range(1));
+  size_t modulus = GeneratePrimes(1, 50, true, ntt_size)[0];
+  auto input = GenerateInsecureUniformIntRandomValues(ntt_size, 0, modulus);
+  NTT ntt(ntt_size, modulus);
+
+  uint64_t parallel_cutoff = NTT::GetParallelCutoff();
+  NTT::SetParallelCutoff(1 << 16);
+  for (auto _ : state) {
+    ntt.ComputeInverse(input.data(), input.data(), 1, 1);
+  }
+  NTT::SetParallelCutoff(parallel_cutoff);
+  SetNumThreads(0);
+}
+
+BENCHMARK(BM_InvNTTParallel)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime()
+    ->Args({1 << 16, 1})
+    ->Args({1 << 16, 4})
+    ->Args({1 << 18, 1})
+    ->Args({1 << 18, 4});
+
+//=================================================================
+
+// Negacyclic polynomial multiplication
+
+// state[0] is the degree
+// state[1] is 1 to multiply by a polynomial already in NTT form
+// Compare with BM_NTTMultiplyUnfused at the same arguments, which includes
+// the cost of the scratch buffer of Multiply
+static void BM_NTTMultiplyFused(benchmark::State& state) {  //  NOLINT
+  size_t ntt_size = state.range(0);
+  bool transformed = state.range(1);
+  size_t modulus = GeneratePrimes(1, 50, true, ntt_size)[0];
+  auto x = GenerateInsecureUniformIntRandomValues(ntt_size, 0, modulus);
+  auto y = GenerateInsecureUniformIntRandomValues(ntt_size, 0, modulus);
+  AlignedVector64<uint64_t> y_ntt(ntt_size, 0);
+  AlignedVector64<uint64_t> output(ntt_size, 0);
+  NTT ntt(ntt_size, modulus);
+  ntt.ComputeForward(y_ntt.data(), y.data(), 1, 4);
+
+  for (auto _ : state) {
+    if (transformed) {
+      ntt.MultiplyTransformed(output.data(), x.data(), y_ntt.data(), 1, 1);
+    } else {
+      ntt.Multiply(output.data(), x.data(), y.data(), 1, 1);
+    }
+  }
+}
+
+BENCHMARK(BM_NTTMultiplyFused)
+    ->Unit(benchmark::kMicrosecond)
+    ->ArgsProduct({{1024, 4096, 16384, 65536}, {0, 1}});
+
+// Unfused reference: forward NTTs, EltwiseMultMod and inverse NTT as
+// separate passes
+static void BM_NTTMultiplyUnfused(benchmark::State& state) {  //  NOLINT
+  size_t ntt_size = state.range(0);
+  bool transformed = state.range(1);
+  size_t modulus = GeneratePrimes(1, 50, true, ntt_size)[0];
+  auto x = GenerateInsecureUniformIntRandomValues(ntt_size, 0, modulus);
+  auto y = GenerateInsecureUniformIntRandomValues(ntt_size, 0, modulus);
+  AlignedVector64<uint64_t> y_ntt(ntt_size, 0);
+  AlignedVector64<uint64_t> output(ntt_size, 0);
+  NTT ntt(ntt_size, modulus);
+  ntt.ComputeForward(y_ntt.data(), y.data(), 1, 4);
+
+  for (auto _ : state) {
+    if (!transformed) {
+      ntt.ComputeForward(y_ntt.data(), y.data(), 1, 4);
+    }
+    ntt.ComputeForward(output.data(), x.data(), 1, 4);
+    EltwiseMultMod(output.data(), output.data(), y_ntt.data(), ntt_size,
+                   modulus, 4);
+    ntt.ComputeInverse(output.data(), output.data(), 1, 1);
+  }
+}
+
+BENCHMARK(BM_NTTMultiplyUnfused)
+    ->Unit(benchmark::kMicrosecond)
+    ->ArgsProduct({{1024, 4096, 16384, 65536}, {0, 1}});
+
+// Forward NTT of residues modulo a larger RNS prime, as in key switching
+// state[0] is the degree
+// state[1] is 0 for EltwiseReduceMod followed by ComputeForward, 1 for
+// ComputeForwardFromUnreduced
+// state[2] is the number of modulus bits
+static void BM_FwdNTTFromUnreduced(benchmark::State& state) {  //  NOLINT
+  size_t ntt_size = state.range(0);
+  bool fused = state.range(1);
+  size_t modulus = GeneratePrimes(1, state.range(2), true, ntt_size)[0];
+  size_t foreign_modulus = GeneratePrimes(1, 60, true, ntt_size)[0];
+  auto input =
+      GenerateInsecureUniformIntRandomValues(ntt_size, 0, foreign_modulus);
+  AlignedVector64<uint64_t> output(ntt_size, 0);
+  NTT ntt(ntt_size, modulus);
+
+  for (auto _ : state) {
+    if (fused) {
+      ntt.ComputeForwardFromUnreduced(output.data(), input.data(), 4);
+    } else {
+      EltwiseReduceMod(output.data(), input.data(), ntt_size, modulus,
+                       modulus, 1);
+      ntt.ComputeForward(output.data(), output.data(), 1, 4);
+    }
+  }
+}
+
+BENCHMARK(BM_FwdNTTFromUnreduced)
+    ->Unit(benchmark::kMicrosecond)
+    ->ArgsProduct({{1024, 4096, 16384, 65536}, {0, 1}, {29, 49}});
+
+// Inverse NTT followed by a constant multiplication and addition, as in
+// rescaling and mod-down
+// state[0] is the degree
+// state[1] is 0 for ComputeInverse followed by EltwiseFMAMod, 1 for
+// ComputeInverseScaled
+static void BM_InvNTTScaled(benchmark::State& state) {  //  NOLINT
+  size_t ntt_size = state.range(0);
+  bool fused = state.range(1);
+  size_t modulus = GeneratePrimes(1, 49, true, ntt_size)[0];
+  uint64_t scalar = modulus / 3;
+  uint64_t addend = modulus / 2;
+  auto input = GenerateInsecureUniformIntRandomValues(ntt_size, 0, modulus);
+  AlignedVector64<uint64_t> addends(ntt_size, addend);
+  AlignedVector64<uint64_t> output(ntt_size, 0);
+  NTT ntt(ntt_size, modulus);
+
+  for (auto _ : state) {
+    if (fused) {
+      ntt.ComputeInverseScaled(output.data(), input.data(), scalar, addend, 1,
+                               1);
+    } else {
+      ntt.ComputeInverse(output.data(), input.data(), 1, 1);
+      EltwiseFMAMod(output.data(), output.data(), scalar, addends.data(),
+                    ntt_size, modulus, 1);
+    }
+  }
+}
+
+BENCHMARK(BM_InvNTTScaled)
+    ->Unit(benchmark::kMicrosecond)
+    ->ArgsProduct({{1024, 4096, 16384, 65536}, {0, 1}});
+
+// Forward and inverse NTTs of several polynomials of the same modulus
+// state[0] is the degree
+// state[1] is the number of polynomials
+// state[2] is 0 for ComputeForward and ComputeInverse on each polynomial, 1
+// for ComputeForwardMulti and ComputeInverseMulti
+static void BM_NTTMulti(benchmark::State& state) {  //  NOLINT
+  size_t ntt_size = state.range(0);
+  size_t num_polys = state.range(1);
+  bool multi = state.range(2);
+  size_t modulus = GeneratePrimes(1, 49, true, ntt_size)[0];
+  NTT ntt(ntt_size, modulus);
+
+  std::vector<AlignedVector64<uint64_t>> inputs;
+  std::vector<uint64_t*> polys;
+  for (size_t i = 0; i < num_polys; ++i) {
+    inputs.push_back(
+        GenerateInsecureUniformIntRandomValues(ntt_size, 0, modulus));
+  }
+  for (auto& input : inputs) {
+    polys.push_back(input.data());
+  }
+
+  for (auto _ : state) {
+    if (multi) {
+      ntt.ComputeForwardMulti(polys.data(), polys.data(), num_polys, 2, 1);
+      ntt.ComputeInverseMulti(polys.data(), polys.data(), num_polys, 1, 1);
+    } else {
+      for (auto* poly : polys) {
+        ntt.ComputeForward(poly, poly, 2, 1);
+        ntt.ComputeInverse(poly, poly, 1, 1);
+      }
+    }
+  }
+}
+
+BENCHMARK(BM_NTTMulti)
+    ->Unit(benchmark::kMicrosecond)
+    ->ArgsProduct({{1024, 4096, 16384}, {2, 3}, {0, 1}});
+
+// Small NTTs of many polynomials
+// state[0] is the degree
+// state[1] is the number of polynomials
+// state[2] is 0 for ComputeForward and ComputeInverse on each polynomial, 1 for
+// ComputeForwardBatch and ComputeInverseBatch on the coefficient-major batch
+static void BM_NTTBatch(benchmark::State& state) {  //  NOLINT
+  size_t ntt_size = state.range(0);
+  size_t num_polys = state.range(1);
+  bool batch = state.range(2);
+  size_t modulus = GeneratePrimes(1, 49, true, ntt_size)[0];
+  NTT ntt(ntt_size, modulus);
+
+  auto input =
+      GenerateInsecureUniformIntRandomValues(ntt_size * num_polys, 0, modulus);
+
+  for (auto _ : state) {
+    if (batch) {
+      ntt.ComputeForwardBatch(input.data(), input.data(), num_polys, 1, 1);
+      ntt.ComputeInverseBatch(input.data(), input.data(), num_polys, 1, 1);
+    } else {
+      for (size_t p = 0; p < num_polys; ++p) {
+        uint64_t* poly = input.data() + p * ntt_size;
+        ntt.ComputeForward(poly, poly, 1, 1);
+        ntt.ComputeInverse(poly, poly, 1, 1);
+      }
+    }
+  }
+}
+
+BENCHMARK(BM_NTTBatch)
+    ->Unit(benchmark::kMicrosecond)
+    ->ArgsProduct({{2, 4, 8, 16, 64}, {8, 64}, {0, 1}});
+
+// Returns the bytes of the root of unity tables read in state[1] mode of
+// BM_FwdNTTTwiddleMode and BM_InvNTTTwiddleMode
+static size_t TwiddleModeTableBytes(size_t ntt_size, int64_t mode) {
+  if (mode == 2) {
+    return 2 * CompactRootTableSize(ntt_size) * sizeof(uint64_t);
+  }
+  if (mode == 3) {
+    return ntt_size * sizeof(uint64_t);
+  }
+  return 2 * ntt_size * sizeof(uint64_t);
+}
+
+// Compares the twiddle modes, with each thread transforming its own data
+// state[0] is the degree
+// state[1] is 0 for the full tables via ComputeForward, 1 for the full tables
+// via the native radix-2 transform, 2 for the compact tables and 3 for the
+// Montgomery tables
+// state[2] is the number of modulus bits
+static void BM_FwdNTTTwiddleMode(benchmark::State& state) {  //  NOLINT
+  size_t ntt_size = state.range(0);
+  size_t modulus = GeneratePrimes(1, state.range(2), true, ntt_size)[0];
+  NTT ntt(ntt_size, modulus);
+  if (state.range(1) == 2) {
+    ntt.SetTwiddleMode(NTT::TwiddleMode::Compact);
+  } else if (state.range(1) == 3) {
+    ntt.SetTwiddleMode(NTT::TwiddleMode::Montgomery);
+  }
+  const uint64_t* W = ntt.GetRootOfUnityPowers().data();
+  const uint64_t* W_precon = ntt.GetPrecon64RootOfUnityPowers().data();
+
+  auto input = GenerateInsecureUniformIntRandomValues(ntt_size, 0, modulus);
+  for (auto _ : state) {
+    if (state.range(1) == 1) {
+      ForwardTransformToBitReverseRadix2(input.data(), input.data(), ntt_size,
+                                         modulus, W, W_precon, 4, 4);
+    } else {
+      ntt.ComputeForward(input.data(), input.data(), 4, 4);
+    }
+  }
+  state.counters["twiddle_bytes"] =
+      static_cast<double>(TwiddleModeTableBytes(ntt_size, state.range(1)));
+}
+
+BENCHMARK(BM_FwdNTTTwiddleMode)
+    ->Unit(benchmark::kMicrosecond)
+    ->ArgsProduct({{16384, 32768, 65536, 131072}, {0, 1, 2, 3}, {49, 60}})
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+
+//=================================================================
+
+// Compares natural-order forward transforms
+// state[0] is the degree
+// state[1] is 0 for ComputeForward, i.e. bit-reversed output, 1 for
+// ComputeForward followed by BitReversePermute, and 2 for
+// ComputeForwardNatural, which uses the Stockham transform when the AVX512 and
+// AVX2 transforms are disabled
+static void BM_FwdNTTNatural(benchmark::State& state) {  //  NOLINT
+  size_t ntt_size = state.range(0);
+  size_t modulus = GeneratePrimes(1, 50, true, ntt_size)[0];
+  NTT ntt(ntt_size, modulus);
+
+  auto input = GenerateInsecureUniformIntRandomValues(ntt_size, 0, modulus);
+  for (auto _ : state) {
+    if (state.range(1) == 2) {
+      ntt.ComputeForwardNatural(input.data(), input.data(), 4, 4);
+    } else {
+      ntt.ComputeForward(input.data(), input.data(), 4, 4);
+      if (state.range(1) == 1) {
+        BitReversePermute(input.data(), input.data(), ntt_size);
+      }
+    }
+  }
+}
+
+BENCHMARK(BM_FwdNTTNatural)
+    ->Unit(benchmark::kMicrosecond)
+    ->ArgsProduct({{1024, 4096, 16384, 65536}, {0, 1, 2}});
+
+//=================================================================
+
+// state[0] is the number of elements
+// state[1] is 1 for in-place, 0 for out-of-place
+static void BM_BitReversePermute(benchmark::State& state) {  //  NOLINT
+  size_t n = state.range(0);
+  auto input = GenerateInsecureUniformIntRandomValues(n, 0, 1ULL << 50);
+  AlignedVector64<uint64_t> output(n, 0);
+  uint64_t* result = (state.range(1) == 1) ? input.data() : output.data();
+  for (auto _ : state) {
+    BitReversePermute(result, input.data(), n);
+  }
+}
+
+BENCHMARK(BM_BitReversePermute)
+    ->Unit(benchmark::kMicrosecond)
+    ->ArgsProduct({{1024, 16384, 65536, 1 << 20}, {0, 1}});
+
+//=================================================================
+
+// state[0] is the length, a power of two times 3 and 5 for the mixed-radix
+// transform, or times 7 for Bluestein's algorithm
+static void BM_MixedRadixNTT(benchmark::State& state) {  //  NOLINT
+  uint64_t n = state.range(0);
+  // q == 1 mod (odd part of n) * 2^21 satisfies the requirements of either
+  // algorithm for n <= 2^20
+  uint64_t factor = (n / (n & (~n + 1))) << 21;
+  uint64_t k = (1ULL << 49) / factor + 1;
+  while (!IsPrime(k * factor + 1)) {
+    ++k;
+  }
+  uint64_t modulus = k * factor + 1;
+  MixedRadixNTT ntt(n, modulus);
+
+  auto input = GenerateInsecureUniformIntRandomValues(n, 0, modulus);
+  for (auto _ : state) {
+    ntt.ComputeForward(input.data(), input.data());
+  }
+}
+
+BENCHMARK(BM_MixedRadixNTT)
+    ->Unit(benchmark::kMicrosecond)
+    ->Args({3 * 4096})
+    ->Args({5 * 4096})
+    ->Args({15 * 1024})
+    ->Args({45 * 256})
+    ->Args({7 * 2048});
+
+//=================================================================
+
+// Compares the 32-bit NTT with the 64-bit NTT for a 30-bit modulus
+// state[0] is the degree
+// state[1] is 0 for NTT32 and 1 for NTT
+static void BM_FwdNTT32(benchmark::State& state) {  //  NOLINT
+  size_t ntt_size = state.range(0);
+  uint64_t modulus = GeneratePrimes(1, 29, true, ntt_size)[0];
+  auto input = GenerateInsecureUniformIntRandomValues(ntt_size, 0, modulus);
+
+  if (state.range(1) == 0) {
+    NTT32 ntt32(ntt_size, static_cast<uint32_t>(modulus));
+    AlignedVector64<uint32_t> input32(input.begin(), input.end());
+    for (auto _ : state) {
+      ntt32.ComputeForward(input32.data(), input32.data(), 4, 4);
+    }
+  } else {
+    NTT ntt(ntt_size, modulus);
+    for (auto _ : state) {
+      ntt.ComputeForward(input.data(), input.data(), 4, 4);
+    }
+  }
+}
+
+BENCHMARK(BM_FwdNTT32)
+    ->Unit(benchmark::kMicrosecond)
+    ->ArgsProduct({{1024, 4096, 16384}, {0, 1}});
+
+//=================================================================
+
+// Compares moduli just below 2^50, 2^52, 2^60, 2^62 and 2^64. Moduli of at
+// least 2^62 use fully reduced Montgomery butterflies, which are slower per
+// transform, but fewer limbs cover the same RNS modulus Q: e.g. log Q = 881
+// needs 15 limbs of 60 or 62 bits but 14 of 64 bits, and log Q = 1760 needs 30,
+// 29 and 28 limbs, respectively. The limbs counter reports the limb count for
+// log Q = 1760. With AVX512-IFMA, moduli in [2^50, 2^52) likewise use fully
+// reduced butterflies; set HEXL_DISABLE_AVX512IFMA to compare with the
+// AVX512-DQ transforms.
+// state[0] is the degree
+// state[1] is the modulus bit-width, i.e. the modulus is less than 2^state[1]
+static void BM_FwdNTTModulusBits(benchmark::State& state) {  //  NOLINT
+  size_t ntt_size = state.range(0);
+  size_t bit_width = state.range(1);
+  uint64_t modulus = GeneratePrimes(1, bit_width - 1, false, ntt_size)[0];
+  NTT ntt(ntt_size, modulus);
+
+  auto input = GenerateInsecureUniformIntRandomValues(ntt_size, 0, modulus);
+  for (auto _ : state) {
+    ntt.ComputeForward(input.data(), input.data(), 4, 4);
+  }
+  state.counters["limbs"] =
+      static_cast<double>((1760 + bit_width - 1) / bit_width);
+}
+
+BENCHMARK(BM_FwdNTTModulusBits)
+    ->Unit(benchmark::kMicrosecond)
+    ->ArgsProduct({{1024, 4096, 16384}, {50, 52, 60, 62, 64}});
+
+//=================================================================
+
 // Inverse transforms
 
 static void BM_InvNTTNativeRadix2InPlace(benchmark::State& state) {  //  NOLINT
@@ -431,6 +1245,37 @@ BENCHMARK(BM_InvNTTNativeRadix4Copy)
 
 //=================================================================
 
+// state[0] is the degree
+// state[1] is the base NTT size; 0 uses the default, and the degree itself
+// disables the depth-first traversal
+static void BM_InvNTTNativeBlocked(benchmark::State& state) {  //  NOLINT
+  size_t ntt_size = state.range(0);
+  size_t modulus = GeneratePrimes(1, 62, true, ntt_size)[0];
+
+  auto input = GenerateInsecureUniformIntRandomValues(ntt_size, 0, modulus);
+  NTT ntt(ntt_size, modulus);
+
+  size_t base_ntt_size = NTT::GetBaseNTTSize();
+  NTT::SetBaseNTTSize(state.range(1));
+  for (auto _ : state) {
+    InverseTransformFromBitReverseRadix4(
+        input.data(), input.data(), ntt_size, modulus,
+        ntt.GetInvRootOfUnityPowers().data(),
+        ntt.GetPrecon64InvRootOfUnityPowers().data(), 1, 1);
+  }
+  SetNTTBytesMovedCounters(state, ntt_size, NTT::GetBaseNTTSize());
+  NTT::SetBaseNTTSize(base_ntt_size);
+}
+
+BENCHMARK(BM_InvNTTNativeBlocked)
+    ->Unit(benchmark::kMicrosecond)
+    ->Args({1 << 16, 0})
+    ->Args({1 << 16, 1 << 16})
+    ->Args({1 << 17, 0})
+    ->Args({1 << 17, 1 << 17});
+
+//=================================================================
+
 #ifdef HEXL_HAS_AVX512IFMA
 // state[0] is the degree
 static void BM_InvNTT_AVX512IFMA(benchmark::State& state) {  //  NOLINT
@@ -547,5 +1392,160 @@ BENCHMARK(BM_InvNTT_AVX512DQ_64)
 
 //=================================================================
 
+#ifdef HEXL_HAS_AVX256
+// state[0] is the degree
+// state[1] is the output modulus factor
+static void BM_InvNTT_AVX2_32(benchmark::State& state) {  //  NOLINT
+  size_t ntt_size = state.range(0);
+  uint64_t output_mod_factor = state.range(1);
+  size_t modulus = GeneratePrimes(1, 29, true, ntt_size)[0];
+
+  auto input = GenerateInsecureUniformIntRandomValues(ntt_size, 0, modulus);
+  NTT ntt(ntt_size, modulus);
+
+  const AlignedVector64<uint64_t> root_of_unity = ntt.GetInvRootOfUnityPowers();
+  const AlignedVector64<uint64_t> precon_root_of_unity =
+      ntt.GetPrecon32InvRootOfUnityPowers();
+
+  for (auto _ : state) {
+    InverseTransformFromBitReverseAVX2<32>(
+        input.data(), input.data(), ntt_size, modulus, root_of_unity.data(),
+        precon_root_of_unity.data(), output_mod_factor, output_mod_factor);
+  }
+}
+
+BENCHMARK(BM_InvNTT_AVX2_32)
+    ->Unit(benchmark::kMicrosecond)
+    ->Args({1024, 1})
+    ->Args({1024, 2})
+    ->Args({4096, 1})
+    ->Args({4096, 2})
+    ->Args({16384, 1})
+    ->Args({16384, 2});
+
+// state[0] is the degree
+// state[1] is the output modulus factor
+static void BM_InvNTT_AVX2_64(benchmark::State& state) {  //  NOLINT
+  size_t ntt_size = state.range(0);
+  uint64_t output_mod_factor = state.range(1);
+  size_t modulus = GeneratePrimes(1, 61, true, ntt_size)[0];
+
+  auto input = GenerateInsecureUniformIntRandomValues(ntt_size, 0, modulus);
+  NTT ntt(ntt_size, modulus);
+
+  const AlignedVector64<uint64_t> root_of_unity = ntt.GetInvRootOfUnityPowers();
+  const AlignedVector64<uint64_t> precon_root_of_unity =
+      ntt.GetPrecon64InvRootOfUnityPowers();
+
+  for (auto _ : state) {
+    InverseTransformFromBitReverseAVX2<NTT::s_default_shift_bits>(
+        input.data(), input.data(), ntt_size, modulus, root_of_unity.data(),
+        precon_root_of_unity.data(), output_mod_factor, output_mod_factor);
+  }
+}
+
+BENCHMARK(BM_InvNTT_AVX2_64)
+    ->Unit(benchmark::kMicrosecond)
+    ->Args({1024, 1})
+    ->Args({1024, 2})
+    ->Args({4096, 1})
+    ->Args({4096, 2})
+    ->Args({16384, 1})
+    ->Args({16384, 2});
+#endif
+
+//=================================================================
+
+// Compares the twiddle modes, with each thread transforming its own data
+// state[0] is the degree
+// state[1] is 0 for the full tables via ComputeInverse, 1 for the full tables
+// via the native radix-2 transform, 2 for the compact tables and 3 for the
+// Montgomery tables
+// state[2] is the number of modulus bits
+static void BM_InvNTTTwiddleMode(benchmark::State& state) {  //  NOLINT
+  size_t ntt_size = state.range(0);
+  size_t modulus = GeneratePrimes(1, state.range(2), true, ntt_size)[0];
+  NTT ntt(ntt_size, modulus);
+  if (state.range(1) == 2) {
+    ntt.SetTwiddleMode(NTT::TwiddleMode::Compact);
+  } else if (state.range(1) == 3) {
+    ntt.SetTwiddleMode(NTT::TwiddleMode::Montgomery);
+  }
+  const uint64_t* inv_W = ntt.GetInvRootOfUnityPowers().data();
+  const uint64_t* inv_W_precon = ntt.GetPrecon64InvRootOfUnityPowers().data();
+
+  auto input = GenerateInsecureUniformIntRandomValues(ntt_size, 0, modulus);
+  for (auto _ : state) {
+    if (state.range(1) == 1) {
+      InverseTransformFromBitReverseRadix2(input.data(), input.data(),
+                                           ntt_size, modulus, inv_W,
+                                           inv_W_precon, 2, 2);
+    } else {
+      ntt.ComputeInverse(input.data(), input.data(), 2, 2);
+    }
+  }
+  state.counters["twiddle_bytes"] =
+      static_cast<double>(TwiddleModeTableBytes(ntt_size, state.range(1)));
+}
+
+BENCHMARK(BM_InvNTTTwiddleMode)
+    ->Unit(benchmark::kMicrosecond)
+    ->ArgsProduct({{16384, 32768, 65536, 131072}, {0, 1, 2, 3}, {49, 60}})
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+
+//=================================================================
+
+// Compares the 32-bit NTT with the 64-bit NTT for a 30-bit modulus
+// state[0] is the degree
+// state[1] is 0 for NTT32 and 1 for NTT
+static void BM_InvNTT32(benchmark::State& state) {  //  NOLINT
+  size_t ntt_size = state.range(0);
+  uint64_t modulus = GeneratePrimes(1, 29, true, ntt_size)[0];
+  auto input = GenerateInsecureUniformIntRandomValues(ntt_size, 0, modulus);
+
+  if (state.range(1) == 0) {
+    NTT32 ntt32(ntt_size, static_cast<uint32_t>(modulus));
+    AlignedVector64<uint32_t> input32(input.begin(), input.end());
+    for (auto _ : state) {
+      ntt32.ComputeInverse(input32.data(), input32.data(), 2, 2);
+    }
+  } else {
+    NTT ntt(ntt_size, modulus);
+    for (auto _ : state) {
+      ntt.ComputeInverse(input.data(), input.data(), 2, 2);
+    }
+  }
+}
+
+BENCHMARK(BM_InvNTT32)
+    ->Unit(benchmark::kMicrosecond)
+    ->ArgsProduct({{1024, 4096, 16384}, {0, 1}});
+
+//=================================================================
+
+// See BM_FwdNTTModulusBits
+// state[0] is the degree
+// state[1] is the modulus bit-width, i.e. the modulus is less than 2^state[1]
+static void BM_InvNTTModulusBits(benchmark::State& state) {  //  NOLINT
+  size_t ntt_size = state.range(0);
+  size_t bit_width = state.range(1);
+  uint64_t modulus = GeneratePrimes(1, bit_width - 1, false, ntt_size)[0];
+  NTT ntt(ntt_size, modulus);
+
+  auto input = GenerateInsecureUniformIntRandomValues(ntt_size, 0, modulus);
+  for (auto _ : state) {
+    ntt.ComputeInverse(input.data(), input.data(), 2, 2);
+  }
+  state.counters["limbs"] =
+      static_cast<double>((1760 + bit_width - 1) / bit_width);
+}
+
+BENCHMARK(BM_InvNTTModulusBits)
+    ->Unit(benchmark::kMicrosecond)
+    ->ArgsProduct({{1024, 4096, 16384}, {50, 52, 60, 62, 64}});
+
+//=================================================================
+
 }  // namespace hexl
 }  // namespace intel
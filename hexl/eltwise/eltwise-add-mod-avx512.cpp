@@ -24,7 +24,6 @@ void EltwiseAddModAVX512(uint64_t* result, const uint64_t* operand1,
   HEXL_CHECK(operand2 != nullptr, "Require operand2 != nullptr");
   HEXL_CHECK(n != 0, "Require n != 0");
   HEXL_CHECK(modulus > 1, "Require modulus > 1");
-  HEXL_CHECK(modulus < (1ULL << 63), "Require modulus < 2**63");
   HEXL_CHECK_BOUNDS(operand1, n, modulus,
                     "pre-add value in operand1 exceeds bound " << modulus);
   HEXL_CHECK_BOUNDS(operand2, n, modulus,
@@ -39,6 +38,8 @@ void EltwiseAddModAVX512(uint64_t* result, const uint64_t* operand1,
     n -= n_mod_8;
   }
 
+  // The small-modulus variant relies on the sign bit, so requires q < 2^63
+  const bool large_modulus = modulus >= (1ULL << 63);
   __m512i v_modulus = _mm512_set1_epi64(static_cast<int64_t>(modulus));
   __m512i* vp_result = reinterpret_cast<__m512i*>(result);
   const __m512i* vp_operand1 = reinterpret_cast<const __m512i*>(operand1);
@@ -50,7 +51,10 @@ void EltwiseAddModAVX512(uint64_t* result, const uint64_t* operand1,
     __m512i v_operand2 = _mm512_loadu_si512(vp_operand2);
 
     __m512i v_result =
-        _mm512_hexl_small_add_mod_epi64(v_operand1, v_operand2, v_modulus);
+        large_modulus
+            ? _mm512_hexl_large_add_mod_epi64(v_operand1, v_operand2, v_modulus)
+            : _mm512_hexl_small_add_mod_epi64(v_operand1, v_operand2,
+                                              v_modulus);
 
     _mm512_storeu_si512(vp_result, v_result);
 
@@ -69,7 +73,6 @@ void EltwiseAddModAVX512(uint64_t* result, const uint64_t* operand1,
   HEXL_CHECK(operand1 != nullptr, "Require operand1 != nullptr");
   HEXL_CHECK(n != 0, "Require n != 0");
   HEXL_CHECK(modulus > 1, "Require modulus > 1");
-  HEXL_CHECK(modulus < (1ULL << 63), "Require modulus < 2**63");
   HEXL_CHECK_BOUNDS(operand1, n, modulus,
                     "pre-add value in operand1 exceeds bound " << modulus);
   HEXL_CHECK(operand2 < modulus, "Require operand2 < modulus");
@@ -82,6 +85,8 @@ void EltwiseAddModAVX512(uint64_t* result, const uint64_t* operand1,
     n -= n_mod_8;
   }
 
+  // The small-modulus variant relies on the sign bit, so requires q < 2^63
+  const bool large_modulus = modulus >= (1ULL << 63);
   __m512i v_modulus = _mm512_set1_epi64(static_cast<int64_t>(modulus));
   __m512i* vp_result = reinterpret_cast<__m512i*>(result);
   const __m512i* vp_operand1 = reinterpret_cast<const __m512i*>(operand1);
@@ -92,7 +97,10 @@ void EltwiseAddModAVX512(uint64_t* result, const uint64_t* operand1,
     __m512i v_operand1 = _mm512_loadu_si512(vp_operand1);
 
     __m512i v_result =
-        _mm512_hexl_small_add_mod_epi64(v_operand1, v_operand2, v_modulus);
+        large_modulus
+            ? _mm512_hexl_large_add_mod_epi64(v_operand1, v_operand2, v_modulus)
+            : _mm512_hexl_small_add_mod_epi64(v_operand1, v_operand2,
+                                              v_modulus);
 
     _mm512_storeu_si512(vp_result, v_result);
 
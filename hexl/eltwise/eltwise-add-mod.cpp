@@ -21,7 +21,6 @@ void EltwiseAddModNative(uint64_t* result, const uint64_t* operand1,
   HEXL_CHECK(operand2 != nullptr, "Require operand2 != nullptr");
   HEXL_CHECK(n != 0, "Require n != 0");
   HEXL_CHECK(modulus > 1, "Require modulus > 1");
-  HEXL_CHECK(modulus < (1ULL << 63), "Require modulus < 2**63");
   HEXL_CHECK_BOUNDS(operand1, n, modulus,
                     "pre-add value in operand1 exceeds bound " << modulus);
   HEXL_CHECK_BOUNDS(operand2, n, modulus,
@@ -29,11 +28,13 @@ void EltwiseAddModNative(uint64_t* result, const uint64_t* operand1,
 
   HEXL_LOOP_UNROLL_4
   for (size_t i = 0; i < n; ++i) {
-    uint64_t sum = *operand1 + *operand2;
-    if (sum >= modulus) {
-      *result = sum - modulus;
+    // Compares against modulus - operand2 rather than forming the sum, which
+    // may overflow for moduli of 64 bits
+    uint64_t diff = modulus - *operand2;
+    if (*operand1 >= diff) {
+      *result = *operand1 - diff;
     } else {
-      *result = sum;
+      *result = *operand1 + *operand2;
     }
 
     ++operand1;
@@ -48,7 +49,6 @@ void EltwiseAddModNative(uint64_t* result, const uint64_t* operand1,
   HEXL_CHECK(operand1 != nullptr, "Require operand1 != nullptr");
   HEXL_CHECK(n != 0, "Require n != 0");
   HEXL_CHECK(modulus > 1, "Require modulus > 1");
-  HEXL_CHECK(modulus < (1ULL << 63), "Require modulus < 2**63");
   HEXL_CHECK_BOUNDS(operand1, n, modulus,
                     "pre-add value in operand1 exceeds bound " << modulus);
   HEXL_CHECK(operand2 < modulus, "Require operand2 < modulus");
@@ -74,7 +74,6 @@ void EltwiseAddMod(uint64_t* result, const uint64_t* operand1,
   HEXL_CHECK(operand2 != nullptr, "Require operand2 != nullptr");
   HEXL_CHECK(n != 0, "Require n != 0");
   HEXL_CHECK(modulus > 1, "Require modulus > 1");
-  HEXL_CHECK(modulus < (1ULL << 63), "Require modulus < 2**63");
   HEXL_CHECK_BOUNDS(operand1, n, modulus,
                     "pre-add value in operand1 exceeds bound " << modulus);
   HEXL_CHECK_BOUNDS(operand2, n, modulus,
@@ -96,7 +95,6 @@ void EltwiseAddMod(uint64_t* result, const uint64_t* operand1,
   HEXL_CHECK(operand1 != nullptr, "Require operand1 != nullptr");
   HEXL_CHECK(n != 0, "Require n != 0");
   HEXL_CHECK(modulus > 1, "Require modulus > 1");
-  HEXL_CHECK(modulus < (1ULL << 63), "Require modulus < 2**63");
   HEXL_CHECK_BOUNDS(operand1, n, modulus,
                     "pre-add value in operand1 exceeds bound " << modulus);
   HEXL_CHECK(operand2 < modulus, "Require operand2 < modulus");
@@ -75,6 +75,21 @@ void EltwiseMultModAVX512Float(uint64_t* result, const uint64_t* operand1,
                                const uint64_t* operand2, uint64_t n,
                                uint64_t modulus);
 
+/// @brief Multiplies two vectors elementwise with modular reduction, for odd
+/// moduli of up to 64 bits
+/// @param[in] result Result of element-wise multiplication
+/// @param[in] operand1 Vector of elements to multiply. Elements may take any
+/// 64-bit value.
+/// @param[in] operand2 Vector of elements to multiply. Elements may take any
+/// 64-bit value.
+/// @param[in] n Number of elements in each vector
+/// @param[in] modulus Odd modulus with which to perform modular reduction
+/// @details AVX512DQ implementation of EltwiseMultModLargeModulusNative
+void EltwiseMultModLargeModulusAVX512(uint64_t* result,
+                                      const uint64_t* operand1,
+                                      const uint64_t* operand2, uint64_t n,
+                                      uint64_t modulus);
+
 #endif  // HEXL_HAS_AVX512DQ
 
 }  // namespace hexl
@@ -14,6 +14,7 @@
 #include "hexl/util/check.hpp"
 #include "hexl/util/compiler.hpp"
 #include "hexl/util/defines.hpp"
+#include "number-theory/montgomery.hpp"
 #include "util/avx512-util.hpp"
 
 namespace intel {
@@ -832,6 +833,48 @@ void EltwiseMultModAVX512Float(uint64_t* result, const uint64_t* operand1,
   HEXL_CHECK_BOUNDS(result, n, modulus, "result exceeds bound " << modulus);
 }
 
+void EltwiseMultModLargeModulusAVX512(uint64_t* result,
+                                      const uint64_t* operand1,
+                                      const uint64_t* operand2, uint64_t n,
+                                      uint64_t modulus) {
+  HEXL_CHECK(modulus % 2 == 1, "Require odd modulus " << modulus);
+  uint64_t n_mod_8 = n % 8;
+  if (n_mod_8 != 0) {
+    EltwiseMultModLargeModulusNative(result, operand1, operand2, n_mod_8,
+                                     modulus);
+    operand1 += n_mod_8;
+    operand2 += n_mod_8;
+    result += n_mod_8;
+    n -= n_mod_8;
+  }
+
+  const uint64_t r_squared =
+      ToMontgomeryForm(ToMontgomeryForm(1, modulus, 64), modulus, 64);
+  __m512i v_modulus = _mm512_set1_epi64(static_cast<int64_t>(modulus));
+  __m512i v_q_inv =
+      _mm512_set1_epi64(static_cast<int64_t>(InverseModPowerOfTwo(modulus)));
+  __m512i v_r_squared = _mm512_set1_epi64(static_cast<int64_t>(r_squared));
+
+  const __m512i* vp_operand1 = reinterpret_cast<const __m512i*>(operand1);
+  const __m512i* vp_operand2 = reinterpret_cast<const __m512i*>(operand2);
+  __m512i* vp_result = reinterpret_cast<__m512i*>(result);
+
+  HEXL_LOOP_UNROLL_4
+  for (size_t i = n / 8; i > 0; --i) {
+    __m512i v_x = _mm512_loadu_si512(vp_operand1);
+    __m512i v_y = _mm512_loadu_si512(vp_operand2);
+    __m512i v_x_mont =
+        _mm512_hexl_montgomery_mul_epu64(v_x, v_r_squared, v_modulus, v_q_inv);
+    __m512i v_prod =
+        _mm512_hexl_montgomery_mul_epu64(v_y, v_x_mont, v_modulus, v_q_inv);
+    _mm512_storeu_si512(vp_result, v_prod);
+
+    ++vp_operand1;
+    ++vp_operand2;
+    ++vp_result;
+  }
+}
+
 #endif  // HEXL_HAS_AVX512DQ
 
 }  // namespace hexl
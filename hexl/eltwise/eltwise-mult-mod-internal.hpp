@@ -100,5 +100,24 @@ void EltwiseMultModNative(uint64_t* result, const uint64_t* operand1,
   }
 }
 
+/// @brief Multiplies two vectors elementwise with modular reduction, for odd
+/// moduli of up to 64 bits
+/// @param[in] result Result of element-wise multiplication
+/// @param[in] operand1 Vector of elements to multiply. Elements may take any
+/// 64-bit value.
+/// @param[in] operand2 Vector of elements to multiply. Elements may take any
+/// 64-bit value.
+/// @param[in] n Number of elements in each vector
+/// @param[in] modulus Odd modulus with which to perform modular reduction
+/// @details Computes \p result[i] = (\p operand1[i] * \p operand2[i]) mod \p
+/// modulus for i=0, ..., \p n - 1 with two exact Montgomery multiplications:
+/// the first maps \p operand1[i] to Montgomery form, which the second cancels.
+/// Unlike the Barrett reduction of EltwiseMultModNative, neither step requires
+/// spare bits above the modulus.
+void EltwiseMultModLargeModulusNative(uint64_t* result,
+                                      const uint64_t* operand1,
+                                      const uint64_t* operand2, uint64_t n,
+                                      uint64_t modulus);
+
 }  // namespace hexl
 }  // namespace intel
@@ -10,7 +10,9 @@
 #include "hexl/number-theory/number-theory.hpp"
 #include "hexl/util/aligned-allocator.hpp"
 #include "hexl/util/check.hpp"
+#include "number-theory/montgomery.hpp"
 #include "util/cpu-features.hpp"
+#include "util/util-internal.hpp"
 
 namespace intel {
 namespace hexl {
@@ -23,15 +25,29 @@ void EltwiseMultMod(uint64_t* result, const uint64_t* operand1,
   HEXL_CHECK(operand2 != nullptr, "Require operand2 != nullptr");
   HEXL_CHECK(n != 0, "Require n != 0");
   HEXL_CHECK(modulus > 1, "Require modulus > 1");
-  HEXL_CHECK(input_mod_factor * modulus < (1ULL << 63),
-             "Require input_mod_factor * modulus < (1ULL << 63)");
   HEXL_CHECK(
       input_mod_factor == 1 || input_mod_factor == 2 || input_mod_factor == 4,
       "Require input_mod_factor = 1, 2, or 4")
-  HEXL_CHECK_BOUNDS(operand1, n, input_mod_factor * modulus,
-                    "operand1 exceeds bound " << (input_mod_factor * modulus))
-  HEXL_CHECK_BOUNDS(operand2, n, input_mod_factor * modulus,
-                    "operand2 exceeds bound " << (input_mod_factor * modulus))
+  HEXL_CHECK_BOUNDS(
+      operand1, n, ModFactorBound(modulus, input_mod_factor),
+      "operand1 exceeds bound " << ModFactorBound(modulus, input_mod_factor))
+  HEXL_CHECK_BOUNDS(
+      operand2, n, ModFactorBound(modulus, input_mod_factor),
+      "operand2 exceeds bound " << ModFactorBound(modulus, input_mod_factor))
+
+  // The Barrett kernels need two spare bits above the modulus
+  if (modulus >= (1ULL << 62) || input_mod_factor * modulus >= (1ULL << 63)) {
+#ifdef HEXL_HAS_AVX512DQ
+    if (has_avx512dq) {
+      HEXL_VLOG(3, "Calling EltwiseMultModLargeModulusAVX512");
+      EltwiseMultModLargeModulusAVX512(result, operand1, operand2, n, modulus);
+      return;
+    }
+#endif
+    HEXL_VLOG(3, "Calling EltwiseMultModLargeModulusNative");
+    EltwiseMultModLargeModulusNative(result, operand1, operand2, n, modulus);
+    return;
+  }
 
 #ifdef HEXL_HAS_AVX512DQ
   if (has_avx512dq) {
@@ -81,5 +97,24 @@ void EltwiseMultMod(uint64_t* result, const uint64_t* operand1,
   }
   return;
 }
+
+void EltwiseMultModLargeModulusNative(uint64_t* result,
+                                      const uint64_t* operand1,
+                                      const uint64_t* operand2, uint64_t n,
+                                      uint64_t modulus) {
+  HEXL_CHECK(modulus % 2 == 1, "Require odd modulus " << modulus);
+  const uint64_t q_inv = InverseModPowerOfTwo(modulus);
+  // R^2 mod q for R = 2^64
+  const uint64_t r_squared =
+      ToMontgomeryForm(ToMontgomeryForm(1, modulus, 64), modulus, 64);
+
+  HEXL_LOOP_UNROLL_4
+  for (size_t i = 0; i < n; ++i) {
+    uint64_t x_mont =
+        MultiplyModMontgomery(operand1[i], r_squared, modulus, q_inv);
+    result[i] = MultiplyModMontgomery(operand2[i], x_mont, modulus, q_inv);
+  }
+}
+
 }  // namespace hexl
 }  // namespace intel
@@ -20,7 +20,6 @@ void EltwiseSubModNative(uint64_t* result, const uint64_t* operand1,
   HEXL_CHECK(operand2 != nullptr, "Require operand2 != nullptr");
   HEXL_CHECK(n != 0, "Require n != 0");
   HEXL_CHECK(modulus > 1, "Require modulus > 1");
-  HEXL_CHECK(modulus < (1ULL << 63), "Require modulus < 2**63");
   HEXL_CHECK_BOUNDS(operand1, n, modulus,
                     "pre-sub value in operand1 exceeds bound " << modulus);
   HEXL_CHECK_BOUNDS(operand2, n, modulus,
@@ -46,7 +45,6 @@ void EltwiseSubModNative(uint64_t* result, const uint64_t* operand1,
   HEXL_CHECK(operand1 != nullptr, "Require operand1 != nullptr");
   HEXL_CHECK(n != 0, "Require n != 0");
   HEXL_CHECK(modulus > 1, "Require modulus > 1");
-  HEXL_CHECK(modulus < (1ULL << 63), "Require modulus < 2**63");
   HEXL_CHECK_BOUNDS(operand1, n, modulus,
                     "pre-sub value in operand1 exceeds bound " << modulus);
   HEXL_CHECK(operand2 < modulus, "Require operand2 < modulus");
@@ -70,7 +68,6 @@ void EltwiseSubMod(uint64_t* result, const uint64_t* operand1,
   HEXL_CHECK(operand2 != nullptr, "Require operand2 != nullptr");
   HEXL_CHECK(n != 0, "Require n != 0");
   HEXL_CHECK(modulus > 1, "Require modulus > 1");
-  HEXL_CHECK(modulus < (1ULL << 63), "Require modulus < 2**63");
   HEXL_CHECK_BOUNDS(operand1, n, modulus,
                     "pre-sub value in operand1 exceeds bound " << modulus);
   HEXL_CHECK_BOUNDS(operand2, n, modulus,
@@ -92,7 +89,6 @@ void EltwiseSubMod(uint64_t* result, const uint64_t* operand1,
   HEXL_CHECK(operand1 != nullptr, "Require operand1 != nullptr");
   HEXL_CHECK(n != 0, "Require n != 0");
   HEXL_CHECK(modulus > 1, "Require modulus > 1");
-  HEXL_CHECK(modulus < (1ULL << 63), "Require modulus < 2**63");
   HEXL_CHECK_BOUNDS(operand1, n, modulus,
                     "pre-sub value in operand1 exceeds bound " << modulus);
   HEXL_CHECK(operand2 < modulus, "Require operand2 < modulus");
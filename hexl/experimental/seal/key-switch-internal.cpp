@@ -3,16 +3,19 @@
 
 #include "hexl/experimental/seal/key-switch-internal.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <exception>
 #include <iostream>
+#include <memory>
+#include <vector>
 
 #include "hexl/eltwise/eltwise-add-mod.hpp"
 #include "hexl/eltwise/eltwise-fma-mod.hpp"
 #include "hexl/eltwise/eltwise-mult-mod.hpp"
-#include "hexl/eltwise/eltwise-reduce-mod.hpp"
 #include "hexl/experimental/seal/ntt-cache.hpp"
 #include "hexl/logging/logging.hpp"
+#include "hexl/ntt/ntt.hpp"
 #include "hexl/number-theory/number-theory.hpp"
 #include "hexl/util/aligned-allocator.hpp"
 #include "hexl/util/check.hpp"
@@ -46,13 +49,21 @@ void KeySwitch(uint64_t* result, const uint64_t* t_target_iter_ptr, uint64_t n,
   std::vector<uint64_t> t_ntt(coeff_count, 0);
   uint64_t* t_ntt_ptr = t_ntt.data();
 
+  // Look up the NTTs once, outside the loops below
+  uint64_t num_ntts = std::max(decomp_modulus_size, key_modulus_size);
+  std::vector<std::shared_ptr<NTT>> ntt_owners(num_ntts);
+  std::vector<NTT*> ntts(num_ntts, nullptr);
+  for (uint64_t j = 0; j < num_ntts; ++j) {
+    if (j < decomp_modulus_size || j == key_modulus_size - 1) {
+      ntt_owners[j] = GetNTT(n, moduli[j]);
+      ntts[j] = ntt_owners[j].get();
+    }
+  }
+
   // In CKKS t_target is in NTT form; switch
   // back to normal form
-  for (size_t j = 0; j < decomp_modulus_size; ++j) {
-    GetNTT(n, moduli[j])
-        .ComputeInverse(&t_target_ptr[j * coeff_count],
-                        &t_target_ptr[j * coeff_count], 2, 1);
-  }
+  ComputeInverseRNS(t_target_ptr, t_target_ptr, ntts.data(),
+                    decomp_modulus_size, 2, 1);
 
   std::vector<uint64_t> t_poly_prod(
       key_component_count * coeff_count * rns_modulus_size, 0);
@@ -71,21 +82,16 @@ void KeySwitch(uint64_t* result, const uint64_t* t_target_iter_ptr, uint64_t n,
       if (i == j) {
         t_operand = &t_target_iter_ptr[j * coeff_count];
       } else {
-        // Perform RNS-NTT conversion
-        // No need to perform RNS conversion (modular reduction)
+        // Perform RNS-NTT conversion, with lazy outputs in [0, 4q)
         if (moduli[j] <= moduli[key_index]) {
-          for (size_t l = 0; l < coeff_count; ++l) {
-            t_ntt_ptr[l] = t_target_ptr[j * coeff_count + l];
-          }
+          // No need to perform RNS conversion (modular reduction)
+          ntts[key_index]->ComputeForward(
+              t_ntt_ptr, &t_target_ptr[j * coeff_count], 1, 4);
         } else {
-          // Perform RNS conversion (modular reduction)
-          intel::hexl::EltwiseReduceMod(
-              t_ntt_ptr, &t_target_ptr[j * coeff_count], coeff_count,
-              moduli[key_index], moduli[key_index], 1);
+          // RNS conversion (modular reduction) fused into the NTT
+          ntts[key_index]->ComputeForwardFromUnreduced(
+              t_ntt_ptr, &t_target_ptr[j * coeff_count], 4);
         }
-
-        // NTT conversion lazy outputs in [0, 4q)
-        GetNTT(n, moduli[key_index]).ComputeForward(t_ntt_ptr, t_ntt_ptr, 4, 4);
         t_operand = t_ntt_ptr;
       }
 
@@ -138,47 +144,34 @@ void KeySwitch(uint64_t* result, const uint64_t* t_target_iter_ptr, uint64_t n,
         &t_poly_prod[key_component * coeff_count * rns_modulus_size];
     uint64_t* t_last = &t_poly_prod_it[decomp_modulus_size * coeff_count];
 
-    GetNTT(n, moduli[key_modulus_size - 1])
-        .ComputeInverse(t_last, t_last, 2, 2);
-
     uint64_t qk = moduli[key_modulus_size - 1];
     uint64_t qk_half = qk >> 1;
 
-    for (size_t i = 0; i < coeff_count; ++i) {
-      uint64_t barrett_factor =
-          MultiplyFactor(1, 64, moduli[key_modulus_size - 1]).BarrettFactor();
-      t_last[i] = BarrettReduce64(t_last[i] + qk_half,
-                                  moduli[key_modulus_size - 1], barrett_factor);
-    }
+    // InvNTT with qk / 2 added to the outputs in [0, qk) in its final stage
+    ntts[key_modulus_size - 1]->ComputeInverseScaled(t_last, t_last, 1, qk_half,
+                                                     2, 1);
 
     for (size_t i = 0; i < decomp_modulus_size; ++i) {
       // (ct mod 4qk) mod qi
       uint64_t qi = moduli[i];
 
-      // TODO(fboemer): Use input_mod_factor != 0 when qk / qi < 4
-      // TODO(fboemer): Use output_mod_factor == 4?
-      uint64_t input_mod_factor = (qk > qi) ? moduli[i] : 2;
-      if (qk > qi) {
-        intel::hexl::EltwiseReduceMod(t_ntt_ptr, t_last, coeff_count, moduli[i],
-                                      input_mod_factor, 1);
-      } else {
-        for (size_t coeff_idx = 0; coeff_idx < coeff_count; ++coeff_idx) {
-          t_ntt_ptr[coeff_idx] = t_last[coeff_idx];
-        }
-      }
-
-      // Lazy subtraction, results in [0, 2*qi), since fix is in [0, qi].
+      // Lazy subtraction; fix is in [0, qi].
       uint64_t barrett_factor =
           MultiplyFactor(1, 64, moduli[i]).BarrettFactor();
       uint64_t fix = qi - BarrettReduce64(qk_half, moduli[i], barrett_factor);
       for (size_t l = 0; l < coeff_count; ++l) {
-        t_ntt_ptr[l] += fix;
+        t_ntt_ptr[l] = t_last[l] + fix;
       }
 
-      uint64_t qi_lazy = qi << 1;  // some multiples of qi
-      GetNTT(n, moduli[i]).ComputeForward(t_ntt_ptr, t_ntt_ptr, 4, 4);
+      if (qk > qi) {
+        // (ct mod qk) mod qi is fused into the NTT
+        ntts[i]->ComputeForwardFromUnreduced(t_ntt_ptr, t_ntt_ptr, 4);
+      } else {
+        // Results in [0, 2*qi), since t_last is in [0, qk)
+        ntts[i]->ComputeForward(t_ntt_ptr, t_ntt_ptr, 2, 4);
+      }
       // Since SEAL uses at most 60bit moduli, 8*qi < 2^63.
-      qi_lazy = qi << 2;
+      uint64_t qi_lazy = qi << 2;
 
       // ((ct mod qi) - (ct mod qk)) mod qi
       uint64_t* t_ith_poly = &t_poly_prod_it[i * coeff_count];
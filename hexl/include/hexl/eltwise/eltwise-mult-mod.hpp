@@ -15,9 +15,11 @@ namespace hexl {
 /// @param[in] operand2 Vector of elements to multiply. Each element must be
 /// less than the modulus.
 /// @param[in] n Number of elements in each vector
-/// @param[in] modulus Modulus with which to perform modular reduction
+/// @param[in] modulus Modulus with which to perform modular reduction. Must be
+/// odd if at least 2^62.
 /// @param[in] input_mod_factor Assumes input elements are in [0,
-/// input_mod_factor * p) Must be 1, 2 or 4.
+/// input_mod_factor * p), or less than 2^64 if that is smaller. Must be 1, 2 or
+/// 4.
 /// @details Computes \p result[i] = (\p operand1[i] * \p operand2[i]) mod \p
 /// modulus for i=0, ..., \p n - 1
 void EltwiseMultMod(uint64_t* result, const uint64_t* operand1,
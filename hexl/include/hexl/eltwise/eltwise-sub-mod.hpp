@@ -16,7 +16,7 @@ namespace hexl {
 /// less than the modulus
 /// @param[in] n Number of elements in each vector
 /// @param[in] modulus Modulus with which to perform modular reduction. Must be
-/// in the range \f$[2, 2^{63} - 1]\f$
+/// in the range \f$[2, 2^{64} - 1]\f$
 /// @details Computes \f$ operand1[i] = (operand1[i] - operand2[i]) \mod modulus
 /// \f$ for \f$ i=0, ..., n-1\f$.
 void EltwiseSubMod(uint64_t* result, const uint64_t* operand1,
@@ -30,7 +30,7 @@ void EltwiseSubMod(uint64_t* result, const uint64_t* operand1,
 /// less than the modulus
 /// @param[in] n Number of elements in each vector
 /// @param[in] modulus Modulus with which to perform modular reduction. Must be
-/// in the range \f$[2, 2^{63} - 1]\f$
+/// in the range \f$[2, 2^{64} - 1]\f$
 /// @details Computes \f$ operand1[i] = (operand1[i] - operand2) \mod modulus
 /// \f$ for \f$ i=0, ..., n-1\f$.
 void EltwiseSubMod(uint64_t* result, const uint64_t* operand1,
@@ -17,6 +17,9 @@
 #include "hexl/experimental/seal/key-switch-internal.hpp"
 #include "hexl/experimental/seal/key-switch.hpp"
 #include "hexl/logging/logging.hpp"
+#include "hexl/ntt/ntt-32.hpp"
+#include "hexl/ntt/ntt-mixed-radix.hpp"
+#include "hexl/ntt/ntt-registry.hpp"
 #include "hexl/ntt/ntt.hpp"
 #include "hexl/number-theory/number-theory.hpp"
 #include "hexl/util/check.hpp"
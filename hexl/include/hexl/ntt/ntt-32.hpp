@@ -0,0 +1,132 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdint.h>
+
+#include <memory>
+
+#include "hexl/util/aligned-allocator.hpp"
+#include "hexl/util/allocator.hpp"
+
+namespace intel {
+namespace hexl {
+
+/// @brief Performs the negacyclic number-theoretic transform over
+/// \f$ \mathbb{Z}_q[X] / (X^N + 1) \f$ on uint32_t coefficients, for prime
+/// moduli q < 2^30 such as BFV plaintext moduli
+/// @details Computes the same transforms as NTT, with the same bit-reversed
+/// output order and lazy reduction bounds, but stores coefficients and roots of
+/// unity in 32 bits. This halves the memory traffic and doubles the number of
+/// coefficients per vector: the AVX512 transforms process 16 coefficients per
+/// vector and the AVX2 transforms 8.
+class NTT32 {
+ public:
+  /// @brief Initializes an empty NTT32 object
+  NTT32() = default;
+
+  /// @brief Initializes an NTT32 object with degree \p degree and modulus \p q
+  /// @param[in] degree N. Size of the transform. Must be a power of two, at
+  /// most 2^NTT::MaxDirectDegreeBits().
+  /// @param[in] q Prime modulus. Must satisfy \f$ q == 1 \mod 2N \f$ and q <
+  /// 2^MaxModulusBits()
+  /// @param[in] alloc_ptr Custom memory allocator used for the tables
+  /// @details Uses the minimal 2N'th root of unity, so the transforms equal
+  /// those of NTT(degree, q).
+  NTT32(uint64_t degree, uint32_t q,
+        std::shared_ptr<AllocatorBase> alloc_ptr = {});
+
+  /// @brief Initializes an NTT32 object with degree \p degree, modulus \p q
+  /// and root of unity \p root_of_unity
+  /// @param[in] degree N. Size of the transform. Must be a power of two, at
+  /// most 2^NTT::MaxDirectDegreeBits().
+  /// @param[in] q Prime modulus. Must satisfy \f$ q == 1 \mod 2N \f$ and q <
+  /// 2^MaxModulusBits()
+  /// @param[in] root_of_unity 2N'th primitive root of unity modulo \p q
+  /// @param[in] alloc_ptr Custom memory allocator used for the tables
+  NTT32(uint64_t degree, uint32_t q, uint32_t root_of_unity,
+        std::shared_ptr<AllocatorBase> alloc_ptr = {});
+
+  /// @brief Returns true if arguments satisfy constraints for the NTT32
+  /// @param[in] degree N. Size of the transform. Must be a power of two, at
+  /// most 2^NTT::MaxDirectDegreeBits().
+  /// @param[in] modulus Prime modulus q. Must satisfy q mod 2N = 1 and q <
+  /// 2^MaxModulusBits()
+  static bool CheckArguments(uint64_t degree, uint64_t modulus);
+
+  /// @brief Maximum number of bits in the modulus, such that all lazily
+  /// reduced values in [0, 4q) fit in 32 bits
+  static size_t MaxModulusBits() { return 30; }
+
+  /// @brief Computes the forward NTT
+  /// @param[out] result Stores the result. May alias \p operand.
+  /// @param[in] operand Data on which to compute the NTT
+  /// @param[in] input_mod_factor Assumes input operand are in [0,
+  /// input_mod_factor * q). Must be 1, 2 or 4.
+  /// @param[in] output_mod_factor Returns output operand in [0,
+  /// output_mod_factor * q). Must be 1 or 4.
+  void ComputeForward(uint32_t* result, const uint32_t* operand,
+                      uint64_t input_mod_factor,
+                      uint64_t output_mod_factor) const;
+
+  /// @brief Computes the inverse NTT
+  /// @param[out] result Stores the result. May alias \p operand.
+  /// @param[in] operand Data on which to compute the NTT
+  /// @param[in] input_mod_factor Assumes input operand are in [0,
+  /// input_mod_factor * q). Must be 1 or 2.
+  /// @param[in] output_mod_factor Returns output operand in [0,
+  /// output_mod_factor * q). Must be 1 or 2.
+  void ComputeInverse(uint32_t* result, const uint32_t* operand,
+                      uint64_t input_mod_factor,
+                      uint64_t output_mod_factor) const;
+
+  /// @brief Returns the degree N
+  uint64_t GetDegree() const { return m_degree; }
+
+  /// @brief Returns the word-sized prime modulus
+  uint32_t GetModulus() const { return m_q; }
+
+  /// @brief Returns the 2N'th root of unity of the transforms
+  uint32_t GetMinimalRootOfUnity() const { return m_w; }
+
+  /// @brief Returns the root of unity powers in bit-reversed order, in the
+  /// layout of NTT::GetRootOfUnityPowers()
+  const AlignedVector64<uint32_t>& GetRootOfUnityPowers() const {
+    return m_root_of_unity_powers;
+  }
+
+  /// @brief Returns the 32-bit pre-conditioned root of unity powers
+  /// floor(w * 2^32 / q)
+  const AlignedVector64<uint32_t>& GetPreconRootOfUnityPowers() const {
+    return m_precon_root_of_unity_powers;
+  }
+
+  /// @brief Returns the inverse root of unity powers, in the layout of
+  /// NTT::GetInvRootOfUnityPowers()
+  const AlignedVector64<uint32_t>& GetInvRootOfUnityPowers() const {
+    return m_inv_root_of_unity_powers;
+  }
+
+  /// @brief Returns the 32-bit pre-conditioned inverse root of unity powers
+  const AlignedVector64<uint32_t>& GetPreconInvRootOfUnityPowers() const {
+    return m_precon_inv_root_of_unity_powers;
+  }
+
+ private:
+  uint64_t m_degree{0};
+  uint32_t m_q{0};
+  uint32_t m_w{0};
+
+  std::shared_ptr<AllocatorBase> m_alloc;
+  AlignedAllocator<uint32_t, 64> m_aligned_alloc{m_alloc};
+
+  AlignedVector64<uint32_t> m_root_of_unity_powers{m_aligned_alloc};
+  AlignedVector64<uint32_t> m_precon_root_of_unity_powers{m_aligned_alloc};
+  AlignedVector64<uint32_t> m_inv_root_of_unity_powers{m_aligned_alloc};
+  AlignedVector64<uint32_t> m_precon_inv_root_of_unity_powers{
+      m_aligned_alloc};
+};
+
+}  // namespace hexl
+}  // namespace intel
@@ -0,0 +1,122 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "hexl/ntt/ntt.hpp"
+#include "hexl/util/aligned-allocator.hpp"
+#include "hexl/util/allocator.hpp"
+
+namespace intel {
+namespace hexl {
+
+/// @brief Performs the cyclic number-theoretic transform of arbitrary length
+/// n, i.e. the DFT over \f$ \mathbb{Z}_q \f$ evaluating a polynomial of degree
+/// less than n at the powers of an n'th root of unity, as used for m'th
+/// cyclotomic rings with m not a power of two.
+/// @details For n = n1 * 2^k with n1 a product of powers of 3 and 5, the
+/// transform is split into 2^k radix-3 and radix-5 transforms of length n1,
+/// computed together on rows of 2^k elements, and n1 cyclic NTTs of length
+/// 2^k, which use the AVX512 or AVX2 transforms where available. Other
+/// lengths use Bluestein's algorithm, which computes the transform as a cyclic
+/// convolution of power-of-two length M >= 2n - 1 via a cyclic NTT.
+class MixedRadixNTT {
+ public:
+  /// @brief Initializes an empty MixedRadixNTT object
+  MixedRadixNTT() = default;
+
+  /// @brief Initializes a MixedRadixNTT object of length \p degree and modulus
+  /// \p q
+  /// @param[in] degree n. Length of the transform. Must be positive.
+  /// @param[in] q Prime modulus. Must satisfy CheckArguments(degree, q).
+  /// @param[in] alloc_ptr Custom memory allocator used for intermediate
+  /// calculations
+  MixedRadixNTT(uint64_t degree, uint64_t q,
+                std::shared_ptr<AllocatorBase> alloc_ptr = {});
+
+  /// @brief Returns true if a transform of length \p degree modulo \p q is
+  /// supported, i.e. n is at most 2^NTT::MaxDegreeBits(), its largest power of
+  /// two factor is at most 2^NTT::MaxDirectDegreeBits(), and \p q is a prime
+  /// less than 2^61 with q == 1 mod n. If n has prime factors other than 2,
+  /// 3 and 5, Bluestein's algorithm additionally requires q == 1 mod M, for
+  /// the power of two M >= 2n - 1, with M at most
+  /// 2^NTT::MaxDirectDegreeBits(), and q == 1 mod 2n if n is even.
+  static bool CheckArguments(uint64_t degree, uint64_t q);
+
+  /// @brief Returns true if the transform of length \p degree uses Bluestein's
+  /// algorithm, i.e. if \p degree has prime factors other than 2, 3 and 5
+  static bool UsesBluestein(uint64_t degree);
+
+  /// @brief Computes the forward transform result[k] = sum_j operand[j] *
+  /// w^(j k) mod q, for the root of unity w = GetRootOfUnity(). Inputs and
+  /// outputs are in natural order.
+  /// @param[out] result Stores the result. May alias \p operand.
+  /// @param[in] operand Data on which to compute the transform, in [0, q)
+  /// @details Outputs are in [0, q).
+  void ComputeForward(uint64_t* result, const uint64_t* operand) const;
+
+  /// @brief Computes the inverse of ComputeForward, i.e. result[j] = n^{-1} *
+  /// sum_k operand[k] * w^(-j k) mod q
+  /// @param[out] result Stores the result. May alias \p operand.
+  /// @param[in] operand Data on which to compute the transform, in [0, q)
+  /// @details Outputs are in [0, q).
+  void ComputeInverse(uint64_t* result, const uint64_t* operand) const;
+
+  /// @brief Returns the length n of the transform
+  uint64_t GetDegree() const { return m_degree; }
+
+  /// @brief Returns the word-sized prime modulus
+  uint64_t GetModulus() const { return m_q; }
+
+  /// @brief Returns the primitive n'th root of unity w of the transform
+  uint64_t GetRootOfUnity() const { return m_w; }
+
+ private:
+  // Precomputed tables of the forward or inverse transform
+  struct Tables;
+  std::shared_ptr<const Tables> ComputeTables(bool inverse) const;
+
+  // Computes the length-m_odd_degree transforms over the rows of m_pow2_degree
+  // elements, using scratch of size n plus the butterfly scratch. result may
+  // alias operand.
+  void ColumnTransform(uint64_t* result, const uint64_t* operand,
+                       uint64_t* scratch, const Tables& tables) const;
+
+  // Computes the transform with Bluestein's algorithm
+  void BluesteinTransform(uint64_t* result, const uint64_t* operand,
+                          const Tables& tables) const;
+
+  uint64_t m_degree{0};
+  uint64_t m_q{0};
+  uint64_t m_w{0};
+
+  // Square root of m_w defining the chirp of Bluestein's algorithm
+  uint64_t m_chirp_root{0};
+
+  // Factorization n = m_odd_degree * m_pow2_degree, with m_odd_degree the
+  // product of the radices in m_radices, in order of application
+  uint64_t m_odd_degree{1};
+  uint64_t m_pow2_degree{1};
+  std::vector<uint64_t> m_radices;
+
+  // ReverseBits(i, Log2(m_pow2_degree)) for i < m_pow2_degree
+  std::vector<uint64_t> m_bit_reversed;
+
+  std::shared_ptr<AllocatorBase> m_alloc;
+  AlignedAllocator<uint64_t, 64> m_aligned_alloc{m_alloc};
+
+  // Cyclic NTT of length m_pow2_degree, or of the Bluestein convolution
+  // length. Not set if the length is 1.
+  std::shared_ptr<NTT> m_ntt;
+
+  std::shared_ptr<const Tables> m_fwd_tables;
+  std::shared_ptr<const Tables> m_inv_tables;
+};
+
+}  // namespace hexl
+}  // namespace intel
@@ -0,0 +1,181 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "hexl/ntt/ntt.hpp"
+
+namespace intel {
+namespace hexl {
+
+/// @brief Thread-safe registry of NTT objects keyed on (degree, modulus, root
+/// of unity), which shares one NTT per parameter set between its users
+/// @details The registry holds at most GetByteBudget() bytes of precomputed
+/// tables, as reported by NTT::GetTableMemoryBytes(), evicting the least
+/// recently used NTTs when a new NTT exceeds the budget. Evicted NTTs remain
+/// valid for users which still hold them, and are freed when the last user
+/// releases them. NTTs returned by the registry are shared, so must not be
+/// reconfigured, e.g. via NTT::SetNativeRadix(). Registered NTTs use
+/// NTT::GetDefaultTwiddleMode() at the time they are constructed.
+///
+/// Get locks the registry on each call. For lookups in hot loops, GetCached
+/// serves repeated lookups from a small per-thread cache without locking or
+/// writing shared memory.
+class NTTRegistry {
+ public:
+  /// @brief Usage statistics of a registry
+  struct Stats {
+    /// @brief Number of lookups which returned a registered NTT. Lookups
+    /// served by the per-thread caches of GetCached are not counted.
+    uint64_t hits = 0;
+    /// @brief Number of lookups which constructed a new NTT
+    uint64_t misses = 0;
+    /// @brief Number of NTTs evicted to stay within the byte budget
+    uint64_t evictions = 0;
+    /// @brief Number of registered NTTs
+    size_t num_entries = 0;
+    /// @brief Table memory of the registered NTTs, in bytes
+    size_t num_bytes = 0;
+  };
+
+  /// @brief Initializes an empty registry
+  /// @param[in] byte_budget Maximum table memory of the registered NTTs, in
+  /// bytes. A value of 0 means no limit.
+  explicit NTTRegistry(size_t byte_budget = 0);
+
+  /// @brief Returns the process-wide registry, which has no byte budget
+  /// unless set by SetByteBudget()
+  static NTTRegistry& Global();
+
+  /// @brief Returns the NTT with the given parameters, constructing and
+  /// registering it if needed
+  /// @param[in] degree Size of the transform. Must be a power of two.
+  /// @param[in] modulus Prime modulus. Must satisfy modulus == 1 mod 2 *
+  /// degree
+  /// @param[in] root_of_unity Primitive 2 * degree'th root of unity mod
+  /// modulus, or 0 to use the minimal one. NTTs with root_of_unity 0 and with
+  /// an explicit minimal root of unity are registered separately.
+  std::shared_ptr<NTT> Get(uint64_t degree, uint64_t modulus,
+                           uint64_t root_of_unity = 0);
+
+  /// @brief Returns the same NTT as Get, looking it up in a per-thread cache
+  /// of recently used NTTs first
+  /// @details A cached lookup reads one shared atomic counter, which changes
+  /// only when NTTs are removed from the registry, and copies a shared_ptr
+  /// owned by the calling thread. It neither locks the registry nor updates
+  /// the hit count; instead it marks the NTT as referenced, which protects it
+  /// from the next eviction. Each thread caches up to
+  /// s_thread_cache_size NTTs, which may keep NTTs removed from the registry
+  /// alive until the thread next calls GetCached.
+  std::shared_ptr<NTT> GetCached(uint64_t degree, uint64_t modulus,
+                                 uint64_t root_of_unity = 0);
+
+  /// @brief Number of NTTs in the per-thread cache of GetCached
+  static const size_t s_thread_cache_size = 16;
+
+  /// @brief Constructs and registers the NTTs of the given degree for each of
+  /// \p moduli which are not registered yet, without counting hits or misses
+  /// @param[in] degree Size of the transforms
+  /// @param[in] moduli Prime moduli, each 1 mod 2 * degree
+  /// @param[in] all_tables If true, also builds all lazily computed tables,
+  /// e.g. those returned by NTT::GetRootOfUnityPowers()
+  void Prewarm(uint64_t degree, const std::vector<uint64_t>& moduli,
+               bool all_tables = false);
+
+  /// @brief Removes all NTTs from the registry
+  void Purge();
+
+  /// @brief Removes the NTT with the given parameters from the registry
+  /// @return True if it was registered
+  bool Purge(uint64_t degree, uint64_t modulus, uint64_t root_of_unity = 0);
+
+  /// @brief Returns the maximum table memory of the registered NTTs, in bytes,
+  /// or 0 if unlimited
+  size_t GetByteBudget() const;
+
+  /// @brief Sets the value returned by GetByteBudget(), evicting the least
+  /// recently used NTTs to meet the new budget
+  /// @details The most recently used NTT is kept even if it alone exceeds the
+  /// budget.
+  void SetByteBudget(size_t byte_budget);
+
+  /// @brief Returns the usage statistics of the registry
+  /// @details num_bytes includes tables which registered NTTs have built since
+  /// they were last returned by Get.
+  Stats GetStats() const;
+
+  /// @brief Resets the hit, miss and eviction counts to 0
+  void ResetStats();
+
+ private:
+  struct Key {
+    uint64_t degree;
+    uint64_t modulus;
+    uint64_t root_of_unity;
+
+    bool operator==(const Key& other) const {
+      return degree == other.degree && modulus == other.modulus &&
+             root_of_unity == other.root_of_unity;
+    }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+
+  struct Entry {
+    Key key;
+    std::shared_ptr<NTT> ntt;
+    size_t num_bytes;
+    // Set by GetCached, which does not reorder the LRU list. Entries with the
+    // flag set are moved to the front instead of being evicted.
+    std::shared_ptr<std::atomic<bool>> referenced;
+  };
+
+  // Returns the registered NTT, constructing it on a miss. If referenced is
+  // not nullptr, stores the referenced flag of the entry.
+  std::shared_ptr<NTT> Lookup(
+      const Key& key, bool count_stats,
+      std::shared_ptr<std::atomic<bool>>* referenced = nullptr);
+
+  // Moves the entry to the front of the LRU list and updates its size.
+  // Requires m_mutex to be held.
+  void Touch(std::list<Entry>::iterator entry);
+
+  // Evicts the least recently used entries, except the most recently used,
+  // until the total size is within budget. Requires m_mutex to be held.
+  void EvictToBudget();
+
+  // Removes the entry and invalidates the per-thread caches. Requires m_mutex
+  // to be held.
+  void Erase(std::list<Entry>::iterator entry);
+
+  // Identifies the registry in the per-thread caches
+  const uint64_t m_id;
+
+  // Incremented whenever an entry is removed, invalidating the per-thread
+  // caches. Kept on its own cache line, since it is read by every GetCached.
+  alignas(64) std::atomic<uint64_t> m_generation{0};
+
+  alignas(64) mutable std::mutex m_mutex;
+  size_t m_byte_budget;
+  size_t m_num_bytes{0};
+  Stats m_stats;
+
+  // Most recently used entry first
+  std::list<Entry> m_lru;
+  std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> m_entries;
+};
+
+}  // namespace hexl
+}  // namespace intel
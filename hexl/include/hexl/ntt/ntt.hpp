@@ -5,7 +5,9 @@
 
 #include <stdint.h>
 
+#include <iosfwd>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "hexl/util/aligned-allocator.hpp"
@@ -14,11 +16,14 @@
 namespace intel {
 namespace hexl {
 
+class FourStepNTT;
+
 /// @brief Performs negacyclic forward and inverse number-theoretic transform
 /// (NTT), commonly used in RLWE cryptography.
 /// @details The number-theoretic transform (NTT) specializes the discrete
 /// Fourier transform (DFT) to the finite field \f$ \mathbb{Z}_q[X] / (X^N + 1)
-/// \f$.
+/// \f$. NTTs returned by CreateCyclic instead compute the cyclic transform
+/// over \f$ \mathbb{Z}_q[X] / (X^N - 1) \f$.
 class NTT {
  public:
   /// @brief Helper class for custom memory allocation
@@ -83,12 +88,62 @@ class NTT {
                 std::make_shared<AllocatorAdapter<Allocator, AllocatorArgs...>>(
                     std::move(a), std::forward<AllocatorArgs>(args)...))) {}
 
+  /// @brief Returns an NTT of degree \p degree with the same modulus, which
+  /// reads the precomputed tables of this NTT in place instead of computing
+  /// its own
+  /// @param[in] degree Power of two, at most GetDegree()
+  /// @details The root of unity of the returned NTT is
+  /// GetMinimalRootOfUnity()^(GetDegree() / degree), which is generally not
+  /// the minimal root of unity for \p degree. The native and inverse tables
+  /// are shared, and only the AVX512 layout of the forward roots, if used, is
+  /// computed. The returned NTT keeps this NTT's tables alive, and its
+  /// GetTableMemoryBytes() excludes them. Calling CreateSubNTT on the returned
+  /// NTT shares the tables of the original NTT.
+  NTT CreateSubNTT(uint64_t degree) const;
+
+  /// @brief Returns an NTT computing the cyclic transform of degree \p degree,
+  /// i.e. over Z_q[X] / (X^N - 1)
+  /// @param[in] degree N. Size of the transform. Must be a power of two, at
+  /// least 2 and at most 2^MaxDirectDegreeBits().
+  /// @param[in] q Prime modulus. Must satisfy \f$ q == 1 \mod N \f$
+  /// @param[in] alloc_ptr Custom memory allocator used for intermediate
+  /// calculations
+  /// @details ComputeForward evaluates the input polynomial at w^bitrev(i),
+  /// for the minimal N'th root of unity w, using the same transforms and with
+  /// the same lazy reduction bounds as the negacyclic NTT. Multiply computes
+  /// cyclic convolutions. Cyclic NTTs do not support TwiddleMode::Compact.
+  static NTT CreateCyclic(uint64_t degree, uint64_t q,
+                          std::shared_ptr<AllocatorBase> alloc_ptr = {});
+
+  /// @brief Returns an NTT computing the cyclic transform of degree \p degree
+  /// with root of unity \p root_of_unity
+  /// @param[in] degree N. Size of the transform. Must be a power of two, at
+  /// least 2 and at most 2^MaxDirectDegreeBits().
+  /// @param[in] q Prime modulus. Must satisfy \f$ q == 1 \mod N \f$
+  /// @param[in] root_of_unity Primitive N'th root of unity in \f$
+  /// \mathbb{Z_q} \f$
+  /// @param[in] alloc_ptr Custom memory allocator used for intermediate
+  /// calculations
+  static NTT CreateCyclic(uint64_t degree, uint64_t q, uint64_t root_of_unity,
+                          std::shared_ptr<AllocatorBase> alloc_ptr = {});
+
   /// @brief Returns true if arguments satisfy constraints for negacyclic NTT
   /// @param[in] degree N. Size of the transform, i.e. the polynomial degree.
   /// Must be a power of two.
   /// @param[in] modulus Prime modulus q. Must satisfy q mod 2N = 1
   static bool CheckArguments(uint64_t degree, uint64_t modulus);
 
+  /// @brief Returns true if arguments satisfy constraints for cyclic NTT
+  /// @param[in] degree N. Size of the transform. Must be a power of two.
+  /// @param[in] modulus Prime modulus q. Must satisfy q mod N = 1
+  /// @details The native and AVX512 transforms, which both kinds of NTT
+  /// share, check these weaker constraints.
+  static bool CheckCyclicArguments(uint64_t degree, uint64_t modulus);
+
+  /// @brief Returns true if this NTT was returned by CreateCyclic, or is a
+  /// sub-NTT or deserialized copy of one
+  bool IsCyclic() const { return m_cyclic; }
+
   /// @brief Compute forward NTT. Results are bit-reversed.
   /// @param[out] result Stores the result
   /// @param[in] operand Data on which to compute the NTT
@@ -99,6 +154,18 @@ class NTT {
   void ComputeForward(uint64_t* result, const uint64_t* operand,
                       uint64_t input_mod_factor, uint64_t output_mod_factor);
 
+  /// @brief Compute forward NTT of inputs not reduced modulo q, e.g. residues
+  /// modulo another RNS prime. Results are bit-reversed.
+  /// @param[out] result Stores the result. May alias \p operand.
+  /// @param[in] operand Data on which to compute the NTT; any 64-bit values
+  /// @param[in] output_mod_factor Returns output \p result in [0,
+  /// output_mod_factor * q). Must be 1 or 4.
+  /// @details Equivalent to reducing \p operand modulo q and calling
+  /// ComputeForward, but in the default twiddle mode the reduction is fused
+  /// into the first butterfly stage rather than taking a separate pass.
+  void ComputeForwardFromUnreduced(uint64_t* result, const uint64_t* operand,
+                                   uint64_t output_mod_factor);
+
   /// Compute inverse NTT. Results are bit-reversed.
   /// @param[out] result Stores the result
   /// @param[in] operand Data on which to compute the NTT
@@ -109,7 +176,244 @@ class NTT {
   void ComputeInverse(uint64_t* result, const uint64_t* operand,
                       uint64_t input_mod_factor, uint64_t output_mod_factor);
 
-  /// @brief Returns the minimal 2N'th root of unity
+  /// @brief Compute inverse NTT scaled by a constant and shifted by an additive
+  /// correction, i.e. scalar * InvNTT(operand) + addend mod q. Inputs are
+  /// bit-reversed.
+  /// @param[out] result Stores the result. May alias \p operand.
+  /// @param[in] operand Data on which to compute the NTT
+  /// @param[in] scalar Constant multiplying each output. Must be less than q.
+  /// @param[in] addend Constant added to each output. Must be less than q.
+  /// @param[in] input_mod_factor Assume input \p operand are in [0,
+  /// input_mod_factor * q). Must be 1 or 2.
+  /// @param[in] output_mod_factor Returns output \p result in [0,
+  /// output_mod_factor * q). Must be 1 or 2.
+  /// @details In the default twiddle mode, the scalar is folded into the
+  /// multiplication by n^{-1} in the final butterfly stage, and the addend is
+  /// added in the same stage, rather than taking separate passes such as
+  /// EltwiseFMAMod.
+  void ComputeInverseScaled(uint64_t* result, const uint64_t* operand,
+                            uint64_t scalar, uint64_t addend,
+                            uint64_t input_mod_factor,
+                            uint64_t output_mod_factor);
+
+  /// @brief Compute forward NTT of several polynomials. Results are
+  /// bit-reversed.
+  /// @param[out] result Pointers to the \p num_polys outputs. result[i] may
+  /// alias operand[i], but no other input or output.
+  /// @param[in] operand Pointers to the \p num_polys inputs
+  /// @param[in] num_polys Number of polynomials to transform
+  /// @param[in] input_mod_factor Assume inputs are in [0, input_mod_factor *
+  /// q). Must be 1, 2 or 4.
+  /// @param[in] output_mod_factor Returns outputs in [0, output_mod_factor *
+  /// q). Must be 1 or 4.
+  /// @details Equivalent to calling ComputeForward on each polynomial. With
+  /// AVX512, serial transforms process the polynomials in lockstep, such that
+  /// each root of unity vector is loaded once for all the polynomials.
+  void ComputeForwardMulti(uint64_t* const* result,
+                           const uint64_t* const* operand, size_t num_polys,
+                           uint64_t input_mod_factor,
+                           uint64_t output_mod_factor);
+
+  /// @brief Compute inverse NTT of several polynomials. Inputs are
+  /// bit-reversed.
+  /// @param[out] result Pointers to the \p num_polys outputs. result[i] may
+  /// alias operand[i], but no other input or output.
+  /// @param[in] operand Pointers to the \p num_polys inputs
+  /// @param[in] num_polys Number of polynomials to transform
+  /// @param[in] input_mod_factor Assume inputs are in [0, input_mod_factor *
+  /// q). Must be 1 or 2.
+  /// @param[in] output_mod_factor Returns outputs in [0, output_mod_factor *
+  /// q). Must be 1 or 2.
+  /// @details Equivalent to calling ComputeInverse on each polynomial, with the
+  /// same lockstep processing as ComputeForwardMulti
+  void ComputeInverseMulti(uint64_t* const* result,
+                           const uint64_t* const* operand, size_t num_polys,
+                           uint64_t input_mod_factor,
+                           uint64_t output_mod_factor);
+
+  /// @brief Compute forward NTTs of a batch of polynomials stored
+  /// coefficient-major. Results are bit-reversed.
+  /// @param[out] result Stores the result, in the layout of \p operand. May
+  /// alias \p operand.
+  /// @param[in] operand Coefficient i of polynomial p at index i * num_polys +
+  /// p, for i in [0, N) and p in [0, num_polys)
+  /// @param[in] num_polys Number of polynomials
+  /// @param[in] input_mod_factor Assume input \p operand are in [0,
+  /// input_mod_factor * q). Must be 1, 2 or 4.
+  /// @param[in] output_mod_factor Returns output \p result in [0,
+  /// output_mod_factor * q). Must be 1 or 4.
+  /// @details Vectorizes across the polynomials rather than within each one,
+  /// with one polynomial per SIMD lane, so degrees below the minimum of the
+  /// vectorized ComputeForward, such as N < 16, are vectorized too. Uses the
+  /// AVX512 kernels for at least 8 polynomials, and the AVX2 kernels for at
+  /// least 4.
+  void ComputeForwardBatch(uint64_t* result, const uint64_t* operand,
+                           size_t num_polys, uint64_t input_mod_factor,
+                           uint64_t output_mod_factor);
+
+  /// @brief Compute inverse NTTs of a batch of polynomials stored
+  /// coefficient-major, i.e. the inverse of ComputeForwardBatch. Inputs are
+  /// bit-reversed.
+  /// @param[out] result Stores the result, in the layout of \p operand. May
+  /// alias \p operand.
+  /// @param[in] operand Coefficient i of polynomial p at index i * num_polys +
+  /// p, for i in [0, N) and p in [0, num_polys)
+  /// @param[in] num_polys Number of polynomials
+  /// @param[in] input_mod_factor Assume input \p operand are in [0,
+  /// input_mod_factor * q). Must be 1 or 2.
+  /// @param[in] output_mod_factor Returns output \p result in [0,
+  /// output_mod_factor * q). Must be 1 or 2.
+  void ComputeInverseBatch(uint64_t* result, const uint64_t* operand,
+                           size_t num_polys, uint64_t input_mod_factor,
+                           uint64_t output_mod_factor);
+
+  /// @brief Compute forward NTT with results in natural order, i.e. result[i]
+  /// is the evaluation at psi^(2i + 1) for the minimal root of unity psi
+  /// @param[out] result Stores the result. May alias \p operand.
+  /// @param[in] operand Data on which to compute the NTT
+  /// @param[in] input_mod_factor Assume input \p operand are in [0,
+  /// input_mod_factor * q). Must be 1, 2 or 4.
+  /// @param[in] output_mod_factor Returns output \p result in [0,
+  /// output_mod_factor * q). Must be 1 or 4.
+  /// @details Equivalent to ComputeForward followed by BitReversePermute. When
+  /// ComputeForward uses a scalar transform, computed without a separate
+  /// permutation pass by a Stockham transform. For cyclic NTTs, result[i] is
+  /// the evaluation at w^i for the minimal root of unity w.
+  void ComputeForwardNatural(uint64_t* result, const uint64_t* operand,
+                             uint64_t input_mod_factor,
+                             uint64_t output_mod_factor);
+
+  /// @brief Compute inverse NTT of inputs in natural order, i.e. the inverse
+  /// of ComputeForwardNatural
+  /// @param[out] result Stores the result. May alias \p operand.
+  /// @param[in] operand Data on which to compute the NTT
+  /// @param[in] input_mod_factor Assume input \p operand are in [0,
+  /// input_mod_factor * q). Must be 1 or 2.
+  /// @param[in] output_mod_factor Returns output \p result in [0,
+  /// output_mod_factor * q). Must be 1 or 2.
+  void ComputeInverseNatural(uint64_t* result, const uint64_t* operand,
+                             uint64_t input_mod_factor,
+                             uint64_t output_mod_factor);
+
+  /// @brief Computes the negacyclic product operand1 * operand2 mod (X^N + 1,
+  /// q) as InvNTT(NTT(operand1) * NTT(operand2)). For cyclic NTTs, computes
+  /// the cyclic product mod (X^N - 1, q).
+  /// @param[out] result Stores the product. May alias either operand.
+  /// @param[in] operand1 First polynomial, in coefficient form
+  /// @param[in] operand2 Second polynomial, in coefficient form
+  /// @param[in] input_mod_factor Assume inputs \p operand1 and \p operand2 are
+  /// in [0, input_mod_factor * q). Must be 1, 2 or 4.
+  /// @param[in] output_mod_factor Returns output \p result in [0,
+  /// output_mod_factor * q). Must be 1 or 2.
+  /// @details The forward NTT outputs stay lazily reduced in [0, 4q), and the
+  /// pointwise product is computed on each cache-resident block of the inverse
+  /// NTT, avoiding a separate pass over memory.
+  void Multiply(uint64_t* result, const uint64_t* operand1,
+                const uint64_t* operand2, uint64_t input_mod_factor,
+                uint64_t output_mod_factor);
+
+  /// @brief Computes the negacyclic product of \p operand with a polynomial
+  /// already in NTT form, such as a constant plaintext, as
+  /// InvNTT(NTT(operand) * transformed_operand).
+  /// @param[out] result Stores the product. May alias \p operand.
+  /// @param[in] operand Polynomial in coefficient form
+  /// @param[in] transformed_operand Output of ComputeForward on the second
+  /// polynomial. Must be in [0, 4q) and must not alias \p result.
+  /// @param[in] input_mod_factor Assume input \p operand is in [0,
+  /// input_mod_factor * q). Must be 1, 2 or 4.
+  /// @param[in] output_mod_factor Returns output \p result in [0,
+  /// output_mod_factor * q). Must be 1 or 2.
+  void MultiplyTransformed(uint64_t* result, const uint64_t* operand,
+                           const uint64_t* transformed_operand,
+                           uint64_t input_mod_factor,
+                           uint64_t output_mod_factor);
+
+  /// @brief Radix of the native C++ implementation, which is used when no
+  /// AVX512 or AVX2 implementation applies
+  enum class NativeRadix { Radix2 = 2, Radix4 = 4 };
+
+  /// @brief Returns the radix used by the native forward transform
+  NativeRadix GetFwdNativeRadix() const { return m_fwd_native_radix; }
+
+  /// @brief Returns the radix used by the native inverse transform
+  NativeRadix GetInvNativeRadix() const { return m_inv_native_radix; }
+
+  /// @brief Overrides the radices selected at construction
+  /// @param[in] fwd_radix Radix used by the native forward transform
+  /// @param[in] inv_radix Radix used by the native inverse transform
+  void SetNativeRadix(NativeRadix fwd_radix, NativeRadix inv_radix) {
+    m_fwd_native_radix = fwd_radix;
+    m_inv_native_radix = inv_radix;
+  }
+
+  /// @brief Returns the native radix given by the built-in heuristic table
+  /// for a transform of size \p degree. Radix-4 performs half as many passes
+  /// over memory as radix-2, which pays off once the data exceeds the L1
+  /// cache.
+  static NativeRadix DefaultNativeRadix(uint64_t degree);
+
+  /// @brief Enables or disables timing-based selection of the native radix.
+  /// @details When enabled, constructing an NTT times both native radices once
+  /// per (degree, modulus bit-width) pair and selects the faster one for each
+  /// direction; results are cached for the lifetime of the process. When
+  /// disabled, DefaultNativeRadix is used. Measurement is initially enabled
+  /// iff the HEXL_NTT_MEASURE_RADIX environment variable is set.
+  static void SetMeasureNativeRadix(bool measure);
+
+  /// @brief Returns true if timing-based selection of the native radix is
+  /// enabled
+  static bool GetMeasureNativeRadix();
+
+  /// @brief Storage of the root of unity powers read by the transforms
+  enum class TwiddleMode {
+    /// Tables of all N roots of unity powers, with their pre-conditioned
+    /// values, read by all implementations
+    Full,
+    /// Compact tables of about 2 sqrt(N) roots of unity powers, from which the
+    /// transforms compute each root as the product of two powers. Trades one
+    /// modular multiplication per butterfly, for all but the first sqrt(N)
+    /// roots, for a table that stays resident in the L1 cache. Read by the
+    /// native C++ transforms and by AVX512 and AVX2 transforms, with 52-bit
+    /// multiplications for the AVX512-IFMA transforms and 64-bit otherwise.
+    Compact,
+    /// A single table of N roots of unity powers w * R mod q per direction,
+    /// without pre-conditioned values, read by transforms using Montgomery
+    /// multiplication. R is 2^52 for the AVX512-IFMA transforms and 2^64
+    /// otherwise. Since the transforms are linear, inputs in Montgomery form
+    /// yield outputs in Montgomery form; outputs are those of Full mode.
+    /// Halves the table memory of Full mode. The only mode supported for
+    /// moduli of at least s_max_lazy_modulus.
+    Montgomery
+  };
+
+  /// @brief Returns the twiddle mode used by ComputeForward and ComputeInverse
+  TwiddleMode GetTwiddleMode() const { return m_twiddle_mode; }
+
+  /// @brief Overrides the twiddle mode selected at construction
+  /// @details Tables of the new mode are built on the first transform. Has no
+  /// effect on four-step NTTs, which use Full mode. Cyclic NTTs use Full mode
+  /// in place of Compact mode. NTTs with moduli of at least s_max_lazy_modulus
+  /// always use Montgomery mode.
+  void SetTwiddleMode(TwiddleMode mode) {
+    if (m_q >= s_max_lazy_modulus) {
+      mode = TwiddleMode::Montgomery;
+    } else if (m_cyclic && mode == TwiddleMode::Compact) {
+      mode = TwiddleMode::Full;
+    }
+    m_twiddle_mode = mode;
+  }
+
+  /// @brief Returns the twiddle mode of newly constructed NTTs. Only the tables
+  /// of this mode are built at construction.
+  /// @details Initially Compact or Montgomery iff the HEXL_NTT_TWIDDLE_MODE
+  /// environment variable is set to "compact" or "montgomery", respectively.
+  static TwiddleMode GetDefaultTwiddleMode();
+
+  /// @brief Sets the value returned by GetDefaultTwiddleMode()
+  static void SetDefaultTwiddleMode(TwiddleMode mode);
+
+  /// @brief Returns the minimal 2N'th root of unity, or the minimal N'th root
+  /// of unity of cyclic NTTs
   uint64_t GetMinimalRootOfUnity() const { return m_w; }
 
   /// @brief Returns the degree N
@@ -120,7 +424,7 @@ class NTT {
 
   /// @brief Returns the root of unity powers in bit-reversed order
   const AlignedVector64<uint64_t>& GetRootOfUnityPowers() const {
-    return m_root_of_unity_powers;
+    return GetTable(Table::RootOfUnityPowers);
   }
 
   /// @brief Returns the root of unity power at bit-reversed index i.
@@ -129,42 +433,42 @@ class NTT {
   /// @brief Returns 32-bit pre-conditioned root of unity powers in
   /// bit-reversed order
   const AlignedVector64<uint64_t>& GetPrecon32RootOfUnityPowers() const {
-    return m_precon32_root_of_unity_powers;
+    return GetTable(Table::Precon32RootOfUnityPowers);
   }
 
   /// @brief Returns 64-bit pre-conditioned root of unity powers in
   /// bit-reversed order
   const AlignedVector64<uint64_t>& GetPrecon64RootOfUnityPowers() const {
-    return m_precon64_root_of_unity_powers;
+    return GetTable(Table::Precon64RootOfUnityPowers);
   }
 
   /// @brief Returns the root of unity powers in bit-reversed order with
-  /// modifications for use by AVX512 implementation
+  /// modifications for use by AVX512 and AVX2 implementations
   const AlignedVector64<uint64_t>& GetAVX512RootOfUnityPowers() const {
-    return m_avx512_root_of_unity_powers;
+    return GetTable(Table::AVX512RootOfUnityPowers);
   }
 
   /// @brief Returns 32-bit pre-conditioned AVX512 root of unity powers in
   /// bit-reversed order
   const AlignedVector64<uint64_t>& GetAVX512Precon32RootOfUnityPowers() const {
-    return m_avx512_precon32_root_of_unity_powers;
+    return GetTable(Table::AVX512Precon32RootOfUnityPowers);
   }
 
   /// @brief Returns 52-bit pre-conditioned AVX512 root of unity powers in
   /// bit-reversed order
   const AlignedVector64<uint64_t>& GetAVX512Precon52RootOfUnityPowers() const {
-    return m_avx512_precon52_root_of_unity_powers;
+    return GetTable(Table::AVX512Precon52RootOfUnityPowers);
   }
 
   /// @brief Returns 64-bit pre-conditioned AVX512 root of unity powers in
   /// bit-reversed order
   const AlignedVector64<uint64_t>& GetAVX512Precon64RootOfUnityPowers() const {
-    return m_avx512_precon64_root_of_unity_powers;
+    return GetTable(Table::AVX512Precon64RootOfUnityPowers);
   }
 
   /// @brief Returns the inverse root of unity powers in bit-reversed order
   const AlignedVector64<uint64_t>& GetInvRootOfUnityPowers() const {
-    return m_inv_root_of_unity_powers;
+    return GetTable(Table::InvRootOfUnityPowers);
   }
 
   /// @brief Returns the inverse root of unity power at bit-reversed index i.
@@ -176,28 +480,140 @@ class NTT {
   /// unity
   // powers for the modulus and root of unity.
   const AlignedVector64<uint64_t>& GetPrecon32InvRootOfUnityPowers() const {
-    return m_precon32_inv_root_of_unity_powers;
+    return GetTable(Table::Precon32InvRootOfUnityPowers);
   }
 
   /// @brief Returns the vector of 52-bit pre-conditioned pre-computed root of
   /// unity
   // powers for the modulus and root of unity.
   const AlignedVector64<uint64_t>& GetPrecon52InvRootOfUnityPowers() const {
-    return m_precon52_inv_root_of_unity_powers;
+    return GetTable(Table::Precon52InvRootOfUnityPowers);
   }
 
   /// @brief Returns the vector of 64-bit pre-conditioned pre-computed root of
   /// unity
   // powers for the modulus and root of unity.
   const AlignedVector64<uint64_t>& GetPrecon64InvRootOfUnityPowers() const {
-    return m_precon64_inv_root_of_unity_powers;
+    return GetTable(Table::Precon64InvRootOfUnityPowers);
   }
 
+  /// @brief Returns the root of unity powers read by ComputeForward on this
+  /// CPU, i.e. the data of GetAVX512RootOfUnityPowers() if an AVX512 or AVX2
+  /// transform applies, and of GetRootOfUnityPowers() otherwise. In Montgomery
+  /// and Compact twiddle modes, returns the table of that mode instead.
+  /// @details Unlike the Get*RootOfUnityPowers() functions, does not copy
+  /// tables loaded by Deserialize. Returns nullptr for four-step NTTs.
+  const uint64_t* GetDispatchedRootOfUnityPowers() const;
+
+  /// @brief Returns the inverse root of unity powers read by ComputeInverse,
+  /// i.e. the data of GetInvRootOfUnityPowers(), or the table of the twiddle
+  /// mode in Montgomery and Compact twiddle modes
+  /// @details Does not copy tables loaded by Deserialize. Returns nullptr for
+  /// four-step NTTs.
+  const uint64_t* GetDispatchedInvRootOfUnityPowers() const;
+
+  /// @brief Writes the parameters and all precomputed tables of this NTT to
+  /// \p stream in a versioned binary format, which Deserialize loads without
+  /// recomputing the tables
+  /// @details Builds any table which has not been built yet. The format uses
+  /// the byte order of the host. Four-step NTTs only store their parameters.
+  void Serialize(std::ostream& stream) const;
+
+  /// @brief Returns the NTT stored in \p buffer by Serialize. The tables are
+  /// used in place, without copying.
+  /// @param[in] buffer Output of Serialize. Must be 8-byte aligned; 64-byte
+  /// alignment allows aligned loads of the tables.
+  /// @param[in] size Size of \p buffer in bytes
+  /// @param[in] buffer_owner Kept alive by the returned NTT and its copies, so
+  /// that \p buffer remains valid. If empty, \p buffer must outlive them.
+  /// @param[in] alloc_ptr Custom memory allocator used for tables built later,
+  /// e.g. copies returned by the Get*RootOfUnityPowers() functions
+  /// @details Throws std::invalid_argument if the header or the table sizes are
+  /// invalid. The table contents are trusted.
+  static NTT Deserialize(const void* buffer, size_t size,
+                         std::shared_ptr<const void> buffer_owner = {},
+                         std::shared_ptr<AllocatorBase> alloc_ptr = {});
+
+  /// @brief Returns the NTT stored by Serialize in the file at \p path, which
+  /// is memory-mapped read-only where supported, so the tables are loaded by
+  /// page faults on first use and shared between processes
+  /// @details Throws std::runtime_error if the file cannot be read, and
+  /// std::invalid_argument if its contents are invalid. On platforms without
+  /// mmap, the file is read into memory instead.
+  static NTT DeserializeMapped(const std::string& path,
+                               std::shared_ptr<AllocatorBase> alloc_ptr = {});
+
+  /// @brief Version of the format written by Serialize
+  static const uint64_t s_serialization_version{2};
+
   /// @brief Maximum power of 2 in degree
-  static size_t MaxDegreeBits() { return 20; }
+  static size_t MaxDegreeBits() { return 24; }
+
+  /// @brief Maximum power of 2 in degree computed by a direct transform.
+  /// Larger degrees use the four-step decomposition.
+  static size_t MaxDirectDegreeBits() { return 20; }
+
+  /// @brief Returns the size of the blocks on which the transforms switch from
+  /// depth-first to breadth-first traversal
+  /// @details Transforms larger than the base size recursively split the data
+  /// into blocks, performing one or two stages per pass over each block, until
+  /// the blocks are no larger than the base size. All remaining stages of a
+  /// block are then computed while the block is resident in the L1 cache.
+  static size_t GetBaseNTTSize();
+
+  /// @brief Sets the base size used by GetBaseNTTSize()
+  /// @param[in] base_ntt_size Power of two, at least 16. A value of 0 restores
+  /// DefaultBaseNTTSize().
+  static void SetBaseNTTSize(size_t base_ntt_size);
+
+  /// @brief Returns the value of the HEXL_NTT_BASE_SIZE environment variable
+  /// if set, and otherwise the largest power of two such that the data and
+  /// twiddle factors of a block fit in the detected L1 data cache
+  static size_t DefaultBaseNTTSize();
+
+  /// @brief Returns the smallest degree for which a single forward or inverse
+  /// transform is split into parallel tasks, or 0 if parallel transforms are
+  /// disabled
+  /// @details The outer recursion levels of a transform are run with the blocks
+  /// of each level as tasks, followed by the independent sub-transforms of the
+  /// innermost level, using the threads set by SetNumThreads. Transforms
+  /// computed inside other parallel HEXL routines, e.g. ComputeForwardRNS, are
+  /// always serial.
+  static uint64_t GetParallelCutoff();
+
+  /// @brief Sets the degree returned by GetParallelCutoff()
+  /// @param[in] cutoff Smallest degree computed in parallel. A value of 0
+  /// disables parallel transforms.
+  static void SetParallelCutoff(uint64_t cutoff);
+
+  /// @brief Returns the value of the HEXL_NTT_PARALLEL_CUTOFF environment
+  /// variable if set, and 0 otherwise, i.e. parallel transforms are opt-in
+  static uint64_t DefaultParallelCutoff();
+
+  /// @brief Returns true if the transforms use the four-step decomposition
+  /// @details The four-step decomposition is used for degrees larger than
+  /// 2^MaxDirectDegreeBits(). It splits the transform into cache-resident
+  /// transforms over the rows and columns of an N2 x N1 matrix. In that case,
+  /// the root of unity tables returned by this class are empty.
+  bool IsFourStep() const { return m_four_step != nullptr; }
+
+  /// @brief Returns the number of bytes of precomputed tables currently held
+  /// by this object, including those of the four-step sub-transforms
+  /// @details Only the tables read by the transforms that ComputeForward and
+  /// ComputeInverse dispatch to on this CPU are built at construction. Other
+  /// tables, e.g. those returned by GetPrecon32RootOfUnityPowers() when the
+  /// AVX512 transforms are used, are built on first access. Copies of an NTT
+  /// share their tables.
+  size_t GetTableMemoryBytes() const;
 
   /// @brief Maximum number of bits in modulus;
-  static size_t MaxModulusBits() { return 62; }
+  static size_t MaxModulusBits() { return 64; }
+
+  /// @brief Maximum modulus of the transforms with lazy reduction, whose
+  /// outputs in [0, 4q) fit in 64 bits. Transforms with larger moduli use
+  /// Montgomery multiplication with fully reduced butterflies, and return
+  /// outputs in [0, q) for any output_mod_factor.
+  static const size_t s_max_lazy_modulus{1ULL << 62};
 
   /// @brief Default bit shift used in Barrett precomputation
   static const size_t s_default_shift_bits{64};
@@ -222,6 +638,11 @@ class NTT {
   /// transform
   static const size_t s_max_inv_ifma_modulus{1ULL << (s_ifma_shift_bits - 2)};
 
+  /// @brief Maximum modulus to use AVX512-IFMA acceleration for the fully
+  /// reduced transforms, which apply to moduli of at least
+  /// s_max_fwd_ifma_modulus
+  static const size_t s_max_ifma_modulus{1ULL << s_ifma_shift_bits};
+
   /// @brief Maximum modulus to use AVX512-DQ acceleration for the inverse
   /// transform
   static const size_t s_max_inv_dq_modulus{1ULL << (s_default_shift_bits - 2)};
@@ -232,7 +653,7 @@ class NTT {
     } else if (bit_shift == 52) {
       return s_max_fwd_ifma_modulus;
     } else if (bit_shift == 64) {
-      return 1ULL << MaxModulusBits();
+      return s_max_lazy_modulus;
     }
     HEXL_CHECK(false, "Invalid bit_shift " << bit_shift);
     return 0;
@@ -244,14 +665,127 @@ class NTT {
     } else if (bit_shift == 52) {
       return s_max_inv_ifma_modulus;
     } else if (bit_shift == 64) {
-      return 1ULL << MaxModulusBits();
+      return s_max_lazy_modulus;
     }
     HEXL_CHECK(false, "Invalid bit_shift " << bit_shift);
     return 0;
   }
 
  private:
-  void ComputeRootOfUnityPowers();
+  // Identifies the precomputed tables returned by the Get*RootOfUnityPowers()
+  // functions, followed by the Montgomery, compact and natural-order tables.
+  // The order is part of the serialization format, which omits the compact
+  // and natural-order tables.
+  enum class Table {
+    RootOfUnityPowers,
+    Precon32RootOfUnityPowers,
+    Precon64RootOfUnityPowers,
+    AVX512RootOfUnityPowers,
+    AVX512Precon32RootOfUnityPowers,
+    AVX512Precon52RootOfUnityPowers,
+    AVX512Precon64RootOfUnityPowers,
+    InvRootOfUnityPowers,
+    Precon32InvRootOfUnityPowers,
+    Precon52InvRootOfUnityPowers,
+    Precon64InvRootOfUnityPowers,
+    Montgomery52RootOfUnityPowers,
+    Montgomery64RootOfUnityPowers,
+    Montgomery52InvRootOfUnityPowers,
+    Montgomery64InvRootOfUnityPowers,
+    CompactRootOfUnityPowers,
+    Precon52CompactRootOfUnityPowers,
+    Precon64CompactRootOfUnityPowers,
+    CompactInvRootOfUnityPowers,
+    Precon52CompactInvRootOfUnityPowers,
+    Precon64CompactInvRootOfUnityPowers,
+    NaturalRootOfUnityPowers,
+    Precon64NaturalRootOfUnityPowers,
+    NaturalInvRootOfUnityPowers,
+    Precon64NaturalInvRootOfUnityPowers,
+    NumTables
+  };
+
+  struct LazyTables;
+
+  // Returns the given table, computing it on the first call. Thread-safe.
+  const AlignedVector64<uint64_t>& GetTable(Table table) const;
+
+  // Returns the data of the given table, without copying tables loaded by
+  // Deserialize
+  const uint64_t* GetTableData(Table table) const;
+
+  // Returns the number of elements of the given table
+  static size_t TableSize(Table table, uint64_t degree);
+
+  // Returns true if ComputeForward uses an AVX512 or AVX2 transform, which
+  // reads the AVX512 root of unity layout
+  bool UsesAVX512Layout() const;
+
+  // Returns the bit shift of the Shoup multiplications of the transforms
+  // ComputeForward and ComputeInverse dispatch to in Compact mode, i.e. 52 if
+  // the AVX512-IFMA transforms apply and 64 otherwise
+  uint64_t CompactBitShift() const;
+
+  // Returns the pre-conditioned compact table read by the transforms in
+  // Compact mode, for the bit shift CompactBitShift()
+  Table CompactPreconTable(bool inverse) const;
+
+  // Returns the bit shift of the Montgomery multiplications of the transforms
+  // ComputeForward and ComputeInverse dispatch to in Montgomery mode, i.e. 52
+  // if the AVX512-IFMA transforms apply and 64 otherwise
+  uint64_t MontgomeryBitShift() const;
+
+  // Returns true if ComputeForward and ComputeInverse use the fully reduced
+  // AVX512-IFMA transforms, which read the Montgomery tables in Full mode too.
+  // These cover moduli in [s_max_fwd_ifma_modulus, s_max_ifma_modulus), for
+  // which the lazy outputs of the other AVX512-IFMA transforms exceed 52 bits.
+  bool UsesFullyReducedIFMA() const;
+
+  // Returns true if ComputeForwardMulti and ComputeInverseMulti transform the
+  // polynomials in lockstep with the AVX512 multi-polynomial kernels
+  bool UsesMultiAVX512() const;
+
+  // Returns true if ComputeForwardBatch and ComputeInverseBatch use the
+  // batched kernels, rather than transforming each polynomial in turn
+  bool UsesBatchKernels() const;
+
+  // Applies the Full-mode transform ComputeForward dispatches to, to the block
+  // of size m_degree >> recursion_depth at index recursion_half of the
+  // recursive transform, as the kernels do when recursing
+  void ForwardTransformFull(uint64_t* result, const uint64_t* operand,
+                            uint64_t input_mod_factor,
+                            uint64_t output_mod_factor,
+                            uint64_t recursion_depth, uint64_t recursion_half);
+
+  // Returns the forward or inverse Montgomery table for MontgomeryBitShift()
+  Table MontgomeryTable(bool inverse) const;
+
+  // Returns true if ComputeForwardNatural and ComputeInverseNatural use the
+  // Stockham transforms, rather than the bit-reversed transforms followed by
+  // BitReversePermute
+  bool UsesStockham() const;
+
+  AlignedVector64<uint64_t> ComputeTable(Table table) const;
+
+  // Builds the tables used by the transforms that ComputeForward and
+  // ComputeInverse dispatch to on this CPU
+  void ComputeDispatchedTables();
+
+  // Computes the inverse NTT of operand, or of the pointwise product of
+  // operand and mult_operand when mult_operand is not nullptr
+  void InverseTransform(uint64_t* result, const uint64_t* operand,
+                        const uint64_t* mult_operand, uint64_t input_mod_factor,
+                        uint64_t output_mod_factor);
+
+  // Applies the Full-mode transform InverseTransform dispatches to, with the
+  // outputs multiplied by scalar and shifted by addend in the final stage
+  void InverseTransformFull(uint64_t* result, const uint64_t* operand,
+                            const uint64_t* mult_operand,
+                            uint64_t input_mod_factor,
+                            uint64_t output_mod_factor, uint64_t scalar,
+                            uint64_t addend);
+
+  void SelectNativeRadix();
 
   uint64_t m_degree;  // N: size of NTT transform, should be power of 2
   uint64_t m_q;       // prime modulus. Must satisfy q == 1 mod 2n
@@ -265,32 +799,67 @@ class NTT {
 
   AlignedAllocator<uint64_t, 64> m_aligned_alloc;
 
-  // powers of the minimal root of unity
-  AlignedVector64<uint64_t> m_root_of_unity_powers;
-  // vector of floor(W * 2**32 / m_q), with W the root of unity powers
-  AlignedVector64<uint64_t> m_precon32_root_of_unity_powers;
-  // vector of floor(W * 2**64 / m_q), with W the root of unity powers
-  AlignedVector64<uint64_t> m_precon64_root_of_unity_powers;
-
-  // powers of the minimal root of unity adjusted for use in AVX512
-  // implementations
-  AlignedVector64<uint64_t> m_avx512_root_of_unity_powers;
-  // vector of floor(W * 2**32 / m_q), with W the AVX512 root of unity powers
-  AlignedVector64<uint64_t> m_avx512_precon32_root_of_unity_powers;
-  // vector of floor(W * 2**52 / m_q), with W the AVX512 root of unity powers
-  AlignedVector64<uint64_t> m_avx512_precon52_root_of_unity_powers;
-  // vector of floor(W * 2**64 / m_q), with W the AVX512 root of unity powers
-  AlignedVector64<uint64_t> m_avx512_precon64_root_of_unity_powers;
-
-  // vector of floor(W * 2**32 / m_q), with W the inverse root of unity powers
-  AlignedVector64<uint64_t> m_precon32_inv_root_of_unity_powers;
-  // vector of floor(W * 2**52 / m_q), with W the inverse root of unity powers
-  AlignedVector64<uint64_t> m_precon52_inv_root_of_unity_powers;
-  // vector of floor(W * 2**64 / m_q), with W the inverse root of unity powers
-  AlignedVector64<uint64_t> m_precon64_inv_root_of_unity_powers;
-
-  AlignedVector64<uint64_t> m_inv_root_of_unity_powers;
+  // Precomputed tables, built on first use and shared by copies of this object
+  std::shared_ptr<LazyTables> m_tables;
+
+  NativeRadix m_fwd_native_radix{NativeRadix::Radix2};
+  NativeRadix m_inv_native_radix{NativeRadix::Radix2};
+
+  TwiddleMode m_twiddle_mode{TwiddleMode::Full};
+
+  // Set for NTTs over Z_q[X] / (X^N - 1), whose root of unity m_w is an N'th
+  // root of unity
+  bool m_cyclic{false};
+
+  // Set for degrees above 2^MaxDirectDegreeBits()
+  std::shared_ptr<FourStepNTT> m_four_step;
 };
 
+/// @brief Permutes \p n elements into bit-reversed order, i.e. result[i] =
+/// operand[ReverseBits(i, log2(n))]
+/// @param[out] result Stores the result. May alias \p operand.
+/// @param[in] operand Data to permute
+/// @param[in] n Number of elements. Must be a power of two.
+/// @details Converts between the bit-reversed order of ComputeForward and the
+/// natural order of ComputeForwardNatural. Elements are moved in 8 x 8 tiles,
+/// so each load and store covers a full cache line.
+void BitReversePermute(uint64_t* result, const uint64_t* operand, uint64_t n);
+
+/// @brief Computes the forward NTT of each RNS limb of a polynomial. Results
+/// are bit-reversed.
+/// @param[out] result Stores the result, of size num_moduli * N
+/// @param[in] operand Data on which to compute the NTTs, of size num_moduli *
+/// N. Limb i is stored contiguously starting at operand + i * N.
+/// @param[in] ntts Array of \p num_moduli NTT objects of the same degree N;
+/// limb i is transformed using ntts[i]
+/// @param[in] num_moduli Number of RNS limbs
+/// @param[in] input_mod_factor Assume limb i of \p operand is in [0,
+/// input_mod_factor * q_i). Must be 1, 2 or 4.
+/// @param[in] output_mod_factor Returns limb i of \p result in [0,
+/// output_mod_factor * q_i). Must be 1 or 4.
+/// @details The limbs are distributed across the threads set by
+/// SetNumThreads. In-place computation is supported.
+void ComputeForwardRNS(uint64_t* result, const uint64_t* operand,
+                       NTT* const* ntts, size_t num_moduli,
+                       uint64_t input_mod_factor, uint64_t output_mod_factor);
+
+/// @brief Computes the inverse NTT of each RNS limb of a polynomial. Operands
+/// are bit-reversed.
+/// @param[out] result Stores the result, of size num_moduli * N
+/// @param[in] operand Data on which to compute the NTTs, of size num_moduli *
+/// N. Limb i is stored contiguously starting at operand + i * N.
+/// @param[in] ntts Array of \p num_moduli NTT objects of the same degree N;
+/// limb i is transformed using ntts[i]
+/// @param[in] num_moduli Number of RNS limbs
+/// @param[in] input_mod_factor Assume limb i of \p operand is in [0,
+/// input_mod_factor * q_i). Must be 1 or 2.
+/// @param[in] output_mod_factor Returns limb i of \p result in [0,
+/// output_mod_factor * q_i). Must be 1 or 2.
+/// @details The limbs are distributed across the threads set by
+/// SetNumThreads. In-place computation is supported.
+void ComputeInverseRNS(uint64_t* result, const uint64_t* operand,
+                       NTT* const* ntts, size_t num_moduli,
+                       uint64_t input_mod_factor, uint64_t output_mod_factor);
+
 }  // namespace hexl
 }  // namespace intel
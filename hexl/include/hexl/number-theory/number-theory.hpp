@@ -179,7 +179,8 @@ bool IsPrime(uint64_t n);
 // 2^(bit_size+1)]. Ensures each prime q satisfies
 // q % (2*ntt_size+1)) == 1
 /// @param[in] num_primes Number of primes to generate
-/// @param[in] bit_size Bit size of each prime
+/// @param[in] bit_size Bit size of each prime. At most 63, i.e. the primes are
+/// less than 2^64.
 /// @param[in] prefer_small_primes When true, returns primes starting from
 /// 2^(bit_size); when false, returns primes starting from 2^(bit_size+1)
 /// @param[in] ntt_size N such that each prime q satisfies q % (2N) == 1. N must
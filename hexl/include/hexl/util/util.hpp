@@ -49,5 +49,18 @@ inline CMPINT Not(CMPINT cmp) {
   }
 }
 
+/// @brief Sets the number of threads used by multi-threaded HEXL routines,
+/// including the calling thread
+/// @param[in] num_threads Number of threads. A value of 0 restores the
+/// default, given by the HEXL_NUM_THREADS environment variable if set, or by
+/// the number of hardware threads otherwise.
+/// @details Must not be called from within a multi-threaded HEXL routine, e.g.
+/// from a callback it invokes; such calls throw std::logic_error.
+void SetNumThreads(size_t num_threads);
+
+/// @brief Returns the number of threads used by multi-threaded HEXL routines,
+/// including the calling thread
+size_t GetNumThreads();
+
 }  // namespace hexl
 }  // namespace intel
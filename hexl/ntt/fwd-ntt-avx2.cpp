@@ -0,0 +1,386 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ntt/fwd-ntt-avx2.hpp"
+
+#include <immintrin.h>
+
+#include <cstring>
+#include <vector>
+
+#include "hexl/logging/logging.hpp"
+#include "hexl/ntt/ntt.hpp"
+#include "hexl/number-theory/number-theory.hpp"
+#include "ntt/ntt-avx2-util.hpp"
+#include "ntt/ntt-internal.hpp"
+#include "util/thread-pool.hpp"
+#include "util/avx2-util.hpp"
+
+namespace intel {
+namespace hexl {
+
+#ifdef HEXL_HAS_AVX256
+template void ForwardTransformToBitReverseAVX2<32>(
+    uint64_t* result, const uint64_t* operand, uint64_t degree, uint64_t mod,
+    const uint64_t* root_of_unity_powers,
+    const uint64_t* precon_root_of_unity_powers, uint64_t input_mod_factor,
+    uint64_t output_mod_factor, uint64_t recursion_depth,
+    uint64_t recursion_half);
+
+template void ForwardTransformToBitReverseAVX2<NTT::s_default_shift_bits>(
+    uint64_t* result, const uint64_t* operand, uint64_t degree, uint64_t mod,
+    const uint64_t* root_of_unity_powers,
+    const uint64_t* precon_root_of_unity_powers, uint64_t input_mod_factor,
+    uint64_t output_mod_factor, uint64_t recursion_depth,
+    uint64_t recursion_half);
+
+/// @brief The Harvey butterfly: assume \p X, \p Y in [0, 4q), and return X', Y'
+/// in [0, 4q) such that X', Y' = X + WY, X - WY (mod q).
+/// @param[in,out] X Input representing 4 64-bit unsigned integers in SIMD form
+/// @param[in,out] Y Input representing 4 64-bit unsigned integers in SIMD form
+/// @param[in] W Root of unity represented as 4 64-bit unsigned integers in
+/// SIMD form
+/// @param[in] W_precon Preconditioned \p W for BitShift-bit Barrett
+/// reduction
+/// @param[in] modulus Modulus, i.e. q represented as 4 64-bit unsigned
+/// integers in SIMD form
+/// @param[in] twice_modulus Twice the modulus, i.e. 2*q represented as 4 64-bit
+/// unsigned integers in SIMD form
+/// @param InputLessThanMod If true, assumes \p X, \p Y < \p q. Otherwise,
+/// assumes \p X, \p Y < 4*\p q
+/// @details See Algorithm 4 of https://arxiv.org/pdf/1205.2926.pdf
+template <int BitShift, bool InputLessThanMod>
+inline void FwdButterfly(__m256i* X, __m256i* Y, __m256i W, __m256i W_precon,
+                         __m256i modulus, __m256i twice_modulus) {
+  if (!InputLessThanMod) {
+    *X = _mm256_hexl_small_mod_epu64(*X, twice_modulus);
+  }
+
+  // For BitShift == 32, all operands are less than 2^32, so each product is
+  // computed exactly by a single _mm256_mul_epu32
+  __m256i Q = _mm256_hexl_mulhi_approx_epi<BitShift>(W_precon, *Y);
+  __m256i W_Y = _mm256_hexl_mullo_epi<BitShift>(W, *Y);
+  __m256i Q_p = _mm256_hexl_mullo_epi<BitShift>(Q, modulus);
+  __m256i T = _mm256_sub_epi64(W_Y, Q_p);
+  if (BitShift == 64) {
+    // The approximate Q yields T in [0, 4q); reduce T to [0, 2q)
+    T = _mm256_hexl_small_mod_epu64(T, twice_modulus);
+  }
+
+  __m256i twice_mod_minus_T = _mm256_sub_epi64(twice_modulus, T);
+  *Y = _mm256_add_epi64(*X, twice_mod_minus_T);
+  *X = _mm256_add_epi64(*X, T);
+}
+
+template <int BitShift>
+void FwdT1(uint64_t* operand, __m256i v_modulus, __m256i v_twice_mod,
+           uint64_t m, const uint64_t* W, const uint64_t* W_precon) {
+  size_t j1 = 0;
+
+  // 4 | m guaranteed by n >= 16
+  HEXL_LOOP_UNROLL_4
+  for (size_t i = m / 4; i > 0; --i) {
+    uint64_t* X = operand + j1;
+    __m256i* v_X_pt = reinterpret_cast<__m256i*>(X);
+
+    __m256i v_X;
+    __m256i v_Y;
+    LoadInterleavedT1(X, &v_X, &v_Y);
+    __m256i v_W = LoadWOpT1(static_cast<const void*>(W));
+    __m256i v_W_precon = LoadWOpT1(static_cast<const void*>(W_precon));
+
+    FwdButterfly<BitShift, false>(&v_X, &v_Y, v_W, v_W_precon, v_modulus,
+                                  v_twice_mod);
+    WriteInterleavedT1(v_X, v_Y, v_X_pt);
+
+    j1 += 8;
+    W += 4;
+    W_precon += 4;
+  }
+}
+
+template <int BitShift>
+void FwdT2(uint64_t* operand, __m256i v_modulus, __m256i v_twice_mod,
+           uint64_t m, const uint64_t* W, const uint64_t* W_precon) {
+  const __m256i* v_W_pt = reinterpret_cast<const __m256i*>(W);
+  const __m256i* v_W_precon_pt = reinterpret_cast<const __m256i*>(W_precon);
+  size_t j1 = 0;
+
+  // 2 | m guaranteed by n >= 16
+  HEXL_LOOP_UNROLL_4
+  for (size_t i = m / 2; i > 0; --i) {
+    uint64_t* X = operand + j1;
+    __m256i* v_X_pt = reinterpret_cast<__m256i*>(X);
+
+    __m256i v_X;
+    __m256i v_Y;
+    LoadInterleavedT2(X, &v_X, &v_Y);
+
+    // Roots of unity are duplicated in the AVX512 root of unity layout
+    __m256i v_W = _mm256_loadu_si256(v_W_pt++);
+    __m256i v_W_precon = _mm256_loadu_si256(v_W_precon_pt++);
+
+    FwdButterfly<BitShift, false>(&v_X, &v_Y, v_W, v_W_precon, v_modulus,
+                                  v_twice_mod);
+    WriteInterleavedT2(v_X, v_Y, v_X_pt);
+
+    j1 += 8;
+  }
+}
+
+template <int BitShift>
+void FwdT4(uint64_t* operand, __m256i v_modulus, __m256i v_twice_mod,
+           uint64_t m, const uint64_t* W, const uint64_t* W_precon) {
+  const __m256i* v_W_pt = reinterpret_cast<const __m256i*>(W);
+  const __m256i* v_W_precon_pt = reinterpret_cast<const __m256i*>(W_precon);
+  size_t j1 = 0;
+
+  HEXL_LOOP_UNROLL_4
+  for (size_t i = m; i > 0; --i) {
+    uint64_t* X = operand + j1;
+    __m256i* v_X_pt = reinterpret_cast<__m256i*>(X);
+
+    __m256i v_X = _mm256_loadu_si256(v_X_pt);
+    __m256i v_Y = _mm256_loadu_si256(v_X_pt + 1);
+
+    // Roots of unity are quadruplicated in the AVX512 root of unity layout
+    __m256i v_W = _mm256_loadu_si256(v_W_pt++);
+    __m256i v_W_precon = _mm256_loadu_si256(v_W_precon_pt++);
+
+    FwdButterfly<BitShift, false>(&v_X, &v_Y, v_W, v_W_precon, v_modulus,
+                                  v_twice_mod);
+
+    _mm256_storeu_si256(v_X_pt++, v_X);
+    _mm256_storeu_si256(v_X_pt, v_Y);
+
+    j1 += 8;
+  }
+}
+
+// Out-of-place implementation
+template <int BitShift, bool InputLessThanMod>
+void FwdT8(uint64_t* result, const uint64_t* operand, __m256i v_modulus,
+           __m256i v_twice_mod, uint64_t t, uint64_t m, const uint64_t* W,
+           const uint64_t* W_precon) {
+  size_t j1 = 0;
+
+  HEXL_LOOP_UNROLL_4
+  for (size_t i = 0; i < m; i++) {
+    // Referencing operand
+    const uint64_t* X_op = operand + j1;
+    const uint64_t* Y_op = X_op + t;
+
+    const __m256i* v_X_op_pt = reinterpret_cast<const __m256i*>(X_op);
+    const __m256i* v_Y_op_pt = reinterpret_cast<const __m256i*>(Y_op);
+
+    // Referencing result
+    uint64_t* X_r = result + j1;
+    uint64_t* Y_r = X_r + t;
+
+    __m256i* v_X_r_pt = reinterpret_cast<__m256i*>(X_r);
+    __m256i* v_Y_r_pt = reinterpret_cast<__m256i*>(Y_r);
+
+    // Weights and weights' preconditions
+    __m256i v_W = _mm256_set1_epi64x(static_cast<int64_t>(*W++));
+    __m256i v_W_precon = _mm256_set1_epi64x(static_cast<int64_t>(*W_precon++));
+
+    // assume 4 | t
+    for (size_t j = t / 4; j > 0; --j) {
+      __m256i v_X = _mm256_loadu_si256(v_X_op_pt++);
+      __m256i v_Y = _mm256_loadu_si256(v_Y_op_pt++);
+
+      FwdButterfly<BitShift, InputLessThanMod>(&v_X, &v_Y, v_W, v_W_precon,
+                                               v_modulus, v_twice_mod);
+
+      _mm256_storeu_si256(v_X_r_pt++, v_X);
+      _mm256_storeu_si256(v_Y_r_pt++, v_Y);
+    }
+    j1 += (t << 1);
+  }
+}
+
+template <int BitShift>
+void ForwardTransformToBitReverseAVX2(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* root_of_unity_powers,
+    const uint64_t* precon_root_of_unity_powers, uint64_t input_mod_factor,
+    uint64_t output_mod_factor, uint64_t recursion_depth,
+    uint64_t recursion_half) {
+  HEXL_CHECK(NTT::CheckCyclicArguments(n, modulus), "");
+  HEXL_CHECK(modulus < NTT::s_max_fwd_modulus(BitShift),
+             "modulus " << modulus << " too large for BitShift " << BitShift
+                        << " => maximum value "
+                        << NTT::s_max_fwd_modulus(BitShift));
+  HEXL_CHECK_BOUNDS(precon_root_of_unity_powers, n, MaximumValue(BitShift),
+                    "precon_root_of_unity_powers too large");
+  // Skip input bound checking for recursive steps
+  HEXL_CHECK_BOUNDS(operand, (recursion_depth == 0) ? n : 0,
+                    input_mod_factor * modulus,
+                    "operand larger than input_mod_factor * modulus ("
+                        << input_mod_factor << " * " << modulus << ")");
+  HEXL_CHECK(n >= 16,
+             "Don't support small transforms. Need n >= 16, got n = " << n);
+  HEXL_CHECK(
+      input_mod_factor == 1 || input_mod_factor == 2 || input_mod_factor == 4,
+      "input_mod_factor must be 1, 2, or 4; got " << input_mod_factor);
+  HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 4,
+             "output_mod_factor must be 1 or 4; got " << output_mod_factor);
+
+  uint64_t twice_mod = modulus << 1;
+
+  __m256i v_modulus = _mm256_set1_epi64x(static_cast<int64_t>(modulus));
+  __m256i v_twice_mod = _mm256_set1_epi64x(static_cast<int64_t>(twice_mod));
+
+  const size_t base_ntt_size = NTT::GetBaseNTTSize();
+
+  if (n <= base_ntt_size) {  // Perform breadth-first NTT
+    size_t t = (n >> 1);
+    size_t m = 1;
+    size_t W_idx = (m << recursion_depth) + (recursion_half * m);
+
+    // Copy for out-of-place in case m is <= base_ntt_size from start
+    if (result != operand) {
+      std::memcpy(result, operand, n * sizeof(uint64_t));
+    }
+
+    // First iteration assumes input in [0,p)
+    if (m < (n >> 3)) {
+      const uint64_t* W = &root_of_unity_powers[W_idx];
+      const uint64_t* W_precon = &precon_root_of_unity_powers[W_idx];
+
+      if ((input_mod_factor <= 2) && (recursion_depth == 0)) {
+        FwdT8<BitShift, true>(result, result, v_modulus, v_twice_mod, t, m, W,
+                              W_precon);
+      } else {
+        FwdT8<BitShift, false>(result, result, v_modulus, v_twice_mod, t, m, W,
+                               W_precon);
+      }
+
+      t >>= 1;
+      m <<= 1;
+      W_idx <<= 1;
+    }
+    for (; m < (n >> 3); m <<= 1) {
+      const uint64_t* W = &root_of_unity_powers[W_idx];
+      const uint64_t* W_precon = &precon_root_of_unity_powers[W_idx];
+      FwdT8<BitShift, false>(result, result, v_modulus, v_twice_mod, t, m, W,
+                             W_precon);
+      t >>= 1;
+      W_idx <<= 1;
+    }
+
+    // Do T=4, T=2, T=1 separately
+    {
+      // Maps the index into the original root of unity vector to the index
+      // into the AVX512 root of unity vector; see
+      // ForwardTransformToBitReverseAVX512
+      auto compute_new_W_idx = [&](size_t idx) {
+        size_t N = n << recursion_depth;
+
+        // FwdT8 range
+        if (idx <= N / 8) {
+          return idx;
+        }
+        // FwdT4 range
+        if (idx <= N / 4) {
+          return (idx - N / 8) * 4 + (N / 8);
+        }
+        // FwdT2 range
+        if (idx <= N / 2) {
+          return (idx - N / 4) * 2 + (5 * N / 8);
+        }
+        // FwdT1 range
+        return idx + (5 * N / 8);
+      };
+
+      size_t new_W_idx = compute_new_W_idx(W_idx);
+      const uint64_t* W = &root_of_unity_powers[new_W_idx];
+      const uint64_t* W_precon = &precon_root_of_unity_powers[new_W_idx];
+      FwdT4<BitShift>(result, v_modulus, v_twice_mod, m, W, W_precon);
+
+      m <<= 1;
+      W_idx <<= 1;
+      new_W_idx = compute_new_W_idx(W_idx);
+      W = &root_of_unity_powers[new_W_idx];
+      W_precon = &precon_root_of_unity_powers[new_W_idx];
+      FwdT2<BitShift>(result, v_modulus, v_twice_mod, m, W, W_precon);
+
+      m <<= 1;
+      W_idx <<= 1;
+      new_W_idx = compute_new_W_idx(W_idx);
+      W = &root_of_unity_powers[new_W_idx];
+      W_precon = &precon_root_of_unity_powers[new_W_idx];
+      FwdT1<BitShift>(result, v_modulus, v_twice_mod, m, W, W_precon);
+    }
+
+    if (output_mod_factor == 1) {
+      // n power of two at least 16 => n divisible by 4
+      __m256i* v_X_pt = reinterpret_cast<__m256i*>(result);
+      for (size_t i = 0; i < n; i += 4) {
+        __m256i v_X = _mm256_loadu_si256(v_X_pt);
+
+        // Reduce from [0, 4q) to [0, q)
+        v_X = _mm256_hexl_small_mod_epu64(v_X, v_twice_mod);
+        v_X = _mm256_hexl_small_mod_epu64(v_X, v_modulus);
+
+        HEXL_CHECK_BOUNDS(ExtractValues(v_X).data(), 4, modulus,
+                          "v_X exceeds bound " << modulus);
+
+        _mm256_storeu_si256(v_X_pt, v_X);
+
+        ++v_X_pt;
+      }
+    }
+  } else {
+    // Perform depth-first NTT via recursive call
+    size_t t = (n >> 1);
+    size_t W_idx = (1ULL << recursion_depth) + recursion_half;
+    const uint64_t* W = &root_of_unity_powers[W_idx];
+    const uint64_t* W_precon = &precon_root_of_unity_powers[W_idx];
+
+    FwdT8<BitShift, false>(result, operand, v_modulus, v_twice_mod, t, 1, W,
+                           W_precon);
+
+    const uint64_t parallel_levels =
+        (recursion_depth == 0) ? ParallelNTTLevels(n) : 0;
+    if (parallel_levels > 0) {
+      // Run the first stage of the blocks of each subsequent recursion level,
+      // and then the sub-transforms of the innermost level, as parallel tasks
+      ThreadPool& pool = ThreadPool::GetInstance();
+      for (uint64_t level = 1; level < parallel_levels; ++level) {
+        const uint64_t block_size = n >> level;
+        pool.ParallelFor(size_t(1) << level, [&](size_t block) {
+          uint64_t* X = &result[block * block_size];
+          size_t block_W_idx = (1ULL << level) + block;
+          FwdT8<BitShift, false>(X, X, v_modulus, v_twice_mod, block_size / 2,
+                                 1, &root_of_unity_powers[block_W_idx],
+                                 &precon_root_of_unity_powers[block_W_idx]);
+        });
+      }
+      const uint64_t block_size = n >> parallel_levels;
+      pool.ParallelFor(size_t(1) << parallel_levels, [&](size_t block) {
+        uint64_t* X = &result[block * block_size];
+        ForwardTransformToBitReverseAVX2<BitShift>(
+            X, X, block_size, modulus, root_of_unity_powers,
+            precon_root_of_unity_powers, input_mod_factor, output_mod_factor,
+            parallel_levels, block);
+      });
+      return;
+    }
+
+    ForwardTransformToBitReverseAVX2<BitShift>(
+        result, result, n / 2, modulus, root_of_unity_powers,
+        precon_root_of_unity_powers, input_mod_factor, output_mod_factor,
+        recursion_depth + 1, recursion_half * 2);
+
+    ForwardTransformToBitReverseAVX2<BitShift>(
+        &result[n / 2], &result[n / 2], n / 2, modulus, root_of_unity_powers,
+        precon_root_of_unity_powers, input_mod_factor, output_mod_factor,
+        recursion_depth + 1, recursion_half * 2 + 1);
+  }
+}
+
+#endif  // HEXL_HAS_AVX256
+
+}  // namespace hexl
+}  // namespace intel
@@ -12,6 +12,7 @@
 #include "hexl/number-theory/number-theory.hpp"
 #include "ntt/ntt-avx512-util.hpp"
 #include "ntt/ntt-internal.hpp"
+#include "util/thread-pool.hpp"
 #include "util/avx512-util.hpp"
 
 namespace intel {
@@ -24,6 +25,12 @@ template void ForwardTransformToBitReverseAVX512<NTT::s_ifma_shift_bits>(
     const uint64_t* precon_root_of_unity_powers, uint64_t input_mod_factor,
     uint64_t output_mod_factor, uint64_t recursion_depth,
     uint64_t recursion_half);
+
+template void ForwardTransformToBitReverseMultiAVX512<NTT::s_ifma_shift_bits>(
+    uint64_t* const* result, const uint64_t* const* operand, size_t num_polys,
+    uint64_t n, uint64_t modulus, const uint64_t* root_of_unity_powers,
+    const uint64_t* precon_root_of_unity_powers, uint64_t input_mod_factor,
+    uint64_t output_mod_factor);
 #endif
 
 #ifdef HEXL_HAS_AVX512DQ
@@ -40,6 +47,19 @@ template void ForwardTransformToBitReverseAVX512<NTT::s_default_shift_bits>(
     const uint64_t* precon_root_of_unity_powers, uint64_t input_mod_factor,
     uint64_t output_mod_factor, uint64_t recursion_depth,
     uint64_t recursion_half);
+
+template void ForwardTransformToBitReverseMultiAVX512<32>(
+    uint64_t* const* result, const uint64_t* const* operand, size_t num_polys,
+    uint64_t n, uint64_t modulus, const uint64_t* root_of_unity_powers,
+    const uint64_t* precon_root_of_unity_powers, uint64_t input_mod_factor,
+    uint64_t output_mod_factor);
+
+template void
+ForwardTransformToBitReverseMultiAVX512<NTT::s_default_shift_bits>(
+    uint64_t* const* result, const uint64_t* const* operand, size_t num_polys,
+    uint64_t n, uint64_t modulus, const uint64_t* root_of_unity_powers,
+    const uint64_t* precon_root_of_unity_powers, uint64_t input_mod_factor,
+    uint64_t output_mod_factor);
 #endif
 
 #ifdef HEXL_HAS_AVX512DQ
@@ -237,7 +257,7 @@ void ForwardTransformToBitReverseAVX512(
     const uint64_t* precon_root_of_unity_powers, uint64_t input_mod_factor,
     uint64_t output_mod_factor, uint64_t recursion_depth,
     uint64_t recursion_half) {
-  HEXL_CHECK(NTT::CheckArguments(n, modulus), "");
+  HEXL_CHECK(NTT::CheckCyclicArguments(n, modulus), "");
   HEXL_CHECK(modulus < NTT::s_max_fwd_modulus(BitShift),
              "modulus " << modulus << " too large for BitShift " << BitShift
                         << " => maximum value "
@@ -271,7 +291,7 @@ void ForwardTransformToBitReverseAVX512(
                 precon_root_of_unity_powers, precon_root_of_unity_powers + n));
   HEXL_VLOG(5, "operand " << std::vector<uint64_t>(operand, operand + n));
 
-  static const size_t base_ntt_size = 1024;
+  const size_t base_ntt_size = NTT::GetBaseNTTSize();
 
   if (n <= base_ntt_size) {  // Perform breadth-first NTT
     size_t t = (n >> 1);
@@ -391,6 +411,34 @@ void ForwardTransformToBitReverseAVX512(
     FwdT8<BitShift, false>(result, operand, v_neg_modulus, v_twice_mod, t, 1, W,
                            W_precon);
 
+    const uint64_t parallel_levels =
+        (recursion_depth == 0) ? ParallelNTTLevels(n) : 0;
+    if (parallel_levels > 0) {
+      // Run the first stage of the blocks of each subsequent recursion level,
+      // and then the sub-transforms of the innermost level, as parallel tasks
+      ThreadPool& pool = ThreadPool::GetInstance();
+      for (uint64_t level = 1; level < parallel_levels; ++level) {
+        const uint64_t block_size = n >> level;
+        pool.ParallelFor(size_t(1) << level, [&](size_t block) {
+          uint64_t* X = &result[block * block_size];
+          size_t block_W_idx = (1ULL << level) + block;
+          FwdT8<BitShift, false>(X, X, v_neg_modulus, v_twice_mod,
+                                 block_size / 2, 1,
+                                 &root_of_unity_powers[block_W_idx],
+                                 &precon_root_of_unity_powers[block_W_idx]);
+        });
+      }
+      const uint64_t block_size = n >> parallel_levels;
+      pool.ParallelFor(size_t(1) << parallel_levels, [&](size_t block) {
+        uint64_t* X = &result[block * block_size];
+        ForwardTransformToBitReverseAVX512<BitShift>(
+            X, X, block_size, modulus, root_of_unity_powers,
+            precon_root_of_unity_powers, input_mod_factor, output_mod_factor,
+            parallel_levels, block);
+      });
+      return;
+    }
+
     ForwardTransformToBitReverseAVX512<BitShift>(
         result, result, n / 2, modulus, root_of_unity_powers,
         precon_root_of_unity_powers, input_mod_factor, output_mod_factor,
@@ -403,6 +451,301 @@ void ForwardTransformToBitReverseAVX512(
   }
 }
 
+// The *Multi variants apply a stage to the blocks at \p offset of each of the
+// \p num_polys polynomials, loading each root of unity vector once
+
+template <int BitShift>
+void FwdT1Multi(uint64_t* const* polys, size_t num_polys, size_t offset,
+                __m512i v_neg_modulus, __m512i v_twice_mod, uint64_t m,
+                const uint64_t* W, const uint64_t* W_precon) {
+  const __m512i* v_W_pt = reinterpret_cast<const __m512i*>(W);
+  const __m512i* v_W_precon_pt = reinterpret_cast<const __m512i*>(W_precon);
+
+  // 8 | m guaranteed by n >= 16
+  for (size_t j1 = 0; j1 < 2 * m; j1 += 16) {
+    __m512i v_W = _mm512_loadu_si512(v_W_pt++);
+    __m512i v_W_precon = _mm512_loadu_si512(v_W_precon_pt++);
+
+    for (size_t p = 0; p < num_polys; ++p) {
+      uint64_t* X = polys[p] + offset + j1;
+      __m512i v_X;
+      __m512i v_Y;
+      LoadFwdInterleavedT1(X, &v_X, &v_Y);
+      FwdButterfly<BitShift, false>(&v_X, &v_Y, v_W, v_W_precon,
+                                    v_neg_modulus, v_twice_mod);
+      WriteFwdInterleavedT1(v_X, v_Y, reinterpret_cast<__m512i*>(X));
+    }
+  }
+}
+
+template <int BitShift>
+void FwdT2Multi(uint64_t* const* polys, size_t num_polys, size_t offset,
+                __m512i v_neg_modulus, __m512i v_twice_mod, uint64_t m,
+                const uint64_t* W, const uint64_t* W_precon) {
+  const __m512i* v_W_pt = reinterpret_cast<const __m512i*>(W);
+  const __m512i* v_W_precon_pt = reinterpret_cast<const __m512i*>(W_precon);
+
+  // 4 | m guaranteed by n >= 16
+  for (size_t j1 = 0; j1 < 4 * m; j1 += 16) {
+    __m512i v_W = _mm512_loadu_si512(v_W_pt++);
+    __m512i v_W_precon = _mm512_loadu_si512(v_W_precon_pt++);
+
+    for (size_t p = 0; p < num_polys; ++p) {
+      __m512i* v_X_pt = reinterpret_cast<__m512i*>(polys[p] + offset + j1);
+      __m512i v_X;
+      __m512i v_Y;
+      LoadFwdInterleavedT2(polys[p] + offset + j1, &v_X, &v_Y);
+      FwdButterfly<BitShift, false>(&v_X, &v_Y, v_W, v_W_precon,
+                                    v_neg_modulus, v_twice_mod);
+      _mm512_storeu_si512(v_X_pt, v_X);
+      _mm512_storeu_si512(v_X_pt + 1, v_Y);
+    }
+  }
+}
+
+template <int BitShift>
+void FwdT4Multi(uint64_t* const* polys, size_t num_polys, size_t offset,
+                __m512i v_neg_modulus, __m512i v_twice_mod, uint64_t m,
+                const uint64_t* W, const uint64_t* W_precon) {
+  const __m512i* v_W_pt = reinterpret_cast<const __m512i*>(W);
+  const __m512i* v_W_precon_pt = reinterpret_cast<const __m512i*>(W_precon);
+
+  // 2 | m guaranteed by n >= 16
+  for (size_t j1 = 0; j1 < 8 * m; j1 += 16) {
+    __m512i v_W = _mm512_loadu_si512(v_W_pt++);
+    __m512i v_W_precon = _mm512_loadu_si512(v_W_precon_pt++);
+
+    for (size_t p = 0; p < num_polys; ++p) {
+      __m512i* v_X_pt = reinterpret_cast<__m512i*>(polys[p] + offset + j1);
+      __m512i v_X;
+      __m512i v_Y;
+      LoadFwdInterleavedT4(polys[p] + offset + j1, &v_X, &v_Y);
+      FwdButterfly<BitShift, false>(&v_X, &v_Y, v_W, v_W_precon,
+                                    v_neg_modulus, v_twice_mod);
+      _mm512_storeu_si512(v_X_pt, v_X);
+      _mm512_storeu_si512(v_X_pt + 1, v_Y);
+    }
+  }
+}
+
+// Out-of-place implementation
+template <int BitShift, bool InputLessThanMod>
+void FwdT8Multi(uint64_t* const* result, const uint64_t* const* operand,
+                size_t num_polys, size_t offset, __m512i v_neg_modulus,
+                __m512i v_twice_mod, uint64_t t, uint64_t m, const uint64_t* W,
+                const uint64_t* W_precon) {
+  size_t j1 = offset;
+
+  for (size_t i = 0; i < m; i++) {
+    __m512i v_W = _mm512_set1_epi64(static_cast<int64_t>(*W++));
+    __m512i v_W_precon = _mm512_set1_epi64(static_cast<int64_t>(*W_precon++));
+
+    for (size_t p = 0; p < num_polys; ++p) {
+      const uint64_t* X_op = operand[p] + j1;
+      const uint64_t* Y_op = X_op + t;
+      uint64_t* X_r = result[p] + j1;
+      uint64_t* Y_r = X_r + t;
+
+      // assume 8 | t
+      for (size_t j = 0; j < t; j += 8) {
+        __m512i v_X = _mm512_loadu_si512(X_op + j);
+        __m512i v_Y = _mm512_loadu_si512(Y_op + j);
+
+        FwdButterfly<BitShift, InputLessThanMod>(&v_X, &v_Y, v_W, v_W_precon,
+                                                 v_neg_modulus, v_twice_mod);
+
+        _mm512_storeu_si512(X_r + j, v_X);
+        _mm512_storeu_si512(Y_r + j, v_Y);
+      }
+    }
+    j1 += (t << 1);
+  }
+}
+
+// Transforms the blocks of size n at offset of each polynomial; mirrors the
+// serial path of ForwardTransformToBitReverseAVX512
+template <int BitShift>
+void ForwardTransformToBitReverseMultiAVX512Impl(
+    uint64_t* const* result, const uint64_t* const* operand, size_t num_polys,
+    size_t offset, uint64_t n, uint64_t modulus,
+    const uint64_t* root_of_unity_powers,
+    const uint64_t* precon_root_of_unity_powers, uint64_t input_mod_factor,
+    uint64_t output_mod_factor, uint64_t recursion_depth,
+    uint64_t recursion_half, uint64_t base_ntt_size) {
+  __m512i v_modulus = _mm512_set1_epi64(static_cast<int64_t>(modulus));
+  __m512i v_neg_modulus = _mm512_set1_epi64(-static_cast<int64_t>(modulus));
+  __m512i v_twice_mod = _mm512_set1_epi64(static_cast<int64_t>(2 * modulus));
+
+  if (n > base_ntt_size) {
+    // Perform depth-first NTT via recursive call
+    size_t W_idx = (1ULL << recursion_depth) + recursion_half;
+    FwdT8Multi<BitShift, false>(result, operand, num_polys, offset,
+                                v_neg_modulus, v_twice_mod, n >> 1, 1,
+                                &root_of_unity_powers[W_idx],
+                                &precon_root_of_unity_powers[W_idx]);
+
+    ForwardTransformToBitReverseMultiAVX512Impl<BitShift>(
+        result, result, num_polys, offset, n / 2, modulus,
+        root_of_unity_powers, precon_root_of_unity_powers, input_mod_factor,
+        output_mod_factor, recursion_depth + 1, recursion_half * 2,
+        base_ntt_size);
+    ForwardTransformToBitReverseMultiAVX512Impl<BitShift>(
+        result, result, num_polys, offset + n / 2, n / 2, modulus,
+        root_of_unity_powers, precon_root_of_unity_powers, input_mod_factor,
+        output_mod_factor, recursion_depth + 1, recursion_half * 2 + 1,
+        base_ntt_size);
+    return;
+  }
+
+  // Perform breadth-first NTT
+  size_t t = (n >> 1);
+  size_t m = 1;
+  size_t W_idx = (m << recursion_depth) + (recursion_half * m);
+
+  // First iteration reads the operand, and assumes input in [0, 2q) at the
+  // top level. m < n / 8 guaranteed by n >= 16
+  {
+    const uint64_t* W = &root_of_unity_powers[W_idx];
+    const uint64_t* W_precon = &precon_root_of_unity_powers[W_idx];
+    if ((input_mod_factor <= 2) && (recursion_depth == 0)) {
+      FwdT8Multi<BitShift, true>(result, operand, num_polys, offset,
+                                 v_neg_modulus, v_twice_mod, t, m, W,
+                                 W_precon);
+    } else {
+      FwdT8Multi<BitShift, false>(result, operand, num_polys, offset,
+                                  v_neg_modulus, v_twice_mod, t, m, W,
+                                  W_precon);
+    }
+    t >>= 1;
+    m <<= 1;
+    W_idx <<= 1;
+  }
+  for (; m < (n >> 3); m <<= 1) {
+    FwdT8Multi<BitShift, false>(result, result, num_polys, offset,
+                                v_neg_modulus, v_twice_mod, t, m,
+                                &root_of_unity_powers[W_idx],
+                                &precon_root_of_unity_powers[W_idx]);
+    t >>= 1;
+    W_idx <<= 1;
+  }
+
+  // Do T=4, T=2, T=1 separately, with the same remapping of the root of unity
+  // index as ForwardTransformToBitReverseAVX512
+  auto compute_new_W_idx = [&](size_t idx) {
+    size_t N = n << recursion_depth;
+    if (idx <= N / 8) {
+      return idx;
+    }
+    if (idx <= N / 4) {
+      return (idx - N / 8) * 4 + (N / 8);
+    }
+    if (idx <= N / 2) {
+      return (idx - N / 4) * 2 + (5 * N / 8);
+    }
+    return idx + (5 * N / 8);
+  };
+
+  size_t new_W_idx = compute_new_W_idx(W_idx);
+  FwdT4Multi<BitShift>(result, num_polys, offset, v_neg_modulus, v_twice_mod,
+                       m, &root_of_unity_powers[new_W_idx],
+                       &precon_root_of_unity_powers[new_W_idx]);
+  m <<= 1;
+  W_idx <<= 1;
+  new_W_idx = compute_new_W_idx(W_idx);
+  FwdT2Multi<BitShift>(result, num_polys, offset, v_neg_modulus, v_twice_mod,
+                       m, &root_of_unity_powers[new_W_idx],
+                       &precon_root_of_unity_powers[new_W_idx]);
+  m <<= 1;
+  W_idx <<= 1;
+  new_W_idx = compute_new_W_idx(W_idx);
+  FwdT1Multi<BitShift>(result, num_polys, offset, v_neg_modulus, v_twice_mod,
+                       m, &root_of_unity_powers[new_W_idx],
+                       &precon_root_of_unity_powers[new_W_idx]);
+
+  if (output_mod_factor == 1) {
+    for (size_t p = 0; p < num_polys; ++p) {
+      uint64_t* X = result[p] + offset;
+      for (size_t i = 0; i < n; i += 8) {
+        __m512i v_X = _mm512_loadu_si512(X + i);
+        // Reduce from [0, 4q) to [0, q)
+        v_X = _mm512_hexl_small_mod_epu64(v_X, v_twice_mod);
+        v_X = _mm512_hexl_small_mod_epu64(v_X, v_modulus);
+        _mm512_storeu_si512(X + i, v_X);
+      }
+    }
+  }
+}
+
+template <int BitShift>
+void ForwardTransformToBitReverseMultiAVX512(
+    uint64_t* const* result, const uint64_t* const* operand, size_t num_polys,
+    uint64_t n, uint64_t modulus, const uint64_t* root_of_unity_powers,
+    const uint64_t* precon_root_of_unity_powers, uint64_t input_mod_factor,
+    uint64_t output_mod_factor) {
+  HEXL_CHECK(NTT::CheckCyclicArguments(n, modulus), "");
+  HEXL_CHECK(modulus < NTT::s_max_fwd_modulus(BitShift),
+             "modulus " << modulus << " too large for BitShift " << BitShift
+                        << " => maximum value "
+                        << NTT::s_max_fwd_modulus(BitShift));
+  HEXL_CHECK(n >= 16,
+             "Don't support small transforms. Need n >= 16, got n = " << n);
+  HEXL_CHECK(
+      input_mod_factor == 1 || input_mod_factor == 2 || input_mod_factor == 4,
+      "input_mod_factor must be 1, 2, or 4; got " << input_mod_factor);
+  HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 4,
+             "output_mod_factor must be 1 or 4; got " << output_mod_factor);
+  for (size_t p = 0; p < num_polys; ++p) {
+    HEXL_CHECK_BOUNDS(operand[p], n, input_mod_factor * modulus,
+                      "operand " << p << " larger than input_mod_factor * "
+                                    "modulus ("
+                                 << input_mod_factor << " * " << modulus
+                                 << ")");
+  }
+
+  // Keep the blocks of all the polynomials in the breadth-first base case
+  // resident in cache together
+  uint64_t base_ntt_size = NTT::GetBaseNTTSize();
+  while (base_ntt_size > 16 &&
+         base_ntt_size * num_polys > NTT::GetBaseNTTSize()) {
+    base_ntt_size >>= 1;
+  }
+
+  ForwardTransformToBitReverseMultiAVX512Impl<BitShift>(
+      result, operand, num_polys, 0, n, modulus, root_of_unity_powers,
+      precon_root_of_unity_powers, input_mod_factor, output_mod_factor, 0, 0,
+      base_ntt_size);
+}
+
+void ForwardFirstStageReduceAVX512(uint64_t* result, const uint64_t* operand,
+                                   uint64_t n, uint64_t modulus, uint64_t W) {
+  HEXL_CHECK(n >= 16, "Don't support small transforms. Need n >= 16, got n = "
+                          << n);
+  HEXL_CHECK(modulus < NTT::s_max_lazy_modulus,
+             "modulus " << modulus << " exceeds bound "
+                        << NTT::s_max_lazy_modulus);
+  const size_t t = n >> 1;
+  __m512i v_neg_modulus = _mm512_set1_epi64(-static_cast<int64_t>(modulus));
+  __m512i v_twice_mod = _mm512_set1_epi64(static_cast<int64_t>(2 * modulus));
+  __m512i v_barrett = _mm512_set1_epi64(
+      static_cast<int64_t>(MultiplyFactor(1, 64, modulus).BarrettFactor()));
+  __m512i v_W = _mm512_set1_epi64(static_cast<int64_t>(W));
+  __m512i v_W_precon = _mm512_set1_epi64(
+      static_cast<int64_t>(MultiplyFactor(W, 64, modulus).BarrettFactor()));
+
+  for (size_t j = 0; j < t; j += 8) {
+    __m512i v_X = _mm512_loadu_si512(operand + j);
+    __m512i v_Y = _mm512_loadu_si512(operand + j + t);
+    // Barrett reduction of X to [0, 2q); the Shoup multiplication in the
+    // butterfly accepts any 64-bit Y
+    __m512i v_Q = _mm512_hexl_mulhi_epi<64>(v_X, v_barrett);
+    v_X = _mm512_hexl_mullo_add_lo_epi<64>(v_X, v_Q, v_neg_modulus);
+    FwdButterfly<NTT::s_default_shift_bits, true>(
+        &v_X, &v_Y, v_W, v_W_precon, v_neg_modulus, v_twice_mod);
+    _mm512_storeu_si512(result + j, v_X);
+    _mm512_storeu_si512(result + j + t, v_Y);
+  }
+}
+
 #endif  // HEXL_HAS_AVX512DQ
 
 }  // namespace hexl
@@ -40,6 +40,23 @@ void ForwardTransformToBitReverseAVX512(
     uint64_t output_mod_factor, uint64_t recursion_depth = 0,
     uint64_t recursion_half = 0);
 
+/// @brief AVX512 forward NTT of \p num_polys polynomials in lockstep, such
+/// that each root of unity vector is loaded once and applied to all the
+/// polynomials. Parameters as in ForwardTransformToBitReverseAVX512, with
+/// \p result[i] and \p operand[i] the output and input of the i'th
+/// polynomial. \p result[i] may alias \p operand[i].
+template <int BitShift>
+void ForwardTransformToBitReverseMultiAVX512(
+    uint64_t* const* result, const uint64_t* const* operand, size_t num_polys,
+    uint64_t n, uint64_t modulus, const uint64_t* root_of_unity_powers,
+    const uint64_t* precon_root_of_unity_powers, uint64_t input_mod_factor,
+    uint64_t output_mod_factor);
+
+/// @brief AVX512 implementation of ForwardFirstStageReduce. \p n must be at
+/// least 16.
+void ForwardFirstStageReduceAVX512(uint64_t* result, const uint64_t* operand,
+                                   uint64_t n, uint64_t modulus, uint64_t W);
+
 #endif  // HEXL_HAS_AVX512DQ
 
 }  // namespace hexl
@@ -0,0 +1,437 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ntt/inv-ntt-avx2.hpp"
+
+#include <immintrin.h>
+
+#include <cstring>
+#include <vector>
+
+#include "hexl/eltwise/eltwise-mult-mod.hpp"
+#include "hexl/logging/logging.hpp"
+#include "hexl/ntt/ntt.hpp"
+#include "hexl/number-theory/number-theory.hpp"
+#include "ntt/ntt-avx2-util.hpp"
+#include "ntt/ntt-default.hpp"
+#include "ntt/ntt-internal.hpp"
+#include "util/thread-pool.hpp"
+#include "util/avx2-util.hpp"
+
+namespace intel {
+namespace hexl {
+
+#ifdef HEXL_HAS_AVX256
+template void InverseTransformFromBitReverseAVX2<32>(
+    uint64_t* result, const uint64_t* operand, uint64_t degree,
+    uint64_t modulus, const uint64_t* inv_root_of_unity_powers,
+    const uint64_t* precon_inv_root_of_unity_powers, uint64_t input_mod_factor,
+    uint64_t output_mod_factor, uint64_t recursion_depth,
+    uint64_t recursion_half, const uint64_t* mult_operand, uint64_t scalar,
+    uint64_t addend);
+
+template void InverseTransformFromBitReverseAVX2<NTT::s_default_shift_bits>(
+    uint64_t* result, const uint64_t* operand, uint64_t degree,
+    uint64_t modulus, const uint64_t* inv_root_of_unity_powers,
+    const uint64_t* precon_inv_root_of_unity_powers, uint64_t input_mod_factor,
+    uint64_t output_mod_factor, uint64_t recursion_depth,
+    uint64_t recursion_half, const uint64_t* mult_operand, uint64_t scalar,
+    uint64_t addend);
+
+// Returns W * T mod q in [0, 2q), for T < 4q and W_precon the
+// BitShift-bit preconditioned W
+template <int BitShift>
+inline __m256i MultiplyModLazyAVX2(__m256i T, __m256i W, __m256i W_precon,
+                                   __m256i modulus, __m256i twice_modulus) {
+  // For BitShift == 32, all operands are less than 2^32, so each product is
+  // computed exactly by a single _mm256_mul_epu32
+  __m256i Q = _mm256_hexl_mulhi_approx_epi<BitShift>(W_precon, T);
+  __m256i W_T = _mm256_hexl_mullo_epi<BitShift>(W, T);
+  __m256i Q_p = _mm256_hexl_mullo_epi<BitShift>(Q, modulus);
+  __m256i result = _mm256_sub_epi64(W_T, Q_p);
+  if (BitShift == 64) {
+    // The approximate Q yields a result in [0, 4q); reduce to [0, 2q)
+    result = _mm256_hexl_small_mod_epu64(result, twice_modulus);
+  }
+  return result;
+}
+
+/// @brief The Harvey butterfly: assume X, Y in [0, 2q), and return X', Y' in
+/// [0, 2q). such that X', Y' = X + Y (mod q), W(X - Y) (mod q).
+/// @param[in,out] X Input representing 4 64-bit unsigned integers in SIMD form
+/// @param[in,out] Y Input representing 4 64-bit unsigned integers in SIMD form
+/// @param[in] W Root of unity representing 4 64-bit unsigned integers in SIMD
+/// form
+/// @param[in] W_precon Preconditioned \p W for BitShift-bit Barrett
+/// reduction
+/// @param[in] modulus Modulus, i.e. q represented as 4 64-bit unsigned
+/// integers in SIMD form
+/// @param[in] twice_modulus Twice the modulus, i.e. 2*q represented as 4 64-bit
+/// unsigned integers in SIMD form
+/// @param InputLessThanMod If true, assumes \p X, \p Y < \p q. Otherwise,
+/// assumes \p X, \p Y < 2*\p q
+/// @details See Algorithm 3 of https://arxiv.org/pdf/1205.2926.pdf
+template <int BitShift, bool InputLessThanMod>
+inline void InvButterfly(__m256i* X, __m256i* Y, __m256i W, __m256i W_precon,
+                         __m256i modulus, __m256i twice_modulus) {
+  // Compute T first to allow in-place update of X
+  __m256i Y_minus_2q = _mm256_sub_epi64(*Y, twice_modulus);
+  __m256i T = _mm256_sub_epi64(*X, Y_minus_2q);
+
+  if (InputLessThanMod) {
+    // No need for modulus reduction, since inputs are in [0, q)
+    *X = _mm256_add_epi64(*X, *Y);
+  } else {
+    // Compute (X + Y - 2q < 0) ? (X + Y) : (X + Y - 2q)
+    *X = _mm256_add_epi64(*X, Y_minus_2q);
+    *X = _mm256_hexl_signed_small_mod_epi64(*X, twice_modulus);
+  }
+
+  *Y = MultiplyModLazyAVX2<BitShift>(T, W, W_precon, modulus, twice_modulus);
+}
+
+template <int BitShift, bool InputLessThanMod>
+void InvT1(uint64_t* operand, __m256i v_modulus, __m256i v_twice_mod,
+           uint64_t m, const uint64_t* W, const uint64_t* W_precon) {
+  size_t j1 = 0;
+
+  // 4 | m guaranteed by n >= 16
+  HEXL_LOOP_UNROLL_4
+  for (size_t i = m / 4; i > 0; --i) {
+    uint64_t* X = operand + j1;
+    __m256i* v_X_pt = reinterpret_cast<__m256i*>(X);
+
+    __m256i v_X;
+    __m256i v_Y;
+    LoadInterleavedT1(X, &v_X, &v_Y);
+
+    __m256i v_W = LoadWOpT1(static_cast<const void*>(W));
+    __m256i v_W_precon = LoadWOpT1(static_cast<const void*>(W_precon));
+
+    InvButterfly<BitShift, InputLessThanMod>(&v_X, &v_Y, v_W, v_W_precon,
+                                             v_modulus, v_twice_mod);
+    WriteInterleavedT1(v_X, v_Y, v_X_pt);
+
+    j1 += 8;
+    W += 4;
+    W_precon += 4;
+  }
+}
+
+template <int BitShift>
+void InvT2(uint64_t* X, __m256i v_modulus, __m256i v_twice_mod, uint64_t m,
+           const uint64_t* W, const uint64_t* W_precon) {
+  // 2 | m guaranteed by n >= 16
+  HEXL_LOOP_UNROLL_4
+  for (size_t i = m / 2; i > 0; --i) {
+    __m256i* v_X_pt = reinterpret_cast<__m256i*>(X);
+
+    __m256i v_X;
+    __m256i v_Y;
+    LoadInterleavedT2(X, &v_X, &v_Y);
+
+    __m256i v_W = LoadWOpT2(static_cast<const void*>(W));
+    __m256i v_W_precon = LoadWOpT2(static_cast<const void*>(W_precon));
+
+    InvButterfly<BitShift, false>(&v_X, &v_Y, v_W, v_W_precon, v_modulus,
+                                  v_twice_mod);
+    WriteInterleavedT2(v_X, v_Y, v_X_pt);
+
+    X += 8;
+    W += 2;
+    W_precon += 2;
+  }
+}
+
+template <int BitShift>
+void InvT4(uint64_t* X, __m256i v_modulus, __m256i v_twice_mod, uint64_t m,
+           const uint64_t* W, const uint64_t* W_precon) {
+  HEXL_LOOP_UNROLL_4
+  for (size_t i = m; i > 0; --i) {
+    __m256i* v_X_pt = reinterpret_cast<__m256i*>(X);
+
+    __m256i v_X = _mm256_loadu_si256(v_X_pt);
+    __m256i v_Y = _mm256_loadu_si256(v_X_pt + 1);
+
+    __m256i v_W = _mm256_set1_epi64x(static_cast<int64_t>(*W++));
+    __m256i v_W_precon = _mm256_set1_epi64x(static_cast<int64_t>(*W_precon++));
+
+    InvButterfly<BitShift, false>(&v_X, &v_Y, v_W, v_W_precon, v_modulus,
+                                  v_twice_mod);
+
+    _mm256_storeu_si256(v_X_pt++, v_X);
+    _mm256_storeu_si256(v_X_pt, v_Y);
+    X += 8;
+  }
+}
+
+template <int BitShift>
+void InvT8(uint64_t* operand, __m256i v_modulus, __m256i v_twice_mod,
+           uint64_t t, uint64_t m, const uint64_t* W,
+           const uint64_t* W_precon) {
+  size_t j1 = 0;
+
+  HEXL_LOOP_UNROLL_4
+  for (size_t i = 0; i < m; i++) {
+    uint64_t* X = operand + j1;
+    uint64_t* Y = X + t;
+
+    __m256i v_W = _mm256_set1_epi64x(static_cast<int64_t>(*W++));
+    __m256i v_W_precon = _mm256_set1_epi64x(static_cast<int64_t>(*W_precon++));
+
+    __m256i* v_X_pt = reinterpret_cast<__m256i*>(X);
+    __m256i* v_Y_pt = reinterpret_cast<__m256i*>(Y);
+
+    // assume 4 | t
+    for (size_t j = t / 4; j > 0; --j) {
+      __m256i v_X = _mm256_loadu_si256(v_X_pt);
+      __m256i v_Y = _mm256_loadu_si256(v_Y_pt);
+
+      InvButterfly<BitShift, false>(&v_X, &v_Y, v_W, v_W_precon, v_modulus,
+                                    v_twice_mod);
+
+      _mm256_storeu_si256(v_X_pt++, v_X);
+      _mm256_storeu_si256(v_Y_pt++, v_Y);
+    }
+    j1 += (t << 1);
+  }
+}
+
+template <int BitShift>
+void InverseTransformFromBitReverseAVX2(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* inv_root_of_unity_powers,
+    const uint64_t* precon_inv_root_of_unity_powers, uint64_t input_mod_factor,
+    uint64_t output_mod_factor, uint64_t recursion_depth,
+    uint64_t recursion_half, const uint64_t* mult_operand, uint64_t scalar,
+    uint64_t addend) {
+  HEXL_CHECK(NTT::CheckCyclicArguments(n, modulus), "");
+  HEXL_CHECK(n >= 16,
+             "InverseTransformFromBitReverseAVX2 doesn't support small "
+             "transforms. Need n >= 16, got n = "
+                 << n);
+  HEXL_CHECK(modulus < NTT::s_max_inv_modulus(BitShift),
+             "modulus " << modulus << " too large for BitShift " << BitShift
+                        << " => maximum value "
+                        << NTT::s_max_inv_modulus(BitShift));
+  HEXL_CHECK_BOUNDS(precon_inv_root_of_unity_powers, n, MaximumValue(BitShift),
+                    "precon_inv_root_of_unity_powers too large");
+  // Skip input bound checking for recursive steps
+  HEXL_CHECK_BOUNDS(operand, (recursion_depth == 0) ? n : 0,
+                    input_mod_factor * modulus,
+                    "operand larger than input_mod_factor * modulus ("
+                        << input_mod_factor << " * " << modulus << ")");
+  HEXL_CHECK(input_mod_factor == 1 || input_mod_factor == 2 ||
+                 (mult_operand != nullptr && input_mod_factor == 4),
+             "input_mod_factor must be 1 or 2; got " << input_mod_factor);
+  HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 2,
+             "output_mod_factor must be 1 or 2; got " << output_mod_factor);
+
+  uint64_t twice_mod = modulus << 1;
+  __m256i v_modulus = _mm256_set1_epi64x(static_cast<int64_t>(modulus));
+  __m256i v_twice_mod = _mm256_set1_epi64x(static_cast<int64_t>(twice_mod));
+
+  size_t t = 1;
+  size_t m = (n >> 1);
+  size_t W_idx = 1 + m * recursion_half;
+
+  const size_t base_ntt_size = NTT::GetBaseNTTSize();
+
+  if (n <= base_ntt_size) {  // Perform breadth-first InvNTT
+    if (mult_operand != nullptr) {
+      // Pointwise product, computed while the block is resident in cache
+      EltwiseMultMod(result, operand, mult_operand, n, modulus,
+                     input_mod_factor);
+      operand = result;
+      input_mod_factor = 1;
+    } else if (operand != result) {
+      std::memcpy(result, operand, n * sizeof(uint64_t));
+    }
+
+    // Extract t=1, t=2, t=4 loops separately
+    {
+      // t = 1
+      const uint64_t* W = &inv_root_of_unity_powers[W_idx];
+      const uint64_t* W_precon = &precon_inv_root_of_unity_powers[W_idx];
+      if ((input_mod_factor == 1) && (recursion_depth == 0)) {
+        InvT1<BitShift, true>(result, v_modulus, v_twice_mod, m, W, W_precon);
+      } else {
+        InvT1<BitShift, false>(result, v_modulus, v_twice_mod, m, W, W_precon);
+      }
+
+      t <<= 1;
+      m >>= 1;
+      uint64_t W_idx_delta =
+          m * ((1ULL << (recursion_depth + 1)) - recursion_half);
+      W_idx += W_idx_delta;
+
+      // t = 2
+      W = &inv_root_of_unity_powers[W_idx];
+      W_precon = &precon_inv_root_of_unity_powers[W_idx];
+      InvT2<BitShift>(result, v_modulus, v_twice_mod, m, W, W_precon);
+
+      t <<= 1;
+      m >>= 1;
+      W_idx_delta >>= 1;
+      W_idx += W_idx_delta;
+
+      // t = 4
+      W = &inv_root_of_unity_powers[W_idx];
+      W_precon = &precon_inv_root_of_unity_powers[W_idx];
+      InvT4<BitShift>(result, v_modulus, v_twice_mod, m, W, W_precon);
+      t <<= 1;
+      m >>= 1;
+      W_idx_delta >>= 1;
+      W_idx += W_idx_delta;
+
+      // t >= 8
+      for (; m > 1;) {
+        W = &inv_root_of_unity_powers[W_idx];
+        W_precon = &precon_inv_root_of_unity_powers[W_idx];
+        InvT8<BitShift>(result, v_modulus, v_twice_mod, t, m, W, W_precon);
+        t <<= 1;
+        m >>= 1;
+        W_idx_delta >>= 1;
+        W_idx += W_idx_delta;
+      }
+    }
+  } else {
+    const uint64_t parallel_levels =
+        (recursion_depth == 0) ? ParallelNTTLevels(n) : 0;
+    if (parallel_levels > 0) {
+      // Run the sub-transforms of the innermost recursion level, and then the
+      // last stage of the blocks of each level, which the serial recursion
+      // computes in the m == 2 stage of their parent, as parallel tasks
+      ThreadPool& pool = ThreadPool::GetInstance();
+      const uint64_t block_size = n >> parallel_levels;
+      pool.ParallelFor(size_t(1) << parallel_levels, [&](size_t block) {
+        size_t offset = block * block_size;
+        InverseTransformFromBitReverseAVX2<BitShift>(
+            &result[offset], &operand[offset], block_size, modulus,
+            inv_root_of_unity_powers, precon_inv_root_of_unity_powers,
+            input_mod_factor, output_mod_factor, parallel_levels, block,
+            mult_operand ? &mult_operand[offset] : nullptr);
+      });
+      for (uint64_t level = parallel_levels; level > 0; --level) {
+        const uint64_t level_block_size = n >> level;
+        pool.ParallelFor(size_t(1) << level, [&](size_t block) {
+          size_t block_W_idx = InvRootIndex(n, 1, level, block);
+          InvT8<BitShift>(&result[block * level_block_size], v_modulus,
+                          v_twice_mod, level_block_size / 2, 1,
+                          &inv_root_of_unity_powers[block_W_idx],
+                          &precon_inv_root_of_unity_powers[block_W_idx]);
+        });
+      }
+    } else {
+      InverseTransformFromBitReverseAVX2<BitShift>(
+          result, operand, n / 2, modulus, inv_root_of_unity_powers,
+          precon_inv_root_of_unity_powers, input_mod_factor, output_mod_factor,
+          recursion_depth + 1, 2 * recursion_half, mult_operand);
+      InverseTransformFromBitReverseAVX2<BitShift>(
+          &result[n / 2], &operand[n / 2], n / 2, modulus,
+          inv_root_of_unity_powers, precon_inv_root_of_unity_powers,
+          input_mod_factor, output_mod_factor, recursion_depth + 1,
+          2 * recursion_half + 1,
+          mult_operand ? &mult_operand[n / 2] : nullptr);
+    }
+
+    uint64_t W_idx_delta =
+        m * ((1ULL << (recursion_depth + 1)) - recursion_half);
+    for (; m > 2; m >>= 1) {
+      t <<= 1;
+      W_idx_delta >>= 1;
+      W_idx += W_idx_delta;
+    }
+    if (m == 2) {
+      const uint64_t* W = &inv_root_of_unity_powers[W_idx];
+      const uint64_t* W_precon = &precon_inv_root_of_unity_powers[W_idx];
+      // Already computed for the blocks of the first level in parallel
+      if (parallel_levels == 0) {
+        InvT8<BitShift>(result, v_modulus, v_twice_mod, t, m, W, W_precon);
+      }
+      t <<= 1;
+      m >>= 1;
+      W_idx_delta >>= 1;
+      W_idx += W_idx_delta;
+    }
+  }
+
+  // Final loop through data
+  if (recursion_depth == 0) {
+    HEXL_VLOG(4, "AVX2 intermediate result "
+                     << std::vector<uint64_t>(result, result + n));
+
+    const uint64_t W = inv_root_of_unity_powers[W_idx];
+    MultiplyFactor mf_inv_n(
+        MultiplyMod(InverseMod(n, modulus), scalar, modulus), BitShift,
+        modulus);
+    const uint64_t inv_n = mf_inv_n.Operand();
+    const uint64_t inv_n_prime = mf_inv_n.BarrettFactor();
+
+    MultiplyFactor mf_inv_n_w(MultiplyMod(inv_n, W, modulus), BitShift,
+                              modulus);
+    const uint64_t inv_n_w = mf_inv_n_w.Operand();
+    const uint64_t inv_n_w_prime = mf_inv_n_w.BarrettFactor();
+
+    uint64_t* X = result;
+    uint64_t* Y = X + (n >> 1);
+
+    __m256i v_inv_n = _mm256_set1_epi64x(static_cast<int64_t>(inv_n));
+    __m256i v_inv_n_prime =
+        _mm256_set1_epi64x(static_cast<int64_t>(inv_n_prime));
+    __m256i v_inv_n_w = _mm256_set1_epi64x(static_cast<int64_t>(inv_n_w));
+    __m256i v_inv_n_w_prime =
+        _mm256_set1_epi64x(static_cast<int64_t>(inv_n_w_prime));
+    __m256i v_addend = _mm256_set1_epi64x(static_cast<int64_t>(addend));
+
+    __m256i* v_X_pt = reinterpret_cast<__m256i*>(X);
+    __m256i* v_Y_pt = reinterpret_cast<__m256i*>(Y);
+
+    // Merge final InvNTT loop with modulus reduction baked-in
+    HEXL_LOOP_UNROLL_4
+    for (size_t j = n / 8; j > 0; --j) {
+      __m256i v_X = _mm256_loadu_si256(v_X_pt);
+      __m256i v_Y = _mm256_loadu_si256(v_Y_pt);
+
+      // Slightly different from regular InvButterfly because different W is
+      // used for X and Y
+      __m256i Y_minus_2q = _mm256_sub_epi64(v_Y, v_twice_mod);
+      __m256i X_plus_Y_mod2q = _mm256_hexl_signed_small_mod_epi64(
+          _mm256_add_epi64(v_X, Y_minus_2q), v_twice_mod);
+      // T = *X + twice_mod - *Y
+      __m256i T = _mm256_sub_epi64(v_X, Y_minus_2q);
+
+      v_X = MultiplyModLazyAVX2<BitShift>(X_plus_Y_mod2q, v_inv_n,
+                                          v_inv_n_prime, v_modulus,
+                                          v_twice_mod);
+      v_Y = MultiplyModLazyAVX2<BitShift>(T, v_inv_n_w, v_inv_n_w_prime,
+                                          v_modulus, v_twice_mod);
+
+      if (addend != 0) {
+        // Reduce to [0, q) before adding the correction, so the sum is in [0,
+        // 2q)
+        v_X = _mm256_add_epi64(_mm256_hexl_small_mod_epu64(v_X, v_modulus),
+                               v_addend);
+        v_Y = _mm256_add_epi64(_mm256_hexl_small_mod_epu64(v_Y, v_modulus),
+                               v_addend);
+      }
+
+      if (output_mod_factor == 1) {
+        // Modulus reduction from [0, 2q), to [0, q)
+        v_X = _mm256_hexl_small_mod_epu64(v_X, v_modulus);
+        v_Y = _mm256_hexl_small_mod_epu64(v_Y, v_modulus);
+      }
+
+      _mm256_storeu_si256(v_X_pt++, v_X);
+      _mm256_storeu_si256(v_Y_pt++, v_Y);
+    }
+
+    HEXL_VLOG(5, "AVX2 returning result "
+                     << std::vector<uint64_t>(result, result + n));
+  }
+}
+
+#endif  // HEXL_HAS_AVX256
+
+}  // namespace hexl
+}  // namespace intel
@@ -0,0 +1,50 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "ntt/ntt-internal.hpp"
+
+namespace intel {
+namespace hexl {
+
+#ifdef HEXL_HAS_AVX256
+
+/// @brief AVX2 implementation of the inverse NTT
+/// @param[out] result Output data
+/// @param[in] operand Input data
+/// @param[in] n Size of the transform, i.e. the polynomial degree. Must be a
+/// power of two.
+/// @param[in] modulus Prime modulus q. Must satisfy q == 1 mod 2n
+/// @param[in] inv_root_of_unity_powers Powers of inverse 2n'th root of unity in
+/// F_q. In bit-reversed order.
+/// @param[in] precon_inv_root_of_unity_powers Pre-conditioned powers of inverse
+/// 2n'th root of unity in F_q. In bit-reversed order.
+/// @param[in] input_mod_factor Upper bound for inputs; inputs must be in [0,
+/// input_mod_factor * q)
+/// @param[in] output_mod_factor Upper bound for result; result must be in [0,
+/// output_mod_factor * q)
+/// @param[in] recursion_depth Depth of recursive call
+/// @param[in] recursion_half Helper for indexing roots of unity
+/// @param[in] mult_operand If not nullptr, computes the inverse NTT of the
+/// elementwise product of operand and mult_operand instead, with both inputs
+/// in [0, input_mod_factor * q) for input_mod_factor in {1, 2, 4}
+/// @param[in] scalar Output scalar in [0, q), folded into the multiplication
+/// by n^{-1} of the final stage
+/// @param[in] addend Additive correction in [0, q), added to each output in
+/// the final stage
+/// @details Follows the recursive structure of
+/// InverseTransformFromBitReverseAVX512, operating on 4 64-bit lanes.
+template <int BitShift>
+void InverseTransformFromBitReverseAVX2(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* inv_root_of_unity_powers,
+    const uint64_t* precon_inv_root_of_unity_powers, uint64_t input_mod_factor,
+    uint64_t output_mod_factor, uint64_t recursion_depth = 0,
+    uint64_t recursion_half = 0, const uint64_t* mult_operand = nullptr,
+    uint64_t scalar = 1, uint64_t addend = 0);
+
+#endif  // HEXL_HAS_AVX256
+
+}  // namespace hexl
+}  // namespace intel
@@ -9,11 +9,14 @@
 #include <functional>
 #include <vector>
 
+#include "hexl/eltwise/eltwise-mult-mod.hpp"
 #include "hexl/logging/logging.hpp"
 #include "hexl/ntt/ntt.hpp"
 #include "hexl/number-theory/number-theory.hpp"
 #include "ntt/ntt-avx512-util.hpp"
+#include "ntt/ntt-default.hpp"
 #include "ntt/ntt-internal.hpp"
+#include "util/thread-pool.hpp"
 #include "util/avx512-util.hpp"
 
 namespace intel {
@@ -25,7 +28,15 @@ template void InverseTransformFromBitReverseAVX512<NTT::s_ifma_shift_bits>(
     uint64_t modulus, const uint64_t* inv_root_of_unity_powers,
     const uint64_t* precon_inv_root_of_unity_powers, uint64_t input_mod_factor,
     uint64_t output_mod_factor, uint64_t recursion_depth,
-    uint64_t recursion_half);
+    uint64_t recursion_half, const uint64_t* mult_operand, uint64_t scalar,
+    uint64_t addend);
+
+template void
+InverseTransformFromBitReverseMultiAVX512<NTT::s_ifma_shift_bits>(
+    uint64_t* const* result, const uint64_t* const* operand, size_t num_polys,
+    uint64_t n, uint64_t modulus, const uint64_t* inv_root_of_unity_powers,
+    const uint64_t* precon_inv_root_of_unity_powers, uint64_t input_mod_factor,
+    uint64_t output_mod_factor);
 #endif
 
 #ifdef HEXL_HAS_AVX512DQ
@@ -34,14 +45,29 @@ template void InverseTransformFromBitReverseAVX512<32>(
     uint64_t modulus, const uint64_t* inv_root_of_unity_powers,
     const uint64_t* precon_inv_root_of_unity_powers, uint64_t input_mod_factor,
     uint64_t output_mod_factor, uint64_t recursion_depth,
-    uint64_t recursion_half);
+    uint64_t recursion_half, const uint64_t* mult_operand, uint64_t scalar,
+    uint64_t addend);
 
 template void InverseTransformFromBitReverseAVX512<NTT::s_default_shift_bits>(
     uint64_t* result, const uint64_t* operand, uint64_t degree,
     uint64_t modulus, const uint64_t* inv_root_of_unity_powers,
     const uint64_t* precon_inv_root_of_unity_powers, uint64_t input_mod_factor,
     uint64_t output_mod_factor, uint64_t recursion_depth,
-    uint64_t recursion_half);
+    uint64_t recursion_half, const uint64_t* mult_operand, uint64_t scalar,
+    uint64_t addend);
+
+template void InverseTransformFromBitReverseMultiAVX512<32>(
+    uint64_t* const* result, const uint64_t* const* operand, size_t num_polys,
+    uint64_t n, uint64_t modulus, const uint64_t* inv_root_of_unity_powers,
+    const uint64_t* precon_inv_root_of_unity_powers, uint64_t input_mod_factor,
+    uint64_t output_mod_factor);
+
+template void
+InverseTransformFromBitReverseMultiAVX512<NTT::s_default_shift_bits>(
+    uint64_t* const* result, const uint64_t* const* operand, size_t num_polys,
+    uint64_t n, uint64_t modulus, const uint64_t* inv_root_of_unity_powers,
+    const uint64_t* precon_inv_root_of_unity_powers, uint64_t input_mod_factor,
+    uint64_t output_mod_factor);
 #endif
 
 #ifdef HEXL_HAS_AVX512DQ
@@ -221,14 +247,116 @@ void InvT8(uint64_t* operand, __m512i v_neg_modulus, __m512i v_twice_mod,
   }
 }
 
+// Final stage of the inverse NTT of size n, with the multiplication by n^{-1}
+// and the scalar folded in, and the addend added. W is the root of unity of
+// the final stage.
+template <int BitShift>
+void InvFinalStage(uint64_t* result, uint64_t n, uint64_t modulus, uint64_t W,
+                   uint64_t output_mod_factor, uint64_t scalar,
+                   uint64_t addend) {
+  __m512i v_modulus = _mm512_set1_epi64(static_cast<int64_t>(modulus));
+  __m512i v_neg_modulus = _mm512_set1_epi64(-static_cast<int64_t>(modulus));
+  __m512i v_twice_mod = _mm512_set1_epi64(static_cast<int64_t>(2 * modulus));
+
+  MultiplyFactor mf_inv_n(
+      MultiplyMod(InverseMod(n, modulus), scalar, modulus), BitShift,
+      modulus);
+  const uint64_t inv_n = mf_inv_n.Operand();
+  const uint64_t inv_n_prime = mf_inv_n.BarrettFactor();
+
+  MultiplyFactor mf_inv_n_w(MultiplyMod(inv_n, W, modulus), BitShift,
+                            modulus);
+  const uint64_t inv_n_w = mf_inv_n_w.Operand();
+  const uint64_t inv_n_w_prime = mf_inv_n_w.BarrettFactor();
+
+  HEXL_VLOG(4, "inv_n_w " << inv_n_w);
+
+  uint64_t* X = result;
+  uint64_t* Y = X + (n >> 1);
+
+  __m512i v_inv_n = _mm512_set1_epi64(static_cast<int64_t>(inv_n));
+  __m512i v_inv_n_prime =
+      _mm512_set1_epi64(static_cast<int64_t>(inv_n_prime));
+  __m512i v_inv_n_w = _mm512_set1_epi64(static_cast<int64_t>(inv_n_w));
+  __m512i v_inv_n_w_prime =
+      _mm512_set1_epi64(static_cast<int64_t>(inv_n_w_prime));
+  __m512i v_addend = _mm512_set1_epi64(static_cast<int64_t>(addend));
+
+  __m512i* v_X_pt = reinterpret_cast<__m512i*>(X);
+  __m512i* v_Y_pt = reinterpret_cast<__m512i*>(Y);
+
+  // Merge final InvNTT loop with modulus reduction baked-in
+  HEXL_LOOP_UNROLL_4
+  for (size_t j = n / 16; j > 0; --j) {
+    __m512i v_X = _mm512_loadu_si512(v_X_pt);
+    __m512i v_Y = _mm512_loadu_si512(v_Y_pt);
+
+    // Slightly different from regular InvButterfly because different W is
+    // used for X and Y
+    __m512i Y_minus_2q = _mm512_sub_epi64(v_Y, v_twice_mod);
+    __m512i X_plus_Y_mod2q =
+        _mm512_hexl_small_add_mod_epi64(v_X, v_Y, v_twice_mod);
+    // T = *X + twice_mod - *Y
+    __m512i T = _mm512_sub_epi64(v_X, Y_minus_2q);
+
+    if (BitShift == 32) {
+      __m512i Q1 = _mm512_hexl_mullo_epi<64>(v_inv_n_prime, X_plus_Y_mod2q);
+      Q1 = _mm512_srli_epi64(Q1, 32);
+      // X = inv_N * X_plus_Y_mod2q - Q1 * modulus;
+      __m512i inv_N_tx = _mm512_hexl_mullo_epi<64>(v_inv_n, X_plus_Y_mod2q);
+      v_X = _mm512_hexl_mullo_add_lo_epi<64>(inv_N_tx, Q1, v_neg_modulus);
+
+      __m512i Q2 = _mm512_hexl_mullo_epi<64>(v_inv_n_w_prime, T);
+      Q2 = _mm512_srli_epi64(Q2, 32);
+
+      // Y = inv_N_W * T - Q2 * modulus;
+      __m512i inv_N_W_T = _mm512_hexl_mullo_epi<64>(v_inv_n_w, T);
+      v_Y = _mm512_hexl_mullo_add_lo_epi<64>(inv_N_W_T, Q2, v_neg_modulus);
+    } else {
+      __m512i Q1 =
+          _mm512_hexl_mulhi_epi<BitShift>(v_inv_n_prime, X_plus_Y_mod2q);
+      // X = inv_N * X_plus_Y_mod2q - Q1 * modulus;
+      __m512i inv_N_tx =
+          _mm512_hexl_mullo_epi<BitShift>(v_inv_n, X_plus_Y_mod2q);
+      v_X =
+          _mm512_hexl_mullo_add_lo_epi<BitShift>(inv_N_tx, Q1, v_neg_modulus);
+
+      __m512i Q2 = _mm512_hexl_mulhi_epi<BitShift>(v_inv_n_w_prime, T);
+      // Y = inv_N_W * T - Q2 * modulus;
+      __m512i inv_N_W_T = _mm512_hexl_mullo_epi<BitShift>(v_inv_n_w, T);
+      v_Y = _mm512_hexl_mullo_add_lo_epi<BitShift>(inv_N_W_T, Q2,
+                                                   v_neg_modulus);
+    }
+
+    if (addend != 0) {
+      // Reduce to [0, q) before adding the correction, so the sum is in [0,
+      // 2q)
+      v_X = _mm512_add_epi64(_mm512_hexl_small_mod_epu64(v_X, v_modulus),
+                             v_addend);
+      v_Y = _mm512_add_epi64(_mm512_hexl_small_mod_epu64(v_Y, v_modulus),
+                             v_addend);
+    }
+
+    if (output_mod_factor == 1) {
+      // Modulus reduction from [0, 2q), to [0, q)
+      v_X = _mm512_hexl_small_mod_epu64(v_X, v_modulus);
+      v_Y = _mm512_hexl_small_mod_epu64(v_Y, v_modulus);
+    }
+
+    _mm512_storeu_si512(v_X_pt++, v_X);
+    _mm512_storeu_si512(v_Y_pt++, v_Y);
+  }
+}
+
 template <int BitShift>
 void InverseTransformFromBitReverseAVX512(
     uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
     const uint64_t* inv_root_of_unity_powers,
     const uint64_t* precon_inv_root_of_unity_powers, uint64_t input_mod_factor,
     uint64_t output_mod_factor, uint64_t recursion_depth,
-    uint64_t recursion_half) {
-  HEXL_CHECK(NTT::CheckArguments(n, modulus), "");
+    uint64_t recursion_half, const uint64_t* mult_operand, uint64_t scalar,
+    uint64_t addend) {
+  HEXL_CHECK(NTT::CheckCyclicArguments(n, modulus), "");
   HEXL_CHECK(n >= 16,
              "InverseTransformFromBitReverseAVX512 doesn't support small "
              "transforms. Need n >= 16, got n = "
@@ -245,13 +373,13 @@ void InverseTransformFromBitReverseAVX512(
                     input_mod_factor * modulus,
                     "operand larger than input_mod_factor * modulus ("
                         << input_mod_factor << " * " << modulus << ")");
-  HEXL_CHECK(input_mod_factor == 1 || input_mod_factor == 2,
+  HEXL_CHECK(input_mod_factor == 1 || input_mod_factor == 2 ||
+                 (mult_operand != nullptr && input_mod_factor == 4),
              "input_mod_factor must be 1 or 2; got " << input_mod_factor);
   HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 2,
              "output_mod_factor must be 1 or 2; got " << output_mod_factor);
 
   uint64_t twice_mod = modulus << 1;
-  __m512i v_modulus = _mm512_set1_epi64(static_cast<int64_t>(modulus));
   __m512i v_neg_modulus = _mm512_set1_epi64(-static_cast<int64_t>(modulus));
   __m512i v_twice_mod = _mm512_set1_epi64(static_cast<int64_t>(twice_mod));
 
@@ -259,10 +387,16 @@ void InverseTransformFromBitReverseAVX512(
   size_t m = (n >> 1);
   size_t W_idx = 1 + m * recursion_half;
 
-  static const size_t base_ntt_size = 1024;
+  const size_t base_ntt_size = NTT::GetBaseNTTSize();
 
   if (n <= base_ntt_size) {  // Perform breadth-first InvNTT
-    if (operand != result) {
+    if (mult_operand != nullptr) {
+      // Pointwise product, computed while the block is resident in cache
+      EltwiseMultMod(result, operand, mult_operand, n, modulus,
+                     input_mod_factor);
+      operand = result;
+      input_mod_factor = 1;
+    } else if (operand != result) {
       std::memcpy(result, operand, n * sizeof(uint64_t));
     }
 
@@ -316,15 +450,44 @@ void InverseTransformFromBitReverseAVX512(
       }
     }
   } else {
-    InverseTransformFromBitReverseAVX512<BitShift>(
-        result, operand, n / 2, modulus, inv_root_of_unity_powers,
-        precon_inv_root_of_unity_powers, input_mod_factor, output_mod_factor,
-        recursion_depth + 1, 2 * recursion_half);
-    InverseTransformFromBitReverseAVX512<BitShift>(
-        &result[n / 2], &operand[n / 2], n / 2, modulus,
-        inv_root_of_unity_powers, precon_inv_root_of_unity_powers,
-        input_mod_factor, output_mod_factor, recursion_depth + 1,
-        2 * recursion_half + 1);
+    const uint64_t parallel_levels =
+        (recursion_depth == 0) ? ParallelNTTLevels(n) : 0;
+    if (parallel_levels > 0) {
+      // Run the sub-transforms of the innermost recursion level, and then the
+      // last stage of the blocks of each level, which the serial recursion
+      // computes in the m == 2 stage of their parent, as parallel tasks
+      ThreadPool& pool = ThreadPool::GetInstance();
+      const uint64_t block_size = n >> parallel_levels;
+      pool.ParallelFor(size_t(1) << parallel_levels, [&](size_t block) {
+        size_t offset = block * block_size;
+        InverseTransformFromBitReverseAVX512<BitShift>(
+            &result[offset], &operand[offset], block_size, modulus,
+            inv_root_of_unity_powers, precon_inv_root_of_unity_powers,
+            input_mod_factor, output_mod_factor, parallel_levels, block,
+            mult_operand ? &mult_operand[offset] : nullptr);
+      });
+      for (uint64_t level = parallel_levels; level > 0; --level) {
+        const uint64_t level_block_size = n >> level;
+        pool.ParallelFor(size_t(1) << level, [&](size_t block) {
+          size_t block_W_idx = InvRootIndex(n, 1, level, block);
+          InvT8<BitShift>(&result[block * level_block_size], v_neg_modulus,
+                          v_twice_mod, level_block_size / 2, 1,
+                          &inv_root_of_unity_powers[block_W_idx],
+                          &precon_inv_root_of_unity_powers[block_W_idx]);
+        });
+      }
+    } else {
+      InverseTransformFromBitReverseAVX512<BitShift>(
+          result, operand, n / 2, modulus, inv_root_of_unity_powers,
+          precon_inv_root_of_unity_powers, input_mod_factor, output_mod_factor,
+          recursion_depth + 1, 2 * recursion_half, mult_operand);
+      InverseTransformFromBitReverseAVX512<BitShift>(
+          &result[n / 2], &operand[n / 2], n / 2, modulus,
+          inv_root_of_unity_powers, precon_inv_root_of_unity_powers,
+          input_mod_factor, output_mod_factor, recursion_depth + 1,
+          2 * recursion_half + 1,
+          mult_operand ? &mult_operand[n / 2] : nullptr);
+    }
 
     uint64_t W_idx_delta =
         m * ((1ULL << (recursion_depth + 1)) - recursion_half);
@@ -336,7 +499,10 @@ void InverseTransformFromBitReverseAVX512(
     if (m == 2) {
       const uint64_t* W = &inv_root_of_unity_powers[W_idx];
       const uint64_t* W_precon = &precon_inv_root_of_unity_powers[W_idx];
-      InvT8<BitShift>(result, v_neg_modulus, v_twice_mod, t, m, W, W_precon);
+      // Already computed for the blocks of the first level in parallel
+      if (parallel_levels == 0) {
+        InvT8<BitShift>(result, v_neg_modulus, v_twice_mod, t, m, W, W_precon);
+      }
       t <<= 1;
       m >>= 1;
       W_idx_delta >>= 1;
@@ -349,86 +515,269 @@ void InverseTransformFromBitReverseAVX512(
     HEXL_VLOG(4, "AVX512 intermediate result "
                      << std::vector<uint64_t>(result, result + n));
 
-    const uint64_t W = inv_root_of_unity_powers[W_idx];
-    MultiplyFactor mf_inv_n(InverseMod(n, modulus), BitShift, modulus);
-    const uint64_t inv_n = mf_inv_n.Operand();
-    const uint64_t inv_n_prime = mf_inv_n.BarrettFactor();
+    InvFinalStage<BitShift>(result, n, modulus, inv_root_of_unity_powers[W_idx],
+                            output_mod_factor, scalar, addend);
 
-    MultiplyFactor mf_inv_n_w(MultiplyMod(inv_n, W, modulus), BitShift,
-                              modulus);
-    const uint64_t inv_n_w = mf_inv_n_w.Operand();
-    const uint64_t inv_n_w_prime = mf_inv_n_w.BarrettFactor();
+    HEXL_VLOG(5, "AVX512 returning result "
+                     << std::vector<uint64_t>(result, result + n));
+  }
+}
 
-    HEXL_VLOG(4, "inv_n_w " << inv_n_w);
+// The *Multi variants apply a stage to the blocks at \p offset of each of the
+// \p num_polys polynomials, loading each root of unity vector once
 
-    uint64_t* X = result;
-    uint64_t* Y = X + (n >> 1);
+template <int BitShift, bool InputLessThanMod>
+void InvT1Multi(uint64_t* const* polys, size_t num_polys, size_t offset,
+                __m512i v_neg_modulus, __m512i v_twice_mod, uint64_t m,
+                const uint64_t* W, const uint64_t* W_precon) {
+  // 8 | m guaranteed by n >= 16
+  for (size_t j1 = 0; j1 < 2 * m; j1 += 16) {
+    __m512i v_W = _mm512_loadu_si512(W);
+    __m512i v_W_precon = _mm512_loadu_si512(W_precon);
+
+    for (size_t p = 0; p < num_polys; ++p) {
+      uint64_t* X = polys[p] + offset + j1;
+      __m512i* v_X_pt = reinterpret_cast<__m512i*>(X);
+      __m512i v_X;
+      __m512i v_Y;
+      LoadInvInterleavedT1(X, &v_X, &v_Y);
+      InvButterfly<BitShift, InputLessThanMod>(&v_X, &v_Y, v_W, v_W_precon,
+                                               v_neg_modulus, v_twice_mod);
+      _mm512_storeu_si512(v_X_pt, v_X);
+      _mm512_storeu_si512(v_X_pt + 1, v_Y);
+    }
+    W += 8;
+    W_precon += 8;
+  }
+}
 
-    __m512i v_inv_n = _mm512_set1_epi64(static_cast<int64_t>(inv_n));
-    __m512i v_inv_n_prime =
-        _mm512_set1_epi64(static_cast<int64_t>(inv_n_prime));
-    __m512i v_inv_n_w = _mm512_set1_epi64(static_cast<int64_t>(inv_n_w));
-    __m512i v_inv_n_w_prime =
-        _mm512_set1_epi64(static_cast<int64_t>(inv_n_w_prime));
+template <int BitShift>
+void InvT2Multi(uint64_t* const* polys, size_t num_polys, size_t offset,
+                __m512i v_neg_modulus, __m512i v_twice_mod, uint64_t m,
+                const uint64_t* W, const uint64_t* W_precon) {
+  // 4 | m guaranteed by n >= 16
+  for (size_t j1 = 0; j1 < 4 * m; j1 += 16) {
+    __m512i v_W = LoadWOpT2(static_cast<const void*>(W));
+    __m512i v_W_precon = LoadWOpT2(static_cast<const void*>(W_precon));
 
-    __m512i* v_X_pt = reinterpret_cast<__m512i*>(X);
-    __m512i* v_Y_pt = reinterpret_cast<__m512i*>(Y);
+    for (size_t p = 0; p < num_polys; ++p) {
+      uint64_t* X = polys[p] + offset + j1;
+      __m512i* v_X_pt = reinterpret_cast<__m512i*>(X);
+      __m512i v_X;
+      __m512i v_Y;
+      LoadInvInterleavedT2(X, &v_X, &v_Y);
+      InvButterfly<BitShift, false>(&v_X, &v_Y, v_W, v_W_precon,
+                                    v_neg_modulus, v_twice_mod);
+      _mm512_storeu_si512(v_X_pt, v_X);
+      _mm512_storeu_si512(v_X_pt + 1, v_Y);
+    }
+    W += 4;
+    W_precon += 4;
+  }
+}
 
-    // Merge final InvNTT loop with modulus reduction baked-in
-    HEXL_LOOP_UNROLL_4
-    for (size_t j = n / 16; j > 0; --j) {
-      __m512i v_X = _mm512_loadu_si512(v_X_pt);
-      __m512i v_Y = _mm512_loadu_si512(v_Y_pt);
+template <int BitShift>
+void InvT4Multi(uint64_t* const* polys, size_t num_polys, size_t offset,
+                __m512i v_neg_modulus, __m512i v_twice_mod, uint64_t m,
+                const uint64_t* W, const uint64_t* W_precon) {
+  // 2 | m guaranteed by n >= 16
+  for (size_t j1 = 0; j1 < 8 * m; j1 += 16) {
+    __m512i v_W = LoadWOpT4(static_cast<const void*>(W));
+    __m512i v_W_precon = LoadWOpT4(static_cast<const void*>(W_precon));
 
-      // Slightly different from regular InvButterfly because different W is
-      // used for X and Y
-      __m512i Y_minus_2q = _mm512_sub_epi64(v_Y, v_twice_mod);
-      __m512i X_plus_Y_mod2q =
-          _mm512_hexl_small_add_mod_epi64(v_X, v_Y, v_twice_mod);
-      // T = *X + twice_mod - *Y
-      __m512i T = _mm512_sub_epi64(v_X, Y_minus_2q);
-
-      if (BitShift == 32) {
-        __m512i Q1 = _mm512_hexl_mullo_epi<64>(v_inv_n_prime, X_plus_Y_mod2q);
-        Q1 = _mm512_srli_epi64(Q1, 32);
-        // X = inv_N * X_plus_Y_mod2q - Q1 * modulus;
-        __m512i inv_N_tx = _mm512_hexl_mullo_epi<64>(v_inv_n, X_plus_Y_mod2q);
-        v_X = _mm512_hexl_mullo_add_lo_epi<64>(inv_N_tx, Q1, v_neg_modulus);
-
-        __m512i Q2 = _mm512_hexl_mullo_epi<64>(v_inv_n_w_prime, T);
-        Q2 = _mm512_srli_epi64(Q2, 32);
-
-        // Y = inv_N_W * T - Q2 * modulus;
-        __m512i inv_N_W_T = _mm512_hexl_mullo_epi<64>(v_inv_n_w, T);
-        v_Y = _mm512_hexl_mullo_add_lo_epi<64>(inv_N_W_T, Q2, v_neg_modulus);
-      } else {
-        __m512i Q1 =
-            _mm512_hexl_mulhi_epi<BitShift>(v_inv_n_prime, X_plus_Y_mod2q);
-        // X = inv_N * X_plus_Y_mod2q - Q1 * modulus;
-        __m512i inv_N_tx =
-            _mm512_hexl_mullo_epi<BitShift>(v_inv_n, X_plus_Y_mod2q);
-        v_X =
-            _mm512_hexl_mullo_add_lo_epi<BitShift>(inv_N_tx, Q1, v_neg_modulus);
-
-        __m512i Q2 = _mm512_hexl_mulhi_epi<BitShift>(v_inv_n_w_prime, T);
-        // Y = inv_N_W * T - Q2 * modulus;
-        __m512i inv_N_W_T = _mm512_hexl_mullo_epi<BitShift>(v_inv_n_w, T);
-        v_Y = _mm512_hexl_mullo_add_lo_epi<BitShift>(inv_N_W_T, Q2,
-                                                     v_neg_modulus);
+    for (size_t p = 0; p < num_polys; ++p) {
+      uint64_t* X = polys[p] + offset + j1;
+      __m512i v_X;
+      __m512i v_Y;
+      LoadInvInterleavedT4(X, &v_X, &v_Y);
+      InvButterfly<BitShift, false>(&v_X, &v_Y, v_W, v_W_precon,
+                                    v_neg_modulus, v_twice_mod);
+      WriteInvInterleavedT4(v_X, v_Y, reinterpret_cast<__m512i*>(X));
+    }
+    W += 2;
+    W_precon += 2;
+  }
+}
+
+template <int BitShift>
+void InvT8Multi(uint64_t* const* polys, size_t num_polys, size_t offset,
+                __m512i v_neg_modulus, __m512i v_twice_mod, uint64_t t,
+                uint64_t m, const uint64_t* W, const uint64_t* W_precon) {
+  size_t j1 = offset;
+
+  for (size_t i = 0; i < m; i++) {
+    __m512i v_W = _mm512_set1_epi64(static_cast<int64_t>(*W++));
+    __m512i v_W_precon = _mm512_set1_epi64(static_cast<int64_t>(*W_precon++));
+
+    for (size_t p = 0; p < num_polys; ++p) {
+      uint64_t* X = polys[p] + j1;
+      uint64_t* Y = X + t;
+
+      // assume 8 | t
+      for (size_t j = 0; j < t; j += 8) {
+        __m512i v_X = _mm512_loadu_si512(X + j);
+        __m512i v_Y = _mm512_loadu_si512(Y + j);
+
+        InvButterfly<BitShift, false>(&v_X, &v_Y, v_W, v_W_precon,
+                                      v_neg_modulus, v_twice_mod);
+
+        _mm512_storeu_si512(X + j, v_X);
+        _mm512_storeu_si512(Y + j, v_Y);
       }
+    }
+    j1 += (t << 1);
+  }
+}
+
+// Transforms the blocks of size n at offset of each polynomial, excluding the
+// final stage at the top level; mirrors the serial path of
+// InverseTransformFromBitReverseAVX512. Returns the root of unity index of the
+// final stage.
+template <int BitShift>
+size_t InverseTransformFromBitReverseMultiAVX512Impl(
+    uint64_t* const* result, const uint64_t* const* operand, size_t num_polys,
+    size_t offset, uint64_t n, const uint64_t* inv_root_of_unity_powers,
+    const uint64_t* precon_inv_root_of_unity_powers, __m512i v_neg_modulus,
+    __m512i v_twice_mod, uint64_t input_mod_factor, uint64_t recursion_depth,
+    uint64_t recursion_half, uint64_t base_ntt_size) {
+  size_t t = 1;
+  size_t m = (n >> 1);
+  size_t W_idx = 1 + m * recursion_half;
 
-      if (output_mod_factor == 1) {
-        // Modulus reduction from [0, 2q), to [0, q)
-        v_X = _mm512_hexl_small_mod_epu64(v_X, v_modulus);
-        v_Y = _mm512_hexl_small_mod_epu64(v_Y, v_modulus);
+  if (n <= base_ntt_size) {  // Perform breadth-first InvNTT
+    for (size_t p = 0; p < num_polys; ++p) {
+      if (result[p] != operand[p]) {
+        std::memcpy(result[p] + offset, operand[p] + offset,
+                    n * sizeof(uint64_t));
       }
+    }
 
-      _mm512_storeu_si512(v_X_pt++, v_X);
-      _mm512_storeu_si512(v_Y_pt++, v_Y);
+    // t = 1
+    const uint64_t* W = &inv_root_of_unity_powers[W_idx];
+    const uint64_t* W_precon = &precon_inv_root_of_unity_powers[W_idx];
+    if ((input_mod_factor == 1) && (recursion_depth == 0)) {
+      InvT1Multi<BitShift, true>(result, num_polys, offset, v_neg_modulus,
+                                 v_twice_mod, m, W, W_precon);
+    } else {
+      InvT1Multi<BitShift, false>(result, num_polys, offset, v_neg_modulus,
+                                  v_twice_mod, m, W, W_precon);
     }
 
-    HEXL_VLOG(5, "AVX512 returning result "
-                     << std::vector<uint64_t>(result, result + n));
+    t <<= 1;
+    m >>= 1;
+    uint64_t W_idx_delta =
+        m * ((1ULL << (recursion_depth + 1)) - recursion_half);
+    W_idx += W_idx_delta;
+
+    // t = 2
+    W = &inv_root_of_unity_powers[W_idx];
+    W_precon = &precon_inv_root_of_unity_powers[W_idx];
+    InvT2Multi<BitShift>(result, num_polys, offset, v_neg_modulus, v_twice_mod,
+                         m, W, W_precon);
+
+    t <<= 1;
+    m >>= 1;
+    W_idx_delta >>= 1;
+    W_idx += W_idx_delta;
+
+    // t = 4
+    W = &inv_root_of_unity_powers[W_idx];
+    W_precon = &precon_inv_root_of_unity_powers[W_idx];
+    InvT4Multi<BitShift>(result, num_polys, offset, v_neg_modulus, v_twice_mod,
+                         m, W, W_precon);
+    t <<= 1;
+    m >>= 1;
+    W_idx_delta >>= 1;
+    W_idx += W_idx_delta;
+
+    // t >= 8
+    for (; m > 1;) {
+      W = &inv_root_of_unity_powers[W_idx];
+      W_precon = &precon_inv_root_of_unity_powers[W_idx];
+      InvT8Multi<BitShift>(result, num_polys, offset, v_neg_modulus,
+                           v_twice_mod, t, m, W, W_precon);
+      t <<= 1;
+      m >>= 1;
+      W_idx_delta >>= 1;
+      W_idx += W_idx_delta;
+    }
+    return W_idx;
+  }
+
+  InverseTransformFromBitReverseMultiAVX512Impl<BitShift>(
+      result, operand, num_polys, offset, n / 2, inv_root_of_unity_powers,
+      precon_inv_root_of_unity_powers, v_neg_modulus, v_twice_mod,
+      input_mod_factor, recursion_depth + 1, 2 * recursion_half,
+      base_ntt_size);
+  InverseTransformFromBitReverseMultiAVX512Impl<BitShift>(
+      result, operand, num_polys, offset + n / 2, n / 2,
+      inv_root_of_unity_powers, precon_inv_root_of_unity_powers,
+      v_neg_modulus, v_twice_mod, input_mod_factor, recursion_depth + 1,
+      2 * recursion_half + 1, base_ntt_size);
+
+  uint64_t W_idx_delta = m * ((1ULL << (recursion_depth + 1)) - recursion_half);
+  for (; m > 2; m >>= 1) {
+    t <<= 1;
+    W_idx_delta >>= 1;
+    W_idx += W_idx_delta;
+  }
+  if (m == 2) {
+    InvT8Multi<BitShift>(result, num_polys, offset, v_neg_modulus, v_twice_mod,
+                         t, m, &inv_root_of_unity_powers[W_idx],
+                         &precon_inv_root_of_unity_powers[W_idx]);
+    W_idx_delta >>= 1;
+    W_idx += W_idx_delta;
+  }
+  return W_idx;
+}
+
+template <int BitShift>
+void InverseTransformFromBitReverseMultiAVX512(
+    uint64_t* const* result, const uint64_t* const* operand, size_t num_polys,
+    uint64_t n, uint64_t modulus, const uint64_t* inv_root_of_unity_powers,
+    const uint64_t* precon_inv_root_of_unity_powers, uint64_t input_mod_factor,
+    uint64_t output_mod_factor) {
+  HEXL_CHECK(NTT::CheckCyclicArguments(n, modulus), "");
+  HEXL_CHECK(n >= 16,
+             "InverseTransformFromBitReverseMultiAVX512 doesn't support small "
+             "transforms. Need n >= 16, got n = "
+                 << n);
+  HEXL_CHECK(modulus < NTT::s_max_inv_modulus(BitShift),
+             "modulus " << modulus << " too large for BitShift " << BitShift
+                        << " => maximum value "
+                        << NTT::s_max_inv_modulus(BitShift));
+  HEXL_CHECK(input_mod_factor == 1 || input_mod_factor == 2,
+             "input_mod_factor must be 1 or 2; got " << input_mod_factor);
+  HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 2,
+             "output_mod_factor must be 1 or 2; got " << output_mod_factor);
+  for (size_t p = 0; p < num_polys; ++p) {
+    HEXL_CHECK_BOUNDS(operand[p], n, input_mod_factor * modulus,
+                      "operand " << p << " larger than input_mod_factor * "
+                                    "modulus ("
+                                 << input_mod_factor << " * " << modulus
+                                 << ")");
+  }
+
+  __m512i v_neg_modulus = _mm512_set1_epi64(-static_cast<int64_t>(modulus));
+  __m512i v_twice_mod = _mm512_set1_epi64(static_cast<int64_t>(2 * modulus));
+
+  // Keep the blocks of all the polynomials in the breadth-first base case
+  // resident in cache together
+  uint64_t base_ntt_size = NTT::GetBaseNTTSize();
+  while (base_ntt_size > 16 &&
+         base_ntt_size * num_polys > NTT::GetBaseNTTSize()) {
+    base_ntt_size >>= 1;
+  }
+
+  size_t W_idx = InverseTransformFromBitReverseMultiAVX512Impl<BitShift>(
+      result, operand, num_polys, 0, n, inv_root_of_unity_powers,
+      precon_inv_root_of_unity_powers, v_neg_modulus, v_twice_mod,
+      input_mod_factor, 0, 0, base_ntt_size);
+
+  for (size_t p = 0; p < num_polys; ++p) {
+    InvFinalStage<BitShift>(result[p], n, modulus,
+                            inv_root_of_unity_powers[W_idx], output_mod_factor,
+                            1, 0);
   }
 }
 
@@ -25,6 +25,13 @@ namespace hexl {
 /// output_mod_factor * q)
 /// @param[in] recursion_depth Depth of recursive call
 /// @param[in] recursion_half Helper for indexing roots of unity
+/// @param[in] mult_operand If not nullptr, computes the inverse NTT of the
+/// elementwise product of operand and mult_operand instead, with both inputs
+/// in [0, input_mod_factor * q) for input_mod_factor in {1, 2, 4}
+/// @param[in] scalar Output scalar in [0, q), folded into the multiplication
+/// by n^{-1} of the final stage
+/// @param[in] addend Additive correction in [0, q), added to each output in
+/// the final stage
 /// @details The implementation is recursive. The base case is a breadth-first
 /// NTT, where all the butterflies in a given stage are processed before any
 /// butterflies in the next stage. The base case is small enough to fit in the
@@ -38,7 +45,20 @@ void InverseTransformFromBitReverseAVX512(
     const uint64_t* inv_root_of_unity_powers,
     const uint64_t* precon_inv_root_of_unity_powers, uint64_t input_mod_factor,
     uint64_t output_mod_factor, uint64_t recursion_depth = 0,
-    uint64_t recursion_half = 0);
+    uint64_t recursion_half = 0, const uint64_t* mult_operand = nullptr,
+    uint64_t scalar = 1, uint64_t addend = 0);
+
+/// @brief AVX512 inverse NTT of \p num_polys polynomials in lockstep, such
+/// that each root of unity vector is loaded once and applied to all the
+/// polynomials. Parameters as in InverseTransformFromBitReverseAVX512, with
+/// \p result[i] and \p operand[i] the output and input of the i'th
+/// polynomial. \p result[i] may alias \p operand[i].
+template <int BitShift>
+void InverseTransformFromBitReverseMultiAVX512(
+    uint64_t* const* result, const uint64_t* const* operand, size_t num_polys,
+    uint64_t n, uint64_t modulus, const uint64_t* inv_root_of_unity_powers,
+    const uint64_t* precon_inv_root_of_unity_powers, uint64_t input_mod_factor,
+    uint64_t output_mod_factor);
 
 #endif  // HEXL_HAS_AVX512DQ
 
@@ -0,0 +1,232 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include <immintrin.h>
+
+#include "hexl/logging/logging.hpp"
+#include "hexl/number-theory/number-theory.hpp"
+#include "ntt/ntt-32-internal.hpp"
+#include "util/avx2-util.hpp"
+
+namespace intel {
+namespace hexl {
+
+#ifdef HEXL_HAS_AVX256
+
+namespace {
+
+// Permutation indices for the stages with t < 8, which process chunks of 16
+// elements loaded as two vectors v0, v1. The first element of each butterfly
+// with index k < 4 lies in v0 and with k >= 4 in v1, as does the second, so
+// the same in-lane permutation of v0 and v1 gathers the first elements into
+// the low halves and the second elements into the high halves.
+struct SmallStageIndices {
+  explicit SmallStageIndices(size_t t) {
+    alignas(32) int32_t gather[8];
+    alignas(32) int32_t scatter[8];
+    alignas(32) int32_t w[8];
+    alignas(32) int32_t mask[8];
+    int32_t ti = static_cast<int32_t>(t);
+    for (int32_t k = 0; k < 4; ++k) {
+      gather[k] = 2 * ti * (k / ti) + k % ti;
+      gather[k + 4] = gather[k] + ti;
+    }
+    for (int32_t k = 0; k < 8; ++k) {
+      scatter[gather[k]] = k;
+      w[k] = k / ti;
+      mask[k] = (k < 8 / ti) ? -1 : 0;
+    }
+    gather_idx = _mm256_load_si256(reinterpret_cast<const __m256i*>(gather));
+    scatter_idx =
+        _mm256_load_si256(reinterpret_cast<const __m256i*>(scatter));
+    w_idx = _mm256_load_si256(reinterpret_cast<const __m256i*>(w));
+    roots_mask = _mm256_load_si256(reinterpret_cast<const __m256i*>(mask));
+    roots_per_chunk = 8 / t;
+  }
+
+  __m256i gather_idx;
+  __m256i scatter_idx;
+  __m256i w_idx;
+  __m256i roots_mask;
+  size_t roots_per_chunk;
+};
+
+// Butterflies with 32-bit Shoup multiplication on 8 lanes per vector
+class AVX2Shoup32Kernel {
+ public:
+  explicit AVX2Shoup32Kernel(uint32_t modulus)
+      : m_modulus(modulus),
+        m_v_modulus(_mm256_set1_epi32(static_cast<int32_t>(modulus))),
+        m_v_twice_modulus(
+            _mm256_set1_epi32(static_cast<int32_t>(2 * modulus))) {}
+
+  uint32_t Modulus() const { return m_modulus; }
+
+  // Inputs in [0, 4q); outputs in [0, 4q)
+  void FwdStage(uint32_t* result, const uint32_t* operand, size_t t, size_t m,
+                const uint32_t* W, const uint32_t* W_precon) const {
+    Stage<false>(result, operand, t, m, W, W_precon);
+  }
+
+  // Inputs in [0, 2q); outputs in [0, 2q)
+  void InvStage(uint32_t* result, const uint32_t* operand, size_t t, size_t m,
+                const uint32_t* W, const uint32_t* W_precon) const {
+    Stage<true>(result, operand, t, m, W, W_precon);
+  }
+
+  void InvFinalStage(uint32_t* result, const uint32_t* operand, size_t half_n,
+                     uint32_t inv_n, uint32_t inv_n_precon, uint32_t inv_n_w,
+                     uint32_t inv_n_w_precon,
+                     uint64_t output_mod_factor) const {
+    __m256i v_inv_n = _mm256_set1_epi32(static_cast<int32_t>(inv_n));
+    __m256i v_inv_n_precon =
+        _mm256_set1_epi32(static_cast<int32_t>(inv_n_precon));
+    __m256i v_inv_n_w = _mm256_set1_epi32(static_cast<int32_t>(inv_n_w));
+    __m256i v_inv_n_w_precon =
+        _mm256_set1_epi32(static_cast<int32_t>(inv_n_w_precon));
+
+    for (size_t j = 0; j < half_n; j += 8) {
+      __m256i x = Load(operand + j);
+      __m256i y = Load(operand + half_n + j);
+      __m256i tx = MultiplyLazy(_mm256_add_epi32(x, y), v_inv_n,
+                                v_inv_n_precon);
+      __m256i ty = MultiplyLazy(
+          _mm256_sub_epi32(_mm256_add_epi32(x, m_v_twice_modulus), y),
+          v_inv_n_w, v_inv_n_w_precon);
+      if (output_mod_factor == 1) {
+        tx = _mm256_hexl_small_mod_epu32(tx, m_v_modulus);
+        ty = _mm256_hexl_small_mod_epu32(ty, m_v_modulus);
+      }
+      Store(result + j, tx);
+      Store(result + half_n + j, ty);
+    }
+  }
+
+  // Reduces from [0, 4q) to [0, q)
+  void ReduceMod(uint32_t* data, size_t n) const {
+    for (size_t i = 0; i < n; i += 8) {
+      __m256i x = Load(data + i);
+      x = _mm256_hexl_small_mod_epu32(x, m_v_twice_modulus);
+      x = _mm256_hexl_small_mod_epu32(x, m_v_modulus);
+      Store(data + i, x);
+    }
+  }
+
+ private:
+  static __m256i Load(const uint32_t* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  }
+
+  static void Store(uint32_t* p, __m256i x) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), x);
+  }
+
+  // Returns x * w mod q in [0, 2q)
+  __m256i MultiplyLazy(__m256i x, __m256i w, __m256i w_precon) const {
+    __m256i Q = _mm256_hexl_mulhi_epu32(x, w_precon);
+    return _mm256_sub_epi32(_mm256_mullo_epi32(x, w),
+                            _mm256_mullo_epi32(Q, m_v_modulus));
+  }
+
+  template <bool Inverse>
+  void Butterfly(__m256i* X, __m256i* Y, __m256i W, __m256i W_precon) const {
+    if (Inverse) {
+      __m256i tx = _mm256_add_epi32(*X, *Y);
+      __m256i diff =
+          _mm256_sub_epi32(_mm256_add_epi32(*X, m_v_twice_modulus), *Y);
+      *X = _mm256_hexl_small_mod_epu32(tx, m_v_twice_modulus);
+      *Y = MultiplyLazy(diff, W, W_precon);
+    } else {
+      __m256i tx = _mm256_hexl_small_mod_epu32(*X, m_v_twice_modulus);
+      __m256i T = MultiplyLazy(*Y, W, W_precon);
+      *X = _mm256_add_epi32(tx, T);
+      *Y = _mm256_sub_epi32(_mm256_add_epi32(tx, m_v_twice_modulus), T);
+    }
+  }
+
+  template <bool Inverse>
+  void Stage(uint32_t* result, const uint32_t* operand, size_t t, size_t m,
+             const uint32_t* W, const uint32_t* W_precon) const {
+    if (t >= 8) {
+      for (size_t i = 0; i < m; ++i) {
+        __m256i v_W = _mm256_set1_epi32(static_cast<int32_t>(W[i]));
+        __m256i v_W_precon =
+            _mm256_set1_epi32(static_cast<int32_t>(W_precon[i]));
+        size_t offset = 2 * i * t;
+        for (size_t j = offset; j < offset + t; j += 8) {
+          __m256i X = Load(operand + j);
+          __m256i Y = Load(operand + j + t);
+          Butterfly<Inverse>(&X, &Y, v_W, v_W_precon);
+          Store(result + j, X);
+          Store(result + j + t, Y);
+        }
+      }
+      return;
+    }
+
+    const SmallStageIndices idx(t);
+    const size_t num_chunks = (2 * t * m) / 16;
+    for (size_t chunk = 0; chunk < num_chunks; ++chunk) {
+      __m256i u0 = _mm256_permutevar8x32_epi32(Load(operand + 16 * chunk),
+                                               idx.gather_idx);
+      __m256i u1 = _mm256_permutevar8x32_epi32(Load(operand + 16 * chunk + 8),
+                                               idx.gather_idx);
+      __m256i X = _mm256_permute2x128_si256(u0, u1, 0x20);
+      __m256i Y = _mm256_permute2x128_si256(u0, u1, 0x31);
+
+      size_t root_offset = chunk * idx.roots_per_chunk;
+      __m256i v_W = _mm256_permutevar8x32_epi32(
+          _mm256_maskload_epi32(reinterpret_cast<const int*>(W + root_offset),
+                                idx.roots_mask),
+          idx.w_idx);
+      __m256i v_W_precon = _mm256_permutevar8x32_epi32(
+          _mm256_maskload_epi32(
+              reinterpret_cast<const int*>(W_precon + root_offset),
+              idx.roots_mask),
+          idx.w_idx);
+
+      Butterfly<Inverse>(&X, &Y, v_W, v_W_precon);
+
+      u0 = _mm256_permute2x128_si256(X, Y, 0x20);
+      u1 = _mm256_permute2x128_si256(X, Y, 0x31);
+      Store(result + 16 * chunk,
+            _mm256_permutevar8x32_epi32(u0, idx.scatter_idx));
+      Store(result + 16 * chunk + 8,
+            _mm256_permutevar8x32_epi32(u1, idx.scatter_idx));
+    }
+  }
+
+  uint32_t m_modulus;
+  __m256i m_v_modulus;
+  __m256i m_v_twice_modulus;
+};
+
+}  // namespace
+
+void ForwardTransformToBitReverse32AVX2(
+    uint32_t* result, const uint32_t* operand, uint64_t n, uint32_t modulus,
+    const uint32_t* root_of_unity_powers,
+    const uint32_t* precon_root_of_unity_powers, uint64_t output_mod_factor) {
+  HEXL_CHECK(n >= 16, "Don't support small transforms. Need n >= 16, got n = "
+                          << n);
+  ForwardTransform32(AVX2Shoup32Kernel(modulus), result, operand, n,
+                     root_of_unity_powers, precon_root_of_unity_powers,
+                     output_mod_factor);
+}
+
+void InverseTransformFromBitReverse32AVX2(
+    uint32_t* result, const uint32_t* operand, uint64_t n, uint32_t modulus,
+    const uint32_t* inv_root_of_unity_powers,
+    const uint32_t* precon_inv_root_of_unity_powers,
+    uint64_t output_mod_factor) {
+  HEXL_CHECK(n >= 16, "Don't support small transforms. Need n >= 16, got n = "
+                          << n);
+  InverseTransform32(AVX2Shoup32Kernel(modulus), result, operand, n,
+                     inv_root_of_unity_powers, precon_inv_root_of_unity_powers,
+                     output_mod_factor);
+}
+
+#endif  // HEXL_HAS_AVX256
+
+}  // namespace hexl
+}  // namespace intel
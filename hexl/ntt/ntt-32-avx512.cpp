@@ -0,0 +1,217 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include <immintrin.h>
+
+#include "hexl/logging/logging.hpp"
+#include "hexl/number-theory/number-theory.hpp"
+#include "ntt/ntt-32-internal.hpp"
+#include "util/avx512-util.hpp"
+
+namespace intel {
+namespace hexl {
+
+#ifdef HEXL_HAS_AVX512DQ
+
+namespace {
+
+// Permutation indices for the stages with t < 16, which process chunks of 32
+// elements loaded as two vectors v0, v1. X gathers the first element of each
+// butterfly and Y the second, such that the butterflies of X and Y are
+// lane-wise.
+struct SmallStageIndices {
+  explicit SmallStageIndices(size_t t) {
+    alignas(64) int32_t x[16];
+    alignas(64) int32_t y[16];
+    alignas(64) int32_t w[16];
+    alignas(64) int32_t out[32];
+    for (int32_t k = 0; k < 16; ++k) {
+      int32_t ti = static_cast<int32_t>(t);
+      x[k] = 2 * ti * (k / ti) + k % ti;
+      y[k] = x[k] + ti;
+      w[k] = k / ti;
+      out[x[k]] = k;
+      out[y[k]] = 16 + k;
+    }
+    x_idx = _mm512_load_si512(x);
+    y_idx = _mm512_load_si512(y);
+    w_idx = _mm512_load_si512(w);
+    out0_idx = _mm512_load_si512(out);
+    out1_idx = _mm512_load_si512(out + 16);
+    roots_per_chunk = 16 / t;
+    roots_mask = static_cast<__mmask16>((1U << roots_per_chunk) - 1);
+  }
+
+  __m512i x_idx;
+  __m512i y_idx;
+  __m512i w_idx;
+  __m512i out0_idx;
+  __m512i out1_idx;
+  size_t roots_per_chunk;
+  __mmask16 roots_mask;
+};
+
+// Butterflies with 32-bit Shoup multiplication on 16 lanes per vector
+class AVX512Shoup32Kernel {
+ public:
+  explicit AVX512Shoup32Kernel(uint32_t modulus)
+      : m_modulus(modulus),
+        m_v_modulus(_mm512_set1_epi32(static_cast<int32_t>(modulus))),
+        m_v_twice_modulus(
+            _mm512_set1_epi32(static_cast<int32_t>(2 * modulus))) {}
+
+  uint32_t Modulus() const { return m_modulus; }
+
+  // Inputs in [0, 4q); outputs in [0, 4q)
+  void FwdStage(uint32_t* result, const uint32_t* operand, size_t t, size_t m,
+                const uint32_t* W, const uint32_t* W_precon) const {
+    Stage<false>(result, operand, t, m, W, W_precon);
+  }
+
+  // Inputs in [0, 2q); outputs in [0, 2q)
+  void InvStage(uint32_t* result, const uint32_t* operand, size_t t, size_t m,
+                const uint32_t* W, const uint32_t* W_precon) const {
+    Stage<true>(result, operand, t, m, W, W_precon);
+  }
+
+  void InvFinalStage(uint32_t* result, const uint32_t* operand, size_t half_n,
+                     uint32_t inv_n, uint32_t inv_n_precon, uint32_t inv_n_w,
+                     uint32_t inv_n_w_precon,
+                     uint64_t output_mod_factor) const {
+    __m512i v_inv_n = _mm512_set1_epi32(static_cast<int32_t>(inv_n));
+    __m512i v_inv_n_precon =
+        _mm512_set1_epi32(static_cast<int32_t>(inv_n_precon));
+    __m512i v_inv_n_w = _mm512_set1_epi32(static_cast<int32_t>(inv_n_w));
+    __m512i v_inv_n_w_precon =
+        _mm512_set1_epi32(static_cast<int32_t>(inv_n_w_precon));
+
+    for (size_t j = 0; j < half_n; j += 16) {
+      __m512i x = _mm512_loadu_si512(operand + j);
+      __m512i y = _mm512_loadu_si512(operand + half_n + j);
+      __m512i tx = MultiplyLazy(_mm512_add_epi32(x, y), v_inv_n,
+                                v_inv_n_precon);
+      __m512i ty = MultiplyLazy(
+          _mm512_sub_epi32(_mm512_add_epi32(x, m_v_twice_modulus), y),
+          v_inv_n_w, v_inv_n_w_precon);
+      if (output_mod_factor == 1) {
+        tx = _mm512_hexl_small_mod_epu32(tx, m_v_modulus);
+        ty = _mm512_hexl_small_mod_epu32(ty, m_v_modulus);
+      }
+      _mm512_storeu_si512(result + j, tx);
+      _mm512_storeu_si512(result + half_n + j, ty);
+    }
+  }
+
+  // Reduces from [0, 4q) to [0, q)
+  void ReduceMod(uint32_t* data, size_t n) const {
+    for (size_t i = 0; i < n; i += 16) {
+      __m512i x = _mm512_loadu_si512(data + i);
+      x = _mm512_hexl_small_mod_epu32(x, m_v_twice_modulus);
+      x = _mm512_hexl_small_mod_epu32(x, m_v_modulus);
+      _mm512_storeu_si512(data + i, x);
+    }
+  }
+
+ private:
+  // Returns x * w mod q in [0, 2q)
+  __m512i MultiplyLazy(__m512i x, __m512i w, __m512i w_precon) const {
+    __m512i Q = _mm512_hexl_mulhi_epu32(x, w_precon);
+    return _mm512_sub_epi32(_mm512_mullo_epi32(x, w),
+                            _mm512_mullo_epi32(Q, m_v_modulus));
+  }
+
+  template <bool Inverse>
+  void Butterfly(__m512i* X, __m512i* Y, __m512i W, __m512i W_precon) const {
+    if (Inverse) {
+      __m512i tx = _mm512_add_epi32(*X, *Y);
+      __m512i diff =
+          _mm512_sub_epi32(_mm512_add_epi32(*X, m_v_twice_modulus), *Y);
+      *X = _mm512_hexl_small_mod_epu32(tx, m_v_twice_modulus);
+      *Y = MultiplyLazy(diff, W, W_precon);
+    } else {
+      __m512i tx = _mm512_hexl_small_mod_epu32(*X, m_v_twice_modulus);
+      __m512i T = MultiplyLazy(*Y, W, W_precon);
+      *X = _mm512_add_epi32(tx, T);
+      *Y = _mm512_sub_epi32(_mm512_add_epi32(tx, m_v_twice_modulus), T);
+    }
+  }
+
+  template <bool Inverse>
+  void Stage(uint32_t* result, const uint32_t* operand, size_t t, size_t m,
+             const uint32_t* W, const uint32_t* W_precon) const {
+    if (t >= 16) {
+      for (size_t i = 0; i < m; ++i) {
+        __m512i v_W = _mm512_set1_epi32(static_cast<int32_t>(W[i]));
+        __m512i v_W_precon =
+            _mm512_set1_epi32(static_cast<int32_t>(W_precon[i]));
+        size_t offset = 2 * i * t;
+        for (size_t j = offset; j < offset + t; j += 16) {
+          __m512i X = _mm512_loadu_si512(operand + j);
+          __m512i Y = _mm512_loadu_si512(operand + j + t);
+          Butterfly<Inverse>(&X, &Y, v_W, v_W_precon);
+          _mm512_storeu_si512(result + j, X);
+          _mm512_storeu_si512(result + j + t, Y);
+        }
+      }
+      return;
+    }
+
+    const SmallStageIndices idx(t);
+    const size_t num_chunks = (2 * t * m) / 32;
+    for (size_t chunk = 0; chunk < num_chunks; ++chunk) {
+      __m512i v0 = _mm512_loadu_si512(operand + 32 * chunk);
+      __m512i v1 = _mm512_loadu_si512(operand + 32 * chunk + 16);
+      __m512i X = _mm512_permutex2var_epi32(v0, idx.x_idx, v1);
+      __m512i Y = _mm512_permutex2var_epi32(v0, idx.y_idx, v1);
+
+      size_t root_offset = chunk * idx.roots_per_chunk;
+      __m512i v_W = _mm512_permutexvar_epi32(
+          idx.w_idx,
+          _mm512_maskz_loadu_epi32(idx.roots_mask, W + root_offset));
+      __m512i v_W_precon = _mm512_permutexvar_epi32(
+          idx.w_idx,
+          _mm512_maskz_loadu_epi32(idx.roots_mask, W_precon + root_offset));
+
+      Butterfly<Inverse>(&X, &Y, v_W, v_W_precon);
+
+      _mm512_storeu_si512(result + 32 * chunk,
+                          _mm512_permutex2var_epi32(X, idx.out0_idx, Y));
+      _mm512_storeu_si512(result + 32 * chunk + 16,
+                          _mm512_permutex2var_epi32(X, idx.out1_idx, Y));
+    }
+  }
+
+  uint32_t m_modulus;
+  __m512i m_v_modulus;
+  __m512i m_v_twice_modulus;
+};
+
+}  // namespace
+
+void ForwardTransformToBitReverse32AVX512(
+    uint32_t* result, const uint32_t* operand, uint64_t n, uint32_t modulus,
+    const uint32_t* root_of_unity_powers,
+    const uint32_t* precon_root_of_unity_powers, uint64_t output_mod_factor) {
+  HEXL_CHECK(n >= 32, "Don't support small transforms. Need n >= 32, got n = "
+                          << n);
+  ForwardTransform32(AVX512Shoup32Kernel(modulus), result, operand, n,
+                     root_of_unity_powers, precon_root_of_unity_powers,
+                     output_mod_factor);
+}
+
+void InverseTransformFromBitReverse32AVX512(
+    uint32_t* result, const uint32_t* operand, uint64_t n, uint32_t modulus,
+    const uint32_t* inv_root_of_unity_powers,
+    const uint32_t* precon_inv_root_of_unity_powers,
+    uint64_t output_mod_factor) {
+  HEXL_CHECK(n >= 32, "Don't support small transforms. Need n >= 32, got n = "
+                          << n);
+  InverseTransform32(AVX512Shoup32Kernel(modulus), result, operand, n,
+                     inv_root_of_unity_powers, precon_inv_root_of_unity_powers,
+                     output_mod_factor);
+}
+
+#endif  // HEXL_HAS_AVX512DQ
+
+}  // namespace hexl
+}  // namespace intel
@@ -0,0 +1,168 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdint.h>
+
+#include <cstring>
+
+#include "hexl/number-theory/number-theory.hpp"
+
+namespace intel {
+namespace hexl {
+
+/// @brief Returns the 32-bit pre-conditioned value floor(w * 2^32 / q) of \p w
+/// for 32-bit Shoup multiplication
+inline uint32_t Precon32(uint32_t w, uint32_t modulus) {
+  return static_cast<uint32_t>((uint64_t{w} << 32) / modulus);
+}
+
+/// @brief Returns x * w mod q in [0, 2q) by 32-bit Shoup multiplication
+/// @param[in] x Multiplicand, any 32-bit value
+/// @param[in] w Multiplicand in [0, q)
+/// @param[in] w_precon Pre-conditioned \p w, as returned by Precon32
+/// @param[in] modulus Modulus q, less than 2^31
+/// @details The quotient estimate floor(x w_precon / 2^32) is at most one less
+/// than floor(x w / q), so the difference fits in 32 bits.
+inline uint32_t MultiplyModLazy32(uint32_t x, uint32_t w, uint32_t w_precon,
+                                  uint32_t modulus) {
+  uint32_t Q = static_cast<uint32_t>((uint64_t{x} * w_precon) >> 32);
+  return x * w - Q * modulus;
+}
+
+/// @brief Computes the forward NTT of size \p n on 32-bit coefficients with
+/// the butterflies of \p kernel. Assumes \p operand in [0, 4q) and returns
+/// \p result in [0, output_mod_factor * q), for output_mod_factor 1 or 4.
+/// @param[in] kernel Butterfly implementation, providing FwdStage(result,
+/// operand, t, m, W, W_precon), which applies the stage of m groups of 2t
+/// elements using the roots W[0..m), and ReduceMod(data, n), which reduces
+/// \p n values from [0, 4q) to [0, q)
+/// @param[out] result Output data. May alias \p operand.
+/// @param[in] operand Input data
+/// @param[in] n Size of the transform
+/// @param[in] root_of_unity_powers Powers of the 2n'th root of unity in
+/// bit-reversed order, in the layout of NTT::GetRootOfUnityPowers()
+/// @param[in] precon_root_of_unity_powers Pre-conditioned \p
+/// root_of_unity_powers
+/// @param[in] output_mod_factor Must be 1 or 4
+/// @details Breadth-first: the 32-bit coefficients of a transform of up to
+/// 2^13 elements fit in a 32 KB L1 cache, and twice as many in L2 as for
+/// the 64-bit transforms.
+template <typename Kernel>
+void ForwardTransform32(const Kernel& kernel, uint32_t* result,
+                        const uint32_t* operand, uint64_t n,
+                        const uint32_t* root_of_unity_powers,
+                        const uint32_t* precon_root_of_unity_powers,
+                        uint64_t output_mod_factor) {
+  const uint32_t* input = operand;
+  for (uint64_t m = 1, t = n >> 1; m < n; m <<= 1, t >>= 1) {
+    kernel.FwdStage(result, input, t, m, root_of_unity_powers + m,
+                    precon_root_of_unity_powers + m);
+    input = result;
+  }
+  if (input != result) {
+    std::memcpy(result, operand, n * sizeof(uint32_t));
+  }
+  if (output_mod_factor == 1) {
+    kernel.ReduceMod(result, n);
+  }
+}
+
+/// @brief Computes the inverse NTT of size \p n on 32-bit coefficients with
+/// the butterflies of \p kernel. Assumes \p operand in [0, 2q) and returns
+/// \p result in [0, output_mod_factor * q), for output_mod_factor 1 or 2.
+/// @param[in] kernel Butterfly implementation, providing InvStage, analogous
+/// to the FwdStage of ForwardTransform32, InvFinalStage(result, operand,
+/// half_n, inv_n, inv_n_precon, inv_n_w, inv_n_w_precon, output_mod_factor),
+/// which computes the final stage fused with the multiplication by n^{-1}, and
+/// Modulus()
+/// @param[out] result Output data. May alias \p operand.
+/// @param[in] operand Input data
+/// @param[in] n Size of the transform
+/// @param[in] inv_root_of_unity_powers Inverse powers of the 2n'th root of
+/// unity, in the layout of NTT::GetInvRootOfUnityPowers()
+/// @param[in] precon_inv_root_of_unity_powers Pre-conditioned \p
+/// inv_root_of_unity_powers
+/// @param[in] output_mod_factor Must be 1 or 2
+template <typename Kernel>
+void InverseTransform32(const Kernel& kernel, uint32_t* result,
+                        const uint32_t* operand, uint64_t n,
+                        const uint32_t* inv_root_of_unity_powers,
+                        const uint32_t* precon_inv_root_of_unity_powers,
+                        uint64_t output_mod_factor) {
+  const uint32_t modulus = kernel.Modulus();
+  if (n == 1) {
+    uint32_t x = operand[0];
+    result[0] = (output_mod_factor == 1 && x >= modulus) ? x - modulus : x;
+    return;
+  }
+
+  const uint32_t* input = operand;
+  uint64_t root_index = 1;
+  for (uint64_t m = n >> 1, t = 1; m > 1; m >>= 1, t <<= 1) {
+    kernel.InvStage(result, input, t, m, inv_root_of_unity_powers + root_index,
+                    precon_inv_root_of_unity_powers + root_index);
+    root_index += m;
+    input = result;
+  }
+
+  const uint32_t inv_n = static_cast<uint32_t>(InverseMod(n, modulus));
+  const uint32_t inv_n_w = static_cast<uint32_t>(
+      MultiplyMod(inv_n, inv_root_of_unity_powers[n - 1], modulus));
+  kernel.InvFinalStage(result, input, n >> 1, inv_n, Precon32(inv_n, modulus),
+                       inv_n_w, Precon32(inv_n_w, modulus), output_mod_factor);
+}
+
+/// @brief Native forward NTT on 32-bit coefficients. See
+/// ForwardTransform32 for the parameters.
+void ForwardTransformToBitReverse32(uint32_t* result, const uint32_t* operand,
+                                    uint64_t n, uint32_t modulus,
+                                    const uint32_t* root_of_unity_powers,
+                                    const uint32_t* precon_root_of_unity_powers,
+                                    uint64_t output_mod_factor);
+
+/// @brief Native inverse NTT on 32-bit coefficients. See
+/// InverseTransform32 for the parameters.
+void InverseTransformFromBitReverse32(
+    uint32_t* result, const uint32_t* operand, uint64_t n, uint32_t modulus,
+    const uint32_t* inv_root_of_unity_powers,
+    const uint32_t* precon_inv_root_of_unity_powers,
+    uint64_t output_mod_factor);
+
+#ifdef HEXL_HAS_AVX256
+/// @brief AVX2 forward NTT on 32-bit coefficients, 8 per vector. \p n must be
+/// at least 16.
+void ForwardTransformToBitReverse32AVX2(
+    uint32_t* result, const uint32_t* operand, uint64_t n, uint32_t modulus,
+    const uint32_t* root_of_unity_powers,
+    const uint32_t* precon_root_of_unity_powers, uint64_t output_mod_factor);
+
+/// @brief AVX2 inverse NTT on 32-bit coefficients, 8 per vector. \p n must be
+/// at least 16.
+void InverseTransformFromBitReverse32AVX2(
+    uint32_t* result, const uint32_t* operand, uint64_t n, uint32_t modulus,
+    const uint32_t* inv_root_of_unity_powers,
+    const uint32_t* precon_inv_root_of_unity_powers,
+    uint64_t output_mod_factor);
+#endif
+
+#ifdef HEXL_HAS_AVX512DQ
+/// @brief AVX512 forward NTT on 32-bit coefficients, 16 per vector. \p n must
+/// be at least 32.
+void ForwardTransformToBitReverse32AVX512(
+    uint32_t* result, const uint32_t* operand, uint64_t n, uint32_t modulus,
+    const uint32_t* root_of_unity_powers,
+    const uint32_t* precon_root_of_unity_powers, uint64_t output_mod_factor);
+
+/// @brief AVX512 inverse NTT on 32-bit coefficients, 16 per vector. \p n must
+/// be at least 32.
+void InverseTransformFromBitReverse32AVX512(
+    uint32_t* result, const uint32_t* operand, uint64_t n, uint32_t modulus,
+    const uint32_t* inv_root_of_unity_powers,
+    const uint32_t* precon_inv_root_of_unity_powers,
+    uint64_t output_mod_factor);
+#endif
+
+}  // namespace hexl
+}  // namespace intel
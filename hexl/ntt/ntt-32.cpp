@@ -0,0 +1,287 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "hexl/ntt/ntt-32.hpp"
+
+#include "hexl/logging/logging.hpp"
+#include "hexl/ntt/ntt.hpp"
+#include "hexl/number-theory/number-theory.hpp"
+#include "hexl/util/check.hpp"
+#include "ntt/ntt-32-internal.hpp"
+#include "util/cpu-features.hpp"
+
+namespace intel {
+namespace hexl {
+
+namespace {
+
+// Butterflies with 32-bit Shoup multiplication
+class Native32Kernel {
+ public:
+  explicit Native32Kernel(uint32_t modulus)
+      : m_modulus(modulus), m_twice_modulus(modulus << 1) {}
+
+  uint32_t Modulus() const { return m_modulus; }
+
+  // Inputs in [0, 4q); outputs in [0, 4q)
+  void FwdStage(uint32_t* result, const uint32_t* operand, size_t t, size_t m,
+                const uint32_t* W, const uint32_t* W_precon) const {
+    for (size_t i = 0; i < m; ++i) {
+      size_t offset = 2 * i * t;
+      uint32_t* X_r = result + offset;
+      uint32_t* Y_r = X_r + t;
+      const uint32_t* X_op = operand + offset;
+      const uint32_t* Y_op = X_op + t;
+      HEXL_LOOP_UNROLL_4
+      for (size_t j = 0; j < t; ++j) {
+        uint32_t tx = ReduceTwice(X_op[j]);
+        uint32_t T = MultiplyModLazy32(Y_op[j], W[i], W_precon[i], m_modulus);
+        X_r[j] = tx + T;
+        Y_r[j] = tx + m_twice_modulus - T;
+      }
+    }
+  }
+
+  // Inputs in [0, 2q); outputs in [0, 2q)
+  void InvStage(uint32_t* result, const uint32_t* operand, size_t t, size_t m,
+                const uint32_t* W, const uint32_t* W_precon) const {
+    for (size_t i = 0; i < m; ++i) {
+      size_t offset = 2 * i * t;
+      uint32_t* X_r = result + offset;
+      uint32_t* Y_r = X_r + t;
+      const uint32_t* X_op = operand + offset;
+      const uint32_t* Y_op = X_op + t;
+      HEXL_LOOP_UNROLL_4
+      for (size_t j = 0; j < t; ++j) {
+        uint32_t x = X_op[j];
+        uint32_t y = Y_op[j];
+        X_r[j] = ReduceTwice(x + y);
+        Y_r[j] = MultiplyModLazy32(x + m_twice_modulus - y, W[i], W_precon[i],
+                                   m_modulus);
+      }
+    }
+  }
+
+  void InvFinalStage(uint32_t* result, const uint32_t* operand, size_t half_n,
+                     uint32_t inv_n, uint32_t inv_n_precon, uint32_t inv_n_w,
+                     uint32_t inv_n_w_precon,
+                     uint64_t output_mod_factor) const {
+    for (size_t j = 0; j < half_n; ++j) {
+      uint32_t x = operand[j];
+      uint32_t y = operand[j + half_n];
+      uint32_t tx = MultiplyModLazy32(x + y, inv_n, inv_n_precon, m_modulus);
+      uint32_t ty = MultiplyModLazy32(x + m_twice_modulus - y, inv_n_w,
+                                      inv_n_w_precon, m_modulus);
+      if (output_mod_factor == 1) {
+        tx = ReduceOnce(tx);
+        ty = ReduceOnce(ty);
+      }
+      result[j] = tx;
+      result[j + half_n] = ty;
+    }
+  }
+
+  // Reduces from [0, 4q) to [0, q)
+  void ReduceMod(uint32_t* data, size_t n) const {
+    for (size_t i = 0; i < n; ++i) {
+      data[i] = ReduceOnce(ReduceTwice(data[i]));
+    }
+  }
+
+ private:
+  uint32_t ReduceOnce(uint32_t x) const {
+    return (x >= m_modulus) ? x - m_modulus : x;
+  }
+
+  uint32_t ReduceTwice(uint32_t x) const {
+    return (x >= m_twice_modulus) ? x - m_twice_modulus : x;
+  }
+
+  uint32_t m_modulus;
+  uint32_t m_twice_modulus;
+};
+
+}  // namespace
+
+void ForwardTransformToBitReverse32(uint32_t* result, const uint32_t* operand,
+                                    uint64_t n, uint32_t modulus,
+                                    const uint32_t* root_of_unity_powers,
+                                    const uint32_t* precon_root_of_unity_powers,
+                                    uint64_t output_mod_factor) {
+  ForwardTransform32(Native32Kernel(modulus), result, operand, n,
+                     root_of_unity_powers, precon_root_of_unity_powers,
+                     output_mod_factor);
+}
+
+void InverseTransformFromBitReverse32(
+    uint32_t* result, const uint32_t* operand, uint64_t n, uint32_t modulus,
+    const uint32_t* inv_root_of_unity_powers,
+    const uint32_t* precon_inv_root_of_unity_powers,
+    uint64_t output_mod_factor) {
+  InverseTransform32(Native32Kernel(modulus), result, operand, n,
+                     inv_root_of_unity_powers, precon_inv_root_of_unity_powers,
+                     output_mod_factor);
+}
+
+NTT32::NTT32(uint64_t degree, uint32_t q, uint32_t root_of_unity,
+             std::shared_ptr<AllocatorBase> alloc_ptr)
+    : m_degree(degree),
+      m_q(q),
+      m_w(root_of_unity),
+      m_alloc(alloc_ptr),
+      m_aligned_alloc(AlignedAllocator<uint32_t, 64>(m_alloc)) {
+  HEXL_CHECK(CheckArguments(degree, q), "");
+  HEXL_CHECK(IsPrimitiveRoot(m_w, 2 * degree, q),
+             m_w << " is not a primitive 2*" << degree << "'th root of unity");
+
+  uint64_t degree_bits = Log2(m_degree);
+  uint32_t w_inv = static_cast<uint32_t>(InverseMod(m_w, m_q));
+
+  // Powers w^i at index ReverseBits(i); the inverse powers are reordered so
+  // that the roots of each stage are contiguous, as for the 64-bit NTT
+  AlignedVector64<uint32_t> bit_reversed_inv_powers(m_degree, 0,
+                                                    m_aligned_alloc);
+  m_root_of_unity_powers.resize(m_degree);
+  uint64_t w_power = 1;
+  uint64_t w_inv_power = 1;
+  for (uint64_t i = 0; i < m_degree; ++i) {
+    uint64_t index = ReverseBits(i, degree_bits);
+    m_root_of_unity_powers[index] = static_cast<uint32_t>(w_power);
+    bit_reversed_inv_powers[index] = static_cast<uint32_t>(w_inv_power);
+    w_power = MultiplyMod(w_power, m_w, m_q);
+    w_inv_power = MultiplyMod(w_inv_power, w_inv, m_q);
+  }
+
+  m_inv_root_of_unity_powers.resize(m_degree);
+  m_inv_root_of_unity_powers[0] = bit_reversed_inv_powers[0];
+  uint64_t idx = 1;
+  for (uint64_t m = (m_degree >> 1); m > 0; m >>= 1) {
+    for (uint64_t i = 0; i < m; i++) {
+      m_inv_root_of_unity_powers[idx++] = bit_reversed_inv_powers[m + i];
+    }
+  }
+
+  m_precon_root_of_unity_powers.resize(m_degree);
+  m_precon_inv_root_of_unity_powers.resize(m_degree);
+  for (uint64_t i = 0; i < m_degree; ++i) {
+    m_precon_root_of_unity_powers[i] =
+        Precon32(m_root_of_unity_powers[i], m_q);
+    m_precon_inv_root_of_unity_powers[i] =
+        Precon32(m_inv_root_of_unity_powers[i], m_q);
+  }
+}
+
+NTT32::NTT32(uint64_t degree, uint32_t q,
+             std::shared_ptr<AllocatorBase> alloc_ptr)
+    : NTT32(degree, q,
+            static_cast<uint32_t>(MinimalPrimitiveRoot(2 * degree, q)),
+            alloc_ptr) {}
+
+bool NTT32::CheckArguments(uint64_t degree, uint64_t modulus) {
+  HEXL_UNUSED(degree);
+  HEXL_UNUSED(modulus);
+  HEXL_CHECK(IsPowerOfTwo(degree),
+             "degree " << degree << " is not a power of 2");
+  HEXL_CHECK(degree <= (1ULL << NTT::MaxDirectDegreeBits()),
+             "degree should be at most 2^" << NTT::MaxDirectDegreeBits()
+                                           << " got " << degree);
+  HEXL_CHECK(modulus < (1ULL << MaxModulusBits()),
+             "modulus should be less than 2^" << MaxModulusBits() << " got "
+                                              << modulus);
+  HEXL_CHECK(modulus % (2 * degree) == 1, "modulus mod 2n != 1");
+  HEXL_CHECK(IsPrime(modulus), "modulus is not prime");
+
+  return true;
+}
+
+void NTT32::ComputeForward(uint32_t* result, const uint32_t* operand,
+                           uint64_t input_mod_factor,
+                           uint64_t output_mod_factor) const {
+  HEXL_CHECK(result != nullptr, "result == nullptr");
+  HEXL_CHECK(operand != nullptr, "operand == nullptr");
+  HEXL_CHECK(input_mod_factor == 1 || input_mod_factor == 2 ||
+                 input_mod_factor == 4,
+             "input_mod_factor must be 1, 2 or 4; got " << input_mod_factor);
+  HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 4,
+             "output_mod_factor must be 1 or 4; got " << output_mod_factor);
+  HEXL_CHECK_BOUNDS(operand, m_degree, m_q * input_mod_factor,
+                    "operand exceeds bound " << m_q * input_mod_factor);
+  HEXL_UNUSED(input_mod_factor);
+
+  const uint32_t* root_of_unity_powers = m_root_of_unity_powers.data();
+  const uint32_t* precon_root_of_unity_powers =
+      m_precon_root_of_unity_powers.data();
+
+#ifdef HEXL_HAS_AVX512DQ
+  if (has_avx512dq && m_degree >= 32) {
+    HEXL_VLOG(3, "Calling 32-bit AVX512 FwdNTT");
+    ForwardTransformToBitReverse32AVX512(
+        result, operand, m_degree, m_q, root_of_unity_powers,
+        precon_root_of_unity_powers, output_mod_factor);
+    return;
+  }
+#endif
+
+#ifdef HEXL_HAS_AVX256
+  if (has_avx2 && m_degree >= 16) {
+    HEXL_VLOG(3, "Calling 32-bit AVX2 FwdNTT");
+    ForwardTransformToBitReverse32AVX2(
+        result, operand, m_degree, m_q, root_of_unity_powers,
+        precon_root_of_unity_powers, output_mod_factor);
+    return;
+  }
+#endif
+
+  HEXL_VLOG(3, "Calling 32-bit native FwdNTT");
+  ForwardTransformToBitReverse32(result, operand, m_degree, m_q,
+                                 root_of_unity_powers,
+                                 precon_root_of_unity_powers,
+                                 output_mod_factor);
+}
+
+void NTT32::ComputeInverse(uint32_t* result, const uint32_t* operand,
+                           uint64_t input_mod_factor,
+                           uint64_t output_mod_factor) const {
+  HEXL_CHECK(result != nullptr, "result == nullptr");
+  HEXL_CHECK(operand != nullptr, "operand == nullptr");
+  HEXL_CHECK(input_mod_factor == 1 || input_mod_factor == 2,
+             "input_mod_factor must be 1 or 2; got " << input_mod_factor);
+  HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 2,
+             "output_mod_factor must be 1 or 2; got " << output_mod_factor);
+  HEXL_CHECK_BOUNDS(operand, m_degree, m_q * input_mod_factor,
+                    "operand exceeds bound " << m_q * input_mod_factor);
+  HEXL_UNUSED(input_mod_factor);
+
+  const uint32_t* inv_root_of_unity_powers = m_inv_root_of_unity_powers.data();
+  const uint32_t* precon_inv_root_of_unity_powers =
+      m_precon_inv_root_of_unity_powers.data();
+
+#ifdef HEXL_HAS_AVX512DQ
+  if (has_avx512dq && m_degree >= 32) {
+    HEXL_VLOG(3, "Calling 32-bit AVX512 InvNTT");
+    InverseTransformFromBitReverse32AVX512(
+        result, operand, m_degree, m_q, inv_root_of_unity_powers,
+        precon_inv_root_of_unity_powers, output_mod_factor);
+    return;
+  }
+#endif
+
+#ifdef HEXL_HAS_AVX256
+  if (has_avx2 && m_degree >= 16) {
+    HEXL_VLOG(3, "Calling 32-bit AVX2 InvNTT");
+    InverseTransformFromBitReverse32AVX2(
+        result, operand, m_degree, m_q, inv_root_of_unity_powers,
+        precon_inv_root_of_unity_powers, output_mod_factor);
+    return;
+  }
+#endif
+
+  HEXL_VLOG(3, "Calling 32-bit native InvNTT");
+  InverseTransformFromBitReverse32(result, operand, m_degree, m_q,
+                                   inv_root_of_unity_powers,
+                                   precon_inv_root_of_unity_powers,
+                                   output_mod_factor);
+}
+
+}  // namespace hexl
+}  // namespace intel
@@ -0,0 +1,87 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <immintrin.h>
+
+#include "hexl/ntt/ntt.hpp"
+#include "util/avx2-util.hpp"
+
+namespace intel {
+namespace hexl {
+
+#ifdef HEXL_HAS_AVX256
+
+// Given input: 0, 1, 2, 3, 4, 5, 6, 7
+// Returns
+// *out1 =  _mm256_set_epi64x(6, 2, 4, 0);
+// *out2 =  _mm256_set_epi64x(7, 3, 5, 1);
+// i.e. the X and Y operands of the butterflies with t = 1, where the order of
+// the butterflies is permuted by (0, 2, 1, 3).
+inline void LoadInterleavedT1(const uint64_t* arg, __m256i* out1,
+                              __m256i* out2) {
+  const __m256i* arg_256 = reinterpret_cast<const __m256i*>(arg);
+
+  // 0, 1, 2, 3
+  __m256i v1 = _mm256_loadu_si256(arg_256++);
+  // 4, 5, 6, 7
+  __m256i v2 = _mm256_loadu_si256(arg_256);
+
+  *out1 = _mm256_unpacklo_epi64(v1, v2);
+  *out2 = _mm256_unpackhi_epi64(v1, v2);
+}
+
+// Given inputs
+// @param arg1 = _mm256_set_epi64x(6, 2, 4, 0);
+// @param arg2 = _mm256_set_epi64x(7, 3, 5, 1);
+// Writes out = {0, 1, 2, 3, 4, 5, 6, 7}, i.e. the inverse of
+// LoadInterleavedT1
+inline void WriteInterleavedT1(__m256i arg1, __m256i arg2, __m256i* out) {
+  _mm256_storeu_si256(out++, _mm256_unpacklo_epi64(arg1, arg2));
+  _mm256_storeu_si256(out, _mm256_unpackhi_epi64(arg1, arg2));
+}
+
+// Given input: 0, 1, 2, 3, 4, 5, 6, 7
+// Returns
+// *out1 =  _mm256_set_epi64x(5, 4, 1, 0);
+// *out2 =  _mm256_set_epi64x(7, 6, 3, 2);
+inline void LoadInterleavedT2(const uint64_t* arg, __m256i* out1,
+                              __m256i* out2) {
+  const __m256i* arg_256 = reinterpret_cast<const __m256i*>(arg);
+
+  __m256i v1 = _mm256_loadu_si256(arg_256++);
+  __m256i v2 = _mm256_loadu_si256(arg_256);
+
+  *out1 = _mm256_permute2x128_si256(v1, v2, 0x20);
+  *out2 = _mm256_permute2x128_si256(v1, v2, 0x31);
+}
+
+// Given inputs
+// @param arg1 = _mm256_set_epi64x(5, 4, 1, 0);
+// @param arg2 = _mm256_set_epi64x(7, 6, 3, 2);
+// Writes out = {0, 1, 2, 3, 4, 5, 6, 7}, i.e. the inverse of
+// LoadInterleavedT2
+inline void WriteInterleavedT2(__m256i arg1, __m256i arg2, __m256i* out) {
+  _mm256_storeu_si256(out++, _mm256_permute2x128_si256(arg1, arg2, 0x20));
+  _mm256_storeu_si256(out, _mm256_permute2x128_si256(arg1, arg2, 0x31));
+}
+
+// Returns _mm256_set_epi64x(arg[3], arg[1], arg[2], arg[0]), matching the
+// butterfly order of LoadInterleavedT1
+inline __m256i LoadWOpT1(const void* arg) {
+  __m256i v_W = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(arg));
+  return _mm256_permute4x64_epi64(v_W, 0xd8);
+}
+
+// Returns _mm256_set_epi64x(arg[1], arg[1], arg[0], arg[0])
+inline __m256i LoadWOpT2(const void* arg) {
+  __m128i v_W_128 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(arg));
+  __m256i v_W = _mm256_broadcastsi128_si256(v_W_128);
+  return _mm256_permute4x64_epi64(v_W, 0x50);
+}
+
+#endif  // HEXL_HAS_AVX256
+
+}  // namespace hexl
+}  // namespace intel
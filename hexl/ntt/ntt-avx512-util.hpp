@@ -10,6 +10,7 @@
 
 #include "hexl/ntt/ntt.hpp"
 #include "hexl/number-theory/number-theory.hpp"
+#include "hexl/util/check.hpp"
 #include "util/avx512-util.hpp"
 
 namespace intel {
@@ -212,6 +213,72 @@ inline __m512i LoadWOpT4(const void* arg) {
   return v_W;
 }
 
+// Lane permutations of a stage with t in {1, 2, 4}, in which each 16
+// elements hold 8 / t groups of butterflies. Load gathers the X and Y operands
+// of the butterflies of 16 elements into separate vectors, and Store is its
+// inverse. LoadRoots returns the 8 / t roots of the groups, each repeated for
+// the t butterflies of its group.
+class SmallStageLayout {
+ public:
+  explicit SmallStageLayout(size_t t) : m_groups(8 / t) {
+    HEXL_CHECK(t == 1 || t == 2 || t == 4, "Invalid t " << t);
+    if (t == 4) {
+      m_x_idx = _mm512_set_epi64(11, 10, 9, 8, 3, 2, 1, 0);
+      m_y_idx = _mm512_set_epi64(15, 14, 13, 12, 7, 6, 5, 4);
+      m_lo_idx = m_x_idx;
+      m_hi_idx = m_y_idx;
+      m_w_idx = _mm512_set_epi64(1, 1, 1, 1, 0, 0, 0, 0);
+      m_w_mask = 0x3;
+    } else if (t == 2) {
+      m_x_idx = _mm512_set_epi64(13, 12, 9, 8, 5, 4, 1, 0);
+      m_y_idx = _mm512_set_epi64(15, 14, 11, 10, 7, 6, 3, 2);
+      m_lo_idx = _mm512_set_epi64(11, 10, 3, 2, 9, 8, 1, 0);
+      m_hi_idx = _mm512_set_epi64(15, 14, 7, 6, 13, 12, 5, 4);
+      m_w_idx = _mm512_set_epi64(3, 3, 2, 2, 1, 1, 0, 0);
+      m_w_mask = 0xF;
+    } else {
+      m_x_idx = _mm512_set_epi64(14, 12, 10, 8, 6, 4, 2, 0);
+      m_y_idx = _mm512_set_epi64(15, 13, 11, 9, 7, 5, 3, 1);
+      m_lo_idx = _mm512_set_epi64(11, 3, 10, 2, 9, 1, 8, 0);
+      m_hi_idx = _mm512_set_epi64(15, 7, 14, 6, 13, 5, 12, 4);
+      m_w_idx = _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0);
+      m_w_mask = 0xFF;
+    }
+  }
+
+  // Number of groups of butterflies in 16 elements
+  size_t GroupsPerChunk() const { return m_groups; }
+
+  void Load(const uint64_t* operand, __m512i* X, __m512i* Y) const {
+    const __m512i* v_op = reinterpret_cast<const __m512i*>(operand);
+    __m512i v0 = _mm512_loadu_si512(v_op);
+    __m512i v1 = _mm512_loadu_si512(v_op + 1);
+    *X = _mm512_permutex2var_epi64(v0, m_x_idx, v1);
+    *Y = _mm512_permutex2var_epi64(v0, m_y_idx, v1);
+  }
+
+  void Store(uint64_t* result, __m512i X, __m512i Y) const {
+    __m512i* v_result = reinterpret_cast<__m512i*>(result);
+    _mm512_storeu_si512(v_result, _mm512_permutex2var_epi64(X, m_lo_idx, Y));
+    _mm512_storeu_si512(v_result + 1,
+                        _mm512_permutex2var_epi64(X, m_hi_idx, Y));
+  }
+
+  __m512i LoadRoots(const uint64_t* W) const {
+    return _mm512_permutexvar_epi64(m_w_idx,
+                                    _mm512_maskz_loadu_epi64(m_w_mask, W));
+  }
+
+ private:
+  size_t m_groups;
+  __m512i m_x_idx;
+  __m512i m_y_idx;
+  __m512i m_lo_idx;
+  __m512i m_hi_idx;
+  __m512i m_w_idx;
+  __mmask8 m_w_mask;
+};
+
 #endif  // HEXL_HAS_AVX512DQ
 
 }  // namespace hexl
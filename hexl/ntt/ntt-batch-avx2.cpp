@@ -0,0 +1,159 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include <immintrin.h>
+
+#include "hexl/logging/logging.hpp"
+#include "hexl/number-theory/number-theory.hpp"
+#include "ntt/ntt-batch-internal.hpp"
+#include "util/avx2-util.hpp"
+
+namespace intel {
+namespace hexl {
+
+#ifdef HEXL_HAS_AVX256
+
+namespace {
+
+// Butterflies with 64-bit Shoup multiplication on 4 polynomials per vector
+class AVX2BatchKernel {
+ public:
+  explicit AVX2BatchKernel(uint64_t modulus)
+      : m_native(modulus),
+        m_v_modulus(_mm256_set1_epi64x(static_cast<int64_t>(modulus))),
+        m_v_twice_modulus(
+            _mm256_set1_epi64x(static_cast<int64_t>(2 * modulus))) {}
+
+  uint64_t Modulus() const { return m_native.Modulus(); }
+
+  // Inputs in [0, 4q); outputs in [0, 4q)
+  void FwdRows(uint64_t* X, uint64_t* Y, size_t count, uint64_t W,
+               uint64_t W_precon) const {
+    __m256i v_W = _mm256_set1_epi64x(static_cast<int64_t>(W));
+    __m256i v_W_precon = _mm256_set1_epi64x(static_cast<int64_t>(W_precon));
+    size_t j = 0;
+    HEXL_LOOP_UNROLL_4
+    for (; j + 4 <= count; j += 4) {
+      __m256i v_X = Load(X + j);
+      __m256i v_Y = Load(Y + j);
+      v_X = _mm256_hexl_small_mod_epu64(v_X, m_v_twice_modulus);
+      __m256i T = MultiplyLazy(v_Y, v_W, v_W_precon);
+      __m256i twice_mod_minus_T = _mm256_sub_epi64(m_v_twice_modulus, T);
+      Store(X + j, _mm256_add_epi64(v_X, T));
+      Store(Y + j, _mm256_add_epi64(v_X, twice_mod_minus_T));
+    }
+    m_native.FwdRows(X + j, Y + j, count - j, W, W_precon);
+  }
+
+  // Inputs in [0, 2q); outputs in [0, 2q)
+  void InvRows(uint64_t* X, uint64_t* Y, size_t count, uint64_t W,
+               uint64_t W_precon) const {
+    __m256i v_W = _mm256_set1_epi64x(static_cast<int64_t>(W));
+    __m256i v_W_precon = _mm256_set1_epi64x(static_cast<int64_t>(W_precon));
+    size_t j = 0;
+    HEXL_LOOP_UNROLL_4
+    for (; j + 4 <= count; j += 4) {
+      __m256i v_X = Load(X + j);
+      __m256i v_Y = Load(Y + j);
+      __m256i tx = _mm256_add_epi64(v_X, v_Y);
+      tx = _mm256_hexl_small_mod_epu64(tx, m_v_twice_modulus);
+      __m256i ty =
+          _mm256_sub_epi64(_mm256_add_epi64(v_X, m_v_twice_modulus), v_Y);
+      Store(X + j, tx);
+      Store(Y + j, MultiplyLazy(ty, v_W, v_W_precon));
+    }
+    m_native.InvRows(X + j, Y + j, count - j, W, W_precon);
+  }
+
+  void InvFinalRows(uint64_t* X, uint64_t* Y, size_t count, uint64_t inv_n,
+                    uint64_t inv_n_precon, uint64_t inv_n_w,
+                    uint64_t inv_n_w_precon,
+                    uint64_t output_mod_factor) const {
+    __m256i v_inv_n = _mm256_set1_epi64x(static_cast<int64_t>(inv_n));
+    __m256i v_inv_n_precon =
+        _mm256_set1_epi64x(static_cast<int64_t>(inv_n_precon));
+    __m256i v_inv_n_w = _mm256_set1_epi64x(static_cast<int64_t>(inv_n_w));
+    __m256i v_inv_n_w_precon =
+        _mm256_set1_epi64x(static_cast<int64_t>(inv_n_w_precon));
+    size_t j = 0;
+    HEXL_LOOP_UNROLL_4
+    for (; j + 4 <= count; j += 4) {
+      __m256i v_X = Load(X + j);
+      __m256i v_Y = Load(Y + j);
+      __m256i tx = MultiplyLazy(_mm256_add_epi64(v_X, v_Y), v_inv_n,
+                                v_inv_n_precon);
+      __m256i ty = MultiplyLazy(
+          _mm256_sub_epi64(_mm256_add_epi64(v_X, m_v_twice_modulus), v_Y),
+          v_inv_n_w, v_inv_n_w_precon);
+      if (output_mod_factor == 1) {
+        tx = _mm256_hexl_small_mod_epu64(tx, m_v_modulus);
+        ty = _mm256_hexl_small_mod_epu64(ty, m_v_modulus);
+      }
+      Store(X + j, tx);
+      Store(Y + j, ty);
+    }
+    m_native.InvFinalRows(X + j, Y + j, count - j, inv_n, inv_n_precon,
+                          inv_n_w, inv_n_w_precon, output_mod_factor);
+  }
+
+  // Reduces from [0, 4q) to [0, q)
+  void ReduceRows(uint64_t* data, size_t count) const {
+    size_t j = 0;
+    for (; j + 4 <= count; j += 4) {
+      __m256i v_X = Load(data + j);
+      v_X = _mm256_hexl_small_mod_epu64(v_X, m_v_twice_modulus);
+      v_X = _mm256_hexl_small_mod_epu64(v_X, m_v_modulus);
+      Store(data + j, v_X);
+    }
+    m_native.ReduceRows(data + j, count - j);
+  }
+
+ private:
+  static __m256i Load(const uint64_t* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  }
+
+  static void Store(uint64_t* p, __m256i x) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), x);
+  }
+
+  // Returns x * w mod q in [0, 2q) for any 64-bit x
+  __m256i MultiplyLazy(__m256i x, __m256i w, __m256i w_precon) const {
+    __m256i Q = _mm256_hexl_mulhi_approx_epi<64>(w_precon, x);
+    __m256i W_x = _mm256_hexl_mullo_epi<64>(w, x);
+    // The approximate Q yields T in [0, 4q); reduce T to [0, 2q)
+    __m256i T =
+        _mm256_sub_epi64(W_x, _mm256_hexl_mullo_epi<64>(Q, m_v_modulus));
+    return _mm256_hexl_small_mod_epu64(T, m_v_twice_modulus);
+  }
+
+  NativeBatchKernel m_native;
+  __m256i m_v_modulus;
+  __m256i m_v_twice_modulus;
+};
+
+}  // namespace
+
+void ForwardTransformToBitReverseBatchAVX2(
+    uint64_t* result, const uint64_t* operand, uint64_t n, size_t num_polys,
+    uint64_t modulus, const uint64_t* root_of_unity_powers,
+    const uint64_t* precon_root_of_unity_powers, uint64_t output_mod_factor) {
+  ForwardTransformBatch(AVX2BatchKernel(modulus), result, operand, n,
+                        num_polys, root_of_unity_powers,
+                        precon_root_of_unity_powers, output_mod_factor);
+}
+
+void InverseTransformFromBitReverseBatchAVX2(
+    uint64_t* result, const uint64_t* operand, uint64_t n, size_t num_polys,
+    uint64_t modulus, const uint64_t* inv_root_of_unity_powers,
+    const uint64_t* precon_inv_root_of_unity_powers,
+    uint64_t output_mod_factor) {
+  InverseTransformBatch(AVX2BatchKernel(modulus), result, operand, n,
+                        num_polys, inv_root_of_unity_powers,
+                        precon_inv_root_of_unity_powers, output_mod_factor);
+}
+
+#endif  // HEXL_HAS_AVX256
+
+}  // namespace hexl
+}  // namespace intel
@@ -0,0 +1,151 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include <immintrin.h>
+
+#include "hexl/logging/logging.hpp"
+#include "hexl/number-theory/number-theory.hpp"
+#include "ntt/ntt-batch-internal.hpp"
+#include "util/avx512-util.hpp"
+
+namespace intel {
+namespace hexl {
+
+#ifdef HEXL_HAS_AVX512DQ
+
+namespace {
+
+// Butterflies with 64-bit Shoup multiplication on 8 polynomials per vector
+class AVX512BatchKernel {
+ public:
+  explicit AVX512BatchKernel(uint64_t modulus)
+      : m_native(modulus),
+        m_v_modulus(_mm512_set1_epi64(static_cast<int64_t>(modulus))),
+        m_v_neg_modulus(_mm512_set1_epi64(-static_cast<int64_t>(modulus))),
+        m_v_twice_modulus(
+            _mm512_set1_epi64(static_cast<int64_t>(2 * modulus))) {}
+
+  uint64_t Modulus() const { return m_native.Modulus(); }
+
+  // Inputs in [0, 4q); outputs in [0, 4q)
+  void FwdRows(uint64_t* X, uint64_t* Y, size_t count, uint64_t W,
+               uint64_t W_precon) const {
+    __m512i v_W = _mm512_set1_epi64(static_cast<int64_t>(W));
+    __m512i v_W_precon = _mm512_set1_epi64(static_cast<int64_t>(W_precon));
+    size_t j = 0;
+    HEXL_LOOP_UNROLL_4
+    for (; j + 8 <= count; j += 8) {
+      __m512i v_X = _mm512_loadu_si512(X + j);
+      __m512i v_Y = _mm512_loadu_si512(Y + j);
+      v_X = _mm512_hexl_small_mod_epu64(v_X, m_v_twice_modulus);
+      __m512i T = MultiplyLazy(v_Y, v_W, v_W_precon);
+      __m512i twice_mod_minus_T = _mm512_sub_epi64(m_v_twice_modulus, T);
+      _mm512_storeu_si512(X + j, _mm512_add_epi64(v_X, T));
+      _mm512_storeu_si512(Y + j, _mm512_add_epi64(v_X, twice_mod_minus_T));
+    }
+    m_native.FwdRows(X + j, Y + j, count - j, W, W_precon);
+  }
+
+  // Inputs in [0, 2q); outputs in [0, 2q)
+  void InvRows(uint64_t* X, uint64_t* Y, size_t count, uint64_t W,
+               uint64_t W_precon) const {
+    __m512i v_W = _mm512_set1_epi64(static_cast<int64_t>(W));
+    __m512i v_W_precon = _mm512_set1_epi64(static_cast<int64_t>(W_precon));
+    size_t j = 0;
+    HEXL_LOOP_UNROLL_4
+    for (; j + 8 <= count; j += 8) {
+      __m512i v_X = _mm512_loadu_si512(X + j);
+      __m512i v_Y = _mm512_loadu_si512(Y + j);
+      __m512i tx = _mm512_hexl_small_add_mod_epi64(v_X, v_Y, m_v_twice_modulus);
+      __m512i ty =
+          _mm512_sub_epi64(_mm512_add_epi64(v_X, m_v_twice_modulus), v_Y);
+      _mm512_storeu_si512(X + j, tx);
+      _mm512_storeu_si512(Y + j, MultiplyLazy(ty, v_W, v_W_precon));
+    }
+    m_native.InvRows(X + j, Y + j, count - j, W, W_precon);
+  }
+
+  void InvFinalRows(uint64_t* X, uint64_t* Y, size_t count, uint64_t inv_n,
+                    uint64_t inv_n_precon, uint64_t inv_n_w,
+                    uint64_t inv_n_w_precon,
+                    uint64_t output_mod_factor) const {
+    __m512i v_inv_n = _mm512_set1_epi64(static_cast<int64_t>(inv_n));
+    __m512i v_inv_n_precon =
+        _mm512_set1_epi64(static_cast<int64_t>(inv_n_precon));
+    __m512i v_inv_n_w = _mm512_set1_epi64(static_cast<int64_t>(inv_n_w));
+    __m512i v_inv_n_w_precon =
+        _mm512_set1_epi64(static_cast<int64_t>(inv_n_w_precon));
+    size_t j = 0;
+    HEXL_LOOP_UNROLL_4
+    for (; j + 8 <= count; j += 8) {
+      __m512i v_X = _mm512_loadu_si512(X + j);
+      __m512i v_Y = _mm512_loadu_si512(Y + j);
+      __m512i tx = MultiplyLazy(_mm512_add_epi64(v_X, v_Y), v_inv_n,
+                                v_inv_n_precon);
+      __m512i ty = MultiplyLazy(
+          _mm512_sub_epi64(_mm512_add_epi64(v_X, m_v_twice_modulus), v_Y),
+          v_inv_n_w, v_inv_n_w_precon);
+      if (output_mod_factor == 1) {
+        tx = _mm512_hexl_small_mod_epu64(tx, m_v_modulus);
+        ty = _mm512_hexl_small_mod_epu64(ty, m_v_modulus);
+      }
+      _mm512_storeu_si512(X + j, tx);
+      _mm512_storeu_si512(Y + j, ty);
+    }
+    m_native.InvFinalRows(X + j, Y + j, count - j, inv_n, inv_n_precon,
+                          inv_n_w, inv_n_w_precon, output_mod_factor);
+  }
+
+  // Reduces from [0, 4q) to [0, q)
+  void ReduceRows(uint64_t* data, size_t count) const {
+    size_t j = 0;
+    for (; j + 8 <= count; j += 8) {
+      __m512i v_X = _mm512_loadu_si512(data + j);
+      v_X = _mm512_hexl_small_mod_epu64(v_X, m_v_twice_modulus);
+      v_X = _mm512_hexl_small_mod_epu64(v_X, m_v_modulus);
+      _mm512_storeu_si512(data + j, v_X);
+    }
+    m_native.ReduceRows(data + j, count - j);
+  }
+
+ private:
+  // Returns x * w mod q in [0, 2q) for any 64-bit x
+  __m512i MultiplyLazy(__m512i x, __m512i w, __m512i w_precon) const {
+    __m512i Q = _mm512_hexl_mulhi_approx_epi<64>(w_precon, x);
+    __m512i W_x = _mm512_hexl_mullo_epi<64>(w, x);
+    // The approximate Q yields T in [0, 4q); reduce T to [0, 2q)
+    __m512i T = _mm512_hexl_mullo_add_lo_epi<64>(W_x, Q, m_v_neg_modulus);
+    return _mm512_hexl_small_mod_epu64(T, m_v_twice_modulus);
+  }
+
+  NativeBatchKernel m_native;
+  __m512i m_v_modulus;
+  __m512i m_v_neg_modulus;
+  __m512i m_v_twice_modulus;
+};
+
+}  // namespace
+
+void ForwardTransformToBitReverseBatchAVX512(
+    uint64_t* result, const uint64_t* operand, uint64_t n, size_t num_polys,
+    uint64_t modulus, const uint64_t* root_of_unity_powers,
+    const uint64_t* precon_root_of_unity_powers, uint64_t output_mod_factor) {
+  ForwardTransformBatch(AVX512BatchKernel(modulus), result, operand, n,
+                        num_polys, root_of_unity_powers,
+                        precon_root_of_unity_powers, output_mod_factor);
+}
+
+void InverseTransformFromBitReverseBatchAVX512(
+    uint64_t* result, const uint64_t* operand, uint64_t n, size_t num_polys,
+    uint64_t modulus, const uint64_t* inv_root_of_unity_powers,
+    const uint64_t* precon_inv_root_of_unity_powers,
+    uint64_t output_mod_factor) {
+  InverseTransformBatch(AVX512BatchKernel(modulus), result, operand, n,
+                        num_polys, inv_root_of_unity_powers,
+                        precon_inv_root_of_unity_powers, output_mod_factor);
+}
+
+#endif  // HEXL_HAS_AVX512DQ
+
+}  // namespace hexl
+}  // namespace intel
@@ -0,0 +1,227 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdint.h>
+
+#include <cstring>
+
+#include "hexl/number-theory/number-theory.hpp"
+
+namespace intel {
+namespace hexl {
+
+// The batched transforms store num_polys polynomials coefficient-major, i.e.
+// coefficient i of polynomial p at index i * num_polys + p. All the
+// butterflies of a group of a stage then share one root of unity and form a
+// contiguous run of rows, which the kernels process with polynomial p in lane
+// p, independently of the degree.
+
+/// @brief Butterflies on contiguous rows of coefficients with 64-bit Shoup
+/// multiplication, one coefficient at a time. Also completes the rows of the
+/// vectorized kernels not divisible by their vector width.
+class NativeBatchKernel {
+ public:
+  explicit NativeBatchKernel(uint64_t modulus)
+      : m_modulus(modulus), m_twice_modulus(modulus << 1) {}
+
+  uint64_t Modulus() const { return m_modulus; }
+
+  /// @brief Applies the forward butterfly with root \p W to (X[j], Y[j]) for
+  /// j in [0, count). Inputs in [0, 4q); outputs in [0, 4q).
+  void FwdRows(uint64_t* X, uint64_t* Y, size_t count, uint64_t W,
+               uint64_t W_precon) const {
+    for (size_t j = 0; j < count; ++j) {
+      uint64_t tx = ReduceMod<2>(X[j], m_twice_modulus);
+      uint64_t T = MultiplyModLazy<64>(Y[j], W, W_precon, m_modulus);
+      X[j] = tx + T;
+      Y[j] = tx + m_twice_modulus - T;
+    }
+  }
+
+  /// @brief Applies the inverse butterfly with root \p W to (X[j], Y[j]) for
+  /// j in [0, count). Inputs in [0, 2q); outputs in [0, 2q).
+  void InvRows(uint64_t* X, uint64_t* Y, size_t count, uint64_t W,
+               uint64_t W_precon) const {
+    for (size_t j = 0; j < count; ++j) {
+      uint64_t tx = X[j] + Y[j];
+      uint64_t ty = X[j] + m_twice_modulus - Y[j];
+      X[j] = ReduceMod<2>(tx, m_twice_modulus);
+      Y[j] = MultiplyModLazy<64>(ty, W, W_precon, m_modulus);
+    }
+  }
+
+  /// @brief Applies the final inverse butterfly fused with the multiplication
+  /// by n^{-1}. Inputs in [0, 2q); outputs in [0, output_mod_factor * q).
+  void InvFinalRows(uint64_t* X, uint64_t* Y, size_t count, uint64_t inv_n,
+                    uint64_t inv_n_precon, uint64_t inv_n_w,
+                    uint64_t inv_n_w_precon,
+                    uint64_t output_mod_factor) const {
+    for (size_t j = 0; j < count; ++j) {
+      uint64_t tx = X[j] + Y[j];
+      uint64_t ty = X[j] + m_twice_modulus - Y[j];
+      tx = MultiplyModLazy<64>(tx, inv_n, inv_n_precon, m_modulus);
+      ty = MultiplyModLazy<64>(ty, inv_n_w, inv_n_w_precon, m_modulus);
+      if (output_mod_factor == 1) {
+        tx = ReduceMod<2>(tx, m_modulus);
+        ty = ReduceMod<2>(ty, m_modulus);
+      }
+      X[j] = tx;
+      Y[j] = ty;
+    }
+  }
+
+  /// @brief Reduces \p count values from [0, 4q) to [0, q)
+  void ReduceRows(uint64_t* data, size_t count) const {
+    for (size_t j = 0; j < count; ++j) {
+      data[j] = ReduceMod<2>(ReduceMod<2>(data[j], m_twice_modulus), m_modulus);
+    }
+  }
+
+ private:
+  uint64_t m_modulus;
+  uint64_t m_twice_modulus;
+};
+
+/// @brief Computes the forward NTTs of size \p n of \p num_polys
+/// coefficient-major polynomials with the butterflies of \p kernel. Assumes
+/// \p operand in [0, 4q) and returns \p result in [0, output_mod_factor * q),
+/// for output_mod_factor 1 or 4.
+/// @param[in] kernel Butterfly implementation, providing the FwdRows and
+/// ReduceRows of NativeBatchKernel
+/// @param[out] result Output data. May alias \p operand.
+/// @param[in] operand Input data
+/// @param[in] n Size of the transforms
+/// @param[in] num_polys Number of polynomials
+/// @param[in] root_of_unity_powers Powers of the 2n'th root of unity in
+/// bit-reversed order, in the layout of NTT::GetRootOfUnityPowers()
+/// @param[in] precon_root_of_unity_powers Pre-conditioned \p
+/// root_of_unity_powers for 64-bit Shoup multiplication
+/// @param[in] output_mod_factor Must be 1 or 4
+template <typename Kernel>
+void ForwardTransformBatch(const Kernel& kernel, uint64_t* result,
+                           const uint64_t* operand, uint64_t n,
+                           size_t num_polys,
+                           const uint64_t* root_of_unity_powers,
+                           const uint64_t* precon_root_of_unity_powers,
+                           uint64_t output_mod_factor) {
+  if (result != operand) {
+    std::memcpy(result, operand, n * num_polys * sizeof(uint64_t));
+  }
+  for (uint64_t m = 1, t = n >> 1; m < n; m <<= 1, t >>= 1) {
+    const size_t rows = t * num_polys;
+    for (size_t i = 0; i < m; ++i) {
+      uint64_t* X = result + 2 * i * rows;
+      kernel.FwdRows(X, X + rows, rows, root_of_unity_powers[m + i],
+                     precon_root_of_unity_powers[m + i]);
+    }
+  }
+  if (output_mod_factor == 1) {
+    kernel.ReduceRows(result, n * num_polys);
+  }
+}
+
+/// @brief Computes the inverse NTTs of size \p n of \p num_polys
+/// coefficient-major polynomials with the butterflies of \p kernel. Assumes
+/// \p operand in [0, 2q) and returns \p result in [0, output_mod_factor * q),
+/// for output_mod_factor 1 or 2.
+/// @param[in] kernel Butterfly implementation, providing the InvRows,
+/// InvFinalRows and ReduceRows of NativeBatchKernel
+/// @param[out] result Output data. May alias \p operand.
+/// @param[in] operand Input data
+/// @param[in] n Size of the transforms
+/// @param[in] num_polys Number of polynomials
+/// @param[in] inv_root_of_unity_powers Inverse powers of the 2n'th root of
+/// unity, in the layout of NTT::GetInvRootOfUnityPowers()
+/// @param[in] precon_inv_root_of_unity_powers Pre-conditioned \p
+/// inv_root_of_unity_powers for 64-bit Shoup multiplication
+/// @param[in] output_mod_factor Must be 1 or 2
+template <typename Kernel>
+void InverseTransformBatch(const Kernel& kernel, uint64_t* result,
+                           const uint64_t* operand, uint64_t n,
+                           size_t num_polys,
+                           const uint64_t* inv_root_of_unity_powers,
+                           const uint64_t* precon_inv_root_of_unity_powers,
+                           uint64_t output_mod_factor) {
+  if (result != operand) {
+    std::memcpy(result, operand, n * num_polys * sizeof(uint64_t));
+  }
+  if (n == 1) {
+    if (output_mod_factor == 1) {
+      kernel.ReduceRows(result, num_polys);
+    }
+    return;
+  }
+
+  uint64_t root_index = 1;
+  for (uint64_t m = n >> 1, t = 1; m > 1; m >>= 1, t <<= 1) {
+    const size_t rows = t * num_polys;
+    for (size_t i = 0; i < m; ++i) {
+      uint64_t* X = result + 2 * i * rows;
+      kernel.InvRows(X, X + rows, rows,
+                     inv_root_of_unity_powers[root_index + i],
+                     precon_inv_root_of_unity_powers[root_index + i]);
+    }
+    root_index += m;
+  }
+
+  const uint64_t modulus = kernel.Modulus();
+  const uint64_t inv_n = InverseMod(n, modulus);
+  const uint64_t inv_n_w =
+      MultiplyMod(inv_n, inv_root_of_unity_powers[n - 1], modulus);
+  const size_t half_rows = (n >> 1) * num_polys;
+  kernel.InvFinalRows(result, result + half_rows, half_rows, inv_n,
+                      MultiplyFactor(inv_n, 64, modulus).BarrettFactor(),
+                      inv_n_w,
+                      MultiplyFactor(inv_n_w, 64, modulus).BarrettFactor(),
+                      output_mod_factor);
+}
+
+/// @brief Native batched forward NTT. See ForwardTransformBatch for the
+/// parameters.
+void ForwardTransformToBitReverseBatch(
+    uint64_t* result, const uint64_t* operand, uint64_t n, size_t num_polys,
+    uint64_t modulus, const uint64_t* root_of_unity_powers,
+    const uint64_t* precon_root_of_unity_powers, uint64_t output_mod_factor);
+
+/// @brief Native batched inverse NTT. See InverseTransformBatch for the
+/// parameters.
+void InverseTransformFromBitReverseBatch(
+    uint64_t* result, const uint64_t* operand, uint64_t n, size_t num_polys,
+    uint64_t modulus, const uint64_t* inv_root_of_unity_powers,
+    const uint64_t* precon_inv_root_of_unity_powers,
+    uint64_t output_mod_factor);
+
+#ifdef HEXL_HAS_AVX256
+/// @brief AVX2 batched forward NTT, on 4 polynomials per vector
+void ForwardTransformToBitReverseBatchAVX2(
+    uint64_t* result, const uint64_t* operand, uint64_t n, size_t num_polys,
+    uint64_t modulus, const uint64_t* root_of_unity_powers,
+    const uint64_t* precon_root_of_unity_powers, uint64_t output_mod_factor);
+
+/// @brief AVX2 batched inverse NTT, on 4 polynomials per vector
+void InverseTransformFromBitReverseBatchAVX2(
+    uint64_t* result, const uint64_t* operand, uint64_t n, size_t num_polys,
+    uint64_t modulus, const uint64_t* inv_root_of_unity_powers,
+    const uint64_t* precon_inv_root_of_unity_powers,
+    uint64_t output_mod_factor);
+#endif
+
+#ifdef HEXL_HAS_AVX512DQ
+/// @brief AVX512 batched forward NTT, on 8 polynomials per vector
+void ForwardTransformToBitReverseBatchAVX512(
+    uint64_t* result, const uint64_t* operand, uint64_t n, size_t num_polys,
+    uint64_t modulus, const uint64_t* root_of_unity_powers,
+    const uint64_t* precon_root_of_unity_powers, uint64_t output_mod_factor);
+
+/// @brief AVX512 batched inverse NTT, on 8 polynomials per vector
+void InverseTransformFromBitReverseBatchAVX512(
+    uint64_t* result, const uint64_t* operand, uint64_t n, size_t num_polys,
+    uint64_t modulus, const uint64_t* inv_root_of_unity_powers,
+    const uint64_t* precon_inv_root_of_unity_powers,
+    uint64_t output_mod_factor);
+#endif
+
+}  // namespace hexl
+}  // namespace intel
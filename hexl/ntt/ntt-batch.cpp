@@ -0,0 +1,166 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "hexl/logging/logging.hpp"
+#include "hexl/ntt/ntt.hpp"
+#include "hexl/number-theory/number-theory.hpp"
+#include "hexl/util/aligned-allocator.hpp"
+#include "hexl/util/check.hpp"
+#include "ntt/ntt-batch-internal.hpp"
+#include "util/cpu-features.hpp"
+#include "util/util-internal.hpp"
+
+namespace intel {
+namespace hexl {
+
+void ForwardTransformToBitReverseBatch(
+    uint64_t* result, const uint64_t* operand, uint64_t n, size_t num_polys,
+    uint64_t modulus, const uint64_t* root_of_unity_powers,
+    const uint64_t* precon_root_of_unity_powers, uint64_t output_mod_factor) {
+  ForwardTransformBatch(NativeBatchKernel(modulus), result, operand, n,
+                        num_polys, root_of_unity_powers,
+                        precon_root_of_unity_powers, output_mod_factor);
+}
+
+void InverseTransformFromBitReverseBatch(
+    uint64_t* result, const uint64_t* operand, uint64_t n, size_t num_polys,
+    uint64_t modulus, const uint64_t* inv_root_of_unity_powers,
+    const uint64_t* precon_inv_root_of_unity_powers,
+    uint64_t output_mod_factor) {
+  InverseTransformBatch(NativeBatchKernel(modulus), result, operand, n,
+                        num_polys, inv_root_of_unity_powers,
+                        precon_inv_root_of_unity_powers, output_mod_factor);
+}
+
+bool NTT::UsesBatchKernels() const {
+  // The batched kernels use the lazy Harvey butterflies on the tables of the
+  // direct transforms
+  return !m_four_step && m_q < s_max_lazy_modulus;
+}
+
+void NTT::ComputeForwardBatch(uint64_t* result, const uint64_t* operand,
+                              size_t num_polys, uint64_t input_mod_factor,
+                              uint64_t output_mod_factor) {
+  HEXL_CHECK(result != nullptr, "result == nullptr");
+  HEXL_CHECK(operand != nullptr, "operand == nullptr");
+  HEXL_CHECK(
+      input_mod_factor == 1 || input_mod_factor == 2 || input_mod_factor == 4,
+      "input_mod_factor must be 1, 2 or 4; got " << input_mod_factor);
+  HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 4,
+             "output_mod_factor must be 1 or 4; got " << output_mod_factor);
+  HEXL_CHECK_BOUNDS(operand, m_degree * num_polys,
+                    ModFactorBound(m_q, input_mod_factor),
+                    "value in operand exceeds bound "
+                        << ModFactorBound(m_q, input_mod_factor));
+
+  if (!UsesBatchKernels()) {
+    HEXL_VLOG(3, "Calling FwdNTT on each polynomial of the batch");
+    AlignedVector64<uint64_t> poly(m_degree, 0, m_aligned_alloc);
+    for (size_t p = 0; p < num_polys; ++p) {
+      for (size_t i = 0; i < m_degree; ++i) {
+        poly[i] = operand[i * num_polys + p];
+      }
+      ComputeForward(poly.data(), poly.data(), input_mod_factor,
+                     output_mod_factor);
+      for (size_t i = 0; i < m_degree; ++i) {
+        result[i * num_polys + p] = poly[i];
+      }
+    }
+    return;
+  }
+
+  const uint64_t* root_of_unity_powers = GetTableData(Table::RootOfUnityPowers);
+  const uint64_t* precon_root_of_unity_powers =
+      GetTableData(Table::Precon64RootOfUnityPowers);
+
+#ifdef HEXL_HAS_AVX512DQ
+  if (has_avx512dq && num_polys >= 8) {
+    HEXL_VLOG(3, "Calling AVX512 batched FwdNTT");
+    ForwardTransformToBitReverseBatchAVX512(
+        result, operand, m_degree, num_polys, m_q, root_of_unity_powers,
+        precon_root_of_unity_powers, output_mod_factor);
+    return;
+  }
+#endif
+
+#ifdef HEXL_HAS_AVX256
+  if (has_avx2 && num_polys >= 4) {
+    HEXL_VLOG(3, "Calling AVX2 batched FwdNTT");
+    ForwardTransformToBitReverseBatchAVX2(
+        result, operand, m_degree, num_polys, m_q, root_of_unity_powers,
+        precon_root_of_unity_powers, output_mod_factor);
+    return;
+  }
+#endif
+
+  HEXL_VLOG(3, "Calling native batched FwdNTT");
+  ForwardTransformToBitReverseBatch(result, operand, m_degree, num_polys, m_q,
+                                    root_of_unity_powers,
+                                    precon_root_of_unity_powers,
+                                    output_mod_factor);
+}
+
+void NTT::ComputeInverseBatch(uint64_t* result, const uint64_t* operand,
+                              size_t num_polys, uint64_t input_mod_factor,
+                              uint64_t output_mod_factor) {
+  HEXL_CHECK(result != nullptr, "result == nullptr");
+  HEXL_CHECK(operand != nullptr, "operand == nullptr");
+  HEXL_CHECK(input_mod_factor == 1 || input_mod_factor == 2,
+             "input_mod_factor must be 1 or 2; got " << input_mod_factor);
+  HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 2,
+             "output_mod_factor must be 1 or 2; got " << output_mod_factor);
+  HEXL_CHECK_BOUNDS(operand, m_degree * num_polys,
+                    ModFactorBound(m_q, input_mod_factor),
+                    "operand exceeds bound "
+                        << ModFactorBound(m_q, input_mod_factor));
+
+  if (!UsesBatchKernels()) {
+    HEXL_VLOG(3, "Calling InvNTT on each polynomial of the batch");
+    AlignedVector64<uint64_t> poly(m_degree, 0, m_aligned_alloc);
+    for (size_t p = 0; p < num_polys; ++p) {
+      for (size_t i = 0; i < m_degree; ++i) {
+        poly[i] = operand[i * num_polys + p];
+      }
+      ComputeInverse(poly.data(), poly.data(), input_mod_factor,
+                     output_mod_factor);
+      for (size_t i = 0; i < m_degree; ++i) {
+        result[i * num_polys + p] = poly[i];
+      }
+    }
+    return;
+  }
+
+  const uint64_t* inv_root_of_unity_powers =
+      GetTableData(Table::InvRootOfUnityPowers);
+  const uint64_t* precon_inv_root_of_unity_powers =
+      GetTableData(Table::Precon64InvRootOfUnityPowers);
+
+#ifdef HEXL_HAS_AVX512DQ
+  if (has_avx512dq && num_polys >= 8) {
+    HEXL_VLOG(3, "Calling AVX512 batched InvNTT");
+    InverseTransformFromBitReverseBatchAVX512(
+        result, operand, m_degree, num_polys, m_q, inv_root_of_unity_powers,
+        precon_inv_root_of_unity_powers, output_mod_factor);
+    return;
+  }
+#endif
+
+#ifdef HEXL_HAS_AVX256
+  if (has_avx2 && num_polys >= 4) {
+    HEXL_VLOG(3, "Calling AVX2 batched InvNTT");
+    InverseTransformFromBitReverseBatchAVX2(
+        result, operand, m_degree, num_polys, m_q, inv_root_of_unity_powers,
+        precon_inv_root_of_unity_powers, output_mod_factor);
+    return;
+  }
+#endif
+
+  HEXL_VLOG(3, "Calling native batched InvNTT");
+  InverseTransformFromBitReverseBatch(result, operand, m_degree, num_polys,
+                                      m_q, inv_root_of_unity_powers,
+                                      precon_inv_root_of_unity_powers,
+                                      output_mod_factor);
+}
+
+}  // namespace hexl
+}  // namespace intel
@@ -0,0 +1,127 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ntt/ntt-bit-reverse-avx512.hpp"
+
+#include <immintrin.h>
+#include <stdint.h>
+
+#include "hexl/number-theory/number-theory.hpp"
+#include "hexl/util/check.hpp"
+#include "ntt/ntt-internal.hpp"
+
+#ifdef HEXL_HAS_AVX512DQ
+
+namespace intel {
+namespace hexl {
+
+namespace {
+
+// Transposes the 8 x 8 matrix whose rows are rows[0], ..., rows[7]
+inline void Transpose8x8(__m512i* rows) {
+  // Interleaves even and odd elements, and even and odd 128-bit lanes
+  const __m512i lo = _mm512_set_epi64(14, 6, 12, 4, 10, 2, 8, 0);
+  const __m512i hi = _mm512_set_epi64(15, 7, 13, 5, 11, 3, 9, 1);
+  const __m512i even_lanes = _mm512_set_epi64(13, 12, 9, 8, 5, 4, 1, 0);
+  const __m512i odd_lanes = _mm512_set_epi64(15, 14, 11, 10, 7, 6, 3, 2);
+
+  __m512i t0 = _mm512_permutex2var_epi64(rows[0], lo, rows[1]);
+  __m512i t1 = _mm512_permutex2var_epi64(rows[0], hi, rows[1]);
+  __m512i t2 = _mm512_permutex2var_epi64(rows[2], lo, rows[3]);
+  __m512i t3 = _mm512_permutex2var_epi64(rows[2], hi, rows[3]);
+  __m512i t4 = _mm512_permutex2var_epi64(rows[4], lo, rows[5]);
+  __m512i t5 = _mm512_permutex2var_epi64(rows[4], hi, rows[5]);
+  __m512i t6 = _mm512_permutex2var_epi64(rows[6], lo, rows[7]);
+  __m512i t7 = _mm512_permutex2var_epi64(rows[6], hi, rows[7]);
+
+  __m512i u0 = _mm512_permutex2var_epi64(t0, even_lanes, t2);
+  __m512i u1 = _mm512_permutex2var_epi64(t0, odd_lanes, t2);
+  __m512i u2 = _mm512_permutex2var_epi64(t1, even_lanes, t3);
+  __m512i u3 = _mm512_permutex2var_epi64(t1, odd_lanes, t3);
+  __m512i u4 = _mm512_permutex2var_epi64(t4, even_lanes, t6);
+  __m512i u5 = _mm512_permutex2var_epi64(t4, odd_lanes, t6);
+  __m512i u6 = _mm512_permutex2var_epi64(t5, even_lanes, t7);
+  __m512i u7 = _mm512_permutex2var_epi64(t5, odd_lanes, t7);
+
+  rows[0] = _mm512_permutex2var_epi64(u0, even_lanes, u4);
+  rows[4] = _mm512_permutex2var_epi64(u0, odd_lanes, u4);
+  rows[2] = _mm512_permutex2var_epi64(u1, even_lanes, u5);
+  rows[6] = _mm512_permutex2var_epi64(u1, odd_lanes, u5);
+  rows[1] = _mm512_permutex2var_epi64(u2, even_lanes, u6);
+  rows[5] = _mm512_permutex2var_epi64(u2, odd_lanes, u6);
+  rows[3] = _mm512_permutex2var_epi64(u3, even_lanes, u7);
+  rows[7] = _mm512_permutex2var_epi64(u3, odd_lanes, u7);
+}
+
+// Bit reversals of 3-bit indices
+const uint64_t s_reverse_3_bits[8] = {0, 4, 2, 6, 1, 5, 3, 7};
+
+// Loads the tile with middle index b, with rows in bit-reversed order, i.e.
+// row y of tile is row s_reverse_3_bits[y] of the tile
+inline void LoadTile(__m512i* tile, const uint64_t* operand, uint64_t b,
+                     uint64_t row_stride) {
+  auto load_row = [&](uint64_t a) {
+    return _mm512_loadu_si512(
+        reinterpret_cast<const __m512i*>(operand + a * row_stride + 8 * b));
+  };
+  tile[0] = load_row(0);
+  tile[1] = load_row(4);
+  tile[2] = load_row(2);
+  tile[3] = load_row(6);
+  tile[4] = load_row(1);
+  tile[5] = load_row(5);
+  tile[6] = load_row(3);
+  tile[7] = load_row(7);
+}
+
+// Stores a tile loaded by LoadTile to the tile with middle index b
+inline void StoreTile(uint64_t* result, __m512i* tile, uint64_t b,
+                      uint64_t row_stride) {
+  Transpose8x8(tile);
+  for (size_t x = 0; x < 8; ++x) {
+    _mm512_storeu_si512(
+        reinterpret_cast<__m512i*>(result + x * row_stride + 8 * b),
+        tile[s_reverse_3_bits[x]]);
+  }
+}
+
+}  // namespace
+
+void BitReversePermuteAVX512(uint64_t* result, const uint64_t* operand,
+                             uint64_t n) {
+  HEXL_CHECK(IsPowerOfTwo(n), "n " << n << " is not a power of 2");
+  const uint64_t bits = Log2(n);
+  if (bits < 6) {
+    BitReversePermuteNative(result, operand, n);
+    return;
+  }
+
+  // Index i = (a, b, c) with 3-bit a and c maps to (rev(c), rev(b), rev(a)),
+  // so the 8 x 8 tile of elements with middle bits b is transposed, with rows
+  // and columns bit-reversed, into the tile with middle bits rev(b). Tiles b
+  // and rev(b) are loaded before either is stored, so result may alias
+  // operand.
+  const uint64_t middle_bits = bits - 6;
+  const uint64_t row_stride = n >> 3;
+  for (uint64_t b = 0; b < (1ULL << middle_bits); ++b) {
+    uint64_t b_rev = ReverseBits(b, middle_bits);
+    if (b_rev < b) {
+      continue;
+    }
+    __m512i tile[8];
+    LoadTile(tile, operand, b, row_stride);
+    if (b_rev == b) {
+      StoreTile(result, tile, b_rev, row_stride);
+      continue;
+    }
+    __m512i rev_tile[8];
+    LoadTile(rev_tile, operand, b_rev, row_stride);
+    StoreTile(result, tile, b_rev, row_stride);
+    StoreTile(result, rev_tile, b, row_stride);
+  }
+}
+
+}  // namespace hexl
+}  // namespace intel
+
+#endif
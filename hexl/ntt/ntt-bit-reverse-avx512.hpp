@@ -0,0 +1,19 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdint.h>
+
+namespace intel {
+namespace hexl {
+
+/// @brief AVX512 implementation of BitReversePermute
+/// @param[out] result Stores the permuted data. May alias \p operand.
+/// @param[in] operand Data to permute
+/// @param[in] n Number of elements. Must be a power of two.
+void BitReversePermuteAVX512(uint64_t* result, const uint64_t* operand,
+                             uint64_t n);
+
+}  // namespace hexl
+}  // namespace intel
@@ -0,0 +1,98 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdint.h>
+
+#include <utility>
+
+#include "hexl/logging/logging.hpp"
+#include "hexl/ntt/ntt.hpp"
+#include "hexl/number-theory/number-theory.hpp"
+#include "hexl/util/check.hpp"
+#include "ntt/ntt-bit-reverse-avx512.hpp"
+#include "ntt/ntt-internal.hpp"
+#include "util/cpu-features.hpp"
+
+namespace intel {
+namespace hexl {
+
+void BitReversePermuteNative(uint64_t* result, const uint64_t* operand,
+                             uint64_t n) {
+  HEXL_CHECK(IsPowerOfTwo(n), "n " << n << " is not a power of 2");
+  const uint64_t bits = Log2(n);
+
+  if (bits < 6) {
+    if (result == operand) {
+      for (uint64_t i = 0; i < n; ++i) {
+        uint64_t j = ReverseBits(i, bits);
+        if (i < j) {
+          std::swap(result[i], result[j]);
+        }
+      }
+    } else {
+      for (uint64_t i = 0; i < n; ++i) {
+        result[ReverseBits(i, bits)] = operand[i];
+      }
+    }
+    return;
+  }
+
+  // Index i = (a, b, c) with 3-bit a and c maps to (rev(c), rev(b), rev(a)).
+  // The 8 x 8 tile of elements with middle bits b is moved, transposed, to the
+  // tile with middle bits rev(b), one cache line per row. Tiles b and rev(b)
+  // are read before either is written, so result may alias operand.
+  const uint64_t middle_bits = bits - 6;
+  const uint64_t row_stride = n >> 3;
+  const uint64_t reverse_3_bits[8] = {0, 4, 2, 6, 1, 5, 3, 7};
+  uint64_t tile[64];
+  uint64_t rev_tile[64];
+  auto load_tile = [&](uint64_t* dest, uint64_t b) {
+    for (size_t a = 0; a < 8; ++a) {
+      const uint64_t* row = operand + a * row_stride + 8 * b;
+      for (size_t c = 0; c < 8; ++c) {
+        dest[8 * reverse_3_bits[c] + reverse_3_bits[a]] = row[c];
+      }
+    }
+  };
+  auto store_tile = [&](const uint64_t* src, uint64_t b) {
+    for (size_t x = 0; x < 8; ++x) {
+      uint64_t* row = result + x * row_stride + 8 * b;
+      for (size_t y = 0; y < 8; ++y) {
+        row[y] = src[8 * x + y];
+      }
+    }
+  };
+
+  for (uint64_t b = 0; b < (1ULL << middle_bits); ++b) {
+    uint64_t b_rev = ReverseBits(b, middle_bits);
+    if (b_rev < b) {
+      continue;
+    }
+    load_tile(tile, b);
+    if (b_rev != b) {
+      load_tile(rev_tile, b_rev);
+      store_tile(rev_tile, b);
+    }
+    store_tile(tile, b_rev);
+  }
+}
+
+void BitReversePermute(uint64_t* result, const uint64_t* operand, uint64_t n) {
+  HEXL_CHECK(result != nullptr, "result == nullptr");
+  HEXL_CHECK(operand != nullptr, "operand == nullptr");
+  HEXL_CHECK(IsPowerOfTwo(n), "n " << n << " is not a power of 2");
+
+#ifdef HEXL_HAS_AVX512DQ
+  if (has_avx512dq) {
+    HEXL_VLOG(3, "Calling BitReversePermuteAVX512");
+    BitReversePermuteAVX512(result, operand, n);
+    return;
+  }
+#endif
+
+  HEXL_VLOG(3, "Calling BitReversePermuteNative");
+  BitReversePermuteNative(result, operand, n);
+}
+
+}  // namespace hexl
+}  // namespace intel
@@ -0,0 +1,311 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ntt/ntt-compact-avx2.hpp"
+
+#include <immintrin.h>
+#include <stdint.h>
+
+#include "hexl/logging/logging.hpp"
+#include "hexl/number-theory/number-theory.hpp"
+#include "hexl/util/check.hpp"
+#include "ntt/ntt-avx2-util.hpp"
+#include "ntt/ntt-compact.hpp"
+#include "ntt/ntt-internal.hpp"
+#include "util/avx2-util.hpp"
+
+#ifdef HEXL_HAS_AVX256
+
+namespace intel {
+namespace hexl {
+
+namespace {
+
+// Butterflies with 64-bit Shoup multiplications, which apply each root of
+// unity W[k] with k >= 2^b as W[k - k mod 2^b] * W[k mod 2^b]. Stages with t
+// in {1, 2} process 8 elements at a time; their 4 / t roots share the high
+// factor, since 2^b >= 4 for n >= 16.
+class AVX2CompactKernel {
+ public:
+  AVX2CompactKernel(uint64_t modulus, const uint64_t* roots,
+                    const uint64_t* precon_roots, uint64_t n)
+      : m_modulus(modulus),
+        m_roots(roots, precon_roots, n),
+        m_v_modulus(_mm256_set1_epi64x(static_cast<int64_t>(modulus))),
+        m_v_twice_modulus(
+            _mm256_set1_epi64x(static_cast<int64_t>(2 * modulus))) {}
+
+  uint64_t Modulus() const { return m_modulus; }
+
+  const CompactRoots& Roots() const { return m_roots; }
+
+  // Inputs in [0, 4q); outputs in [0, 4q)
+  void FwdButterflies(uint64_t* X_r, uint64_t* Y_r, const uint64_t* X_op,
+                      const uint64_t* Y_op, size_t count, uint64_t k) const {
+    const Root W = BroadcastRoot(k);
+    if (k > m_roots.low_mask) {
+      Butterflies(X_r, Y_r, X_op, Y_op, count, [&](__m256i* X, __m256i* Y) {
+        FwdButterfly<true>(X, Y, W);
+      });
+    } else {
+      Butterflies(X_r, Y_r, X_op, Y_op, count, [&](__m256i* X, __m256i* Y) {
+        FwdButterfly<false>(X, Y, W);
+      });
+    }
+  }
+
+  void FwdStage(uint64_t* result, const uint64_t* operand, size_t t, size_t m,
+                uint64_t k) const {
+    if (t >= 4) {
+      for (size_t i = 0; i < m; ++i) {
+        size_t offset = 2 * i * t;
+        FwdButterflies(result + offset, result + offset + t, operand + offset,
+                       operand + offset + t, t, k + i);
+      }
+      return;
+    }
+    SmallStage(result, operand, t, 2 * t * m, k,
+               [this](__m256i* X, __m256i* Y, const Root& W, bool has_high) {
+                 if (has_high) {
+                   FwdButterfly<true>(X, Y, W);
+                 } else {
+                   FwdButterfly<false>(X, Y, W);
+                 }
+               });
+  }
+
+  // Inputs in [0, 2q); outputs in [0, 2q)
+  void InvButterflies(uint64_t* X_r, uint64_t* Y_r, const uint64_t* X_op,
+                      const uint64_t* Y_op, size_t count, uint64_t k) const {
+    const Root W = BroadcastRoot(k);
+    if (k > m_roots.low_mask) {
+      Butterflies(X_r, Y_r, X_op, Y_op, count, [&](__m256i* X, __m256i* Y) {
+        InvButterfly<true>(X, Y, W);
+      });
+    } else {
+      Butterflies(X_r, Y_r, X_op, Y_op, count, [&](__m256i* X, __m256i* Y) {
+        InvButterfly<false>(X, Y, W);
+      });
+    }
+  }
+
+  void InvStage(uint64_t* result, const uint64_t* operand, size_t t, size_t m,
+                uint64_t k) const {
+    if (t >= 4) {
+      for (size_t i = 0; i < m; ++i) {
+        size_t offset = 2 * i * t;
+        InvButterflies(result + offset, result + offset + t, operand + offset,
+                       operand + offset + t, t, k + i);
+      }
+      return;
+    }
+    SmallStage(result, operand, t, 2 * t * m, k,
+               [this](__m256i* X, __m256i* Y, const Root& W, bool has_high) {
+                 if (has_high) {
+                   InvButterfly<true>(X, Y, W);
+                 } else {
+                   InvButterfly<false>(X, Y, W);
+                 }
+               });
+  }
+
+  void InvFinalButterflies(uint64_t* X, uint64_t* Y, size_t count,
+                           uint64_t inv_n, uint64_t inv_n_w,
+                           uint64_t output_mod_factor) const {
+    HEXL_CHECK(count % 4 == 0, "count " << count << " not a multiple of 4");
+    const __m256i v_inv_n = _mm256_set1_epi64x(static_cast<int64_t>(inv_n));
+    const __m256i v_inv_n_precon = _mm256_set1_epi64x(static_cast<int64_t>(
+        MultiplyFactor(inv_n, 64, m_modulus).BarrettFactor()));
+    const __m256i v_inv_n_w = _mm256_set1_epi64x(static_cast<int64_t>(inv_n_w));
+    const __m256i v_inv_n_w_precon = _mm256_set1_epi64x(static_cast<int64_t>(
+        MultiplyFactor(inv_n_w, 64, m_modulus).BarrettFactor()));
+    __m256i* v_X_pt = reinterpret_cast<__m256i*>(X);
+    __m256i* v_Y_pt = reinterpret_cast<__m256i*>(Y);
+    for (size_t j = 0; j < count / 4; ++j) {
+      __m256i v_X = _mm256_loadu_si256(v_X_pt + j);
+      __m256i v_Y = _mm256_loadu_si256(v_Y_pt + j);
+      __m256i tx = _mm256_add_epi64(v_X, v_Y);
+      __m256i ty =
+          _mm256_sub_epi64(_mm256_add_epi64(v_X, m_v_twice_modulus), v_Y);
+      tx = MultiplyLazy(tx, v_inv_n, v_inv_n_precon);
+      ty = MultiplyLazy(ty, v_inv_n_w, v_inv_n_w_precon);
+      if (output_mod_factor == 1) {
+        tx = _mm256_hexl_small_mod_epu64(tx, m_v_modulus);
+        ty = _mm256_hexl_small_mod_epu64(ty, m_v_modulus);
+      }
+      _mm256_storeu_si256(v_X_pt + j, tx);
+      _mm256_storeu_si256(v_Y_pt + j, ty);
+    }
+  }
+
+ private:
+  // The factors of the roots of unity of each lane, with their
+  // pre-conditioned values
+  struct Root {
+    __m256i high;
+    __m256i high_precon;
+    __m256i low;
+    __m256i low_precon;
+  };
+
+  // Returns the factors of W[k] in each lane. The high factor is 1 for k <
+  // 2^b.
+  Root BroadcastRoot(uint64_t k) const {
+    Root W;
+    W.low = _mm256_set1_epi64x(
+        static_cast<int64_t>(m_roots.low[k & m_roots.low_mask]));
+    W.low_precon = _mm256_set1_epi64x(
+        static_cast<int64_t>(m_roots.precon_low[k & m_roots.low_mask]));
+    W.high = _mm256_set1_epi64x(
+        static_cast<int64_t>(m_roots.high[k >> m_roots.low_bits]));
+    W.high_precon = _mm256_set1_epi64x(
+        static_cast<int64_t>(m_roots.precon_high[k >> m_roots.low_bits]));
+    return W;
+  }
+
+  // Applies butterfly(X, Y) to count elements, a multiple of 4
+  template <typename Butterfly>
+  void Butterflies(uint64_t* X_r, uint64_t* Y_r, const uint64_t* X_op,
+                   const uint64_t* Y_op, size_t count,
+                   Butterfly butterfly) const {
+    HEXL_CHECK(count % 4 == 0, "count " << count << " not a multiple of 4");
+    const __m256i* v_X_op = reinterpret_cast<const __m256i*>(X_op);
+    const __m256i* v_Y_op = reinterpret_cast<const __m256i*>(Y_op);
+    __m256i* v_X_r = reinterpret_cast<__m256i*>(X_r);
+    __m256i* v_Y_r = reinterpret_cast<__m256i*>(Y_r);
+    for (size_t j = 0; j < count / 4; ++j) {
+      __m256i v_X = _mm256_loadu_si256(v_X_op + j);
+      __m256i v_Y = _mm256_loadu_si256(v_Y_op + j);
+      butterfly(&v_X, &v_Y);
+      _mm256_storeu_si256(v_X_r + j, v_X);
+      _mm256_storeu_si256(v_Y_r + j, v_Y);
+    }
+  }
+
+  // Applies a stage with t in {1, 2}, whose groups use the roots W[k..), to a
+  // block of n elements, n a multiple of 8
+  template <typename Butterfly>
+  void SmallStage(uint64_t* result, const uint64_t* operand, size_t t,
+                  size_t n, uint64_t k, Butterfly butterfly) const {
+    HEXL_CHECK(n % 8 == 0, "n " << n << " not a multiple of 8");
+    HEXL_CHECK(m_roots.low_mask >= 3, "compact table too small");
+    const size_t groups_per_chunk = 4 / t;
+    for (size_t chunk = 0; chunk < n / 8; ++chunk, k += groups_per_chunk) {
+      const uint64_t low_index = k & m_roots.low_mask;
+      Root W = BroadcastRoot(k);
+      __m256i v_X;
+      __m256i v_Y;
+      __m256i* v_result = reinterpret_cast<__m256i*>(result + 8 * chunk);
+      if (t == 1) {
+        W.low = LoadWOpT1(m_roots.low + low_index);
+        W.low_precon = LoadWOpT1(m_roots.precon_low + low_index);
+        LoadInterleavedT1(operand + 8 * chunk, &v_X, &v_Y);
+        butterfly(&v_X, &v_Y, W, k > m_roots.low_mask);
+        WriteInterleavedT1(v_X, v_Y, v_result);
+      } else {
+        W.low = LoadWOpT2(m_roots.low + low_index);
+        W.low_precon = LoadWOpT2(m_roots.precon_low + low_index);
+        LoadInterleavedT2(operand + 8 * chunk, &v_X, &v_Y);
+        butterfly(&v_X, &v_Y, W, k > m_roots.low_mask);
+        WriteInterleavedT2(v_X, v_Y, v_result);
+      }
+    }
+  }
+
+  // Returns x * W mod q in [0, 2q), for x in [0, 4q)
+  __m256i MultiplyLazy(__m256i x, __m256i W, __m256i W_precon) const {
+    // The approximate Q yields T in [0, 4q)
+    __m256i Q = _mm256_hexl_mulhi_approx_epi<64>(W_precon, x);
+    __m256i W_x = _mm256_hexl_mullo_epi<64>(W, x);
+    __m256i T =
+        _mm256_sub_epi64(W_x, _mm256_hexl_mullo_epi<64>(Q, m_v_modulus));
+    return _mm256_hexl_small_mod_epu64(T, m_v_twice_modulus);
+  }
+
+  // Returns x * W mod q in [0, 2q), for x in [0, 4q), skipping the high
+  // factor unless HasHigh
+  template <bool HasHigh>
+  __m256i MultiplyRoot(__m256i x, const Root& W) const {
+    if (HasHigh) {
+      x = MultiplyLazy(x, W.high, W.high_precon);
+    }
+    return MultiplyLazy(x, W.low, W.low_precon);
+  }
+
+  // X, Y in [0, 4q) => X + WY, X - WY in [0, 4q)
+  template <bool HasHigh>
+  void FwdButterfly(__m256i* X, __m256i* Y, const Root& W) const {
+    __m256i tx = _mm256_hexl_small_mod_epu64(*X, m_v_twice_modulus);
+    __m256i T = MultiplyRoot<HasHigh>(*Y, W);
+    *X = _mm256_add_epi64(tx, T);
+    *Y = _mm256_sub_epi64(_mm256_add_epi64(tx, m_v_twice_modulus), T);
+  }
+
+  // X, Y in [0, 2q) => X + Y, (X - Y) W in [0, 2q)
+  template <bool HasHigh>
+  void InvButterfly(__m256i* X, __m256i* Y, const Root& W) const {
+    __m256i tx = _mm256_add_epi64(*X, *Y);
+    __m256i ty = _mm256_sub_epi64(_mm256_add_epi64(*X, m_v_twice_modulus), *Y);
+    *X = _mm256_hexl_small_mod_epu64(tx, m_v_twice_modulus);
+    *Y = MultiplyRoot<HasHigh>(ty, W);
+  }
+
+  uint64_t m_modulus;
+  CompactRoots m_roots;
+  __m256i m_v_modulus;
+  __m256i m_v_twice_modulus;
+};
+
+}  // namespace
+
+void ForwardTransformToBitReverseCompactAVX2(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* compact_root_of_unity_powers,
+    const uint64_t* precon_compact_root_of_unity_powers,
+    uint64_t input_mod_factor, uint64_t output_mod_factor) {
+  HEXL_CHECK(NTT::CheckArguments(n, modulus), "");
+  HEXL_CHECK(n >= 16, "n " << n << " must be at least 16");
+  HEXL_CHECK(modulus < NTT::s_max_lazy_modulus,
+             "modulus " << modulus << " too large");
+  HEXL_CHECK(input_mod_factor == 1 || input_mod_factor == 2 ||
+                 input_mod_factor == 4,
+             "input_mod_factor must be 1, 2 or 4; got " << input_mod_factor);
+  HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 4,
+             "output_mod_factor must be 1 or 4; got " << output_mod_factor);
+  HEXL_CHECK_BOUNDS(operand, n, modulus * input_mod_factor,
+                    "operand exceeds bound " << modulus * input_mod_factor);
+  HEXL_UNUSED(input_mod_factor);
+
+  ForwardTransformCompact(
+      AVX2CompactKernel(modulus, compact_root_of_unity_powers,
+                        precon_compact_root_of_unity_powers, n),
+      result, operand, n, output_mod_factor);
+}
+
+void InverseTransformFromBitReverseCompactAVX2(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* compact_inv_root_of_unity_powers,
+    const uint64_t* precon_compact_inv_root_of_unity_powers,
+    uint64_t input_mod_factor, uint64_t output_mod_factor) {
+  HEXL_CHECK(NTT::CheckArguments(n, modulus), "");
+  HEXL_CHECK(n >= 16, "n " << n << " must be at least 16");
+  HEXL_CHECK(modulus < NTT::s_max_lazy_modulus,
+             "modulus " << modulus << " too large");
+  HEXL_CHECK(input_mod_factor == 1 || input_mod_factor == 2,
+             "input_mod_factor must be 1 or 2; got " << input_mod_factor);
+  HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 2,
+             "output_mod_factor must be 1 or 2; got " << output_mod_factor);
+  HEXL_CHECK_BOUNDS(operand, n, modulus * input_mod_factor,
+                    "operand exceeds bound " << modulus * input_mod_factor);
+  HEXL_UNUSED(input_mod_factor);
+
+  InverseTransformCompact(
+      AVX2CompactKernel(modulus, compact_inv_root_of_unity_powers,
+                        precon_compact_inv_root_of_unity_powers, n),
+      result, operand, n, output_mod_factor);
+}
+
+}  // namespace hexl
+}  // namespace intel
+
+#endif  // HEXL_HAS_AVX256
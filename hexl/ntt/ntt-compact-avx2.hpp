@@ -0,0 +1,62 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdint.h>
+
+#include "hexl/ntt/ntt.hpp"
+
+namespace intel {
+namespace hexl {
+
+#ifdef HEXL_HAS_AVX256
+
+/// @brief AVX2 implementation of the forward NTT which computes the roots of
+/// unity from a compact table, with 64-bit Shoup multiplications
+/// @param[out] result Output data. Overwritten with NTT output
+/// @param[in] operand Input data.
+/// @param[in] n Size of the transform, i.e. the polynomial degree. Must be a
+/// power of two, at least 16.
+/// @param[in] modulus Prime modulus q. Must satisfy q == 1 mod 2n and q <
+/// NTT::s_max_lazy_modulus
+/// @param[in] compact_root_of_unity_powers Powers of 2n'th root of unity in
+/// F_q, in the layout of ForwardTransformToBitReverseCompact
+/// @param[in] precon_compact_root_of_unity_powers Pre-conditioned \p
+/// compact_root_of_unity_powers for 64-bit Barrett reduction
+/// @param[in] input_mod_factor Upper bound for inputs; inputs must be in [0,
+/// input_mod_factor * q)
+/// @param[in] output_mod_factor Upper bound for result; result must be in [0,
+/// output_mod_factor * q)
+void ForwardTransformToBitReverseCompactAVX2(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* compact_root_of_unity_powers,
+    const uint64_t* precon_compact_root_of_unity_powers,
+    uint64_t input_mod_factor, uint64_t output_mod_factor);
+
+/// @brief AVX2 implementation of the inverse NTT which computes the roots of
+/// unity from a compact table, with 64-bit Shoup multiplications
+/// @param[out] result Output data. Overwritten with NTT output
+/// @param[in] operand Input data.
+/// @param[in] n Size of the transform, i.e. the polynomial degree. Must be a
+/// power of two, at least 16.
+/// @param[in] modulus Prime modulus q. Must satisfy q == 1 mod 2n and q <
+/// NTT::s_max_lazy_modulus
+/// @param[in] compact_inv_root_of_unity_powers Powers of inverse 2n'th root of
+/// unity in F_q, in the layout of ForwardTransformToBitReverseCompact
+/// @param[in] precon_compact_inv_root_of_unity_powers Pre-conditioned \p
+/// compact_inv_root_of_unity_powers for 64-bit Barrett reduction
+/// @param[in] input_mod_factor Upper bound for inputs; inputs must be in [0,
+/// input_mod_factor * q). Must be 1 or 2.
+/// @param[in] output_mod_factor Upper bound for result; result must be in [0,
+/// output_mod_factor * q). Must be 1 or 2.
+void InverseTransformFromBitReverseCompactAVX2(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* compact_inv_root_of_unity_powers,
+    const uint64_t* precon_compact_inv_root_of_unity_powers,
+    uint64_t input_mod_factor, uint64_t output_mod_factor);
+
+#endif  // HEXL_HAS_AVX256
+
+}  // namespace hexl
+}  // namespace intel
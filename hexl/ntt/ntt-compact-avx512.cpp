@@ -0,0 +1,343 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ntt/ntt-compact-avx512.hpp"
+
+#include <immintrin.h>
+#include <stdint.h>
+
+#include "hexl/logging/logging.hpp"
+#include "hexl/number-theory/number-theory.hpp"
+#include "hexl/util/check.hpp"
+#include "ntt/ntt-avx512-util.hpp"
+#include "ntt/ntt-compact.hpp"
+#include "ntt/ntt-internal.hpp"
+#include "util/avx512-util.hpp"
+
+#ifdef HEXL_HAS_AVX512DQ
+
+namespace intel {
+namespace hexl {
+
+namespace {
+
+// Butterflies with BitShift-bit Shoup multiplications, which apply each root
+// of unity W[k] with k >= 2^b as W[k - k mod 2^b] * W[k mod 2^b]. Stages with
+// fewer than 8 butterflies per group process 16 elements at a time; their 8 /
+// t roots share the high factor, since 2^b >= 8 for n >= 32.
+template <int BitShift>
+class AVX512CompactKernel {
+ public:
+  AVX512CompactKernel(uint64_t modulus, const uint64_t* roots,
+                      const uint64_t* precon_roots, uint64_t n)
+      : m_modulus(modulus),
+        m_roots(roots, precon_roots, n),
+        m_v_modulus(_mm512_set1_epi64(static_cast<int64_t>(modulus))),
+        m_v_neg_modulus(_mm512_set1_epi64(-static_cast<int64_t>(modulus))),
+        m_v_twice_modulus(
+            _mm512_set1_epi64(static_cast<int64_t>(2 * modulus))) {}
+
+  uint64_t Modulus() const { return m_modulus; }
+
+  const CompactRoots& Roots() const { return m_roots; }
+
+  // Inputs in [0, 4q); outputs in [0, 4q)
+  void FwdButterflies(uint64_t* X_r, uint64_t* Y_r, const uint64_t* X_op,
+                      const uint64_t* Y_op, size_t count, uint64_t k) const {
+    const Root W = BroadcastRoot(k);
+    if (k > m_roots.low_mask) {
+      Butterflies(X_r, Y_r, X_op, Y_op, count, [&](__m512i* X, __m512i* Y) {
+        FwdButterfly<true>(X, Y, W);
+      });
+    } else {
+      Butterflies(X_r, Y_r, X_op, Y_op, count, [&](__m512i* X, __m512i* Y) {
+        FwdButterfly<false>(X, Y, W);
+      });
+    }
+  }
+
+  void FwdStage(uint64_t* result, const uint64_t* operand, size_t t, size_t m,
+                uint64_t k) const {
+    if (t >= 8) {
+      for (size_t i = 0; i < m; ++i) {
+        size_t offset = 2 * i * t;
+        FwdButterflies(result + offset, result + offset + t, operand + offset,
+                       operand + offset + t, t, k + i);
+      }
+      return;
+    }
+    SmallStage(result, operand, t, 2 * t * m, k,
+               [this](__m512i* X, __m512i* Y, const Root& W, bool has_high) {
+                 if (has_high) {
+                   FwdButterfly<true>(X, Y, W);
+                 } else {
+                   FwdButterfly<false>(X, Y, W);
+                 }
+               });
+  }
+
+  // Inputs in [0, 2q); outputs in [0, 2q)
+  void InvButterflies(uint64_t* X_r, uint64_t* Y_r, const uint64_t* X_op,
+                      const uint64_t* Y_op, size_t count, uint64_t k) const {
+    const Root W = BroadcastRoot(k);
+    if (k > m_roots.low_mask) {
+      Butterflies(X_r, Y_r, X_op, Y_op, count, [&](__m512i* X, __m512i* Y) {
+        InvButterfly<true>(X, Y, W);
+      });
+    } else {
+      Butterflies(X_r, Y_r, X_op, Y_op, count, [&](__m512i* X, __m512i* Y) {
+        InvButterfly<false>(X, Y, W);
+      });
+    }
+  }
+
+  void InvStage(uint64_t* result, const uint64_t* operand, size_t t, size_t m,
+                uint64_t k) const {
+    if (t >= 8) {
+      for (size_t i = 0; i < m; ++i) {
+        size_t offset = 2 * i * t;
+        InvButterflies(result + offset, result + offset + t, operand + offset,
+                       operand + offset + t, t, k + i);
+      }
+      return;
+    }
+    SmallStage(result, operand, t, 2 * t * m, k,
+               [this](__m512i* X, __m512i* Y, const Root& W, bool has_high) {
+                 if (has_high) {
+                   InvButterfly<true>(X, Y, W);
+                 } else {
+                   InvButterfly<false>(X, Y, W);
+                 }
+               });
+  }
+
+  void InvFinalButterflies(uint64_t* X, uint64_t* Y, size_t count,
+                           uint64_t inv_n, uint64_t inv_n_w,
+                           uint64_t output_mod_factor) const {
+    HEXL_CHECK(count % 8 == 0, "count " << count << " not a multiple of 8");
+    const __m512i v_inv_n = _mm512_set1_epi64(static_cast<int64_t>(inv_n));
+    const __m512i v_inv_n_precon = _mm512_set1_epi64(static_cast<int64_t>(
+        MultiplyFactor(inv_n, BitShift, m_modulus).BarrettFactor()));
+    const __m512i v_inv_n_w = _mm512_set1_epi64(static_cast<int64_t>(inv_n_w));
+    const __m512i v_inv_n_w_precon = _mm512_set1_epi64(static_cast<int64_t>(
+        MultiplyFactor(inv_n_w, BitShift, m_modulus).BarrettFactor()));
+    __m512i* v_X_pt = reinterpret_cast<__m512i*>(X);
+    __m512i* v_Y_pt = reinterpret_cast<__m512i*>(Y);
+    for (size_t j = 0; j < count / 8; ++j) {
+      __m512i v_X = _mm512_loadu_si512(v_X_pt + j);
+      __m512i v_Y = _mm512_loadu_si512(v_Y_pt + j);
+      __m512i tx = _mm512_add_epi64(v_X, v_Y);
+      __m512i ty =
+          _mm512_sub_epi64(_mm512_add_epi64(v_X, m_v_twice_modulus), v_Y);
+      tx = MultiplyLazy(tx, v_inv_n, v_inv_n_precon);
+      ty = MultiplyLazy(ty, v_inv_n_w, v_inv_n_w_precon);
+      if (output_mod_factor == 1) {
+        tx = _mm512_hexl_small_mod_epu64(tx, m_v_modulus);
+        ty = _mm512_hexl_small_mod_epu64(ty, m_v_modulus);
+      }
+      _mm512_storeu_si512(v_X_pt + j, tx);
+      _mm512_storeu_si512(v_Y_pt + j, ty);
+    }
+  }
+
+ private:
+  // The factors of the roots of unity of each lane, with their
+  // pre-conditioned values
+  struct Root {
+    __m512i high;
+    __m512i high_precon;
+    __m512i low;
+    __m512i low_precon;
+  };
+
+  // Returns the factors of W[k] in each lane. The high factor is 1 for k <
+  // 2^b.
+  Root BroadcastRoot(uint64_t k) const {
+    Root W;
+    W.low = _mm512_set1_epi64(
+        static_cast<int64_t>(m_roots.low[k & m_roots.low_mask]));
+    W.low_precon = _mm512_set1_epi64(
+        static_cast<int64_t>(m_roots.precon_low[k & m_roots.low_mask]));
+    W.high = _mm512_set1_epi64(
+        static_cast<int64_t>(m_roots.high[k >> m_roots.low_bits]));
+    W.high_precon = _mm512_set1_epi64(
+        static_cast<int64_t>(m_roots.precon_high[k >> m_roots.low_bits]));
+    return W;
+  }
+
+  // Applies butterfly(X, Y) to count elements, a multiple of 8
+  template <typename Butterfly>
+  void Butterflies(uint64_t* X_r, uint64_t* Y_r, const uint64_t* X_op,
+                   const uint64_t* Y_op, size_t count,
+                   Butterfly butterfly) const {
+    HEXL_CHECK(count % 8 == 0, "count " << count << " not a multiple of 8");
+    const __m512i* v_X_op = reinterpret_cast<const __m512i*>(X_op);
+    const __m512i* v_Y_op = reinterpret_cast<const __m512i*>(Y_op);
+    __m512i* v_X_r = reinterpret_cast<__m512i*>(X_r);
+    __m512i* v_Y_r = reinterpret_cast<__m512i*>(Y_r);
+    for (size_t j = 0; j < count / 8; ++j) {
+      __m512i v_X = _mm512_loadu_si512(v_X_op + j);
+      __m512i v_Y = _mm512_loadu_si512(v_Y_op + j);
+      butterfly(&v_X, &v_Y);
+      _mm512_storeu_si512(v_X_r + j, v_X);
+      _mm512_storeu_si512(v_Y_r + j, v_Y);
+    }
+  }
+
+  // Applies a stage with t in {1, 2, 4}, whose groups use the roots W[k..),
+  // to a block of n elements, n a multiple of 16
+  template <typename Butterfly>
+  void SmallStage(uint64_t* result, const uint64_t* operand, size_t t,
+                  size_t n, uint64_t k, Butterfly butterfly) const {
+    HEXL_CHECK(n % 16 == 0, "n " << n << " not a multiple of 16");
+    HEXL_CHECK(m_roots.low_mask >= 7, "compact table too small");
+    const SmallStageLayout layout(t);
+    const size_t groups_per_chunk = layout.GroupsPerChunk();
+    for (size_t chunk = 0; chunk < n / 16; ++chunk, k += groups_per_chunk) {
+      const uint64_t low_index = k & m_roots.low_mask;
+      Root W = BroadcastRoot(k);
+      W.low = layout.LoadRoots(m_roots.low + low_index);
+      W.low_precon = layout.LoadRoots(m_roots.precon_low + low_index);
+
+      __m512i v_X;
+      __m512i v_Y;
+      layout.Load(operand + 16 * chunk, &v_X, &v_Y);
+      butterfly(&v_X, &v_Y, W, k > m_roots.low_mask);
+      layout.Store(result + 16 * chunk, v_X, v_Y);
+    }
+  }
+
+  // Returns x * W mod q in [0, 2q), for x in [0, 4q)
+  __m512i MultiplyLazy(__m512i x, __m512i W, __m512i W_precon) const {
+    if (BitShift == 52) {
+      __m512i Q = _mm512_hexl_mulhi_epi<BitShift>(W_precon, x);
+      __m512i W_x = _mm512_hexl_mullo_epi<BitShift>(W, x);
+      return _mm512_hexl_mullo_add_lo_epi<BitShift>(W_x, Q, m_v_neg_modulus);
+    }
+    // The approximate Q yields T in [0, 4q)
+    __m512i Q = _mm512_hexl_mulhi_approx_epi<BitShift>(W_precon, x);
+    __m512i W_x = _mm512_hexl_mullo_epi<BitShift>(W, x);
+    __m512i T = _mm512_hexl_mullo_add_lo_epi<BitShift>(W_x, Q, m_v_neg_modulus);
+    return _mm512_hexl_small_mod_epu64<2>(T, m_v_twice_modulus);
+  }
+
+  // Returns x * W mod q in [0, 2q), for x in [0, 4q), skipping the high
+  // factor unless HasHigh
+  template <bool HasHigh>
+  __m512i MultiplyRoot(__m512i x, const Root& W) const {
+    if (HasHigh) {
+      x = MultiplyLazy(x, W.high, W.high_precon);
+    }
+    return MultiplyLazy(x, W.low, W.low_precon);
+  }
+
+  // X, Y in [0, 4q) => X + WY, X - WY in [0, 4q)
+  template <bool HasHigh>
+  void FwdButterfly(__m512i* X, __m512i* Y, const Root& W) const {
+    __m512i tx = _mm512_hexl_small_mod_epu64(*X, m_v_twice_modulus);
+    __m512i T = MultiplyRoot<HasHigh>(*Y, W);
+    *X = _mm512_add_epi64(tx, T);
+    *Y = _mm512_sub_epi64(_mm512_add_epi64(tx, m_v_twice_modulus), T);
+  }
+
+  // X, Y in [0, 2q) => X + Y, (X - Y) W in [0, 2q)
+  template <bool HasHigh>
+  void InvButterfly(__m512i* X, __m512i* Y, const Root& W) const {
+    __m512i tx = _mm512_add_epi64(*X, *Y);
+    __m512i ty = _mm512_sub_epi64(_mm512_add_epi64(*X, m_v_twice_modulus), *Y);
+    *X = _mm512_hexl_small_mod_epu64(tx, m_v_twice_modulus);
+    *Y = MultiplyRoot<HasHigh>(ty, W);
+  }
+
+  uint64_t m_modulus;
+  CompactRoots m_roots;
+  __m512i m_v_modulus;
+  __m512i m_v_neg_modulus;
+  __m512i m_v_twice_modulus;
+};
+
+}  // namespace
+
+template <int BitShift>
+void ForwardTransformToBitReverseCompactAVX512(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* compact_root_of_unity_powers,
+    const uint64_t* precon_compact_root_of_unity_powers,
+    uint64_t input_mod_factor, uint64_t output_mod_factor) {
+  HEXL_CHECK(NTT::CheckArguments(n, modulus), "");
+  HEXL_CHECK(n >= 32, "n " << n << " must be at least 32");
+  HEXL_CHECK(modulus < NTT::s_max_fwd_modulus(BitShift),
+             "modulus " << modulus << " too large for BitShift " << BitShift);
+  HEXL_CHECK(input_mod_factor == 1 || input_mod_factor == 2 ||
+                 input_mod_factor == 4,
+             "input_mod_factor must be 1, 2 or 4; got " << input_mod_factor);
+  HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 4,
+             "output_mod_factor must be 1 or 4; got " << output_mod_factor);
+  HEXL_CHECK_BOUNDS(operand, n, modulus * input_mod_factor,
+                    "operand exceeds bound " << modulus * input_mod_factor);
+  HEXL_UNUSED(input_mod_factor);
+
+  ForwardTransformCompact(
+      AVX512CompactKernel<BitShift>(modulus, compact_root_of_unity_powers,
+                                    precon_compact_root_of_unity_powers, n),
+      result, operand, n, output_mod_factor);
+}
+
+template <int BitShift>
+void InverseTransformFromBitReverseCompactAVX512(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* compact_inv_root_of_unity_powers,
+    const uint64_t* precon_compact_inv_root_of_unity_powers,
+    uint64_t input_mod_factor, uint64_t output_mod_factor) {
+  HEXL_CHECK(NTT::CheckArguments(n, modulus), "");
+  HEXL_CHECK(n >= 32, "n " << n << " must be at least 32");
+  HEXL_CHECK(modulus < NTT::s_max_inv_modulus(BitShift),
+             "modulus " << modulus << " too large for BitShift " << BitShift);
+  HEXL_CHECK(input_mod_factor == 1 || input_mod_factor == 2,
+             "input_mod_factor must be 1 or 2; got " << input_mod_factor);
+  HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 2,
+             "output_mod_factor must be 1 or 2; got " << output_mod_factor);
+  HEXL_CHECK_BOUNDS(operand, n, modulus * input_mod_factor,
+                    "operand exceeds bound " << modulus * input_mod_factor);
+  HEXL_UNUSED(input_mod_factor);
+
+  InverseTransformCompact(
+      AVX512CompactKernel<BitShift>(modulus, compact_inv_root_of_unity_powers,
+                                    precon_compact_inv_root_of_unity_powers,
+                                    n),
+      result, operand, n, output_mod_factor);
+}
+
+#ifdef HEXL_HAS_AVX512IFMA
+template void ForwardTransformToBitReverseCompactAVX512<NTT::s_ifma_shift_bits>(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* compact_root_of_unity_powers,
+    const uint64_t* precon_compact_root_of_unity_powers,
+    uint64_t input_mod_factor, uint64_t output_mod_factor);
+
+template void
+InverseTransformFromBitReverseCompactAVX512<NTT::s_ifma_shift_bits>(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* compact_inv_root_of_unity_powers,
+    const uint64_t* precon_compact_inv_root_of_unity_powers,
+    uint64_t input_mod_factor, uint64_t output_mod_factor);
+#endif
+
+template void
+ForwardTransformToBitReverseCompactAVX512<NTT::s_default_shift_bits>(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* compact_root_of_unity_powers,
+    const uint64_t* precon_compact_root_of_unity_powers,
+    uint64_t input_mod_factor, uint64_t output_mod_factor);
+
+template void
+InverseTransformFromBitReverseCompactAVX512<NTT::s_default_shift_bits>(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* compact_inv_root_of_unity_powers,
+    const uint64_t* precon_compact_inv_root_of_unity_powers,
+    uint64_t input_mod_factor, uint64_t output_mod_factor);
+
+}  // namespace hexl
+}  // namespace intel
+
+#endif  // HEXL_HAS_AVX512DQ
@@ -0,0 +1,67 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdint.h>
+
+#include "hexl/ntt/ntt.hpp"
+
+namespace intel {
+namespace hexl {
+
+#ifdef HEXL_HAS_AVX512DQ
+
+/// @brief AVX512 implementation of the forward NTT which computes the roots
+/// of unity from a compact table
+/// @param[out] result Output data. Overwritten with NTT output
+/// @param[in] operand Input data.
+/// @param[in] n Size of the transform, i.e. the polynomial degree. Must be a
+/// power of two, at least 32.
+/// @param[in] modulus Prime modulus q. Must satisfy q == 1 mod 2n and q <
+/// NTT::s_max_fwd_modulus(BitShift)
+/// @param[in] compact_root_of_unity_powers Powers of 2n'th root of unity in
+/// F_q, in the layout of ForwardTransformToBitReverseCompact
+/// @param[in] precon_compact_root_of_unity_powers Pre-conditioned \p
+/// compact_root_of_unity_powers for BitShift-bit Barrett reduction
+/// @param[in] input_mod_factor Upper bound for inputs; inputs must be in [0,
+/// input_mod_factor * q)
+/// @param[in] output_mod_factor Upper bound for result; result must be in [0,
+/// output_mod_factor * q)
+/// @details BitShift 52 uses the AVX512-IFMA multiply instructions; BitShift
+/// 64 emulates the high 64 bits of the products. Each root with a high factor
+/// other than 1 costs one more Shoup multiplication per vector of butterflies.
+template <int BitShift>
+void ForwardTransformToBitReverseCompactAVX512(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* compact_root_of_unity_powers,
+    const uint64_t* precon_compact_root_of_unity_powers,
+    uint64_t input_mod_factor, uint64_t output_mod_factor);
+
+/// @brief AVX512 implementation of the inverse NTT which computes the roots
+/// of unity from a compact table
+/// @param[out] result Output data. Overwritten with NTT output
+/// @param[in] operand Input data.
+/// @param[in] n Size of the transform, i.e. the polynomial degree. Must be a
+/// power of two, at least 32.
+/// @param[in] modulus Prime modulus q. Must satisfy q == 1 mod 2n and q <
+/// NTT::s_max_inv_modulus(BitShift)
+/// @param[in] compact_inv_root_of_unity_powers Powers of inverse 2n'th root of
+/// unity in F_q, in the layout of ForwardTransformToBitReverseCompact
+/// @param[in] precon_compact_inv_root_of_unity_powers Pre-conditioned \p
+/// compact_inv_root_of_unity_powers for BitShift-bit Barrett reduction
+/// @param[in] input_mod_factor Upper bound for inputs; inputs must be in [0,
+/// input_mod_factor * q). Must be 1 or 2.
+/// @param[in] output_mod_factor Upper bound for result; result must be in [0,
+/// output_mod_factor * q). Must be 1 or 2.
+template <int BitShift>
+void InverseTransformFromBitReverseCompactAVX512(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* compact_inv_root_of_unity_powers,
+    const uint64_t* precon_compact_inv_root_of_unity_powers,
+    uint64_t input_mod_factor, uint64_t output_mod_factor);
+
+#endif  // HEXL_HAS_AVX512DQ
+
+}  // namespace hexl
+}  // namespace intel
@@ -0,0 +1,190 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ntt/ntt-compact.hpp"
+
+#include "hexl/logging/logging.hpp"
+#include "hexl/ntt/ntt.hpp"
+#include "hexl/number-theory/number-theory.hpp"
+#include "hexl/util/check.hpp"
+#include "ntt/ntt-default.hpp"
+#include "ntt/ntt-internal.hpp"
+
+namespace intel {
+namespace hexl {
+
+namespace {
+
+// Butterflies which apply each root of unity W[k] with k >= 2^b as W[k - k mod
+// 2^b] * W[k mod 2^b], i.e. as two 64-bit Shoup multiplications
+class NativeCompactKernel {
+ public:
+  NativeCompactKernel(uint64_t modulus, const uint64_t* roots,
+                      const uint64_t* precon_roots, uint64_t n)
+      : m_modulus(modulus),
+        m_twice_modulus(modulus << 1),
+        m_roots(roots, precon_roots, n) {}
+
+  uint64_t Modulus() const { return m_modulus; }
+
+  const CompactRoots& Roots() const { return m_roots; }
+
+  // Inputs in [0, 4q); outputs in [0, 4q)
+  void FwdButterflies(uint64_t* X_r, uint64_t* Y_r, const uint64_t* X_op,
+                      const uint64_t* Y_op, size_t count, uint64_t k) const {
+    const uint64_t W_low = m_roots.low[k & m_roots.low_mask];
+    const uint64_t W_low_precon = m_roots.precon_low[k & m_roots.low_mask];
+    if (k <= m_roots.low_mask) {
+      HEXL_LOOP_UNROLL_8
+      for (size_t j = 0; j < count; j++) {
+        FwdButterflyRadix2(X_r++, Y_r++, X_op++, Y_op++, W_low, W_low_precon,
+                           m_modulus, m_twice_modulus);
+      }
+      return;
+    }
+    const uint64_t W_high = m_roots.high[k >> m_roots.low_bits];
+    const uint64_t W_high_precon = m_roots.precon_high[k >> m_roots.low_bits];
+    HEXL_LOOP_UNROLL_8
+    for (size_t j = 0; j < count; j++) {
+      uint64_t tx = ReduceMod<2>(X_op[j], m_twice_modulus);
+      uint64_t T =
+          MultiplyModLazy<64>(Y_op[j], W_high, W_high_precon, m_modulus);
+      T = MultiplyModLazy<64>(T, W_low, W_low_precon, m_modulus);
+      X_r[j] = tx + T;
+      Y_r[j] = tx + m_twice_modulus - T;
+    }
+  }
+
+  void FwdStage(uint64_t* result, const uint64_t* operand, size_t t, size_t m,
+                uint64_t k) const {
+    for (size_t i = 0; i < m; ++i) {
+      size_t offset = 2 * i * t;
+      FwdButterflies(result + offset, result + offset + t, operand + offset,
+                     operand + offset + t, t, k + i);
+    }
+  }
+
+  // Inputs in [0, 2q); outputs in [0, 2q)
+  void InvButterflies(uint64_t* X_r, uint64_t* Y_r, const uint64_t* X_op,
+                      const uint64_t* Y_op, size_t count, uint64_t k) const {
+    const uint64_t W_low = m_roots.low[k & m_roots.low_mask];
+    const uint64_t W_low_precon = m_roots.precon_low[k & m_roots.low_mask];
+    if (k <= m_roots.low_mask) {
+      HEXL_LOOP_UNROLL_8
+      for (size_t j = 0; j < count; j++) {
+        InvButterflyRadix2(X_r++, Y_r++, X_op++, Y_op++, W_low, W_low_precon,
+                           m_modulus, m_twice_modulus);
+      }
+      return;
+    }
+    const uint64_t W_high = m_roots.high[k >> m_roots.low_bits];
+    const uint64_t W_high_precon = m_roots.precon_high[k >> m_roots.low_bits];
+    HEXL_LOOP_UNROLL_8
+    for (size_t j = 0; j < count; j++) {
+      uint64_t x = X_op[j];
+      uint64_t y = Y_op[j];
+      X_r[j] = ReduceMod<2>(x + y, m_twice_modulus);
+      uint64_t ty = MultiplyModLazy<64>(x + m_twice_modulus - y, W_high,
+                                        W_high_precon, m_modulus);
+      Y_r[j] = MultiplyModLazy<64>(ty, W_low, W_low_precon, m_modulus);
+    }
+  }
+
+  void InvStage(uint64_t* result, const uint64_t* operand, size_t t, size_t m,
+                uint64_t k) const {
+    for (size_t i = 0; i < m; ++i) {
+      size_t offset = 2 * i * t;
+      InvButterflies(result + offset, result + offset + t, operand + offset,
+                     operand + offset + t, t, k + i);
+    }
+  }
+
+  void InvFinalButterflies(uint64_t* X, uint64_t* Y, size_t count,
+                           uint64_t inv_n, uint64_t inv_n_w,
+                           uint64_t output_mod_factor) const {
+    const uint64_t inv_n_precon =
+        MultiplyFactor(inv_n, 64, m_modulus).BarrettFactor();
+    const uint64_t inv_n_w_precon =
+        MultiplyFactor(inv_n_w, 64, m_modulus).BarrettFactor();
+    HEXL_LOOP_UNROLL_8
+    for (size_t j = 0; j < count; j++) {
+      uint64_t x = X[j];
+      uint64_t y = Y[j];
+      X[j] = MultiplyModLazy<64>(x + y, inv_n, inv_n_precon, m_modulus);
+      Y[j] = MultiplyModLazy<64>(x + m_twice_modulus - y, inv_n_w,
+                                 inv_n_w_precon, m_modulus);
+    }
+    if (output_mod_factor == 1) {
+      for (size_t j = 0; j < count; ++j) {
+        X[j] = ReduceMod<2>(X[j], m_modulus);
+        Y[j] = ReduceMod<2>(Y[j], m_modulus);
+      }
+    }
+  }
+
+ private:
+  uint64_t m_modulus;
+  uint64_t m_twice_modulus;
+  CompactRoots m_roots;
+};
+
+}  // namespace
+
+uint64_t CompactRootLowBits(uint64_t n) { return (Log2(n) + 1) / 2; }
+
+uint64_t CompactRootTableSize(uint64_t n) {
+  uint64_t low_bits = CompactRootLowBits(n);
+  return (1ULL << low_bits) + (n >> low_bits);
+}
+
+void ForwardTransformToBitReverseCompact(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* compact_root_of_unity_powers,
+    const uint64_t* precon_compact_root_of_unity_powers,
+    uint64_t input_mod_factor, uint64_t output_mod_factor) {
+  HEXL_CHECK(NTT::CheckArguments(n, modulus), "");
+  HEXL_CHECK_BOUNDS(operand, n, modulus * input_mod_factor,
+                    "operand exceeds bound " << modulus * input_mod_factor);
+  HEXL_CHECK(compact_root_of_unity_powers != nullptr,
+             "compact_root_of_unity_powers == nullptr");
+  HEXL_CHECK(precon_compact_root_of_unity_powers != nullptr,
+             "precon_compact_root_of_unity_powers == nullptr");
+  HEXL_CHECK(
+      input_mod_factor == 1 || input_mod_factor == 2 || input_mod_factor == 4,
+      "input_mod_factor must be 1, 2, or 4; got " << input_mod_factor);
+  HEXL_UNUSED(input_mod_factor);
+  HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 4,
+             "output_mod_factor must be 1 or 4; got " << output_mod_factor);
+
+  ForwardTransformCompact(
+      NativeCompactKernel(modulus, compact_root_of_unity_powers,
+                          precon_compact_root_of_unity_powers, n),
+      result, operand, n, output_mod_factor);
+}
+
+void InverseTransformFromBitReverseCompact(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* compact_inv_root_of_unity_powers,
+    const uint64_t* precon_compact_inv_root_of_unity_powers,
+    uint64_t input_mod_factor, uint64_t output_mod_factor) {
+  HEXL_CHECK(NTT::CheckArguments(n, modulus), "");
+  HEXL_CHECK_BOUNDS(operand, n, modulus * input_mod_factor,
+                    "operand exceeds bound " << modulus * input_mod_factor);
+  HEXL_CHECK(compact_inv_root_of_unity_powers != nullptr,
+             "compact_inv_root_of_unity_powers == nullptr");
+  HEXL_CHECK(precon_compact_inv_root_of_unity_powers != nullptr,
+             "precon_compact_inv_root_of_unity_powers == nullptr");
+  HEXL_CHECK(input_mod_factor == 1 || input_mod_factor == 2,
+             "input_mod_factor must be 1 or 2; got " << input_mod_factor);
+  HEXL_UNUSED(input_mod_factor);
+  HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 2,
+             "output_mod_factor must be 1 or 2; got " << output_mod_factor);
+
+  InverseTransformCompact(
+      NativeCompactKernel(modulus, compact_inv_root_of_unity_powers,
+                          precon_compact_inv_root_of_unity_powers, n),
+      result, operand, n, output_mod_factor);
+}
+
+}  // namespace hexl
+}  // namespace intel
@@ -0,0 +1,233 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdint.h>
+
+#include <cstring>
+
+#include "hexl/eltwise/eltwise-reduce-mod.hpp"
+#include "hexl/ntt/ntt.hpp"
+#include "hexl/number-theory/number-theory.hpp"
+#include "hexl/util/check.hpp"
+#include "ntt/ntt-internal.hpp"
+#include "util/thread-pool.hpp"
+
+namespace intel {
+namespace hexl {
+
+/// @brief Roots of unity W[k] of a compact table, for bit-reversed indices k.
+/// Each root is the product of a high factor W[k - k mod 2^b] and a low factor
+/// W[k mod 2^b], for b = CompactRootLowBits(n); the high factor is 1 for k <
+/// 2^b.
+struct CompactRoots {
+  CompactRoots(const uint64_t* roots, const uint64_t* precon_roots,
+               uint64_t n)
+      : low_bits(CompactRootLowBits(n)),
+        low_mask((1ULL << low_bits) - 1),
+        low(roots),
+        precon_low(precon_roots),
+        high(roots + (1ULL << low_bits)),
+        precon_high(precon_roots + (1ULL << low_bits)) {}
+
+  const uint64_t low_bits;
+  const uint64_t low_mask;
+  const uint64_t* low;
+  const uint64_t* precon_low;
+  const uint64_t* high;
+  const uint64_t* precon_high;
+};
+
+/// @brief Computes the block of a depth-first forward NTT with compact roots
+/// of unity whose first stage uses the root of unity with index \p
+/// root_index. Assumes \p operand in [0, 4q) and returns \p result in [0, 4q).
+/// @param[in] kernel Butterfly implementation, providing
+/// FwdButterflies(X_r, Y_r, X_op, Y_op, count, k), which applies \p count
+/// butterflies with the root W[k], and FwdStage(result, operand, t, m, k),
+/// which applies the stage of m groups of 2t elements using the roots W[k..k +
+/// m)
+/// @param[out] result Output data
+/// @param[in] operand Input data
+/// @param[in] n Size of the block
+/// @param[in] root_index 2^recursion_depth + index of the block
+/// @param[in] recursion_depth Depth of the block
+template <typename Kernel>
+void FwdCompactBlock(const Kernel& kernel, uint64_t* result,
+                     const uint64_t* operand, uint64_t n, uint64_t root_index,
+                     uint64_t recursion_depth) {
+  if (n > NTT::GetBaseNTTSize()) {
+    const uint64_t levels = (recursion_depth == 0) ? ParallelNTTLevels(n) : 0;
+    if (levels > 0) {
+      // The stages of the outer levels are split evenly across the tasks,
+      // after which the blocks are transformed as independent tasks
+      const size_t num_tasks = size_t(1) << levels;
+      ThreadPool& pool = ThreadPool::GetInstance();
+      for (uint64_t level = 0; level < levels; ++level) {
+        const size_t tasks_per_block = num_tasks >> level;
+        const size_t t = n >> (level + 1);
+        const size_t chunk = t / tasks_per_block;
+        const uint64_t* level_operand = (level == 0) ? operand : result;
+        pool.ParallelFor(num_tasks, [&](size_t task) {
+          size_t block = task / tasks_per_block;
+          size_t offset = 2 * t * block + chunk * (task % tasks_per_block);
+          kernel.FwdButterflies(result + offset, result + offset + t,
+                                level_operand + offset,
+                                level_operand + offset + t, chunk,
+                                (1ULL << level) + block);
+        });
+      }
+      const uint64_t block_size = n >> levels;
+      pool.ParallelFor(num_tasks, [&](size_t block) {
+        uint64_t* block_result = result + block * block_size;
+        FwdCompactBlock(kernel, block_result, block_result, block_size,
+                        (1ULL << levels) + block, levels);
+      });
+      return;
+    }
+
+    const uint64_t t = n >> 1;
+    kernel.FwdButterflies(result, result + t, operand, operand + t, t,
+                          root_index);
+    FwdCompactBlock(kernel, result, result, t, 2 * root_index,
+                    recursion_depth + 1);
+    FwdCompactBlock(kernel, result + t, result + t, t, 2 * root_index + 1,
+                    recursion_depth + 1);
+    return;
+  }
+
+  // Breadth-first within the cache-resident block
+  const uint64_t* input = operand;
+  for (uint64_t m = 1, t = n >> 1; m < n; m <<= 1, t >>= 1) {
+    kernel.FwdStage(result, input, t, m, root_index * m);
+    input = result;
+  }
+}
+
+/// @brief Computes the block of a depth-first inverse NTT with compact roots
+/// of unity whose final stage uses the root of unity with index \p
+/// root_index. Assumes \p operand in [0, 2q) and returns \p result in [0, 2q),
+/// or in [0, output_mod_factor * q) for the full transform.
+/// @param[in] kernel Butterfly implementation, providing InvButterflies and
+/// InvStage, analogous to the forward functions of FwdCompactBlock, and
+/// InvFinalButterflies(X, Y, count, inv_n, inv_n_w, output_mod_factor), which
+/// computes the final stage fused with the multiplication by n^{-1}, as well
+/// as Modulus() and Roots()
+/// @param[out] result Output data
+/// @param[in] operand Input data
+/// @param[in] n Size of the block
+/// @param[in] root_index 2^recursion_depth + index of the block
+/// @param[in] recursion_depth Depth of the block
+/// @param[in] output_mod_factor Must be 1 or 2
+template <typename Kernel>
+void InvCompactBlock(const Kernel& kernel, uint64_t* result,
+                     const uint64_t* operand, uint64_t n, uint64_t root_index,
+                     uint64_t recursion_depth, uint64_t output_mod_factor) {
+  const uint64_t modulus = kernel.Modulus();
+  const uint64_t half_n = n >> 1;
+
+  if (n > NTT::GetBaseNTTSize()) {
+    const uint64_t levels = (recursion_depth == 0) ? ParallelNTTLevels(n) : 0;
+    if (levels > 0) {
+      // The blocks are transformed as independent tasks, after which the
+      // stages of the outer levels are split evenly across the tasks
+      const size_t num_tasks = size_t(1) << levels;
+      ThreadPool& pool = ThreadPool::GetInstance();
+      const uint64_t block_size = n >> levels;
+      pool.ParallelFor(num_tasks, [&](size_t block) {
+        uint64_t offset = block * block_size;
+        InvCompactBlock(kernel, result + offset, operand + offset, block_size,
+                        (1ULL << levels) + block, levels, 2);
+      });
+      for (uint64_t level = levels - 1; level > 0; --level) {
+        const size_t tasks_per_block = num_tasks >> level;
+        const size_t t = n >> (level + 1);
+        const size_t chunk = t / tasks_per_block;
+        pool.ParallelFor(num_tasks, [&](size_t task) {
+          size_t block = task / tasks_per_block;
+          size_t offset = 2 * t * block + chunk * (task % tasks_per_block);
+          kernel.InvButterflies(result + offset, result + offset + t,
+                                result + offset, result + offset + t, chunk,
+                                (1ULL << level) + block);
+        });
+      }
+      const uint64_t inv_n = InverseMod(n, modulus);
+      const uint64_t inv_n_w =
+          MultiplyMod(inv_n, kernel.Roots().low[1], modulus);
+      const size_t chunk = half_n / num_tasks;
+      pool.ParallelFor(num_tasks, [&](size_t task) {
+        uint64_t* X = result + task * chunk;
+        kernel.InvFinalButterflies(X, X + half_n, chunk, inv_n, inv_n_w,
+                                   output_mod_factor);
+      });
+      return;
+    }
+
+    InvCompactBlock(kernel, result, operand, half_n, 2 * root_index,
+                    recursion_depth + 1, 2);
+    InvCompactBlock(kernel, result + half_n, operand + half_n, half_n,
+                    2 * root_index + 1, recursion_depth + 1, 2);
+  } else {
+    // Breadth-first within the cache-resident block, except for the final
+    // stage
+    const uint64_t* input = operand;
+    for (uint64_t m = half_n, t = 1; m > 1; m >>= 1, t <<= 1) {
+      kernel.InvStage(result, input, t, m, root_index * m);
+      input = result;
+    }
+    if (input != result) {
+      std::memcpy(result, operand, n * sizeof(uint64_t));
+    }
+  }
+
+  if (recursion_depth > 0) {
+    kernel.InvButterflies(result, result + half_n, result, result + half_n,
+                          half_n, root_index);
+    return;
+  }
+
+  // Final stage, fused with the multiplication by n^{-1}. The root of unity
+  // W[1] is stored in the low factors.
+  const uint64_t inv_n = InverseMod(n, modulus);
+  kernel.InvFinalButterflies(result, result + half_n, half_n, inv_n,
+                             MultiplyMod(inv_n, kernel.Roots().low[1], modulus),
+                             output_mod_factor);
+}
+
+/// @brief Computes the forward NTT of size \p n with compact roots of unity
+/// with the butterflies of \p kernel. Assumes \p operand in [0, 4q) and
+/// returns \p result in [0, output_mod_factor * q), for output_mod_factor 1 or
+/// 4.
+template <typename Kernel>
+void ForwardTransformCompact(const Kernel& kernel, uint64_t* result,
+                             const uint64_t* operand, uint64_t n,
+                             uint64_t output_mod_factor) {
+  if (n == 1) {
+    result[0] = operand[0];
+  } else {
+    FwdCompactBlock(kernel, result, operand, n, 1, 0);
+  }
+  if (output_mod_factor == 1) {
+    EltwiseReduceMod(result, result, n, kernel.Modulus(), 4, 1);
+  }
+}
+
+/// @brief Computes the inverse NTT of size \p n with compact roots of unity
+/// with the butterflies of \p kernel. Assumes \p operand in [0, 2q) and
+/// returns \p result in [0, output_mod_factor * q), for output_mod_factor 1 or
+/// 2.
+template <typename Kernel>
+void InverseTransformCompact(const Kernel& kernel, uint64_t* result,
+                             const uint64_t* operand, uint64_t n,
+                             uint64_t output_mod_factor) {
+  if (n == 1) {
+    result[0] = (output_mod_factor == 1)
+                    ? ReduceMod<2>(operand[0], kernel.Modulus())
+                    : operand[0];
+    return;
+  }
+  InvCompactBlock(kernel, result, operand, n, 1, 0, output_mod_factor);
+}
+
+}  // namespace hexl
+}  // namespace intel
@@ -6,6 +6,7 @@
 #include "hexl/logging/logging.hpp"
 #include "hexl/number-theory/number-theory.hpp"
 #include "hexl/util/check.hpp"
+#include "util/thread-pool.hpp"
 
 namespace intel {
 namespace hexl {
@@ -155,5 +156,282 @@ inline void InvButterflyRadix4(uint64_t* X_r0, uint64_t* X_r1, uint64_t* X_r2,
                                                   << " X_r3 " << *X_r3);
 }
 
+/// @brief Performs the outermost stages of a block of a depth-first forward
+/// NTT. Assumes \p operand in [0, 4q) and returns \p result in [0, 4q).
+/// @param[out] result Output data
+/// @param[in] operand Input data
+/// @param[in] n Size of the block
+/// @param[in] modulus Prime modulus q
+/// @param[in] root_of_unity_powers Powers of 2N'th root of unity in F_q, in
+/// bit-reversed order, for the full transform of size N
+/// @param[in] precon_root_of_unity_powers Pre-conditioned \p
+/// root_of_unity_powers for 64-bit Barrett reduction
+/// @param[in] root_index Index of the root of unity of the first stage of the
+/// block, i.e. 2^recursion_depth + recursion_half
+/// @param[in] num_stages Number of stages to perform. Must be 1 or 2; two
+/// stages are fused into a single radix-4 pass over the block.
+inline void FwdOuterStages(uint64_t* result, const uint64_t* operand,
+                           uint64_t n, uint64_t modulus,
+                           const uint64_t* root_of_unity_powers,
+                           const uint64_t* precon_root_of_unity_powers,
+                           uint64_t root_index, uint64_t num_stages) {
+  uint64_t twice_modulus = modulus << 1;
+  uint64_t four_times_modulus = modulus << 2;
+
+  if (num_stages == 1) {
+    size_t t = (n >> 1);
+    const uint64_t W = root_of_unity_powers[root_index];
+    const uint64_t W_precon = precon_root_of_unity_powers[root_index];
+    HEXL_LOOP_UNROLL_8
+    for (size_t j = 0; j < t; j++) {
+      FwdButterflyRadix2(&result[j], &result[j + t], &operand[j],
+                         &operand[j + t], W, W_precon, modulus, twice_modulus);
+    }
+    return;
+  }
+
+  size_t t = (n >> 2);
+  const uint64_t W1 = root_of_unity_powers[root_index];
+  const uint64_t W2 = root_of_unity_powers[2 * root_index];
+  const uint64_t W3 = root_of_unity_powers[2 * root_index + 1];
+  const uint64_t W1_precon = precon_root_of_unity_powers[root_index];
+  const uint64_t W2_precon = precon_root_of_unity_powers[2 * root_index];
+  const uint64_t W3_precon = precon_root_of_unity_powers[2 * root_index + 1];
+  HEXL_LOOP_UNROLL_4
+  for (size_t j = 0; j < t; j++) {
+    FwdButterflyRadix4(&result[j], &result[j + t], &result[j + 2 * t],
+                       &result[j + 3 * t], &operand[j], &operand[j + t],
+                       &operand[j + 2 * t], &operand[j + 3 * t], W1, W1_precon,
+                       W2, W2_precon, W3, W3_precon, modulus, twice_modulus,
+                       four_times_modulus);
+  }
+}
+
+/// @brief Returns the index into the inverse root of unity powers of the
+/// first root used by the inverse NTT stage with \p m butterfly groups of a
+/// block at depth \p recursion_depth of a transform of size \p N
+inline uint64_t InvRootIndex(uint64_t N, uint64_t m, uint64_t recursion_depth,
+                             uint64_t recursion_half) {
+  // Stages are stored consecutively, starting with the N/2 roots of the stage
+  // with N/2 groups at index 1
+  return N - 2 * (m << recursion_depth) + 1 + recursion_half * m;
+}
+
+/// @brief Performs one in-place inverse NTT stage with \p m butterfly groups
+/// on a block of size \p n. Assumes inputs in [0, 2q) and returns outputs in
+/// [0, 2q).
+/// @param[in, out] result Data of the block
+/// @param[in] n Size of the block
+/// @param[in] m Number of butterfly groups in the stage
+/// @param[in] modulus Prime modulus q
+/// @param[in] W Inverse roots of unity of the \p m groups
+/// @param[in] W_precon Pre-conditioned \p W for 64-bit Barrett reduction
+inline void InvStage(uint64_t* result, uint64_t n, uint64_t m,
+                     uint64_t modulus, const uint64_t* W,
+                     const uint64_t* W_precon) {
+  uint64_t twice_modulus = modulus << 1;
+  size_t t = n / (2 * m);
+  for (size_t i = 0; i < m; i++) {
+    uint64_t* X = result + 2 * i * t;
+    uint64_t* Y = X + t;
+    HEXL_LOOP_UNROLL_8
+    for (size_t j = 0; j < t; j++) {
+      InvButterflyRadix2(&X[j], &Y[j], &X[j], &Y[j], W[i], W_precon[i],
+                         modulus, twice_modulus);
+    }
+  }
+}
+
+/// @brief Performs the two outermost stages of a block of a depth-first
+/// inverse NTT, fused into a single in-place radix-4 pass over the block.
+/// Assumes inputs in [0, 2q) and returns outputs in [0, 2q).
+/// @param[in, out] result Data of the block
+/// @param[in] n Size of the block
+/// @param[in] modulus Prime modulus q
+/// @param[in] W1 Inverse roots of unity of the two groups of the first stage
+/// @param[in] W1_precon Pre-conditioned \p W1 for 64-bit Barrett reduction
+/// @param[in] W2 Inverse root of unity of the second stage
+/// @param[in] W2_precon Pre-conditioned \p W2 for 64-bit Barrett reduction
+inline void InvOuterStagesRadix4(uint64_t* result, uint64_t n, uint64_t modulus,
+                                 const uint64_t* W1, const uint64_t* W1_precon,
+                                 uint64_t W2, uint64_t W2_precon) {
+  uint64_t twice_modulus = modulus << 1;
+  size_t t = (n >> 2);
+  uint64_t* X0 = result;
+  uint64_t* X1 = X0 + t;
+  uint64_t* X2 = X0 + 2 * t;
+  uint64_t* X3 = X0 + 3 * t;
+  HEXL_LOOP_UNROLL_4
+  for (size_t j = 0; j < t; j++) {
+    InvButterflyRadix4(&X0[j], &X1[j], &X2[j], &X3[j], &X0[j], &X1[j], &X2[j],
+                       &X3[j], W1[0], W1_precon[0], W1[1], W1_precon[1], W2,
+                       W2_precon, modulus, twice_modulus);
+  }
+}
+
+/// @brief Performs \p count butterflies of the final inverse NTT stage, with
+/// the multiplication by N^{-1} folded in. Assumes \p X, \p Y in [0, 2q) and
+/// computes X' = N^{-1} (X + Y) + a, Y' = N^{-1} W (X - Y) + a (mod q) in [0,
+/// output_mod_factor * q).
+/// @param[in, out] X Butterfly data
+/// @param[in, out] Y Butterfly data
+/// @param[in] count Number of butterflies
+/// @param[in] modulus Prime modulus q
+/// @param[in] inv_n N^{-1} mod q, optionally times an output scalar
+/// @param[in] inv_n_w N^{-1} W mod q, times the same output scalar
+/// @param[in] output_mod_factor Must be 1 or 2
+/// @param[in] addend Additive correction a in [0, q)
+inline void InvFinalButterflies(uint64_t* X, uint64_t* Y, size_t count,
+                                uint64_t modulus, uint64_t inv_n,
+                                uint64_t inv_n_w, uint64_t output_mod_factor,
+                                uint64_t addend = 0) {
+  uint64_t twice_modulus = modulus << 1;
+  uint64_t inv_n_precon = MultiplyFactor(inv_n, 64, modulus).BarrettFactor();
+  uint64_t inv_n_w_precon =
+      MultiplyFactor(inv_n_w, 64, modulus).BarrettFactor();
+
+  for (size_t j = 0; j < count; ++j) {
+    uint64_t tx = AddUIntMod(X[j], Y[j], twice_modulus);
+    uint64_t ty = X[j] + twice_modulus - Y[j];
+    X[j] = MultiplyModLazy<64>(tx, inv_n, inv_n_precon, modulus);
+    Y[j] = MultiplyModLazy<64>(ty, inv_n_w, inv_n_w_precon, modulus);
+  }
+
+  if (addend != 0) {
+    // Reduce to [0, q) before adding the correction, so the sum is in [0, 2q)
+    for (size_t j = 0; j < count; ++j) {
+      X[j] = ReduceMod<2>(X[j], modulus) + addend;
+      Y[j] = ReduceMod<2>(Y[j], modulus) + addend;
+    }
+  }
+
+  if (output_mod_factor == 1) {
+    // Reduce from [0, 2q) to [0,q)
+    for (size_t j = 0; j < count; ++j) {
+      X[j] = ReduceMod<2>(X[j], modulus);
+      Y[j] = ReduceMod<2>(Y[j], modulus);
+      HEXL_CHECK(X[j] < modulus && Y[j] < modulus,
+                 "Incorrect modulus reduction in InvNTT");
+    }
+  }
+}
+
+/// @brief Computes a forward NTT of size \p n in parallel. The stages of the
+/// outer \p levels recursion levels are split evenly across 2^levels tasks per
+/// stage, after which the 2^levels blocks are transformed as independent tasks.
+/// @param[out] result Output data
+/// @param[in] operand Input data, in [0, 4q)
+/// @param[in] n Size of the transform
+/// @param[in] modulus Prime modulus q
+/// @param[in] root_of_unity_powers Powers of 2n'th root of unity in F_q, in
+/// bit-reversed order
+/// @param[in] precon_root_of_unity_powers Pre-conditioned \p
+/// root_of_unity_powers for 64-bit Barrett reduction
+/// @param[in] levels Number of recursion levels, as returned by
+/// ParallelNTTLevels
+/// @param[in] sub_transform Called as sub_transform(block, block_size, levels,
+/// index) to transform the block of the given index in place, with inputs in
+/// [0, 4q)
+template <typename SubTransform>
+void FwdParallelLevels(uint64_t* result, const uint64_t* operand, uint64_t n,
+                       uint64_t modulus, const uint64_t* root_of_unity_powers,
+                       const uint64_t* precon_root_of_unity_powers,
+                       uint64_t levels, SubTransform sub_transform) {
+  uint64_t twice_modulus = modulus << 1;
+  const size_t num_tasks = size_t(1) << levels;
+  ThreadPool& pool = ThreadPool::GetInstance();
+
+  for (uint64_t level = 0; level < levels; ++level) {
+    // Each block of this level is split evenly across tasks_per_block tasks
+    const size_t tasks_per_block = num_tasks >> level;
+    const size_t t = n >> (level + 1);
+    const size_t chunk = t / tasks_per_block;
+    const uint64_t* level_operand = (level == 0) ? operand : result;
+    pool.ParallelFor(num_tasks, [&](size_t task) {
+      size_t block = task / tasks_per_block;
+      size_t offset = 2 * t * block + chunk * (task % tasks_per_block);
+      uint64_t W_idx = (1ULL << level) + block;
+      const uint64_t W = root_of_unity_powers[W_idx];
+      const uint64_t W_precon = precon_root_of_unity_powers[W_idx];
+      for (size_t j = offset; j < offset + chunk; ++j) {
+        FwdButterflyRadix2(&result[j], &result[j + t], &level_operand[j],
+                           &level_operand[j + t], W, W_precon, modulus,
+                           twice_modulus);
+      }
+    });
+  }
+
+  const uint64_t block_size = n >> levels;
+  pool.ParallelFor(num_tasks, [&](size_t block) {
+    sub_transform(&result[block * block_size], block_size, levels, block);
+  });
+}
+
+/// @brief Computes an inverse NTT of size \p n in parallel. The 2^levels blocks
+/// of the innermost of the outer \p levels recursion levels are transformed as
+/// independent tasks, after which the stages of the outer recursion levels are
+/// split evenly across 2^levels tasks per stage.
+/// @param[out] result Output data, in [0, output_mod_factor * q)
+/// @param[in] n Size of the transform
+/// @param[in] modulus Prime modulus q
+/// @param[in] inv_root_of_unity_powers Powers of inverse 2n'th root of unity
+/// in F_q, in bit-reversed order
+/// @param[in] precon_inv_root_of_unity_powers Pre-conditioned \p
+/// inv_root_of_unity_powers for 64-bit Barrett reduction
+/// @param[in] output_mod_factor Must be 1 or 2
+/// @param[in] scalar Output scalar in [0, q), folded into the multiplication by
+/// N^{-1}
+/// @param[in] addend Additive correction in [0, q), added to each output
+/// @param[in] levels Number of recursion levels, as returned by
+/// ParallelNTTLevels
+/// @param[in] sub_transform Called as sub_transform(offset, block_size, levels,
+/// index) to transform the block of the given index, starting at \p offset in
+/// the operand and result, into \p result with outputs in [0, 2q)
+template <typename SubTransform>
+void InvParallelLevels(uint64_t* result, uint64_t n, uint64_t modulus,
+                       const uint64_t* inv_root_of_unity_powers,
+                       const uint64_t* precon_inv_root_of_unity_powers,
+                       uint64_t output_mod_factor, uint64_t scalar,
+                       uint64_t addend, uint64_t levels,
+                       SubTransform sub_transform) {
+  uint64_t twice_modulus = modulus << 1;
+  const size_t num_tasks = size_t(1) << levels;
+  ThreadPool& pool = ThreadPool::GetInstance();
+
+  const uint64_t block_size = n >> levels;
+  pool.ParallelFor(num_tasks, [&](size_t block) {
+    sub_transform(block * block_size, block_size, levels, block);
+  });
+
+  for (uint64_t level = levels - 1; level > 0; --level) {
+    const size_t tasks_per_block = num_tasks >> level;
+    const size_t t = n >> (level + 1);
+    const size_t chunk = t / tasks_per_block;
+    pool.ParallelFor(num_tasks, [&](size_t task) {
+      size_t block = task / tasks_per_block;
+      size_t offset = 2 * t * block + chunk * (task % tasks_per_block);
+      uint64_t W_idx = InvRootIndex(n, 1, level, block);
+      const uint64_t W = inv_root_of_unity_powers[W_idx];
+      const uint64_t W_precon = precon_inv_root_of_unity_powers[W_idx];
+      for (size_t j = offset; j < offset + chunk; ++j) {
+        InvButterflyRadix2(&result[j], &result[j + t], &result[j],
+                           &result[j + t], W, W_precon, modulus,
+                           twice_modulus);
+      }
+    });
+  }
+
+  // Final stage, folding in the multiplication by N^{-1} and the scalar
+  const uint64_t inv_n = MultiplyMod(InverseMod(n, modulus), scalar, modulus);
+  const uint64_t inv_n_w =
+      MultiplyMod(inv_n, inv_root_of_unity_powers[n - 1], modulus);
+  const size_t chunk = (n >> 1) / num_tasks;
+  pool.ParallelFor(num_tasks, [&](size_t task) {
+    uint64_t* X = result + task * chunk;
+    InvFinalButterflies(X, X + (n >> 1), chunk, modulus, inv_n, inv_n_w,
+                        output_mod_factor, addend);
+  });
+}
+
 }  // namespace hexl
 }  // namespace intel
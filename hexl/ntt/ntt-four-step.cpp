@@ -0,0 +1,150 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ntt/ntt-four-step.hpp"
+
+#include <algorithm>
+
+#include "hexl/eltwise/eltwise-mult-mod.hpp"
+#include "hexl/logging/logging.hpp"
+#include "hexl/number-theory/number-theory.hpp"
+#include "hexl/util/check.hpp"
+
+namespace intel {
+namespace hexl {
+
+FourStepNTT::FourStepNTT(uint64_t degree, uint64_t q, uint64_t root_of_unity,
+                         std::shared_ptr<AllocatorBase> alloc_ptr)
+    : m_degree(degree),
+      m_q(q),
+      m_row_size(1ULL << ((Log2(degree) + 1) / 2)),
+      m_column_size(degree / m_row_size),
+      m_alloc(alloc_ptr),
+      m_aligned_alloc(AlignedAllocator<uint64_t, 64>(m_alloc)),
+      m_row_ntt(m_row_size, q, PowMod(root_of_unity, m_column_size, q),
+                alloc_ptr),
+      m_column_ntt(m_column_size, q, PowMod(root_of_unity, m_row_size, q),
+                   alloc_ptr),
+      m_twiddles(m_aligned_alloc),
+      m_inv_twiddles(m_aligned_alloc) {
+  HEXL_CHECK(IsPowerOfTwo(degree),
+             "degree " << degree << " is not a power of 2");
+  HEXL_CHECK(degree >= 4, "degree " << degree << " must be at least 4");
+  HEXL_CHECK(q % (2 * degree) == 1, "modulus mod 2n != 1");
+
+  HEXL_VLOG(3, "Four-step NTT of degree " << degree << " with row size "
+                                          << m_row_size << " and column size "
+                                          << m_column_size);
+  ComputeTwiddles(root_of_unity);
+}
+
+size_t FourStepNTT::GetTableMemoryBytes() const {
+  return m_row_ntt.GetTableMemoryBytes() + m_column_ntt.GetTableMemoryBytes() +
+         (m_twiddles.size() + m_inv_twiddles.size()) * sizeof(uint64_t);
+}
+
+void FourStepNTT::ComputeTwiddles(uint64_t root_of_unity) {
+  // After the column transforms, row j2 holds the evaluations at
+  // X^N1 = w^(N1 * (2 * k2 + 1)), with k2 = bit_reverse(j2) and w the 2N'th
+  // root of unity. The roots X of these are w^(2 * k2 + 1 + 2 * N2 * k1), so
+  // scaling the i1'th coefficient by w^((2 * k2 + 1 - N2) * i1) turns the row
+  // into a negacyclic transform of size N1 using the root w^N2.
+  uint64_t inv_root_of_unity = InverseMod(root_of_unity, m_q);
+  uint64_t column_bits = Log2(m_column_size);
+
+  m_twiddles.resize(m_degree);
+  m_inv_twiddles.resize(m_degree);
+  for (size_t j2 = 0; j2 < m_column_size; ++j2) {
+    uint64_t exponent =
+        (2 * ReverseBits(j2, column_bits) + 1 + 2 * m_degree - m_column_size) %
+        (2 * m_degree);
+    uint64_t w = PowMod(root_of_unity, exponent, m_q);
+    uint64_t inv_w = PowMod(inv_root_of_unity, exponent, m_q);
+
+    uint64_t* twiddles = &m_twiddles[j2 * m_row_size];
+    uint64_t* inv_twiddles = &m_inv_twiddles[j2 * m_row_size];
+    twiddles[0] = 1;
+    inv_twiddles[0] = 1;
+    for (size_t i1 = 1; i1 < m_row_size; ++i1) {
+      twiddles[i1] = MultiplyMod(twiddles[i1 - 1], w, m_q);
+      inv_twiddles[i1] = MultiplyMod(inv_twiddles[i1 - 1], inv_w, m_q);
+    }
+  }
+}
+
+void FourStepNTT::ComputeForward(uint64_t* result, const uint64_t* operand,
+                                 uint64_t input_mod_factor,
+                                 uint64_t output_mod_factor) const {
+  const size_t N1 = m_row_size;
+  const size_t N2 = m_column_size;
+  const size_t block_size = std::min<size_t>(s_column_block_size, N1);
+
+  // Column transforms. Each block of columns is read and written in place, so
+  // result may alias operand.
+  AlignedVector64<uint64_t> columns(block_size * N2, 0, m_aligned_alloc);
+  for (size_t col = 0; col < N1; col += block_size) {
+    for (size_t i2 = 0; i2 < N2; ++i2) {
+      const uint64_t* row = operand + i2 * N1 + col;
+      for (size_t b = 0; b < block_size; ++b) {
+        columns[b * N2 + i2] = row[b];
+      }
+    }
+    for (size_t b = 0; b < block_size; ++b) {
+      uint64_t* column = &columns[b * N2];
+      m_column_ntt.ComputeForward(column, column, input_mod_factor, 1);
+    }
+    for (size_t j2 = 0; j2 < N2; ++j2) {
+      uint64_t* row = result + j2 * N1 + col;
+      for (size_t b = 0; b < block_size; ++b) {
+        row[b] = columns[b * N2 + j2];
+      }
+    }
+  }
+
+  // Twiddle multiplication and row transforms
+  for (size_t j2 = 0; j2 < N2; ++j2) {
+    uint64_t* row = result + j2 * N1;
+    EltwiseMultMod(row, row, &m_twiddles[j2 * N1], N1, m_q, 1);
+    m_row_ntt.ComputeForward(row, row, 1, output_mod_factor);
+  }
+}
+
+void FourStepNTT::ComputeInverse(uint64_t* result, const uint64_t* operand,
+                                 uint64_t input_mod_factor,
+                                 uint64_t output_mod_factor) const {
+  const size_t N1 = m_row_size;
+  const size_t N2 = m_column_size;
+  const size_t block_size = std::min<size_t>(s_column_block_size, N1);
+
+  // Row transforms and inverse twiddle multiplication. The row transforms
+  // scale by 1 / N1.
+  for (size_t j2 = 0; j2 < N2; ++j2) {
+    uint64_t* row = result + j2 * N1;
+    m_row_ntt.ComputeInverse(row, operand + j2 * N1, input_mod_factor, 1);
+    EltwiseMultMod(row, row, &m_inv_twiddles[j2 * N1], N1, m_q, 1);
+  }
+
+  // Column transforms, which scale by 1 / N2
+  AlignedVector64<uint64_t> columns(block_size * N2, 0, m_aligned_alloc);
+  for (size_t col = 0; col < N1; col += block_size) {
+    for (size_t j2 = 0; j2 < N2; ++j2) {
+      const uint64_t* row = result + j2 * N1 + col;
+      for (size_t b = 0; b < block_size; ++b) {
+        columns[b * N2 + j2] = row[b];
+      }
+    }
+    for (size_t b = 0; b < block_size; ++b) {
+      uint64_t* column = &columns[b * N2];
+      m_column_ntt.ComputeInverse(column, column, 1, output_mod_factor);
+    }
+    for (size_t i2 = 0; i2 < N2; ++i2) {
+      uint64_t* row = result + i2 * N1 + col;
+      for (size_t b = 0; b < block_size; ++b) {
+        row[b] = columns[b * N2 + i2];
+      }
+    }
+  }
+}
+
+}  // namespace hexl
+}  // namespace intel
@@ -0,0 +1,97 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdint.h>
+
+#include <memory>
+
+#include "hexl/ntt/ntt.hpp"
+#include "hexl/util/aligned-allocator.hpp"
+#include "hexl/util/allocator.hpp"
+
+namespace intel {
+namespace hexl {
+
+/// @brief Negacyclic NTT of degree N = N1 * N2 computed via the four-step
+/// (Bailey) decomposition
+/// @details The operand is viewed as a row-major N2 x N1 matrix. The forward
+/// transform computes negacyclic NTTs of size N2 over the columns, multiplies
+/// by twiddle factors, and computes negacyclic NTTs of size N1 over the rows.
+/// The output is bit-reversed, identical to that of a direct transform of
+/// size N. The inverse transform performs these steps in reverse order. Each
+/// inner transform only touches N1 or N2 elements, so it stays cache-resident
+/// even when the full polynomial does not fit in cache.
+class FourStepNTT {
+ public:
+  /// @brief Initializes a four-step NTT of degree \p degree
+  /// @param[in] degree N. Must be a power of two, at least 4
+  /// @param[in] q Prime modulus. Must satisfy q == 1 mod 2N
+  /// @param[in] root_of_unity Primitive 2N'th root of unity in F_q
+  /// @param[in] alloc_ptr Custom memory allocator used for the tables
+  FourStepNTT(uint64_t degree, uint64_t q, uint64_t root_of_unity,
+              std::shared_ptr<AllocatorBase> alloc_ptr = {});
+
+  /// @brief Computes the forward NTT. Results are bit-reversed.
+  /// @param[out] result Stores the result
+  /// @param[in] operand Data on which to compute the NTT
+  /// @param[in] input_mod_factor Assume input \p operand are in [0,
+  /// input_mod_factor * q). Must be 1, 2 or 4.
+  /// @param[in] output_mod_factor Returns output \p result in [0,
+  /// output_mod_factor * q). Must be 1 or 4.
+  void ComputeForward(uint64_t* result, const uint64_t* operand,
+                      uint64_t input_mod_factor,
+                      uint64_t output_mod_factor) const;
+
+  /// @brief Computes the inverse NTT. Operands are bit-reversed.
+  /// @param[out] result Stores the result
+  /// @param[in] operand Data on which to compute the NTT
+  /// @param[in] input_mod_factor Assume input \p operand are in [0,
+  /// input_mod_factor * q). Must be 1 or 2.
+  /// @param[in] output_mod_factor Returns output \p result in [0,
+  /// output_mod_factor * q). Must be 1 or 2.
+  void ComputeInverse(uint64_t* result, const uint64_t* operand,
+                      uint64_t input_mod_factor,
+                      uint64_t output_mod_factor) const;
+
+  /// @brief Returns the degree N
+  uint64_t GetDegree() const { return m_degree; }
+
+  /// @brief Returns the row size N1, i.e. the size of the row transforms
+  uint64_t GetRowSize() const { return m_row_size; }
+
+  /// @brief Returns the column size N2, i.e. the size of the column transforms
+  uint64_t GetColumnSize() const { return m_column_size; }
+
+  /// @brief Returns the number of bytes of the twiddle factors and of the
+  /// tables of the row and column transforms
+  size_t GetTableMemoryBytes() const;
+
+ private:
+  // Number of adjacent columns gathered into contiguous buffers at a time, so
+  // that each row of the matrix is read one cache line at a time
+  static const size_t s_column_block_size{8};
+
+  void ComputeTwiddles(uint64_t root_of_unity);
+
+  uint64_t m_degree;       // N = N1 * N2
+  uint64_t m_q;            // prime modulus
+  uint64_t m_row_size;     // N1
+  uint64_t m_column_size;  // N2
+
+  std::shared_ptr<AllocatorBase> m_alloc;
+  AlignedAllocator<uint64_t, 64> m_aligned_alloc;
+
+  // Negacyclic NTTs of size N1 and N2 used for the rows and columns
+  mutable NTT m_row_ntt;
+  mutable NTT m_column_ntt;
+
+  // Row-major N2 x N1 twiddle factors applied between the column and row
+  // transforms, and their inverses
+  AlignedVector64<uint64_t> m_twiddles;
+  AlignedVector64<uint64_t> m_inv_twiddles;
+};
+
+}  // namespace hexl
+}  // namespace intel
@@ -3,171 +3,791 @@
 
 #include "ntt/ntt-internal.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
 #include <cstring>
+#include <map>
+#include <mutex>
 #include <utility>
+#include <vector>
 
+#include "hexl/eltwise/eltwise-add-mod.hpp"
+#include "hexl/eltwise/eltwise-fma-mod.hpp"
+#include "hexl/eltwise/eltwise-mult-mod.hpp"
 #include "hexl/logging/logging.hpp"
 #include "hexl/ntt/ntt.hpp"
 #include "hexl/number-theory/number-theory.hpp"
 #include "hexl/util/aligned-allocator.hpp"
 #include "hexl/util/check.hpp"
 #include "hexl/util/defines.hpp"
+#include "ntt/fwd-ntt-avx2.hpp"
 #include "ntt/fwd-ntt-avx512.hpp"
+#include "ntt/inv-ntt-avx2.hpp"
 #include "ntt/inv-ntt-avx512.hpp"
+#include "ntt/ntt-compact-avx2.hpp"
+#include "ntt/ntt-compact-avx512.hpp"
+#include "ntt/ntt-four-step.hpp"
+#include "ntt/ntt-montgomery-avx512.hpp"
+#include "ntt/ntt-montgomery.hpp"
+#include "ntt/ntt-tables-avx512.hpp"
+#include "util/cache-info.hpp"
 #include "util/cpu-features.hpp"
+#include "util/util-internal.hpp"
 
 namespace intel {
 namespace hexl {
 
 AllocatorStrategyPtr mallocStrategy = AllocatorStrategyPtr(new MallocStrategy);
 
+void ComputeBarrettFactors(uint64_t* result, const uint64_t* operand,
+                           uint64_t n, uint64_t bit_shift, uint64_t modulus) {
+  HEXL_CHECK(bit_shift == 32 || bit_shift == 52 || bit_shift == 64,
+             "Unsupported BitShift " << bit_shift);
+  HEXL_CHECK(modulus % 2 == 1, "modulus " << modulus << " must be odd");
+  HEXL_CHECK_BOUNDS(operand, n, modulus, "operand exceeds bound " << modulus);
+
+#ifdef HEXL_HAS_AVX512DQ
+  if (has_avx512dq && modulus < (1ULL << 63)) {
+    uint64_t n_mod_8 = n % 8;
+    ComputeBarrettFactorsAVX512(result, operand, n - n_mod_8, bit_shift,
+                                modulus);
+    result += n - n_mod_8;
+    operand += n - n_mod_8;
+    n = n_mod_8;
+  }
+#endif
+
+  // With r = (x << bit_shift) mod q, the factor is the exact quotient
+  // ((x << bit_shift) - r) / q < 2^64. Since q is odd, it equals
+  // ((x << bit_shift) - r) * q^{-1} mod 2^64, and r is computed with a
+  // Shoup multiplication by 2^bit_shift mod q.
+  uint64_t shift_mod = (bit_shift == 64) ? (0 - modulus) % modulus
+                                         : (1ULL << bit_shift) % modulus;
+  uint64_t shift_mod_precon =
+      MultiplyFactor(shift_mod, 64, modulus).BarrettFactor();
+  // Newton iteration for q^{-1} mod 2^64, doubling the correct bits from 3
+  uint64_t inv_modulus = modulus;
+  for (size_t i = 0; i < 5; ++i) {
+    inv_modulus *= 2 - modulus * inv_modulus;
+  }
+
+  for (size_t i = 0; i < n; ++i) {
+    uint64_t rem =
+        MultiplyMod(operand[i], shift_mod, shift_mod_precon, modulus);
+    uint64_t x_shift = (bit_shift == 64) ? 0 : (operand[i] << bit_shift);
+    result[i] = (x_shift - rem) * inv_modulus;
+  }
+}
+
 NTT::NTT(uint64_t degree, uint64_t q, uint64_t root_of_unity,
          std::shared_ptr<AllocatorBase> alloc_ptr)
     : m_degree(degree),
       m_q(q),
       m_w(root_of_unity),
       m_alloc(alloc_ptr),
-      m_aligned_alloc(AlignedAllocator<uint64_t, 64>(m_alloc)),
-      m_root_of_unity_powers(m_aligned_alloc),
-      m_precon32_root_of_unity_powers(m_aligned_alloc),
-      m_precon64_root_of_unity_powers(m_aligned_alloc),
-      m_avx512_root_of_unity_powers(m_aligned_alloc),
-      m_avx512_precon32_root_of_unity_powers(m_aligned_alloc),
-      m_avx512_precon52_root_of_unity_powers(m_aligned_alloc),
-      m_avx512_precon64_root_of_unity_powers(m_aligned_alloc),
-      m_precon32_inv_root_of_unity_powers(m_aligned_alloc),
-      m_precon52_inv_root_of_unity_powers(m_aligned_alloc),
-      m_precon64_inv_root_of_unity_powers(m_aligned_alloc),
-      m_inv_root_of_unity_powers(m_aligned_alloc) {
+      m_aligned_alloc(AlignedAllocator<uint64_t, 64>(m_alloc)) {
   HEXL_CHECK(CheckArguments(degree, q), "");
   HEXL_CHECK(IsPrimitiveRoot(m_w, 2 * degree, q),
              m_w << " is not a primitive 2*" << degree << "'th root of unity");
 
   m_degree_bits = Log2(m_degree);
   m_w_inv = InverseMod(m_w, m_q);
-  ComputeRootOfUnityPowers();
+  if (m_degree_bits > MaxDirectDegreeBits()) {
+    m_four_step = std::make_shared<FourStepNTT>(m_degree, m_q, m_w, m_alloc);
+    return;
+  }
+  m_tables = std::make_shared<LazyTables>(m_aligned_alloc);
+  SetTwiddleMode(GetDefaultTwiddleMode());
+  ComputeDispatchedTables();
+  SelectNativeRadix();
 }
 
 NTT::NTT(uint64_t degree, uint64_t q, std::shared_ptr<AllocatorBase> alloc_ptr)
     : NTT(degree, q, MinimalPrimitiveRoot(2 * degree, q), alloc_ptr) {}
 
+NTT NTT::CreateCyclic(uint64_t degree, uint64_t q,
+                      std::shared_ptr<AllocatorBase> alloc_ptr) {
+  HEXL_CHECK(CheckCyclicArguments(degree, q), "");
+  return CreateCyclic(degree, q, MinimalPrimitiveRoot(degree, q),
+                      std::move(alloc_ptr));
+}
+
+NTT NTT::CreateCyclic(uint64_t degree, uint64_t q, uint64_t root_of_unity,
+                      std::shared_ptr<AllocatorBase> alloc_ptr) {
+  HEXL_CHECK(CheckCyclicArguments(degree, q), "");
+  HEXL_CHECK(degree >= 2 && degree <= (1ULL << MaxDirectDegreeBits()),
+             "degree should be in [2, 2^" << MaxDirectDegreeBits() << "]; got "
+                                          << degree);
+  HEXL_CHECK(IsPrimitiveRoot(root_of_unity, degree, q),
+             root_of_unity << " is not a primitive " << degree
+                           << "'th root of unity");
+
+  NTT ntt;
+  ntt.m_degree = degree;
+  ntt.m_q = q;
+  ntt.m_w = root_of_unity;
+  ntt.m_degree_bits = Log2(degree);
+  ntt.m_w_inv = InverseMod(root_of_unity, q);
+  ntt.m_alloc = std::move(alloc_ptr);
+  ntt.m_aligned_alloc = AlignedAllocator<uint64_t, 64>(ntt.m_alloc);
+  ntt.m_tables = std::make_shared<LazyTables>(ntt.m_aligned_alloc);
+  ntt.m_cyclic = true;
+  ntt.SetTwiddleMode(GetDefaultTwiddleMode());
+  ntt.ComputeDispatchedTables();
+  ntt.SelectNativeRadix();
+  return ntt;
+}
+
+NTT NTT::CreateSubNTT(uint64_t degree) const {
+  HEXL_CHECK(IsPowerOfTwo(degree),
+             "degree " << degree << " is not a power of 2");
+  HEXL_CHECK(degree <= m_degree,
+             "degree " << degree << " exceeds master degree " << m_degree);
+  uint64_t root_of_unity = PowMod(m_w, m_degree / degree, m_q);
+  if (m_cyclic && degree == 1) {
+    // Both transforms of degree 1 are the identity
+    return NTT(degree, m_q, m_q - 1, m_alloc);
+  }
+  if (m_tables == nullptr || Log2(degree) > MaxDirectDegreeBits()) {
+    return NTT(degree, m_q, root_of_unity, m_alloc);
+  }
+
+  NTT ntt;
+  ntt.m_degree = degree;
+  ntt.m_q = m_q;
+  ntt.m_w = root_of_unity;
+  ntt.m_degree_bits = Log2(degree);
+  ntt.m_w_inv = InverseMod(root_of_unity, m_q);
+  ntt.m_alloc = m_alloc;
+  ntt.m_aligned_alloc = m_aligned_alloc;
+  ntt.m_tables = std::make_shared<LazyTables>(m_aligned_alloc);
+  ntt.m_tables->master = (m_tables->master != nullptr)
+                             ? m_tables->master
+                             : std::make_shared<const NTT>(*this);
+  ntt.m_twiddle_mode = m_twiddle_mode;
+  ntt.m_cyclic = m_cyclic;
+  ntt.ComputeDispatchedTables();
+  ntt.SelectNativeRadix();
+  return ntt;
+}
+
 NTT::~NTT() = default;
 
-void NTT::ComputeRootOfUnityPowers() {
-  AlignedVector64<uint64_t> root_of_unity_powers(m_degree, 0, m_aligned_alloc);
-  AlignedVector64<uint64_t> inv_root_of_unity_powers(m_degree, 0,
-                                                     m_aligned_alloc);
-
-  // 64-bit preconditioned inverse and root of unity powers
-  root_of_unity_powers[0] = 1;
-  inv_root_of_unity_powers[0] = InverseMod(1, m_q);
-  uint64_t idx = 0;
-  uint64_t prev_idx = idx;
-
-  for (size_t i = 1; i < m_degree; i++) {
-    idx = ReverseBits(i, m_degree_bits);
-    root_of_unity_powers[idx] =
-        MultiplyMod(root_of_unity_powers[prev_idx], m_w, m_q);
-    inv_root_of_unity_powers[idx] = InverseMod(root_of_unity_powers[idx], m_q);
-
-    prev_idx = idx;
-  }
-
-  m_root_of_unity_powers = root_of_unity_powers;
-  m_avx512_root_of_unity_powers = m_root_of_unity_powers;
-
-  // Duplicate each root of unity at indices [N/4, N/2].
-  // These are the roots of unity used in the FwdNTT FwdT2 function
-  // By creating these duplicates, we avoid extra permutations while loading the
-  // roots of unity
-  AlignedVector64<uint64_t> W2_roots;
-  W2_roots.reserve(m_degree / 2);
-  for (size_t i = m_degree / 4; i < m_degree / 2; ++i) {
-    W2_roots.push_back(m_root_of_unity_powers[i]);
-    W2_roots.push_back(m_root_of_unity_powers[i]);
-  }
-  m_avx512_root_of_unity_powers.erase(
-      m_avx512_root_of_unity_powers.begin() + m_degree / 4,
-      m_avx512_root_of_unity_powers.begin() + m_degree / 2);
-  m_avx512_root_of_unity_powers.insert(
-      m_avx512_root_of_unity_powers.begin() + m_degree / 4, W2_roots.begin(),
-      W2_roots.end());
-
-  // Duplicate each root of unity at indices [N/8, N/4].
-  // These are the roots of unity used in the FwdNTT FwdT4 function
-  // By creating these duplicates, we avoid extra permutations while loading the
-  // roots of unity
-  AlignedVector64<uint64_t> W4_roots;
-  W4_roots.reserve(m_degree / 2);
-  for (size_t i = m_degree / 8; i < m_degree / 4; ++i) {
-    W4_roots.push_back(m_root_of_unity_powers[i]);
-    W4_roots.push_back(m_root_of_unity_powers[i]);
-    W4_roots.push_back(m_root_of_unity_powers[i]);
-    W4_roots.push_back(m_root_of_unity_powers[i]);
-  }
-  m_avx512_root_of_unity_powers.erase(
-      m_avx512_root_of_unity_powers.begin() + m_degree / 8,
-      m_avx512_root_of_unity_powers.begin() + m_degree / 4);
-  m_avx512_root_of_unity_powers.insert(
-      m_avx512_root_of_unity_powers.begin() + m_degree / 8, W4_roots.begin(),
-      W4_roots.end());
-
-  auto compute_barrett_vector = [&](const AlignedVector64<uint64_t>& values,
-                                    uint64_t bit_shift) {
-    AlignedVector64<uint64_t> barrett_vector(m_aligned_alloc);
-    for (uint64_t value : values) {
-      MultiplyFactor mf(value, bit_shift, m_q);
-      barrett_vector.push_back(mf.BarrettFactor());
+const AlignedVector64<uint64_t>& NTT::GetTable(Table table) const {
+  if (m_tables == nullptr) {
+    // Empty or four-step NTT
+    static const AlignedVector64<uint64_t> empty_table;
+    return empty_table;
+  }
+  size_t index = static_cast<size_t>(table);
+  std::call_once(m_tables->built[index], [&]() {
+    const uint64_t* view = m_tables->views[index];
+    if (view != nullptr) {
+      m_tables->tables[index].assign(view, view + m_tables->view_sizes[index]);
+    } else {
+      m_tables->tables[index] = ComputeTable(table);
+    }
+    m_tables->num_bytes += m_tables->tables[index].size() * sizeof(uint64_t);
+  });
+  return m_tables->tables[index];
+}
+
+const uint64_t* NTT::GetTableData(Table table) const {
+  if (m_tables != nullptr) {
+    const uint64_t* view = m_tables->views[static_cast<size_t>(table)];
+    if (view != nullptr) {
+      return view;
+    }
+    if (m_tables->master != nullptr) {
+      const NTT& master = *m_tables->master;
+      switch (table) {
+        // The first m_degree roots of the master NTT, in bit-reversed order,
+        // are the roots of this NTT
+        case Table::RootOfUnityPowers:
+        case Table::Precon32RootOfUnityPowers:
+        case Table::Precon64RootOfUnityPowers:
+        case Table::Montgomery52RootOfUnityPowers:
+        case Table::Montgomery64RootOfUnityPowers:
+          return master.GetTableData(table);
+        // The inverse roots of the last log2(m_degree) stages of the master
+        // NTT are those of this NTT. The first element, which is 1 and not
+        // read by the transforms, differs.
+        case Table::InvRootOfUnityPowers:
+        case Table::Precon32InvRootOfUnityPowers:
+        case Table::Precon52InvRootOfUnityPowers:
+        case Table::Precon64InvRootOfUnityPowers:
+        case Table::Montgomery52InvRootOfUnityPowers:
+        case Table::Montgomery64InvRootOfUnityPowers:
+          return master.GetTableData(table) + (master.m_degree - m_degree);
+        // The AVX512 layout duplicates roots depending on the degree
+        default:
+          break;
+      }
     }
+  }
+  return GetTable(table).data();
+}
+
+bool NTT::UsesAVX512Layout() const {
+  if (m_degree < 16) {
+    return false;
+  }
+  bool has_avx = false;
+#ifdef HEXL_HAS_AVX512IFMA
+  has_avx = has_avx || (has_avx512ifma && (m_q < s_max_fwd_ifma_modulus));
+#endif
+#ifdef HEXL_HAS_AVX512DQ
+  has_avx = has_avx || has_avx512dq;
+#endif
+#ifdef HEXL_HAS_AVX256
+  has_avx = has_avx || has_avx2;
+#endif
+  return has_avx;
+}
+
+uint64_t NTT::MontgomeryBitShift() const {
+#ifdef HEXL_HAS_AVX512IFMA
+  if (has_avx512ifma && (m_q < s_max_ifma_modulus) && (m_degree >= 16)) {
+    return s_ifma_shift_bits;
+  }
+#endif
+  return s_default_shift_bits;
+}
+
+uint64_t NTT::CompactBitShift() const {
+#ifdef HEXL_HAS_AVX512IFMA
+  if (has_avx512ifma && (m_q < s_max_fwd_ifma_modulus) && (m_degree >= 32)) {
+    return s_ifma_shift_bits;
+  }
+#endif
+  return s_default_shift_bits;
+}
+
+NTT::Table NTT::CompactPreconTable(bool inverse) const {
+  if (CompactBitShift() == s_ifma_shift_bits) {
+    return inverse ? Table::Precon52CompactInvRootOfUnityPowers
+                   : Table::Precon52CompactRootOfUnityPowers;
+  }
+  return inverse ? Table::Precon64CompactInvRootOfUnityPowers
+                 : Table::Precon64CompactRootOfUnityPowers;
+}
+
+bool NTT::UsesFullyReducedIFMA() const {
+  return (m_twiddle_mode != TwiddleMode::Compact) &&
+         (MontgomeryBitShift() == s_ifma_shift_bits) &&
+         (m_q >= s_max_fwd_ifma_modulus);
+}
+
+NTT::Table NTT::MontgomeryTable(bool inverse) const {
+  if (MontgomeryBitShift() == s_ifma_shift_bits) {
+    return inverse ? Table::Montgomery52InvRootOfUnityPowers
+                   : Table::Montgomery52RootOfUnityPowers;
+  }
+  return inverse ? Table::Montgomery64InvRootOfUnityPowers
+                 : Table::Montgomery64RootOfUnityPowers;
+}
+
+const uint64_t* NTT::GetDispatchedRootOfUnityPowers() const {
+  if (m_tables == nullptr) {
+    return nullptr;
+  }
+  if (m_twiddle_mode == TwiddleMode::Compact) {
+    return GetTableData(Table::CompactRootOfUnityPowers);
+  }
+  if (m_twiddle_mode == TwiddleMode::Montgomery || UsesFullyReducedIFMA()) {
+    return GetTableData(MontgomeryTable(false));
+  }
+  return UsesAVX512Layout() ? GetTableData(Table::AVX512RootOfUnityPowers)
+                            : GetTableData(Table::RootOfUnityPowers);
+}
+
+const uint64_t* NTT::GetDispatchedInvRootOfUnityPowers() const {
+  if (m_tables == nullptr) {
+    return nullptr;
+  }
+  if (m_twiddle_mode == TwiddleMode::Compact) {
+    return GetTableData(Table::CompactInvRootOfUnityPowers);
+  }
+  if (m_twiddle_mode == TwiddleMode::Montgomery || UsesFullyReducedIFMA()) {
+    return GetTableData(MontgomeryTable(true));
+  }
+  return GetTableData(Table::InvRootOfUnityPowers);
+}
+
+size_t NTT::GetTableMemoryBytes() const {
+  if (m_four_step) {
+    return m_four_step->GetTableMemoryBytes();
+  }
+  return m_tables ? m_tables->num_bytes.load() : 0;
+}
+
+void NTT::ComputeDispatchedTables() {
+  // Mirrors the dispatch in ComputeForward and InverseTransform
+  if (m_twiddle_mode == TwiddleMode::Compact) {
+    GetTableData(CompactPreconTable(false));
+    GetTableData(CompactPreconTable(true));
+    return;
+  }
+  if (m_twiddle_mode == TwiddleMode::Montgomery || UsesFullyReducedIFMA()) {
+    GetTableData(MontgomeryTable(false));
+    GetTableData(MontgomeryTable(true));
+    return;
+  }
+  if (!UsesAVX512Layout()) {
+    GetTableData(Table::Precon64RootOfUnityPowers);
+    GetTableData(Table::Precon64InvRootOfUnityPowers);
+    return;
+  }
+#ifdef HEXL_HAS_AVX512IFMA
+  if (has_avx512ifma && (m_q < s_max_fwd_ifma_modulus)) {
+    GetTableData(Table::AVX512Precon52RootOfUnityPowers);
+    GetTableData(Table::Precon52InvRootOfUnityPowers);
+    return;
+  }
+#endif
+  if (m_q < s_max_fwd_32_modulus) {
+    GetTableData(Table::AVX512Precon32RootOfUnityPowers);
+    GetTableData(Table::Precon32InvRootOfUnityPowers);
+  } else {
+    GetTableData(Table::AVX512Precon64RootOfUnityPowers);
+    GetTableData(Table::Precon64InvRootOfUnityPowers);
+  }
+}
+
+AlignedVector64<uint64_t> NTT::ComputeTable(Table table) const {
+  // The forward tables are read via GetTableData, which may return a view of
+  // the tables of a master NTT. The first element of such a view of an
+  // inverse table differs, so the inverse tables are read via GetTable.
+  auto compute_barrett_vector = [&](const uint64_t* values, size_t n,
+                                    uint64_t bit_shift) {
+    AlignedVector64<uint64_t> barrett_vector(n, 0, m_aligned_alloc);
+    ComputeBarrettFactors(barrett_vector.data(), values, n, bit_shift, m_q);
     return barrett_vector;
   };
+  auto compute_fwd_barrett_vector = [&](Table values, uint64_t bit_shift) {
+    return compute_barrett_vector(GetTableData(values),
+                                  TableSize(values, m_degree), bit_shift);
+  };
+  auto compute_inv_barrett_vector = [&](uint64_t bit_shift) {
+    const AlignedVector64<uint64_t>& values = GetInvRootOfUnityPowers();
+    return compute_barrett_vector(values.data(), values.size(), bit_shift);
+  };
 
-  m_precon32_root_of_unity_powers =
-      compute_barrett_vector(root_of_unity_powers, 32);
-  m_precon64_root_of_unity_powers =
-      compute_barrett_vector(root_of_unity_powers, 64);
+  // Stores the powers w^i for i in [0, n) at bit-reversed indices
+  auto compute_bit_reversed_powers = [&](uint64_t w, uint64_t n) {
+    AlignedVector64<uint64_t> powers(n, 0, m_aligned_alloc);
+    uint64_t w_precon = MultiplyFactor(w, 64, m_q).BarrettFactor();
+    uint64_t power = 1;
+    uint64_t idx = 0;
+    powers[0] = power;
+    for (size_t i = 1; i < n; i++) {
+      power = MultiplyMod(power, w, w_precon, m_q);
+      // Increment the bit-reversed index
+      uint64_t bit = n >> 1;
+      while (idx & bit) {
+        idx ^= bit;
+        bit >>= 1;
+      }
+      idx |= bit;
+      powers[idx] = power;
+    }
+    return powers;
+  };
 
-  // 52-bit preconditioned root of unity powers
-  if (has_avx512ifma) {
-    m_avx512_precon52_root_of_unity_powers =
-        compute_barrett_vector(m_avx512_root_of_unity_powers, 52);
+  // Stores the bit-reversed powers W[k] = w^{bitrev(k)} for k in [0, 2^b),
+  // followed by W[j * 2^b] for j in [0, N / 2^b), where b =
+  // CompactRootLowBits(N). Since bitrev(j * 2^b) = bitrev_{log2(N) - b}(j),
+  // and bitrev(k) for k < 2^b is a multiple of N / 2^b, both parts are
+  // bit-reversed powers.
+  auto compute_compact_powers = [&](uint64_t w) {
+    uint64_t low_size = 1ULL << CompactRootLowBits(m_degree);
+    AlignedVector64<uint64_t> powers = compute_bit_reversed_powers(
+        PowMod(w, m_degree / low_size, m_q), low_size);
+    AlignedVector64<uint64_t> high_powers =
+        compute_bit_reversed_powers(w, m_degree / low_size);
+    powers.insert(powers.end(), high_powers.begin(), high_powers.end());
+    return powers;
+  };
+
+  // Stores the powers w^i for i in [0, N) in natural order
+  auto compute_natural_powers = [&](uint64_t w) {
+    AlignedVector64<uint64_t> powers(m_degree, 0, m_aligned_alloc);
+    uint64_t w_precon = MultiplyFactor(w, 64, m_q).BarrettFactor();
+    powers[0] = 1;
+    for (size_t i = 1; i < m_degree; i++) {
+      powers[i] = MultiplyMod(powers[i - 1], w, w_precon, m_q);
+    }
+    return powers;
+  };
+
+  // Stores the roots of unity of the cyclic transform in the layout of the
+  // bit-reversed powers. The stage with m groups splits X^{N/m} - w^{N j / m}
+  // for j in [0, m), in bit-reversed order, using the roots W[m + j] =
+  // w^{bitrev(j)}, where bitrev reverses log2(N) - 1 bits.
+  auto compute_cyclic_powers = [&](uint64_t w) {
+    AlignedVector64<uint64_t> half_powers =
+        compute_bit_reversed_powers(w, m_degree / 2);
+    AlignedVector64<uint64_t> powers(m_degree, 1, m_aligned_alloc);
+    for (size_t m = 1; m < m_degree; m <<= 1) {
+      std::copy(half_powers.begin(), half_powers.begin() + m,
+                powers.begin() + m);
+    }
+    return powers;
+  };
+
+  auto compute_fwd_powers = [&]() {
+    return m_cyclic ? compute_cyclic_powers(m_w)
+                    : compute_bit_reversed_powers(m_w, m_degree);
+  };
+
+  // Stores the inverse powers w^{-i}, reordered so that the roots of each
+  // stage are contiguous
+  auto compute_inv_powers = [&]() {
+    AlignedVector64<uint64_t> bit_reversed_inv_powers =
+        m_cyclic ? compute_cyclic_powers(m_w_inv)
+                 : compute_bit_reversed_powers(m_w_inv, m_degree);
+    AlignedVector64<uint64_t> inv_root_of_unity_powers(m_degree, 0,
+                                                       m_aligned_alloc);
+    inv_root_of_unity_powers[0] = bit_reversed_inv_powers[0];
+    uint64_t idx = 1;
+    for (size_t m = (m_degree >> 1); m > 0; m >>= 1) {
+      for (size_t i = 0; i < m; i++) {
+        inv_root_of_unity_powers[idx] = bit_reversed_inv_powers[m + i];
+        idx++;
+      }
+    }
+    return inv_root_of_unity_powers;
+  };
+
+  // Converts the powers to Montgomery form w * 2^bit_shift mod q. The
+  // standard tables are not stored, so Montgomery mode keeps a single table
+  // per direction.
+  auto to_montgomery_form = [&](AlignedVector64<uint64_t> powers,
+                                uint64_t bit_shift) {
+    uint64_t r = ToMontgomeryForm(1, m_q, bit_shift);
+    uint64_t r_precon = MultiplyFactor(r, 64, m_q).BarrettFactor();
+    for (uint64_t& power : powers) {
+      power = MultiplyMod(power, r, r_precon, m_q);
+    }
+    return powers;
+  };
+
+  switch (table) {
+    case Table::RootOfUnityPowers:
+      return compute_fwd_powers();
+    case Table::Precon32RootOfUnityPowers:
+      return compute_fwd_barrett_vector(Table::RootOfUnityPowers, 32);
+    case Table::Precon64RootOfUnityPowers:
+      return compute_fwd_barrett_vector(Table::RootOfUnityPowers, 64);
+    case Table::AVX512RootOfUnityPowers: {
+      const uint64_t* root_of_unity_powers =
+          GetTableData(Table::RootOfUnityPowers);
+
+      // Duplicate each root of unity at indices [N/8, N/4] four times, and
+      // each root of unity at indices [N/4, N/2] twice. These are the roots of
+      // unity used in the FwdNTT FwdT4 and FwdT2 functions. By creating these
+      // duplicates, we avoid extra permutations while loading the roots of
+      // unity
+      AlignedVector64<uint64_t> avx512_root_of_unity_powers(m_aligned_alloc);
+      avx512_root_of_unity_powers.reserve(m_degree + m_degree / 4 +
+                                          3 * (m_degree / 8));
+      auto append = [&](size_t begin, size_t end, size_t copies) {
+        for (size_t i = begin; i < end; ++i) {
+          avx512_root_of_unity_powers.insert(avx512_root_of_unity_powers.end(),
+                                             copies, root_of_unity_powers[i]);
+        }
+      };
+      append(0, m_degree / 8, 1);
+      append(m_degree / 8, m_degree / 4, 4);
+      append(m_degree / 4, m_degree / 2, 2);
+      append(m_degree / 2, m_degree, 1);
+      return avx512_root_of_unity_powers;
+    }
+    case Table::AVX512Precon32RootOfUnityPowers:
+      return compute_fwd_barrett_vector(Table::AVX512RootOfUnityPowers, 32);
+    case Table::AVX512Precon52RootOfUnityPowers:
+      return compute_fwd_barrett_vector(Table::AVX512RootOfUnityPowers, 52);
+    case Table::AVX512Precon64RootOfUnityPowers:
+      return compute_fwd_barrett_vector(Table::AVX512RootOfUnityPowers, 64);
+    case Table::InvRootOfUnityPowers:
+      return compute_inv_powers();
+    case Table::Precon32InvRootOfUnityPowers:
+      return compute_inv_barrett_vector(32);
+    case Table::Precon52InvRootOfUnityPowers:
+      return compute_inv_barrett_vector(52);
+    case Table::Precon64InvRootOfUnityPowers:
+      return compute_inv_barrett_vector(64);
+    case Table::CompactRootOfUnityPowers:
+      return compute_compact_powers(m_w);
+    case Table::Precon52CompactRootOfUnityPowers:
+      return compute_fwd_barrett_vector(Table::CompactRootOfUnityPowers, 52);
+    case Table::Precon64CompactRootOfUnityPowers:
+      return compute_fwd_barrett_vector(Table::CompactRootOfUnityPowers, 64);
+    case Table::CompactInvRootOfUnityPowers:
+      return compute_compact_powers(m_w_inv);
+    case Table::Precon52CompactInvRootOfUnityPowers:
+      return compute_fwd_barrett_vector(Table::CompactInvRootOfUnityPowers,
+                                        52);
+    case Table::Precon64CompactInvRootOfUnityPowers:
+      return compute_fwd_barrett_vector(Table::CompactInvRootOfUnityPowers,
+                                        64);
+    case Table::NaturalRootOfUnityPowers:
+      return compute_natural_powers(m_w);
+    case Table::Precon64NaturalRootOfUnityPowers:
+      return compute_fwd_barrett_vector(Table::NaturalRootOfUnityPowers, 64);
+    case Table::NaturalInvRootOfUnityPowers:
+      return compute_natural_powers(m_w_inv);
+    case Table::Precon64NaturalInvRootOfUnityPowers:
+      return compute_fwd_barrett_vector(Table::NaturalInvRootOfUnityPowers,
+                                        64);
+    case Table::Montgomery52RootOfUnityPowers:
+      return to_montgomery_form(compute_fwd_powers(), s_ifma_shift_bits);
+    case Table::Montgomery64RootOfUnityPowers:
+      return to_montgomery_form(compute_fwd_powers(), s_default_shift_bits);
+    case Table::Montgomery52InvRootOfUnityPowers:
+      return to_montgomery_form(compute_inv_powers(), s_ifma_shift_bits);
+    case Table::Montgomery64InvRootOfUnityPowers:
+      return to_montgomery_form(compute_inv_powers(), s_default_shift_bits);
+    default:
+      HEXL_CHECK(false, "Invalid table " << static_cast<size_t>(table));
+      return AlignedVector64<uint64_t>(m_aligned_alloc);
+  }
+}
+
+namespace {
+
+std::atomic<bool>& MeasureNativeRadix() {
+  static std::atomic<bool> measure{std::getenv("HEXL_NTT_MEASURE_RADIX") !=
+                                   nullptr};
+  return measure;
+}
+
+// Measured (forward, inverse) native radices, keyed by (degree, modulus bits)
+using NativeRadixPair = std::pair<NTT::NativeRadix, NTT::NativeRadix>;
+
+std::mutex& NativeRadixCacheMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+std::map<std::pair<uint64_t, uint64_t>, NativeRadixPair>& NativeRadixCache() {
+  static std::map<std::pair<uint64_t, uint64_t>, NativeRadixPair> cache;
+  return cache;
+}
+
+// Returns the minimum over a few trials of the time taken by \p num_reps calls
+// to \p transform
+template <typename Transform>
+std::chrono::nanoseconds TimeTransform(Transform transform, size_t num_reps) {
+  const size_t num_trials = 3;
+  auto best = std::chrono::nanoseconds::max();
+  for (size_t trial = 0; trial < num_trials; ++trial) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t rep = 0; rep < num_reps; ++rep) {
+      transform();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start);
+    best = std::min(best, elapsed);
+  }
+  return best;
+}
+
+std::atomic<size_t>& BaseNTTSize() {
+  static std::atomic<size_t> base_ntt_size{NTT::DefaultBaseNTTSize()};
+  return base_ntt_size;
+}
+
+std::atomic<uint64_t>& ParallelCutoff() {
+  static std::atomic<uint64_t> parallel_cutoff{NTT::DefaultParallelCutoff()};
+  return parallel_cutoff;
+}
+
+std::atomic<NTT::TwiddleMode>& DefaultTwiddleMode() {
+  static std::atomic<NTT::TwiddleMode> twiddle_mode{[]() {
+    const char* env_twiddle_mode = std::getenv("HEXL_NTT_TWIDDLE_MODE");
+    if (env_twiddle_mode != nullptr) {
+      if (std::strcmp(env_twiddle_mode, "compact") == 0) {
+        return NTT::TwiddleMode::Compact;
+      }
+      if (std::strcmp(env_twiddle_mode, "montgomery") == 0) {
+        return NTT::TwiddleMode::Montgomery;
+      }
+    }
+    return NTT::TwiddleMode::Full;
+  }()};
+  return twiddle_mode;
+}
+
+}  // namespace
+
+size_t NTT::GetBaseNTTSize() { return BaseNTTSize(); }
+
+void NTT::SetBaseNTTSize(size_t base_ntt_size) {
+  HEXL_CHECK(base_ntt_size == 0 || IsPowerOfTwo(base_ntt_size),
+             "base_ntt_size " << base_ntt_size << " is not a power of 2");
+  BaseNTTSize() = (base_ntt_size == 0)
+                      ? DefaultBaseNTTSize()
+                      : std::max<size_t>(16, base_ntt_size);
+}
+
+size_t NTT::DefaultBaseNTTSize() {
+  const char* env_base_ntt_size = std::getenv("HEXL_NTT_BASE_SIZE");
+  if (env_base_ntt_size != nullptr) {
+    size_t base_ntt_size = std::strtoul(env_base_ntt_size, nullptr, 10);
+    if (base_ntt_size >= 16 && IsPowerOfTwo(base_ntt_size)) {
+      return base_ntt_size;
+    }
+  }
+  // Each coefficient of a block needs its value, twiddle factor and
+  // pre-conditioned twiddle factor; leave the same again for other data.
+  const size_t bytes_per_coeff = 4 * sizeof(uint64_t);
+  size_t max_base_ntt_size = GetL1DataCacheSize() / bytes_per_coeff;
+  size_t base_ntt_size = 16;
+  while (2 * base_ntt_size <= max_base_ntt_size) {
+    base_ntt_size *= 2;
   }
+  return base_ntt_size;
+}
 
-  if (has_avx512dq) {
-    m_avx512_precon32_root_of_unity_powers =
-        compute_barrett_vector(m_avx512_root_of_unity_powers, 32);
-    m_avx512_precon64_root_of_unity_powers =
-        compute_barrett_vector(m_avx512_root_of_unity_powers, 64);
+uint64_t NTT::GetParallelCutoff() { return ParallelCutoff(); }
+
+void NTT::SetParallelCutoff(uint64_t cutoff) { ParallelCutoff() = cutoff; }
+
+uint64_t NTT::DefaultParallelCutoff() {
+  const char* env_parallel_cutoff = std::getenv("HEXL_NTT_PARALLEL_CUTOFF");
+  if (env_parallel_cutoff != nullptr) {
+    return std::strtoull(env_parallel_cutoff, nullptr, 10);
   }
+  return 0;
+}
 
-  // Inverse root of unity powers
+NTT::TwiddleMode NTT::GetDefaultTwiddleMode() { return DefaultTwiddleMode(); }
 
-  // Reordering inv_root_of_powers
-  AlignedVector64<uint64_t> temp(m_degree, 0, m_aligned_alloc);
-  temp[0] = inv_root_of_unity_powers[0];
-  idx = 1;
+void NTT::SetDefaultTwiddleMode(TwiddleMode mode) {
+  DefaultTwiddleMode() = mode;
+}
+
+uint64_t ParallelNTTLevels(uint64_t n) {
+  uint64_t cutoff = NTT::GetParallelCutoff();
+  if (cutoff == 0 || n < cutoff || n < 4) {
+    return 0;
+  }
+  size_t num_threads = GetNumThreads();
+  if (num_threads <= 1) {
+    return 0;
+  }
+  // Split into between two and four times as many blocks as threads, so the
+  // tasks balance across the threads, keeping blocks at least the base size
+  uint64_t levels = Log2(num_threads - 1) + 2;
+  while (levels > 1 && (n >> levels) < NTT::GetBaseNTTSize()) {
+    --levels;
+  }
+  return levels;
+}
 
-  for (size_t m = (m_degree >> 1); m > 0; m >>= 1) {
-    for (size_t i = 0; i < m; i++) {
-      temp[idx] = inv_root_of_unity_powers[m + i];
-      idx++;
+NTT::NativeRadix NTT::DefaultNativeRadix(uint64_t degree) {
+  return degree >= 8192 ? NativeRadix::Radix4 : NativeRadix::Radix2;
+}
+
+void NTT::SetMeasureNativeRadix(bool measure) {
+  MeasureNativeRadix() = measure;
+}
+
+bool NTT::GetMeasureNativeRadix() { return MeasureNativeRadix(); }
+
+void NTT::SelectNativeRadix() {
+  m_fwd_native_radix = DefaultNativeRadix(m_degree);
+  m_inv_native_radix = DefaultNativeRadix(m_degree);
+  // Compact and Montgomery modes, and the AVX512 and AVX2 transforms, do not
+  // use the native radix; avoid building the full tables to time it
+  if (!GetMeasureNativeRadix() || m_degree < 16 ||
+      m_twiddle_mode != TwiddleMode::Full || UsesAVX512Layout()) {
+    return;
+  }
+
+  const auto key = std::make_pair(m_degree, Log2(m_q) + 1);
+  {
+    std::lock_guard<std::mutex> lock(NativeRadixCacheMutex());
+    auto it = NativeRadixCache().find(key);
+    if (it != NativeRadixCache().end()) {
+      m_fwd_native_radix = it->second.first;
+      m_inv_native_radix = it->second.second;
+      return;
     }
   }
-  m_inv_root_of_unity_powers = std::move(temp);
 
-  // 32-bit preconditioned inverse root of unity powers
-  m_precon32_inv_root_of_unity_powers =
-      compute_barrett_vector(m_inv_root_of_unity_powers, 32);
+  // In-place transforms with lazy reduction keep the data within the bounds
+  // required by the next repetition
+  AlignedVector64<uint64_t> data(m_degree, 0, m_aligned_alloc);
+  for (size_t i = 0; i < m_degree; ++i) {
+    data[i] = i % m_q;
+  }
+  const size_t num_reps = std::max<uint64_t>(1, (1ULL << 14) / m_degree);
+  const uint64_t* W = GetTableData(Table::RootOfUnityPowers);
+  const uint64_t* W_precon = GetTableData(Table::Precon64RootOfUnityPowers);
+  const uint64_t* inv_W = GetTableData(Table::InvRootOfUnityPowers);
+  const uint64_t* inv_W_precon =
+      GetTableData(Table::Precon64InvRootOfUnityPowers);
+  uint64_t* x = data.data();
 
-  // 52-bit preconditioned inverse root of unity powers
-  if (has_avx512ifma) {
-    m_precon52_inv_root_of_unity_powers =
-        compute_barrett_vector(m_inv_root_of_unity_powers, 52);
+  auto fwd_radix2 = TimeTransform(
+      [&]() {
+        ForwardTransformToBitReverseRadix2(x, x, m_degree, m_q, W, W_precon, 4,
+                                           4);
+      },
+      num_reps);
+  auto fwd_radix4 = TimeTransform(
+      [&]() {
+        ForwardTransformToBitReverseRadix4(x, x, m_degree, m_q, W, W_precon, 4,
+                                           4);
+      },
+      num_reps);
+
+  for (size_t i = 0; i < m_degree; ++i) {
+    data[i] = i % m_q;
   }
+  auto inv_radix2 = TimeTransform(
+      [&]() {
+        InverseTransformFromBitReverseRadix2(x, x, m_degree, m_q, inv_W,
+                                             inv_W_precon, 2, 2);
+      },
+      num_reps);
+  auto inv_radix4 = TimeTransform(
+      [&]() {
+        InverseTransformFromBitReverseRadix4(x, x, m_degree, m_q, inv_W,
+                                             inv_W_precon, 2, 2);
+      },
+      num_reps);
+
+  m_fwd_native_radix =
+      fwd_radix4 < fwd_radix2 ? NativeRadix::Radix4 : NativeRadix::Radix2;
+  m_inv_native_radix =
+      inv_radix4 < inv_radix2 ? NativeRadix::Radix4 : NativeRadix::Radix2;
+  HEXL_VLOG(3, "Measured native radix for degree "
+                   << m_degree << ", modulus " << m_q << ": forward "
+                   << static_cast<int>(m_fwd_native_radix) << ", inverse "
+                   << static_cast<int>(m_inv_native_radix));
 
-  // 64-bit preconditioned inverse root of unity powers
-  m_precon64_inv_root_of_unity_powers =
-      compute_barrett_vector(m_inv_root_of_unity_powers, 64);
+  std::lock_guard<std::mutex> lock(NativeRadixCacheMutex());
+  NativeRadixCache().emplace(
+      key, NativeRadixPair(m_fwd_native_radix, m_inv_native_radix));
+}
+
+bool NTT::CheckCyclicArguments(uint64_t degree, uint64_t modulus) {
+  HEXL_UNUSED(degree);
+  HEXL_UNUSED(modulus);
+  HEXL_CHECK(IsPowerOfTwo(degree),
+             "degree " << degree << " is not a power of 2");
+  HEXL_CHECK(degree <= (1ULL << NTT::MaxDegreeBits()),
+             "degree should be less than 2^" << NTT::MaxDegreeBits() << " got "
+                                             << degree);
+  HEXL_CHECK(modulus % degree == 1, "modulus mod n != 1");
+  HEXL_CHECK(IsPrime(modulus), "modulus is not prime");
+
+  return true;
 }
 
 bool NTT::CheckArguments(uint64_t degree, uint64_t modulus) {
@@ -178,9 +798,6 @@ bool NTT::CheckArguments(uint64_t degree, uint64_t modulus) {
   HEXL_CHECK(degree <= (1ULL << NTT::MaxDegreeBits()),
              "degree should be less than 2^" << NTT::MaxDegreeBits() << " got "
                                              << degree);
-  HEXL_CHECK(modulus <= (1ULL << NTT::MaxModulusBits()),
-             "modulus should be less than 2^" << NTT::MaxModulusBits()
-                                              << " got " << modulus);
   HEXL_CHECK(modulus % (2 * degree) == 1, "modulus mod 2n != 1");
   HEXL_CHECK(IsPrime(modulus), "modulus is not prime");
 
@@ -197,58 +814,245 @@ void NTT::ComputeForward(uint64_t* result, const uint64_t* operand,
       "input_mod_factor must be 1, 2 or 4; got " << input_mod_factor);
   HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 4,
              "output_mod_factor must be 1 or 4; got " << output_mod_factor);
-  HEXL_CHECK_BOUNDS(
-      operand, m_degree, m_q * input_mod_factor,
-      "value in operand exceeds bound " << m_q * input_mod_factor);
+  HEXL_CHECK_BOUNDS(operand, m_degree, ModFactorBound(m_q, input_mod_factor),
+                    "value in operand exceeds bound "
+                        << ModFactorBound(m_q, input_mod_factor));
+
+  if (m_four_step) {
+    HEXL_VLOG(3, "Calling four-step FwdNTT");
+    m_four_step->ComputeForward(result, operand, input_mod_factor,
+                                output_mod_factor);
+    return;
+  }
 
+  if (m_twiddle_mode == TwiddleMode::Compact) {
+    const uint64_t* compact_root_of_unity_powers =
+        GetTableData(Table::CompactRootOfUnityPowers);
+    const uint64_t* precon_compact_root_of_unity_powers =
+        GetTableData(CompactPreconTable(false));
 #ifdef HEXL_HAS_AVX512IFMA
-  if (has_avx512ifma && (m_q < s_max_fwd_ifma_modulus && (m_degree >= 16))) {
-    const uint64_t* root_of_unity_powers = GetAVX512RootOfUnityPowers().data();
+    if (CompactBitShift() == s_ifma_shift_bits) {
+      HEXL_VLOG(3, "Calling 52-bit AVX512-IFMA compact FwdNTT");
+      ForwardTransformToBitReverseCompactAVX512<s_ifma_shift_bits>(
+          result, operand, m_degree, m_q, compact_root_of_unity_powers,
+          precon_compact_root_of_unity_powers, input_mod_factor,
+          output_mod_factor);
+      return;
+    }
+#endif
+#ifdef HEXL_HAS_AVX512DQ
+    if (has_avx512dq && m_degree >= 32) {
+      HEXL_VLOG(3, "Calling 64-bit AVX512-DQ compact FwdNTT");
+      ForwardTransformToBitReverseCompactAVX512<s_default_shift_bits>(
+          result, operand, m_degree, m_q, compact_root_of_unity_powers,
+          precon_compact_root_of_unity_powers, input_mod_factor,
+          output_mod_factor);
+      return;
+    }
+#endif
+#ifdef HEXL_HAS_AVX256
+    if (has_avx2 && m_degree >= 16) {
+      HEXL_VLOG(3, "Calling 64-bit AVX2 compact FwdNTT");
+      ForwardTransformToBitReverseCompactAVX2(
+          result, operand, m_degree, m_q, compact_root_of_unity_powers,
+          precon_compact_root_of_unity_powers, input_mod_factor,
+          output_mod_factor);
+      return;
+    }
+#endif
+    HEXL_VLOG(3, "Calling 64-bit compact FwdNTT");
+    ForwardTransformToBitReverseCompact(result, operand, m_degree, m_q,
+                                        compact_root_of_unity_powers,
+                                        precon_compact_root_of_unity_powers,
+                                        input_mod_factor, output_mod_factor);
+    return;
+  }
+
+#ifdef HEXL_HAS_AVX512IFMA
+  if (UsesFullyReducedIFMA()) {
+    HEXL_VLOG(3, "Calling 52-bit AVX512-IFMA fully reduced FwdNTT");
+    ForwardTransformToBitReverseLargeModulusAVX512<s_ifma_shift_bits>(
+        result, operand, m_degree, m_q, GetTableData(MontgomeryTable(false)),
+        input_mod_factor);
+    return;
+  }
+#endif
+
+  if (m_twiddle_mode == TwiddleMode::Montgomery) {
+    const uint64_t* montgomery_root_of_unity_powers =
+        GetTableData(MontgomeryTable(false));
+    if (m_q >= s_max_lazy_modulus) {
+#ifdef HEXL_HAS_AVX512DQ
+      if (has_avx512dq && m_degree >= 16) {
+        HEXL_VLOG(3, "Calling 64-bit AVX512-DQ large-modulus FwdNTT");
+        ForwardTransformToBitReverseLargeModulusAVX512<s_default_shift_bits>(
+            result, operand, m_degree, m_q, montgomery_root_of_unity_powers,
+            input_mod_factor);
+        return;
+      }
+#endif
+      HEXL_VLOG(3, "Calling 64-bit large-modulus FwdNTT");
+      ForwardTransformToBitReverseLargeModulus(result, operand, m_degree, m_q,
+                                               montgomery_root_of_unity_powers,
+                                               input_mod_factor);
+      return;
+    }
+#ifdef HEXL_HAS_AVX512IFMA
+    if (MontgomeryBitShift() == s_ifma_shift_bits) {
+      HEXL_VLOG(3, "Calling 52-bit AVX512-IFMA Montgomery FwdNTT");
+      ForwardTransformToBitReverseMontgomeryAVX512<s_ifma_shift_bits>(
+          result, operand, m_degree, m_q, montgomery_root_of_unity_powers,
+          input_mod_factor, output_mod_factor);
+      return;
+    }
+#endif
+#ifdef HEXL_HAS_AVX512DQ
+    if (has_avx512dq && m_degree >= 16) {
+      HEXL_VLOG(3, "Calling 64-bit AVX512-DQ Montgomery FwdNTT");
+      ForwardTransformToBitReverseMontgomeryAVX512<s_default_shift_bits>(
+          result, operand, m_degree, m_q, montgomery_root_of_unity_powers,
+          input_mod_factor, output_mod_factor);
+      return;
+    }
+#endif
+    HEXL_VLOG(3, "Calling 64-bit Montgomery FwdNTT");
+    ForwardTransformToBitReverseMontgomery(result, operand, m_degree, m_q,
+                                           montgomery_root_of_unity_powers,
+                                           input_mod_factor, output_mod_factor);
+    return;
+  }
+
+  ForwardTransformFull(result, operand, input_mod_factor, output_mod_factor, 0,
+                       0);
+}
+
+void NTT::ComputeForwardFromUnreduced(uint64_t* result,
+                                      const uint64_t* operand,
+                                      uint64_t output_mod_factor) {
+  HEXL_CHECK(result != nullptr, "result == nullptr");
+  HEXL_CHECK(operand != nullptr, "operand == nullptr");
+  HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 4,
+             "output_mod_factor must be 1 or 4; got " << output_mod_factor);
+
+  // The fused first stage needs the lazy Full-mode butterflies, and the root of
+  // unity at index 1 of the dispatched table, which the AVX512 layout keeps in
+  // place for m_degree >= 32
+  if (m_four_step || m_degree < 2 ||
+      m_twiddle_mode != TwiddleMode::Full ||
+      m_q >= s_max_lazy_modulus || UsesFullyReducedIFMA() ||
+      (UsesAVX512Layout() && m_degree < 32)) {
+    HEXL_VLOG(3, "Reducing operand before FwdNTT");
+    const uint64_t barrett_factor = MultiplyFactor(1, 64, m_q).BarrettFactor();
+    for (size_t i = 0; i < m_degree; ++i) {
+      result[i] = BarrettReduce64(operand[i], m_q, barrett_factor);
+    }
+    ComputeForward(result, result, 1, output_mod_factor);
+    return;
+  }
+
+  HEXL_VLOG(3, "Calling FwdNTT with reducing first stage");
+  ForwardFirstStageReduce(result, operand, m_degree, m_q,
+                          GetDispatchedRootOfUnityPowers()[1]);
+  const uint64_t half_n = m_degree / 2;
+  ForwardTransformFull(result, result, 4, output_mod_factor, 1, 0);
+  ForwardTransformFull(result + half_n, result + half_n, 4, output_mod_factor,
+                       1, 1);
+}
+
+void NTT::ForwardTransformFull(uint64_t* result, const uint64_t* operand,
+                               uint64_t input_mod_factor,
+                               uint64_t output_mod_factor,
+                               uint64_t recursion_depth,
+                               uint64_t recursion_half) {
+  const uint64_t n = m_degree >> recursion_depth;
+
+#ifdef HEXL_HAS_AVX512IFMA
+  if (has_avx512ifma && (m_q < s_max_fwd_ifma_modulus) && (n >= 16)) {
+    const uint64_t* root_of_unity_powers =
+        GetTableData(Table::AVX512RootOfUnityPowers);
     const uint64_t* precon_root_of_unity_powers =
-        GetAVX512Precon52RootOfUnityPowers().data();
+        GetTableData(Table::AVX512Precon52RootOfUnityPowers);
 
     HEXL_VLOG(3, "Calling 52-bit AVX512-IFMA FwdNTT");
     ForwardTransformToBitReverseAVX512<s_ifma_shift_bits>(
-        result, operand, m_degree, m_q, root_of_unity_powers,
-        precon_root_of_unity_powers, input_mod_factor, output_mod_factor);
+        result, operand, n, m_q, root_of_unity_powers,
+        precon_root_of_unity_powers, input_mod_factor, output_mod_factor,
+        recursion_depth, recursion_half);
     return;
   }
 #endif
 
 #ifdef HEXL_HAS_AVX512DQ
-  if (has_avx512dq && m_degree >= 16) {
+  if (has_avx512dq && n >= 16) {
     if (m_q < s_max_fwd_32_modulus) {
       HEXL_VLOG(3, "Calling 32-bit AVX512-DQ FwdNTT");
       const uint64_t* root_of_unity_powers =
-          GetAVX512RootOfUnityPowers().data();
+          GetTableData(Table::AVX512RootOfUnityPowers);
       const uint64_t* precon_root_of_unity_powers =
-          GetAVX512Precon32RootOfUnityPowers().data();
+          GetTableData(Table::AVX512Precon32RootOfUnityPowers);
       ForwardTransformToBitReverseAVX512<32>(
-          result, operand, m_degree, m_q, root_of_unity_powers,
-          precon_root_of_unity_powers, input_mod_factor, output_mod_factor);
+          result, operand, n, m_q, root_of_unity_powers,
+          precon_root_of_unity_powers, input_mod_factor, output_mod_factor,
+          recursion_depth, recursion_half);
     } else {
       HEXL_VLOG(3, "Calling 64-bit AVX512-DQ FwdNTT");
       const uint64_t* root_of_unity_powers =
-          GetAVX512RootOfUnityPowers().data();
+          GetTableData(Table::AVX512RootOfUnityPowers);
       const uint64_t* precon_root_of_unity_powers =
-          GetAVX512Precon64RootOfUnityPowers().data();
+          GetTableData(Table::AVX512Precon64RootOfUnityPowers);
 
       ForwardTransformToBitReverseAVX512<s_default_shift_bits>(
-          result, operand, m_degree, m_q, root_of_unity_powers,
-          precon_root_of_unity_powers, input_mod_factor, output_mod_factor);
+          result, operand, n, m_q, root_of_unity_powers,
+          precon_root_of_unity_powers, input_mod_factor, output_mod_factor,
+          recursion_depth, recursion_half);
     }
     return;
   }
 #endif
 
-  HEXL_VLOG(3, "Calling ForwardTransformToBitReverseRadix2");
-  const uint64_t* root_of_unity_powers = GetRootOfUnityPowers().data();
+#ifdef HEXL_HAS_AVX256
+  if (has_avx2 && n >= 16) {
+    const uint64_t* root_of_unity_powers =
+        GetTableData(Table::AVX512RootOfUnityPowers);
+    if (m_q < s_max_fwd_32_modulus) {
+      HEXL_VLOG(3, "Calling 32-bit AVX2 FwdNTT");
+      const uint64_t* precon_root_of_unity_powers =
+          GetTableData(Table::AVX512Precon32RootOfUnityPowers);
+      ForwardTransformToBitReverseAVX2<32>(
+          result, operand, n, m_q, root_of_unity_powers,
+          precon_root_of_unity_powers, input_mod_factor, output_mod_factor,
+          recursion_depth, recursion_half);
+    } else {
+      HEXL_VLOG(3, "Calling 64-bit AVX2 FwdNTT");
+      const uint64_t* precon_root_of_unity_powers =
+          GetTableData(Table::AVX512Precon64RootOfUnityPowers);
+      ForwardTransformToBitReverseAVX2<s_default_shift_bits>(
+          result, operand, n, m_q, root_of_unity_powers,
+          precon_root_of_unity_powers, input_mod_factor, output_mod_factor,
+          recursion_depth, recursion_half);
+    }
+    return;
+  }
+#endif
+
+  const uint64_t* root_of_unity_powers = GetTableData(Table::RootOfUnityPowers);
   const uint64_t* precon_root_of_unity_powers =
-      GetPrecon64RootOfUnityPowers().data();
+      GetTableData(Table::Precon64RootOfUnityPowers);
+
+  if (m_fwd_native_radix == NativeRadix::Radix4) {
+    HEXL_VLOG(3, "Calling ForwardTransformToBitReverseRadix4");
+    ForwardTransformToBitReverseRadix4(
+        result, operand, n, m_q, root_of_unity_powers,
+        precon_root_of_unity_powers, input_mod_factor, output_mod_factor,
+        recursion_depth, recursion_half);
+    return;
+  }
 
+  HEXL_VLOG(3, "Calling ForwardTransformToBitReverseRadix2");
   ForwardTransformToBitReverseRadix2(
-      result, operand, m_degree, m_q, root_of_unity_powers,
-      precon_root_of_unity_powers, input_mod_factor, output_mod_factor);
+      result, operand, n, m_q, root_of_unity_powers,
+      precon_root_of_unity_powers, input_mod_factor, output_mod_factor,
+      recursion_depth, recursion_half);
 }
 
 void NTT::ComputeInverse(uint64_t* result, const uint64_t* operand,
@@ -260,18 +1064,353 @@ void NTT::ComputeInverse(uint64_t* result, const uint64_t* operand,
              "input_mod_factor must be 1 or 2; got " << input_mod_factor);
   HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 2,
              "output_mod_factor must be 1 or 2; got " << output_mod_factor);
-  HEXL_CHECK_BOUNDS(operand, m_degree, m_q * input_mod_factor,
-                    "operand exceeds bound " << m_q * input_mod_factor);
+  HEXL_CHECK_BOUNDS(operand, m_degree, ModFactorBound(m_q, input_mod_factor),
+                    "operand exceeds bound "
+                        << ModFactorBound(m_q, input_mod_factor));
+
+  InverseTransform(result, operand, nullptr, input_mod_factor,
+                   output_mod_factor);
+}
+
+void NTT::ComputeInverseScaled(uint64_t* result, const uint64_t* operand,
+                               uint64_t scalar, uint64_t addend,
+                               uint64_t input_mod_factor,
+                               uint64_t output_mod_factor) {
+  HEXL_CHECK(result != nullptr, "result == nullptr");
+  HEXL_CHECK(operand != nullptr, "operand == nullptr");
+  HEXL_CHECK(input_mod_factor == 1 || input_mod_factor == 2,
+             "input_mod_factor must be 1 or 2; got " << input_mod_factor);
+  HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 2,
+             "output_mod_factor must be 1 or 2; got " << output_mod_factor);
+  HEXL_CHECK(scalar < m_q, "scalar " << scalar << " >= modulus " << m_q);
+  HEXL_CHECK(addend < m_q, "addend " << addend << " >= modulus " << m_q);
+  HEXL_CHECK_BOUNDS(operand, m_degree, ModFactorBound(m_q, input_mod_factor),
+                    "operand exceeds bound "
+                        << ModFactorBound(m_q, input_mod_factor));
+
+  // Only the Full-mode transforms fold the scalar and addend into their final
+  // stage
+  if (m_four_step || m_degree < 2 ||
+      m_twiddle_mode != TwiddleMode::Full || UsesFullyReducedIFMA()) {
+    HEXL_VLOG(3, "Scaling InvNTT output in a separate pass");
+    InverseTransform(result, operand, nullptr, input_mod_factor, 2);
+    if (m_q < (1ULL << 61)) {
+      EltwiseFMAMod(result, result, scalar, nullptr, m_degree, m_q, 2);
+      if (addend != 0) {
+        EltwiseAddMod(result, result, addend, m_degree, m_q);
+      }
+      return;
+    }
+    const uint64_t scalar_precon =
+        MultiplyFactor(scalar, 64, m_q).BarrettFactor();
+    for (size_t i = 0; i < m_degree; ++i) {
+      result[i] = AddUIntMod(MultiplyMod(result[i], scalar, scalar_precon, m_q),
+                             addend, m_q);
+    }
+    return;
+  }
+
+  InverseTransformFull(result, operand, nullptr, input_mod_factor,
+                       output_mod_factor, scalar, addend);
+}
+
+bool NTT::UsesMultiAVX512() const {
+  // The lockstep transforms are serial, so multithreaded transforms of each
+  // polynomial are preferred for large degrees
+  if (m_four_step || m_twiddle_mode != TwiddleMode::Full ||
+      UsesFullyReducedIFMA() || m_degree < 16 ||
+      ParallelNTTLevels(m_degree) > 0) {
+    return false;
+  }
+#ifdef HEXL_HAS_AVX512DQ
+  return has_avx512dq;
+#else
+  return false;
+#endif
+}
+
+void NTT::ComputeForwardMulti(uint64_t* const* result,
+                              const uint64_t* const* operand,
+                              size_t num_polys, uint64_t input_mod_factor,
+                              uint64_t output_mod_factor) {
+  HEXL_CHECK(result != nullptr, "result == nullptr");
+  HEXL_CHECK(operand != nullptr, "operand == nullptr");
+
+  if (num_polys < 2 || !UsesMultiAVX512()) {
+    for (size_t i = 0; i < num_polys; ++i) {
+      ComputeForward(result[i], operand[i], input_mod_factor,
+                     output_mod_factor);
+    }
+    return;
+  }
+
+#ifdef HEXL_HAS_AVX512DQ
+  HEXL_CHECK(
+      input_mod_factor == 1 || input_mod_factor == 2 || input_mod_factor == 4,
+      "input_mod_factor must be 1, 2 or 4; got " << input_mod_factor);
+  HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 4,
+             "output_mod_factor must be 1 or 4; got " << output_mod_factor);
+  const uint64_t* root_of_unity_powers =
+      GetTableData(Table::AVX512RootOfUnityPowers);
+#ifdef HEXL_HAS_AVX512IFMA
+  if (has_avx512ifma && (m_q < s_max_fwd_ifma_modulus)) {
+    HEXL_VLOG(3, "Calling 52-bit AVX512-IFMA multi FwdNTT");
+    ForwardTransformToBitReverseMultiAVX512<s_ifma_shift_bits>(
+        result, operand, num_polys, m_degree, m_q, root_of_unity_powers,
+        GetTableData(Table::AVX512Precon52RootOfUnityPowers), input_mod_factor,
+        output_mod_factor);
+    return;
+  }
+#endif
+  if (m_q < s_max_fwd_32_modulus) {
+    HEXL_VLOG(3, "Calling 32-bit AVX512-DQ multi FwdNTT");
+    ForwardTransformToBitReverseMultiAVX512<32>(
+        result, operand, num_polys, m_degree, m_q, root_of_unity_powers,
+        GetTableData(Table::AVX512Precon32RootOfUnityPowers), input_mod_factor,
+        output_mod_factor);
+    return;
+  }
+  HEXL_VLOG(3, "Calling 64-bit AVX512-DQ multi FwdNTT");
+  ForwardTransformToBitReverseMultiAVX512<s_default_shift_bits>(
+      result, operand, num_polys, m_degree, m_q, root_of_unity_powers,
+      GetTableData(Table::AVX512Precon64RootOfUnityPowers), input_mod_factor,
+      output_mod_factor);
+#endif
+}
+
+void NTT::ComputeInverseMulti(uint64_t* const* result,
+                              const uint64_t* const* operand,
+                              size_t num_polys, uint64_t input_mod_factor,
+                              uint64_t output_mod_factor) {
+  HEXL_CHECK(result != nullptr, "result == nullptr");
+  HEXL_CHECK(operand != nullptr, "operand == nullptr");
+
+  if (num_polys < 2 || !UsesMultiAVX512()) {
+    for (size_t i = 0; i < num_polys; ++i) {
+      ComputeInverse(result[i], operand[i], input_mod_factor,
+                     output_mod_factor);
+    }
+    return;
+  }
+
+#ifdef HEXL_HAS_AVX512DQ
+  HEXL_CHECK(input_mod_factor == 1 || input_mod_factor == 2,
+             "input_mod_factor must be 1 or 2; got " << input_mod_factor);
+  HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 2,
+             "output_mod_factor must be 1 or 2; got " << output_mod_factor);
+  const uint64_t* inv_root_of_unity_powers =
+      GetTableData(Table::InvRootOfUnityPowers);
+#ifdef HEXL_HAS_AVX512IFMA
+  if (has_avx512ifma && (m_q < s_max_inv_ifma_modulus)) {
+    HEXL_VLOG(3, "Calling 52-bit AVX512-IFMA multi InvNTT");
+    InverseTransformFromBitReverseMultiAVX512<s_ifma_shift_bits>(
+        result, operand, num_polys, m_degree, m_q, inv_root_of_unity_powers,
+        GetTableData(Table::Precon52InvRootOfUnityPowers), input_mod_factor,
+        output_mod_factor);
+    return;
+  }
+#endif
+  if (m_q < s_max_inv_32_modulus) {
+    HEXL_VLOG(3, "Calling 32-bit AVX512-DQ multi InvNTT");
+    InverseTransformFromBitReverseMultiAVX512<32>(
+        result, operand, num_polys, m_degree, m_q, inv_root_of_unity_powers,
+        GetTableData(Table::Precon32InvRootOfUnityPowers), input_mod_factor,
+        output_mod_factor);
+    return;
+  }
+  HEXL_VLOG(3, "Calling 64-bit AVX512-DQ multi InvNTT");
+  InverseTransformFromBitReverseMultiAVX512<s_default_shift_bits>(
+      result, operand, num_polys, m_degree, m_q, inv_root_of_unity_powers,
+      GetTableData(Table::Precon64InvRootOfUnityPowers), input_mod_factor,
+      output_mod_factor);
+#endif
+}
+
+void NTT::Multiply(uint64_t* result, const uint64_t* operand1,
+                   const uint64_t* operand2, uint64_t input_mod_factor,
+                   uint64_t output_mod_factor) {
+  HEXL_CHECK(result != nullptr, "result == nullptr");
+  HEXL_CHECK(operand1 != nullptr, "operand1 == nullptr");
+  HEXL_CHECK(operand2 != nullptr, "operand2 == nullptr");
+
+  // Transform operand2 first, so result may alias either operand
+  ScratchBuffer transformed_operand2(m_degree, m_aligned_alloc);
+  ComputeForward(transformed_operand2.data(), operand2, input_mod_factor, 4);
+  MultiplyTransformed(result, operand1, transformed_operand2.data(),
+                      input_mod_factor, output_mod_factor);
+}
+
+void NTT::MultiplyTransformed(uint64_t* result, const uint64_t* operand,
+                              const uint64_t* transformed_operand,
+                              uint64_t input_mod_factor,
+                              uint64_t output_mod_factor) {
+  HEXL_CHECK(result != nullptr, "result == nullptr");
+  HEXL_CHECK(operand != nullptr, "operand == nullptr");
+  HEXL_CHECK(transformed_operand != nullptr, "transformed_operand == nullptr");
+  HEXL_CHECK(result != transformed_operand,
+             "result must not alias transformed_operand");
+  HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 2,
+             "output_mod_factor must be 1 or 2; got " << output_mod_factor);
+  HEXL_CHECK_BOUNDS(transformed_operand, m_degree, ModFactorBound(m_q, 4),
+                    "transformed_operand exceeds bound "
+                        << ModFactorBound(m_q, 4));
+
+  ComputeForward(result, operand, input_mod_factor, 4);
+  InverseTransform(result, result, transformed_operand, 4, output_mod_factor);
+}
+
+void NTT::InverseTransform(uint64_t* result, const uint64_t* operand,
+                           const uint64_t* mult_operand,
+                           uint64_t input_mod_factor,
+                           uint64_t output_mod_factor) {
+  if (m_four_step) {
+    if (mult_operand != nullptr) {
+      EltwiseMultMod(result, operand, mult_operand, m_degree, m_q,
+                     input_mod_factor);
+      operand = result;
+      input_mod_factor = 1;
+    }
+    HEXL_VLOG(3, "Calling four-step InvNTT");
+    m_four_step->ComputeInverse(result, operand, input_mod_factor,
+                                output_mod_factor);
+    return;
+  }
+
+  if (m_twiddle_mode == TwiddleMode::Compact) {
+    if (mult_operand != nullptr) {
+      EltwiseMultMod(result, operand, mult_operand, m_degree, m_q,
+                     input_mod_factor);
+      operand = result;
+      input_mod_factor = 1;
+    }
+    const uint64_t* compact_inv_root_of_unity_powers =
+        GetTableData(Table::CompactInvRootOfUnityPowers);
+    const uint64_t* precon_compact_inv_root_of_unity_powers =
+        GetTableData(CompactPreconTable(true));
+#ifdef HEXL_HAS_AVX512IFMA
+    if (CompactBitShift() == s_ifma_shift_bits) {
+      HEXL_VLOG(3, "Calling 52-bit AVX512-IFMA compact InvNTT");
+      InverseTransformFromBitReverseCompactAVX512<s_ifma_shift_bits>(
+          result, operand, m_degree, m_q, compact_inv_root_of_unity_powers,
+          precon_compact_inv_root_of_unity_powers, input_mod_factor,
+          output_mod_factor);
+      return;
+    }
+#endif
+#ifdef HEXL_HAS_AVX512DQ
+    if (has_avx512dq && m_degree >= 32) {
+      HEXL_VLOG(3, "Calling 64-bit AVX512-DQ compact InvNTT");
+      InverseTransformFromBitReverseCompactAVX512<s_default_shift_bits>(
+          result, operand, m_degree, m_q, compact_inv_root_of_unity_powers,
+          precon_compact_inv_root_of_unity_powers, input_mod_factor,
+          output_mod_factor);
+      return;
+    }
+#endif
+#ifdef HEXL_HAS_AVX256
+    if (has_avx2 && m_degree >= 16) {
+      HEXL_VLOG(3, "Calling 64-bit AVX2 compact InvNTT");
+      InverseTransformFromBitReverseCompactAVX2(
+          result, operand, m_degree, m_q, compact_inv_root_of_unity_powers,
+          precon_compact_inv_root_of_unity_powers, input_mod_factor,
+          output_mod_factor);
+      return;
+    }
+#endif
+    HEXL_VLOG(3, "Calling 64-bit compact InvNTT");
+    InverseTransformFromBitReverseCompact(
+        result, operand, m_degree, m_q, compact_inv_root_of_unity_powers,
+        precon_compact_inv_root_of_unity_powers, input_mod_factor,
+        output_mod_factor);
+    return;
+  }
 
+#ifdef HEXL_HAS_AVX512IFMA
+  if (UsesFullyReducedIFMA()) {
+    if (mult_operand != nullptr) {
+      EltwiseMultMod(result, operand, mult_operand, m_degree, m_q,
+                     input_mod_factor);
+      operand = result;
+      input_mod_factor = 1;
+    }
+    HEXL_VLOG(3, "Calling 52-bit AVX512-IFMA fully reduced InvNTT");
+    InverseTransformFromBitReverseLargeModulusAVX512<s_ifma_shift_bits>(
+        result, operand, m_degree, m_q, GetTableData(MontgomeryTable(true)),
+        input_mod_factor);
+    return;
+  }
+#endif
+
+  if (m_twiddle_mode == TwiddleMode::Montgomery) {
+    if (mult_operand != nullptr) {
+      EltwiseMultMod(result, operand, mult_operand, m_degree, m_q,
+                     input_mod_factor);
+      operand = result;
+      input_mod_factor = 1;
+    }
+    const uint64_t* montgomery_inv_root_of_unity_powers =
+        GetTableData(MontgomeryTable(true));
+    if (m_q >= s_max_lazy_modulus) {
+#ifdef HEXL_HAS_AVX512DQ
+      if (has_avx512dq && m_degree >= 16) {
+        HEXL_VLOG(3, "Calling 64-bit AVX512-DQ large-modulus InvNTT");
+        InverseTransformFromBitReverseLargeModulusAVX512<s_default_shift_bits>(
+            result, operand, m_degree, m_q,
+            montgomery_inv_root_of_unity_powers, input_mod_factor);
+        return;
+      }
+#endif
+      HEXL_VLOG(3, "Calling 64-bit large-modulus InvNTT");
+      InverseTransformFromBitReverseLargeModulus(
+          result, operand, m_degree, m_q, montgomery_inv_root_of_unity_powers,
+          input_mod_factor);
+      return;
+    }
+#ifdef HEXL_HAS_AVX512IFMA
+    if (MontgomeryBitShift() == s_ifma_shift_bits) {
+      HEXL_VLOG(3, "Calling 52-bit AVX512-IFMA Montgomery InvNTT");
+      InverseTransformFromBitReverseMontgomeryAVX512<s_ifma_shift_bits>(
+          result, operand, m_degree, m_q, montgomery_inv_root_of_unity_powers,
+          input_mod_factor, output_mod_factor);
+      return;
+    }
+#endif
+#ifdef HEXL_HAS_AVX512DQ
+    if (has_avx512dq && m_degree >= 16) {
+      HEXL_VLOG(3, "Calling 64-bit AVX512-DQ Montgomery InvNTT");
+      InverseTransformFromBitReverseMontgomeryAVX512<s_default_shift_bits>(
+          result, operand, m_degree, m_q, montgomery_inv_root_of_unity_powers,
+          input_mod_factor, output_mod_factor);
+      return;
+    }
+#endif
+    HEXL_VLOG(3, "Calling 64-bit Montgomery InvNTT");
+    InverseTransformFromBitReverseMontgomery(
+        result, operand, m_degree, m_q, montgomery_inv_root_of_unity_powers,
+        input_mod_factor, output_mod_factor);
+    return;
+  }
+
+  InverseTransformFull(result, operand, mult_operand, input_mod_factor,
+                       output_mod_factor, 1, 0);
+}
+
+void NTT::InverseTransformFull(uint64_t* result, const uint64_t* operand,
+                               const uint64_t* mult_operand,
+                               uint64_t input_mod_factor,
+                               uint64_t output_mod_factor, uint64_t scalar,
+                               uint64_t addend) {
 #ifdef HEXL_HAS_AVX512IFMA
   if (has_avx512ifma && (m_q < s_max_inv_ifma_modulus) && (m_degree >= 16)) {
     HEXL_VLOG(3, "Calling 52-bit AVX512-IFMA InvNTT");
-    const uint64_t* inv_root_of_unity_powers = GetInvRootOfUnityPowers().data();
+    const uint64_t* inv_root_of_unity_powers =
+        GetTableData(Table::InvRootOfUnityPowers);
     const uint64_t* precon_inv_root_of_unity_powers =
-        GetPrecon52InvRootOfUnityPowers().data();
+        GetTableData(Table::Precon52InvRootOfUnityPowers);
     InverseTransformFromBitReverseAVX512<s_ifma_shift_bits>(
         result, operand, m_degree, m_q, inv_root_of_unity_powers,
-        precon_inv_root_of_unity_powers, input_mod_factor, output_mod_factor);
+        precon_inv_root_of_unity_powers, input_mod_factor, output_mod_factor,
+        0, 0, mult_operand, scalar, addend);
     return;
   }
 #endif
@@ -281,34 +1420,73 @@ void NTT::ComputeInverse(uint64_t* result, const uint64_t* operand,
     if (m_q < s_max_inv_32_modulus) {
       HEXL_VLOG(3, "Calling 32-bit AVX512-DQ InvNTT");
       const uint64_t* inv_root_of_unity_powers =
-          GetInvRootOfUnityPowers().data();
+          GetTableData(Table::InvRootOfUnityPowers);
       const uint64_t* precon_inv_root_of_unity_powers =
-          GetPrecon32InvRootOfUnityPowers().data();
+          GetTableData(Table::Precon32InvRootOfUnityPowers);
       InverseTransformFromBitReverseAVX512<32>(
           result, operand, m_degree, m_q, inv_root_of_unity_powers,
-          precon_inv_root_of_unity_powers, input_mod_factor, output_mod_factor);
+          precon_inv_root_of_unity_powers, input_mod_factor, output_mod_factor,
+          0, 0, mult_operand, scalar, addend);
     } else {
       HEXL_VLOG(3, "Calling 64-bit AVX512 InvNTT");
       const uint64_t* inv_root_of_unity_powers =
-          GetInvRootOfUnityPowers().data();
+          GetTableData(Table::InvRootOfUnityPowers);
       const uint64_t* precon_inv_root_of_unity_powers =
-          GetPrecon64InvRootOfUnityPowers().data();
+          GetTableData(Table::Precon64InvRootOfUnityPowers);
 
       InverseTransformFromBitReverseAVX512<s_default_shift_bits>(
           result, operand, m_degree, m_q, inv_root_of_unity_powers,
-          precon_inv_root_of_unity_powers, input_mod_factor, output_mod_factor);
+          precon_inv_root_of_unity_powers, input_mod_factor, output_mod_factor,
+          0, 0, mult_operand, scalar, addend);
     }
     return;
   }
 #endif
 
-  HEXL_VLOG(3, "Calling 64-bit default InvNTT");
-  const uint64_t* inv_root_of_unity_powers = GetInvRootOfUnityPowers().data();
+#ifdef HEXL_HAS_AVX256
+  if (has_avx2 && m_degree >= 16) {
+    const uint64_t* inv_root_of_unity_powers =
+        GetTableData(Table::InvRootOfUnityPowers);
+    if (m_q < s_max_inv_32_modulus) {
+      HEXL_VLOG(3, "Calling 32-bit AVX2 InvNTT");
+      const uint64_t* precon_inv_root_of_unity_powers =
+          GetTableData(Table::Precon32InvRootOfUnityPowers);
+      InverseTransformFromBitReverseAVX2<32>(
+          result, operand, m_degree, m_q, inv_root_of_unity_powers,
+          precon_inv_root_of_unity_powers, input_mod_factor, output_mod_factor,
+          0, 0, mult_operand, scalar, addend);
+    } else {
+      HEXL_VLOG(3, "Calling 64-bit AVX2 InvNTT");
+      const uint64_t* precon_inv_root_of_unity_powers =
+          GetTableData(Table::Precon64InvRootOfUnityPowers);
+      InverseTransformFromBitReverseAVX2<s_default_shift_bits>(
+          result, operand, m_degree, m_q, inv_root_of_unity_powers,
+          precon_inv_root_of_unity_powers, input_mod_factor, output_mod_factor,
+          0, 0, mult_operand, scalar, addend);
+    }
+    return;
+  }
+#endif
+
+  const uint64_t* inv_root_of_unity_powers =
+      GetTableData(Table::InvRootOfUnityPowers);
   const uint64_t* precon_inv_root_of_unity_powers =
-      GetPrecon64InvRootOfUnityPowers().data();
+      GetTableData(Table::Precon64InvRootOfUnityPowers);
+
+  if (m_inv_native_radix == NativeRadix::Radix4) {
+    HEXL_VLOG(3, "Calling 64-bit default radix-4 InvNTT");
+    InverseTransformFromBitReverseRadix4(
+        result, operand, m_degree, m_q, inv_root_of_unity_powers,
+        precon_inv_root_of_unity_powers, input_mod_factor, output_mod_factor,
+        0, 0, mult_operand, scalar, addend);
+    return;
+  }
+
+  HEXL_VLOG(3, "Calling 64-bit default InvNTT");
   InverseTransformFromBitReverseRadix2(
       result, operand, m_degree, m_q, inv_root_of_unity_powers,
-      precon_inv_root_of_unity_powers, input_mod_factor, output_mod_factor);
+      precon_inv_root_of_unity_powers, input_mod_factor, output_mod_factor, 0,
+      0, mult_operand, scalar, addend);
 }
 
 }  // namespace hexl
@@ -5,7 +5,11 @@
 
 #include <stdint.h>
 
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <utility>
+#include <vector>
 
 #include "hexl/ntt/ntt.hpp"
 #include "hexl/number-theory/number-theory.hpp"
@@ -17,6 +21,55 @@
 namespace intel {
 namespace hexl {
 
+/// @brief Precomputed tables of an NTT, built on first use and shared by
+/// copies of the NTT
+struct NTT::LazyTables {
+  explicit LazyTables(const AlignedAllocator<uint64_t, 64>& alloc)
+      : tables(s_num_tables, AlignedVector64<uint64_t>(alloc)) {}
+
+  static const size_t s_num_tables = static_cast<size_t>(Table::NumTables);
+
+  // Number of tables stored by NTT::Serialize. The compact tables are small,
+  // and the natural-order tables rarely used; both are recomputed on first
+  // use.
+  static const size_t s_num_serialized_tables =
+      static_cast<size_t>(Table::CompactRootOfUnityPowers);
+
+  std::vector<AlignedVector64<uint64_t>> tables;
+  std::once_flag built[s_num_tables];
+  std::atomic<size_t> num_bytes{0};
+
+  // Tables loaded by NTT::Deserialize, used in place of computing them. The
+  // memory is kept alive by buffer, if set.
+  const uint64_t* views[s_num_tables] = {};
+  size_t view_sizes[s_num_tables] = {};
+  std::shared_ptr<const void> buffer;
+
+  // For NTTs returned by NTT::CreateSubNTT, the NTT whose tables are read in
+  // place where possible
+  std::shared_ptr<const NTT> master;
+};
+
+/// @brief Returns the number of outer recursion levels into which a single
+/// transform of size \p n is split for parallel computation, or 0 if it is
+/// computed serially
+/// @details The transform is split into 2^levels blocks, each at least
+/// NTT::GetBaseNTTSize() if possible, when parallel transforms are enabled via
+/// NTT::SetParallelCutoff() and more than one thread is available.
+uint64_t ParallelNTTLevels(uint64_t n);
+
+/// @brief Computes the Barrett factors floor((operand[i] << bit_shift) /
+/// modulus) of a table of values
+/// @param[out] result Stores the n Barrett factors
+/// @param[in] operand Values in [0, modulus)
+/// @param[in] n Number of elements
+/// @param[in] bit_shift Must be 32, 52 or 64
+/// @param[in] modulus Odd modulus
+/// @details Equivalent to MultiplyFactor(operand[i], bit_shift,
+/// modulus).BarrettFactor(), without a 128-bit division per element
+void ComputeBarrettFactors(uint64_t* result, const uint64_t* operand,
+                           uint64_t n, uint64_t bit_shift, uint64_t modulus);
+
 /// @brief Radix-2 native C++ NTT implementation of the forward NTT
 /// @param[out] result Output data. Overwritten with NTT output
 /// @param[in] operand Input data.
@@ -31,11 +84,16 @@ namespace hexl {
 /// input_mod_factor * q)
 /// @param[in] output_mod_factor Upper bound for result; result must be in [0,
 /// output_mod_factor * q)
+/// @param[in] recursion_depth Depth of recursive call
+/// @param[in] recursion_half Helper for indexing roots of unity
+/// @details Transforms larger than NTT::GetBaseNTTSize() are computed
+/// depth-first, recursing on blocks until they fit in the L1 cache.
 void ForwardTransformToBitReverseRadix2(
     uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
     const uint64_t* root_of_unity_powers,
     const uint64_t* precon_root_of_unity_powers, uint64_t input_mod_factor = 1,
-    uint64_t output_mod_factor = 1);
+    uint64_t output_mod_factor = 1, uint64_t recursion_depth = 0,
+    uint64_t recursion_half = 0);
 
 /// @brief Radix-4 native C++ NTT implementation of the forward NTT
 /// @param[out] result Output data. Overwritten with NTT output
@@ -51,11 +109,37 @@ void ForwardTransformToBitReverseRadix2(
 /// input_mod_factor * q)
 /// @param[in] output_mod_factor Upper bound for result; result must be in [0,
 /// output_mod_factor * q)
+/// @param[in] recursion_depth Depth of recursive call
+/// @param[in] recursion_half Helper for indexing roots of unity
+/// @details Transforms larger than NTT::GetBaseNTTSize() are computed
+/// depth-first, recursing on blocks until they fit in the L1 cache.
 void ForwardTransformToBitReverseRadix4(
     uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
     const uint64_t* root_of_unity_powers,
     const uint64_t* precon_root_of_unity_powers, uint64_t input_mod_factor = 1,
-    uint64_t output_mod_factor = 1);
+    uint64_t output_mod_factor = 1, uint64_t recursion_depth = 0,
+    uint64_t recursion_half = 0);
+
+/// @brief Applies the first stage of the forward NTT to inputs of any 64-bit
+/// value, reducing them modulo q
+/// @param[out] result Overwritten with the outputs of the first stage, in [0,
+/// 4q). May alias \p operand.
+/// @param[in] operand Input data; any 64-bit values
+/// @param[in] n Size of the transform. Must be a power of two, at least 2.
+/// @param[in] modulus Prime modulus q. Must be less than
+/// NTT::s_max_lazy_modulus.
+/// @param[in] W Root of unity of the first stage, i.e. the root of unity
+/// power at index 1 of the transform's table
+/// @details The first element of each butterfly is Barrett-reduced to [0,
+/// 2q); the Shoup multiplication of the second element by W accepts any 64-bit
+/// value. The remaining stages are those of the sub-transforms of size n / 2
+/// with recursion_depth 1.
+void ForwardFirstStageReduce(uint64_t* result, const uint64_t* operand,
+                             uint64_t n, uint64_t modulus, uint64_t W);
+
+/// @brief Native C++ implementation of ForwardFirstStageReduce
+void ForwardFirstStageReduceNative(uint64_t* result, const uint64_t* operand,
+                                   uint64_t n, uint64_t modulus, uint64_t W);
 
 /// @brief Reference forward NTT which is written for clarity rather than
 /// performance
@@ -95,11 +179,25 @@ void ReferenceInverseTransformFromBitReverse(
 /// input_mod_factor * q)
 /// @param[in] output_mod_factor Upper bound for result; result must be in [0,
 /// output_mod_factor * q)
+/// @param[in] recursion_depth Depth of recursive call
+/// @param[in] recursion_half Helper for indexing roots of unity
+/// @param[in] mult_operand If not nullptr, computes the inverse NTT of the
+/// elementwise product of operand and mult_operand instead, with both inputs
+/// in [0, input_mod_factor * q) for input_mod_factor in {1, 2, 4}
+/// @param[in] scalar Output scalar in [0, q), folded into the multiplication
+/// by n^{-1} of the final stage
+/// @param[in] addend Additive correction in [0, q), added to each output in
+/// the final stage
+/// @details Transforms larger than NTT::GetBaseNTTSize() are computed
+/// depth-first, recursing on blocks until they fit in the L1 cache.
 void InverseTransformFromBitReverseRadix2(
     uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
     const uint64_t* inv_root_of_unity_powers,
     const uint64_t* precon_inv_root_of_unity_powers,
-    uint64_t input_mod_factor = 1, uint64_t output_mod_factor = 1);
+    uint64_t input_mod_factor = 1, uint64_t output_mod_factor = 1,
+    uint64_t recursion_depth = 0, uint64_t recursion_half = 0,
+    const uint64_t* mult_operand = nullptr, uint64_t scalar = 1,
+    uint64_t addend = 0);
 
 /// @brief Radix-4 native C++ NTT implementation of the inverse NTT
 /// @param[out] result Output data. Overwritten with NTT output
@@ -115,11 +213,217 @@ void InverseTransformFromBitReverseRadix2(
 /// input_mod_factor * q)
 /// @param[in] output_mod_factor Upper bound for result; result must be in [0,
 /// output_mod_factor * q)
+/// @param[in] recursion_depth Depth of recursive call
+/// @param[in] recursion_half Helper for indexing roots of unity
+/// @param[in] mult_operand If not nullptr, computes the inverse NTT of the
+/// elementwise product of operand and mult_operand instead, with both inputs
+/// in [0, input_mod_factor * q) for input_mod_factor in {1, 2, 4}
+/// @param[in] scalar Output scalar in [0, q), folded into the multiplication
+/// by n^{-1} of the final stage
+/// @param[in] addend Additive correction in [0, q), added to each output in
+/// the final stage
+/// @details Transforms larger than NTT::GetBaseNTTSize() are computed
+/// depth-first, recursing on blocks until they fit in the L1 cache.
 void InverseTransformFromBitReverseRadix4(
     uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
     const uint64_t* root_of_unity_powers,
     const uint64_t* precon_root_of_unity_powers, uint64_t input_mod_factor = 1,
-    uint64_t output_mod_factor = 1);
+    uint64_t output_mod_factor = 1, uint64_t recursion_depth = 0,
+    uint64_t recursion_half = 0, const uint64_t* mult_operand = nullptr,
+    uint64_t scalar = 1, uint64_t addend = 0);
+
+/// @brief Returns the number of low bits b of the bit-reversed indices of the
+/// roots of unity split off in the compact root of unity table of a transform
+/// of size \p n, i.e. ceil(log2(n) / 2)
+uint64_t CompactRootLowBits(uint64_t n);
+
+/// @brief Returns the size of the compact root of unity table of a transform
+/// of size \p n, i.e. 2^b + n / 2^b for b = CompactRootLowBits(n)
+uint64_t CompactRootTableSize(uint64_t n);
+
+/// @brief Native C++ implementation of the forward NTT which computes the
+/// roots of unity from a compact table
+/// @param[out] result Output data. Overwritten with NTT output
+/// @param[in] operand Input data.
+/// @param[in] n Size of the transform, i.e. the polynomial degree. Must be a
+/// power of two.
+/// @param[in] modulus Prime modulus q. Must satisfy q == 1 mod 2n
+/// @param[in] compact_root_of_unity_powers Powers W[k] of 2n'th root of unity
+/// in F_q, with k in bit-reversed order, stored as W[k] for k in [0, 2^b)
+/// followed by W[j * 2^b] for j in [0, n / 2^b), where b =
+/// CompactRootLowBits(n)
+/// @param[in] precon_compact_root_of_unity_powers Pre-conditioned \p
+/// compact_root_of_unity_powers for 64-bit Barrett reduction
+/// @param[in] input_mod_factor Upper bound for inputs; inputs must be in [0,
+/// input_mod_factor * q)
+/// @param[in] output_mod_factor Upper bound for result; result must be in [0,
+/// output_mod_factor * q)
+/// @details Each root W[k] with k >= 2^b is applied as W[k - k mod 2^b] *
+/// W[k mod 2^b], i.e. as two Shoup multiplications. Transforms larger than
+/// NTT::GetBaseNTTSize() are computed depth-first.
+void ForwardTransformToBitReverseCompact(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* compact_root_of_unity_powers,
+    const uint64_t* precon_compact_root_of_unity_powers,
+    uint64_t input_mod_factor = 1, uint64_t output_mod_factor = 1);
+
+/// @brief Native C++ implementation of the inverse NTT which computes the
+/// roots of unity from a compact table
+/// @param[out] result Output data. Overwritten with NTT output
+/// @param[in] operand Input data.
+/// @param[in] n Size of the transform, i.e. the polynomial degree. Must be a
+/// power of two.
+/// @param[in] modulus Prime modulus q. Must satisfy q == 1 mod 2n
+/// @param[in] compact_inv_root_of_unity_powers Powers of inverse 2n'th root of
+/// unity in F_q, in the layout of ForwardTransformToBitReverseCompact
+/// @param[in] precon_compact_inv_root_of_unity_powers Pre-conditioned \p
+/// compact_inv_root_of_unity_powers for 64-bit Barrett reduction
+/// @param[in] input_mod_factor Upper bound for inputs; inputs must be in [0,
+/// input_mod_factor * q). Must be 1 or 2.
+/// @param[in] output_mod_factor Upper bound for result; result must be in [0,
+/// output_mod_factor * q). Must be 1 or 2.
+void InverseTransformFromBitReverseCompact(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* compact_inv_root_of_unity_powers,
+    const uint64_t* precon_compact_inv_root_of_unity_powers,
+    uint64_t input_mod_factor = 1, uint64_t output_mod_factor = 1);
+
+/// @brief Native C++ implementation of the forward NTT in 64-bit Montgomery
+/// arithmetic, which reads a single table entry per root of unity
+/// @param[out] result Output data. Overwritten with NTT output
+/// @param[in] operand Input data.
+/// @param[in] n Size of the transform, i.e. the polynomial degree. Must be a
+/// power of two.
+/// @param[in] modulus Prime modulus q. Must satisfy q == 1 mod 2n and q <
+/// 2^62
+/// @param[in] montgomery_root_of_unity_powers Powers of 2n'th root of unity in
+/// F_q, in bit-reversed order, in Montgomery form w * 2^64 mod q
+/// @param[in] input_mod_factor Upper bound for inputs; inputs must be in [0,
+/// input_mod_factor * q)
+/// @param[in] output_mod_factor Upper bound for result; result must be in [0,
+/// output_mod_factor * q)
+/// @details Since the transform is linear, inputs in Montgomery form yield
+/// outputs in Montgomery form. Transforms larger than NTT::GetBaseNTTSize()
+/// are computed depth-first.
+void ForwardTransformToBitReverseMontgomery(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* montgomery_root_of_unity_powers,
+    uint64_t input_mod_factor = 1, uint64_t output_mod_factor = 1);
+
+/// @brief Native C++ implementation of the inverse NTT in 64-bit Montgomery
+/// arithmetic
+/// @param[out] result Output data. Overwritten with NTT output
+/// @param[in] operand Input data.
+/// @param[in] n Size of the transform, i.e. the polynomial degree. Must be a
+/// power of two.
+/// @param[in] modulus Prime modulus q. Must satisfy q == 1 mod 2n and q <
+/// 2^62
+/// @param[in] montgomery_inv_root_of_unity_powers Powers of inverse 2n'th root
+/// of unity in F_q, in the layout of NTT::GetInvRootOfUnityPowers(), in
+/// Montgomery form w * 2^64 mod q
+/// @param[in] input_mod_factor Upper bound for inputs; inputs must be in [0,
+/// input_mod_factor * q). Must be 1 or 2.
+/// @param[in] output_mod_factor Upper bound for result; result must be in [0,
+/// output_mod_factor * q). Must be 1 or 2.
+void InverseTransformFromBitReverseMontgomery(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* montgomery_inv_root_of_unity_powers,
+    uint64_t input_mod_factor = 1, uint64_t output_mod_factor = 1);
+
+/// @brief Native C++ implementation of the forward NTT for moduli of up to 64
+/// bits, in 64-bit Montgomery arithmetic with fully reduced butterflies
+/// @param[out] result Output data. Overwritten with NTT output in [0, q)
+/// @param[in] operand Input data.
+/// @param[in] n Size of the transform, i.e. the polynomial degree. Must be a
+/// power of two.
+/// @param[in] modulus Prime modulus q. Must satisfy q == 1 mod 2n
+/// @param[in] montgomery_root_of_unity_powers Powers of 2n'th root of unity in
+/// F_q, in bit-reversed order, in Montgomery form w * 2^64 mod q
+/// @param[in] input_mod_factor Upper bound for inputs; inputs must be in [0,
+/// input_mod_factor * q), or less than 2^64 if that is smaller
+/// @details For q >= 2^62, the lazy reduction of the other transforms
+/// overflows, so every butterfly output is reduced to [0, q) instead.
+/// Slower than ForwardTransformToBitReverseMontgomery, but a 64-bit modulus
+/// holds two more bits than a 62-bit one, which can save a limb of a
+/// multi-limb RNS modulus.
+void ForwardTransformToBitReverseLargeModulus(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* montgomery_root_of_unity_powers,
+    uint64_t input_mod_factor = 1);
+
+/// @brief Native C++ implementation of the inverse NTT for moduli of up to 64
+/// bits. See ForwardTransformToBitReverseLargeModulus.
+/// @param[out] result Output data. Overwritten with NTT output in [0, q)
+/// @param[in] operand Input data.
+/// @param[in] n Size of the transform, i.e. the polynomial degree. Must be a
+/// power of two.
+/// @param[in] modulus Prime modulus q. Must satisfy q == 1 mod 2n
+/// @param[in] montgomery_inv_root_of_unity_powers Powers of inverse 2n'th root
+/// of unity in F_q, in the layout of NTT::GetInvRootOfUnityPowers(), in
+/// Montgomery form w * 2^64 mod q
+/// @param[in] input_mod_factor Upper bound for inputs; inputs must be in [0,
+/// input_mod_factor * q), or less than 2^64 if that is smaller. Must be 1 or
+/// 2.
+void InverseTransformFromBitReverseLargeModulus(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* montgomery_inv_root_of_unity_powers,
+    uint64_t input_mod_factor = 1);
+
+/// @brief Stockham native C++ implementation of the forward NTT, with input
+/// and output in natural order
+/// @param[out] result Output data. Overwritten with NTT output
+/// @param[in] operand Input data. May alias \p result.
+/// @param[in] scratch Buffer of \p n elements, overwritten
+/// @param[in] n Size of the transform, i.e. the polynomial degree. Must be a
+/// power of two.
+/// @param[in] modulus Prime modulus q. Must satisfy q == 1 mod 2n
+/// @param[in] natural_root_of_unity_powers Powers psi^i of 2n'th root of unity
+/// in F_q, for i in [0, n), in natural order
+/// @param[in] precon_natural_root_of_unity_powers Pre-conditioned \p
+/// natural_root_of_unity_powers for 64-bit Barrett reduction
+/// @param[in] input_mod_factor Upper bound for inputs; inputs must be in [0,
+/// input_mod_factor * q)
+/// @param[in] output_mod_factor Upper bound for result; result must be in [0,
+/// output_mod_factor * q)
+/// @details Each stage reads one of \p result and \p scratch and writes the
+/// other, so no bit-reversal permutation is needed. The negacyclic twist by
+/// psi^i is fused into the first stage.
+void ForwardTransformToNaturalStockham(
+    uint64_t* result, const uint64_t* operand, uint64_t* scratch, uint64_t n,
+    uint64_t modulus, const uint64_t* natural_root_of_unity_powers,
+    const uint64_t* precon_natural_root_of_unity_powers,
+    uint64_t input_mod_factor = 1, uint64_t output_mod_factor = 1);
+
+/// @brief Stockham native C++ implementation of the inverse NTT, with input
+/// and output in natural order
+/// @param[out] result Output data. Overwritten with NTT output
+/// @param[in] operand Input data. May alias \p result.
+/// @param[in] scratch Buffer of \p n elements, overwritten
+/// @param[in] n Size of the transform, i.e. the polynomial degree. Must be a
+/// power of two.
+/// @param[in] modulus Prime modulus q. Must satisfy q == 1 mod 2n
+/// @param[in] natural_inv_root_of_unity_powers Powers psi^{-i} of inverse
+/// 2n'th root of unity in F_q, for i in [0, n), in natural order
+/// @param[in] precon_natural_inv_root_of_unity_powers Pre-conditioned \p
+/// natural_inv_root_of_unity_powers for 64-bit Barrett reduction
+/// @param[in] input_mod_factor Upper bound for inputs; inputs must be in [0,
+/// input_mod_factor * q). Must be 1 or 2.
+/// @param[in] output_mod_factor Upper bound for result; result must be in [0,
+/// output_mod_factor * q). Must be 1 or 2.
+/// @details The negacyclic twist by psi^{-i} and the scaling by n^{-1} are
+/// fused into the last stage.
+void InverseTransformFromNaturalStockham(
+    uint64_t* result, const uint64_t* operand, uint64_t* scratch, uint64_t n,
+    uint64_t modulus, const uint64_t* natural_inv_root_of_unity_powers,
+    const uint64_t* precon_natural_inv_root_of_unity_powers,
+    uint64_t input_mod_factor = 1, uint64_t output_mod_factor = 1);
+
+/// @brief Native C++ implementation of BitReversePermute
+/// @param[out] result Stores the permuted data. May alias \p operand.
+/// @param[in] operand Data to permute
+/// @param[in] n Number of elements. Must be a power of two.
+void BitReversePermuteNative(uint64_t* result, const uint64_t* operand,
+                             uint64_t n);
 
 }  // namespace hexl
 }  // namespace intel
@@ -0,0 +1,481 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "hexl/ntt/ntt-mixed-radix.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "hexl/eltwise/eltwise-add-mod.hpp"
+#include "hexl/eltwise/eltwise-fma-mod.hpp"
+#include "hexl/eltwise/eltwise-mult-mod.hpp"
+#include "hexl/eltwise/eltwise-sub-mod.hpp"
+#include "hexl/logging/logging.hpp"
+#include "hexl/number-theory/number-theory.hpp"
+#include "hexl/util/check.hpp"
+#include "util/util-internal.hpp"
+
+namespace intel {
+namespace hexl {
+
+struct MixedRadixNTT::Tables {
+  explicit Tables(const AlignedAllocator<uint64_t, 64>& alloc)
+      : column_roots(alloc),
+        row_twiddles(alloc),
+        chirp(alloc),
+        scaled_chirp(alloc),
+        transformed_chirp(alloc) {}
+
+  // w1^i for i < n1, with w1 the n1'th root of unity of the column transforms
+  AlignedVector64<uint64_t> column_roots;
+
+  // Constants of the radix-3 and radix-5 butterflies; see Radix3Butterfly and
+  // Radix5Butterfly
+  uint64_t radix3[2]{};
+  uint64_t radix5[5]{};
+
+  // w^(j2 * k1) at index k1 * n2 + j2, scaled by 1 / n1 in the inverse
+  // direction. Empty if all ones.
+  AlignedVector64<uint64_t> row_twiddles;
+
+  // Bluestein's algorithm: c^(j^2) for j < n, the same scaled by 1 / n in the
+  // inverse direction, and the NTT of the convolution kernel c^(-i^2), for the
+  // chirp root c with c^2 = w
+  AlignedVector64<uint64_t> chirp;
+  AlignedVector64<uint64_t> scaled_chirp;
+  AlignedVector64<uint64_t> transformed_chirp;
+};
+
+namespace {
+
+// Number of elements processed per butterfly call, such that the temporaries
+// stay in L1 cache
+const uint64_t s_butterfly_block_size = 512;
+
+// Words of scratch used by the butterflies of ColumnTransform
+const uint64_t s_butterfly_scratch_size = 6 * s_butterfly_block_size;
+
+std::vector<uint64_t> PrimeFactors(uint64_t n) {
+  std::vector<uint64_t> factors;
+  for (uint64_t p = 2; p * p <= n; ++p) {
+    if (n % p == 0) {
+      factors.push_back(p);
+      while (n % p == 0) {
+        n /= p;
+      }
+    }
+  }
+  if (n > 1) {
+    factors.push_back(n);
+  }
+  return factors;
+}
+
+// Returns the smallest n'th root of unity of the form g^((q - 1) / n) which is
+// primitive, i.e. with no power w^(n / p) == 1 for a prime p dividing n
+uint64_t PrimitiveRootOfOrder(uint64_t n, uint64_t q) {
+  std::vector<uint64_t> factors = PrimeFactors(n);
+  for (uint64_t g = 2; g < q; ++g) {
+    uint64_t root = PowMod(g, (q - 1) / n, q);
+    bool primitive = std::all_of(factors.begin(), factors.end(),
+                                 [&](uint64_t p) {
+                                   return PowMod(root, n / p, q) != 1;
+                                 });
+    if (primitive) {
+      return root;
+    }
+  }
+  HEXL_CHECK(false, "no primitive root of order " << n << " modulo " << q);
+  return 0;
+}
+
+uint64_t BluesteinLength(uint64_t n) {
+  uint64_t length = 1;
+  while (length < 2 * n - 1) {
+    length <<= 1;
+  }
+  return length;
+}
+
+uint64_t Pow2Factor(uint64_t n) { return n & (~n + 1); }
+
+// Computes y_k = sum_j x_j w3^(j k) on n elements as
+//   y_0 = x_0 + (x_1 + x_2),
+//   y_1,2 = x_0 + c (x_1 + x_2) +/- d (x_1 - x_2),
+// with constants = {c, d} = {-1/2, (w3 - w3^2) / 2}. Uses 2n temporaries.
+void Radix3Butterfly(uint64_t* const* y, const uint64_t* const* x, uint64_t n,
+                     const uint64_t* constants, uint64_t* temp,
+                     uint64_t modulus) {
+  uint64_t* sum = temp;
+  uint64_t* diff = temp + n;
+  EltwiseAddMod(sum, x[1], x[2], n, modulus);
+  EltwiseSubMod(diff, x[1], x[2], n, modulus);
+  EltwiseAddMod(y[0], x[0], sum, n, modulus);
+  EltwiseFMAMod(sum, sum, constants[0], x[0], n, modulus, 1);
+  EltwiseFMAMod(diff, diff, constants[1], nullptr, n, modulus, 1);
+  EltwiseAddMod(y[1], sum, diff, n, modulus);
+  EltwiseSubMod(y[2], sum, diff, n, modulus);
+}
+
+// Computes y_k = sum_j x_j w5^(j k) on n elements as
+//   y_0 = x_0 + t_1 + t_2,
+//   y_1,4 = (x_0 + c_1 t_1 + c_2 t_2) +/- (d_1 s_1 + d_2 s_2),
+//   y_2,3 = (x_0 + c_2 t_1 + c_1 t_2) +/- (d_2 s_1 - d_1 s_2),
+// with t_1,s_1 = x_1 +/- x_4, t_2,s_2 = x_2 +/- x_3 and constants = {c_1, c_2,
+// d_1, d_2, -d_1}, where c_k,d_k = (w5^k +/- w5^(-k)) / 2. Uses 6n
+// temporaries.
+void Radix5Butterfly(uint64_t* const* y, const uint64_t* const* x, uint64_t n,
+                     const uint64_t* constants, uint64_t* temp,
+                     uint64_t modulus) {
+  const uint64_t c1 = constants[0];
+  const uint64_t c2 = constants[1];
+  const uint64_t d1 = constants[2];
+  const uint64_t d2 = constants[3];
+  const uint64_t neg_d1 = constants[4];
+
+  uint64_t* t1 = temp;
+  uint64_t* t2 = temp + n;
+  uint64_t* s1 = temp + 2 * n;
+  uint64_t* s2 = temp + 3 * n;
+  uint64_t* a1 = temp + 4 * n;
+  uint64_t* a2 = temp + 5 * n;
+  EltwiseAddMod(t1, x[1], x[4], n, modulus);
+  EltwiseAddMod(t2, x[2], x[3], n, modulus);
+  EltwiseSubMod(s1, x[1], x[4], n, modulus);
+  EltwiseSubMod(s2, x[2], x[3], n, modulus);
+
+  EltwiseAddMod(y[0], x[0], t1, n, modulus);
+  EltwiseAddMod(y[0], y[0], t2, n, modulus);
+
+  EltwiseFMAMod(a1, t1, c1, x[0], n, modulus, 1);
+  EltwiseFMAMod(a1, t2, c2, a1, n, modulus, 1);
+  EltwiseFMAMod(a2, t1, c2, x[0], n, modulus, 1);
+  EltwiseFMAMod(a2, t2, c1, a2, n, modulus, 1);
+
+  // t1 and t2 are reused for the odd parts
+  uint64_t* b1 = t1;
+  uint64_t* b2 = t2;
+  EltwiseFMAMod(b1, s1, d1, nullptr, n, modulus, 1);
+  EltwiseFMAMod(b1, s2, d2, b1, n, modulus, 1);
+  EltwiseFMAMod(b2, s1, d2, nullptr, n, modulus, 1);
+  EltwiseFMAMod(b2, s2, neg_d1, b2, n, modulus, 1);
+
+  EltwiseAddMod(y[1], a1, b1, n, modulus);
+  EltwiseSubMod(y[4], a1, b1, n, modulus);
+  EltwiseAddMod(y[2], a2, b2, n, modulus);
+  EltwiseSubMod(y[3], a2, b2, n, modulus);
+}
+
+}  // namespace
+
+MixedRadixNTT::MixedRadixNTT(uint64_t degree, uint64_t q,
+                             std::shared_ptr<AllocatorBase> alloc_ptr)
+    : m_degree(degree),
+      m_q(q),
+      m_alloc(alloc_ptr),
+      m_aligned_alloc(AlignedAllocator<uint64_t, 64>(m_alloc)) {
+  HEXL_CHECK(CheckArguments(degree, q), "");
+
+  if (UsesBluestein(degree)) {
+    uint64_t length = BluesteinLength(degree);
+    if (degree % 2 == 0) {
+      m_chirp_root = PrimitiveRootOfOrder(2 * degree, q);
+      m_w = MultiplyMod(m_chirp_root, m_chirp_root, q);
+    } else {
+      m_w = PrimitiveRootOfOrder(degree, q);
+      m_chirp_root = PowMod(m_w, (degree + 1) / 2, q);
+    }
+    m_ntt = std::make_shared<NTT>(NTT::CreateCyclic(length, q, alloc_ptr));
+    HEXL_VLOG(3, "Bluestein NTT of length " << degree
+                                            << " with convolution length "
+                                            << length);
+  } else {
+    m_w = PrimitiveRootOfOrder(degree, q);
+    m_pow2_degree = Pow2Factor(degree);
+    m_odd_degree = degree / m_pow2_degree;
+    for (uint64_t radix : {5, 3}) {
+      for (uint64_t rest = m_odd_degree; rest % radix == 0; rest /= radix) {
+        m_radices.push_back(radix);
+      }
+    }
+    if (m_pow2_degree >= 2) {
+      m_ntt = std::make_shared<NTT>(NTT::CreateCyclic(
+          m_pow2_degree, q, PowMod(m_w, m_odd_degree, q), alloc_ptr));
+      uint64_t bits = Log2(m_pow2_degree);
+      m_bit_reversed.resize(m_pow2_degree);
+      for (uint64_t i = 0; i < m_pow2_degree; ++i) {
+        m_bit_reversed[i] = ReverseBits(i, bits);
+      }
+    }
+    HEXL_VLOG(3, "Mixed-radix NTT of length "
+                     << degree << " = " << m_odd_degree << " * "
+                     << m_pow2_degree);
+  }
+
+  m_fwd_tables = ComputeTables(false);
+  m_inv_tables = ComputeTables(true);
+}
+
+bool MixedRadixNTT::UsesBluestein(uint64_t degree) {
+  degree /= Pow2Factor(degree);
+  for (uint64_t radix : {3, 5}) {
+    while (degree % radix == 0) {
+      degree /= radix;
+    }
+  }
+  return degree != 1;
+}
+
+bool MixedRadixNTT::CheckArguments(uint64_t degree, uint64_t q) {
+  if (degree == 0 || degree > (1ULL << NTT::MaxDegreeBits())) {
+    return false;
+  }
+  if (q < 2 || q >= (1ULL << 61) || (q - 1) % degree != 0 || !IsPrime(q)) {
+    return false;
+  }
+  if (!UsesBluestein(degree)) {
+    return Log2(Pow2Factor(degree)) <= NTT::MaxDirectDegreeBits();
+  }
+  uint64_t length = BluesteinLength(degree);
+  return Log2(length) <= NTT::MaxDirectDegreeBits() &&
+         (q - 1) % length == 0 &&
+         (degree % 2 == 1 || (q - 1) % (2 * degree) == 0);
+}
+
+std::shared_ptr<const MixedRadixNTT::Tables> MixedRadixNTT::ComputeTables(
+    bool inverse) const {
+  auto tables = std::make_shared<Tables>(m_aligned_alloc);
+  uint64_t w = inverse ? InverseMod(m_w, m_q) : m_w;
+
+  if (m_chirp_root != 0) {
+    uint64_t chirp_root =
+        inverse ? InverseMod(m_chirp_root, m_q) : m_chirp_root;
+    uint64_t inv_chirp_root = InverseMod(chirp_root, m_q);
+    uint64_t order = (m_degree % 2 == 0) ? 2 * m_degree : m_degree;
+    uint64_t scale = inverse ? InverseMod(m_degree, m_q) : 1;
+    uint64_t length = m_ntt->GetDegree();
+
+    tables->chirp.resize(m_degree);
+    tables->scaled_chirp.resize(m_degree);
+    tables->transformed_chirp.resize(length, 0);
+    uint64_t* kernel = tables->transformed_chirp.data();
+    for (uint64_t j = 0; j < m_degree; ++j) {
+      uint64_t exponent = (j * j) % order;
+      tables->chirp[j] = PowMod(chirp_root, exponent, m_q);
+      tables->scaled_chirp[j] = MultiplyMod(tables->chirp[j], scale, m_q);
+      kernel[j] = PowMod(inv_chirp_root, exponent, m_q);
+      if (j != 0) {
+        kernel[length - j] = kernel[j];
+      }
+    }
+    m_ntt->ComputeForward(kernel, kernel, 1, 1);
+    return tables;
+  }
+
+  const uint64_t n1 = m_odd_degree;
+  const uint64_t n2 = m_pow2_degree;
+  if (n1 == 1) {
+    return tables;
+  }
+  uint64_t w1 = PowMod(w, n2, m_q);
+  tables->column_roots.resize(n1);
+  tables->column_roots[0] = 1;
+  for (uint64_t i = 1; i < n1; ++i) {
+    tables->column_roots[i] = MultiplyMod(tables->column_roots[i - 1], w1, m_q);
+  }
+
+  uint64_t inv_two = (m_q + 1) / 2;
+  auto half_sum = [&](uint64_t x, uint64_t y) {
+    return MultiplyMod(AddUIntMod(x, y, m_q), inv_two, m_q);
+  };
+  auto half_diff = [&](uint64_t x, uint64_t y) {
+    return MultiplyMod(SubUIntMod(x, y, m_q), inv_two, m_q);
+  };
+  if (n1 % 3 == 0) {
+    const uint64_t* w3 = &tables->column_roots[0];
+    uint64_t stride = n1 / 3;
+    tables->radix3[0] = half_sum(w3[stride], w3[2 * stride]);
+    tables->radix3[1] = half_diff(w3[stride], w3[2 * stride]);
+  }
+  if (n1 % 5 == 0) {
+    const uint64_t* w5 = &tables->column_roots[0];
+    uint64_t stride = n1 / 5;
+    tables->radix5[0] = half_sum(w5[stride], w5[4 * stride]);
+    tables->radix5[1] = half_sum(w5[2 * stride], w5[3 * stride]);
+    tables->radix5[2] = half_diff(w5[stride], w5[4 * stride]);
+    tables->radix5[3] = half_diff(w5[2 * stride], w5[3 * stride]);
+    tables->radix5[4] = SubUIntMod(0, tables->radix5[2], m_q);
+  }
+
+  if (n2 > 1 || inverse) {
+    uint64_t scale = inverse ? InverseMod(n1, m_q) : 1;
+    tables->row_twiddles.resize(m_degree);
+    uint64_t w_k1 = 1;
+    for (uint64_t k1 = 0; k1 < n1; ++k1) {
+      uint64_t* row = &tables->row_twiddles[k1 * n2];
+      row[0] = scale;
+      for (uint64_t j2 = 1; j2 < n2; ++j2) {
+        row[j2] = MultiplyMod(row[j2 - 1], w_k1, m_q);
+      }
+      w_k1 = MultiplyMod(w_k1, w, m_q);
+    }
+  }
+  return tables;
+}
+
+void MixedRadixNTT::ColumnTransform(uint64_t* result, const uint64_t* operand,
+                                    uint64_t* scratch,
+                                    const Tables& tables) const {
+  // Stockham autosort transform on the n1 rows. The stage of radix r and
+  // stride s computes, for the rows p < m = n1 / (s r), j, k < r and q < s,
+  //   y[q + s (r p + k)] = w1^(s p k) * sum_j x[q + s (p + j m)] w_r^(j k),
+  // so the rows q < s of each block are contiguous. The last stage writes to
+  // result.
+  const uint64_t n1 = m_odd_degree;
+  const uint64_t n2 = m_pow2_degree;
+  const size_t num_stages = m_radices.size();
+
+  const uint64_t* x = operand;
+  if (num_stages % 2 == 1 && operand == result) {
+    std::memcpy(scratch, operand, m_degree * sizeof(uint64_t));
+    x = scratch;
+  }
+
+  uint64_t* temp = scratch + m_degree;
+  uint64_t s = 1;
+  uint64_t m = n1;
+  for (size_t stage = 0; stage < num_stages; ++stage) {
+    const uint64_t radix = m_radices[stage];
+    uint64_t* y = ((num_stages - stage) % 2 == 1) ? result : scratch;
+    m /= radix;
+    const uint64_t block = s * n2;
+
+    for (uint64_t p = 0; p < m; ++p) {
+      for (uint64_t offset = 0; offset < block;
+           offset += s_butterfly_block_size) {
+        const uint64_t n = std::min(s_butterfly_block_size, block - offset);
+        const uint64_t* in[5];
+        uint64_t* out[5];
+        for (uint64_t j = 0; j < radix; ++j) {
+          in[j] = x + (p + j * m) * block + offset;
+          out[j] = y + (radix * p + j) * block + offset;
+        }
+        if (radix == 3) {
+          Radix3Butterfly(out, in, n, tables.radix3, temp, m_q);
+        } else {
+          Radix5Butterfly(out, in, n, tables.radix5, temp, m_q);
+        }
+        if (p != 0) {
+          for (uint64_t k = 1; k < radix; ++k) {
+            EltwiseFMAMod(out[k], out[k], tables.column_roots[s * p * k],
+                          nullptr, n, m_q, 1);
+          }
+        }
+      }
+    }
+    x = y;
+    s *= radix;
+  }
+}
+
+void MixedRadixNTT::BluesteinTransform(uint64_t* result,
+                                       const uint64_t* operand,
+                                       const Tables& tables) const {
+  // X_k = c^(k^2) sum_j (x_j c^(j^2)) c^(-(k - j)^2), since w^(j k) = c^(j^2 +
+  // k^2 - (k - j)^2), as a cyclic convolution of length at least 2n - 1
+  AlignedVector64<uint64_t> product(m_ntt->GetDegree(), 0, m_aligned_alloc);
+  EltwiseMultMod(product.data(), operand, tables.chirp.data(), m_degree, m_q,
+                 1);
+  m_ntt->MultiplyTransformed(product.data(), product.data(),
+                             tables.transformed_chirp.data(), 1, 1);
+  EltwiseMultMod(result, product.data(), tables.scaled_chirp.data(), m_degree,
+                 m_q, 1);
+}
+
+void MixedRadixNTT::ComputeForward(uint64_t* result,
+                                   const uint64_t* operand) const {
+  HEXL_CHECK(result != nullptr, "result == nullptr");
+  HEXL_CHECK(operand != nullptr, "operand == nullptr");
+  HEXL_CHECK_BOUNDS(operand, m_degree, m_q,
+                    "value in operand exceeds bound " << m_q);
+
+  if (m_chirp_root != 0) {
+    BluesteinTransform(result, operand, *m_fwd_tables);
+    return;
+  }
+
+  // With j = n2 j1 + j2 and k = k1 + n1 k2, w^(j k) = w1^(j1 k1) w^(j2 k1)
+  // w2^(j2 k2), for w1 = w^n2 and w2 = w^n1. So the transforms of length n1
+  // over the columns j1 of the n1 x n2 matrix, twiddled by w^(j2 k1), are
+  // followed by the transforms of length n2 over the rows.
+  const uint64_t n1 = m_odd_degree;
+  const uint64_t n2 = m_pow2_degree;
+  ScratchBuffer scratch(m_degree + s_butterfly_scratch_size, m_aligned_alloc);
+  const uint64_t* rows = operand;
+  if (n1 > 1) {
+    ColumnTransform(result, operand, scratch.data(), *m_fwd_tables);
+    if (!m_fwd_tables->row_twiddles.empty()) {
+      EltwiseMultMod(result, result, m_fwd_tables->row_twiddles.data(),
+                     m_degree, m_q, 1);
+    }
+    rows = result;
+  }
+  if (!m_ntt) {
+    if (rows != result) {
+      std::memcpy(result, rows, m_degree * sizeof(uint64_t));
+    }
+    return;
+  }
+
+  // The row transforms return bit-reversed outputs, which are transposed to
+  // result[k1 + n1 k2]
+  for (uint64_t k1 = 0; k1 < n1; ++k1) {
+    m_ntt->ComputeForward(&scratch[k1 * n2], rows + k1 * n2, 1, 1);
+  }
+  for (uint64_t k1 = 0; k1 < n1; ++k1) {
+    const uint64_t* row = &scratch[k1 * n2];
+    for (uint64_t k2 = 0; k2 < n2; ++k2) {
+      result[k1 + n1 * k2] = row[m_bit_reversed[k2]];
+    }
+  }
+}
+
+void MixedRadixNTT::ComputeInverse(uint64_t* result,
+                                   const uint64_t* operand) const {
+  HEXL_CHECK(result != nullptr, "result == nullptr");
+  HEXL_CHECK(operand != nullptr, "operand == nullptr");
+  HEXL_CHECK_BOUNDS(operand, m_degree, m_q,
+                    "value in operand exceeds bound " << m_q);
+
+  if (m_chirp_root != 0) {
+    BluesteinTransform(result, operand, *m_inv_tables);
+    return;
+  }
+
+  // Reverses the steps of ComputeForward. The inverse row transforms scale by
+  // 1 / n2 and the inverse twiddles by 1 / n1.
+  const uint64_t n1 = m_odd_degree;
+  const uint64_t n2 = m_pow2_degree;
+  ScratchBuffer scratch(m_degree + s_butterfly_scratch_size, m_aligned_alloc);
+  if (m_ntt) {
+    for (uint64_t k1 = 0; k1 < n1; ++k1) {
+      uint64_t* row = &scratch[k1 * n2];
+      for (uint64_t k2 = 0; k2 < n2; ++k2) {
+        row[m_bit_reversed[k2]] = operand[k1 + n1 * k2];
+      }
+    }
+    for (uint64_t k1 = 0; k1 < n1; ++k1) {
+      m_ntt->ComputeInverse(result + k1 * n2, &scratch[k1 * n2], 1, 1);
+    }
+  } else if (result != operand) {
+    std::memcpy(result, operand, m_degree * sizeof(uint64_t));
+  }
+  if (n1 > 1) {
+    EltwiseMultMod(result, result, m_inv_tables->row_twiddles.data(), m_degree,
+                   m_q, 1);
+    ColumnTransform(result, result, scratch.data(), *m_inv_tables);
+  }
+}
+
+}  // namespace hexl
+}  // namespace intel
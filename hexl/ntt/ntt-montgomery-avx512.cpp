@@ -0,0 +1,509 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ntt/ntt-montgomery-avx512.hpp"
+
+#include <immintrin.h>
+#include <stdint.h>
+
+#include "hexl/logging/logging.hpp"
+#include "hexl/number-theory/number-theory.hpp"
+#include "hexl/util/check.hpp"
+#include "ntt/ntt-avx512-util.hpp"
+#include "ntt/ntt-internal.hpp"
+#include "ntt/ntt-montgomery.hpp"
+#include "util/avx512-util.hpp"
+
+#ifdef HEXL_HAS_AVX512DQ
+
+namespace intel {
+namespace hexl {
+
+namespace {
+
+// Applies a stage with t in {1, 2, 4} to a block of n elements, n a multiple
+// of 16. Each 16 elements hold 8 / t groups of butterflies.
+template <typename Butterfly>
+void SmallStage(uint64_t* result, const uint64_t* operand, size_t t, size_t n,
+                const uint64_t* W, Butterfly butterfly) {
+  HEXL_CHECK(n % 16 == 0, "n " << n << " not a multiple of 16");
+  const SmallStageLayout layout(t);
+  const size_t groups_per_chunk = layout.GroupsPerChunk();
+  for (size_t chunk = 0; chunk < n / 16; ++chunk) {
+    __m512i v_X;
+    __m512i v_Y;
+    layout.Load(operand + 16 * chunk, &v_X, &v_Y);
+    butterfly(&v_X, &v_Y, layout.LoadRoots(W + chunk * groups_per_chunk));
+    layout.Store(result + 16 * chunk, v_X, v_Y);
+  }
+}
+
+// Butterflies with BitShift-bit Montgomery multiplication, i.e. R =
+// 2^BitShift. Vectorized stages with fewer than 8 butterflies per group
+// process 16 elements at a time, gathering the X and Y operands of each
+// butterfly into separate vectors.
+template <int BitShift>
+class AVX512MontgomeryKernel {
+ public:
+  explicit AVX512MontgomeryKernel(uint64_t modulus)
+      : m_modulus(modulus),
+        m_v_modulus(_mm512_set1_epi64(static_cast<int64_t>(modulus))),
+        m_v_twice_modulus(_mm512_set1_epi64(static_cast<int64_t>(2 * modulus))),
+        m_v_q_inv(_mm512_set1_epi64(static_cast<int64_t>(
+            InverseModPowerOfTwo(modulus) & MaximumValue(BitShift)))) {}
+
+  uint64_t Modulus() const { return m_modulus; }
+
+  uint64_t MontgomeryForm(uint64_t x) const {
+    return ToMontgomeryForm(x, m_modulus, BitShift);
+  }
+
+  void FwdButterflies(uint64_t* X_r, uint64_t* Y_r, const uint64_t* X_op,
+                      const uint64_t* Y_op, size_t count, uint64_t W) const {
+    HEXL_CHECK(count % 8 == 0, "count " << count << " not a multiple of 8");
+    const __m512i v_W = _mm512_set1_epi64(static_cast<int64_t>(W));
+    const __m512i* v_X_op = reinterpret_cast<const __m512i*>(X_op);
+    const __m512i* v_Y_op = reinterpret_cast<const __m512i*>(Y_op);
+    __m512i* v_X_r = reinterpret_cast<__m512i*>(X_r);
+    __m512i* v_Y_r = reinterpret_cast<__m512i*>(Y_r);
+    for (size_t j = 0; j < count / 8; ++j) {
+      __m512i v_X = _mm512_loadu_si512(v_X_op + j);
+      __m512i v_Y = _mm512_loadu_si512(v_Y_op + j);
+      FwdButterfly(&v_X, &v_Y, v_W);
+      _mm512_storeu_si512(v_X_r + j, v_X);
+      _mm512_storeu_si512(v_Y_r + j, v_Y);
+    }
+  }
+
+  void FwdStage(uint64_t* result, const uint64_t* operand, size_t t, size_t m,
+                const uint64_t* W) const {
+    if (t >= 8) {
+      for (size_t i = 0; i < m; ++i) {
+        size_t offset = 2 * i * t;
+        FwdButterflies(result + offset, result + offset + t, operand + offset,
+                       operand + offset + t, t, W[i]);
+      }
+      return;
+    }
+    SmallStage(result, operand, t, 2 * t * m, W, [this](__m512i* X, __m512i* Y,
+                                                        __m512i v_W) {
+      FwdButterfly(X, Y, v_W);
+    });
+  }
+
+  void InvButterflies(uint64_t* X_r, uint64_t* Y_r, const uint64_t* X_op,
+                      const uint64_t* Y_op, size_t count, uint64_t W) const {
+    HEXL_CHECK(count % 8 == 0, "count " << count << " not a multiple of 8");
+    const __m512i v_W = _mm512_set1_epi64(static_cast<int64_t>(W));
+    const __m512i* v_X_op = reinterpret_cast<const __m512i*>(X_op);
+    const __m512i* v_Y_op = reinterpret_cast<const __m512i*>(Y_op);
+    __m512i* v_X_r = reinterpret_cast<__m512i*>(X_r);
+    __m512i* v_Y_r = reinterpret_cast<__m512i*>(Y_r);
+    for (size_t j = 0; j < count / 8; ++j) {
+      __m512i v_X = _mm512_loadu_si512(v_X_op + j);
+      __m512i v_Y = _mm512_loadu_si512(v_Y_op + j);
+      InvButterfly(&v_X, &v_Y, v_W);
+      _mm512_storeu_si512(v_X_r + j, v_X);
+      _mm512_storeu_si512(v_Y_r + j, v_Y);
+    }
+  }
+
+  void InvStage(uint64_t* result, const uint64_t* operand, size_t t, size_t m,
+                const uint64_t* W) const {
+    if (t >= 8) {
+      for (size_t i = 0; i < m; ++i) {
+        size_t offset = 2 * i * t;
+        InvButterflies(result + offset, result + offset + t, operand + offset,
+                       operand + offset + t, t, W[i]);
+      }
+      return;
+    }
+    SmallStage(result, operand, t, 2 * t * m, W, [this](__m512i* X, __m512i* Y,
+                                                        __m512i v_W) {
+      InvButterfly(X, Y, v_W);
+    });
+  }
+
+  void InvFinalButterflies(uint64_t* X, uint64_t* Y, size_t count,
+                           uint64_t inv_n, uint64_t inv_n_w,
+                           uint64_t output_mod_factor) const {
+    HEXL_CHECK(count % 8 == 0, "count " << count << " not a multiple of 8");
+    const __m512i v_inv_n = _mm512_set1_epi64(static_cast<int64_t>(inv_n));
+    const __m512i v_inv_n_w = _mm512_set1_epi64(static_cast<int64_t>(inv_n_w));
+    __m512i* v_X_pt = reinterpret_cast<__m512i*>(X);
+    __m512i* v_Y_pt = reinterpret_cast<__m512i*>(Y);
+    for (size_t j = 0; j < count / 8; ++j) {
+      __m512i v_X = _mm512_loadu_si512(v_X_pt + j);
+      __m512i v_Y = _mm512_loadu_si512(v_Y_pt + j);
+      __m512i tx = _mm512_add_epi64(v_X, v_Y);
+      __m512i ty =
+          _mm512_sub_epi64(_mm512_add_epi64(v_X, m_v_twice_modulus), v_Y);
+      tx = Multiply(tx, v_inv_n);
+      ty = Multiply(ty, v_inv_n_w);
+      if (output_mod_factor == 1) {
+        tx = _mm512_hexl_small_mod_epu64(tx, m_v_modulus);
+        ty = _mm512_hexl_small_mod_epu64(ty, m_v_modulus);
+      }
+      _mm512_storeu_si512(v_X_pt + j, tx);
+      _mm512_storeu_si512(v_Y_pt + j, ty);
+    }
+  }
+
+ private:
+  // Returns x * y / 2^BitShift mod q in (0, 2q), for x in [0, 4q)
+  __m512i Multiply(__m512i x, __m512i y) const {
+    __m512i prod_lo = _mm512_hexl_mullo_epi<BitShift>(x, y);
+    __m512i prod_hi = _mm512_hexl_mulhi_epi<BitShift>(x, y);
+    __m512i m = _mm512_hexl_mullo_epi<BitShift>(prod_lo, m_v_q_inv);
+    __m512i mq_hi = _mm512_hexl_mulhi_epi<BitShift>(m, m_v_modulus);
+    return _mm512_add_epi64(_mm512_sub_epi64(prod_hi, mq_hi), m_v_modulus);
+  }
+
+  // X, Y in [0, 4q) => X + WY, X - WY in [0, 4q)
+  void FwdButterfly(__m512i* X, __m512i* Y, __m512i W) const {
+    __m512i tx = _mm512_hexl_small_mod_epu64(*X, m_v_twice_modulus);
+    __m512i T = Multiply(*Y, W);
+    *X = _mm512_add_epi64(tx, T);
+    *Y = _mm512_sub_epi64(_mm512_add_epi64(tx, m_v_twice_modulus), T);
+  }
+
+  // X, Y in [0, 2q) => X + Y, (X - Y) W in [0, 2q)
+  void InvButterfly(__m512i* X, __m512i* Y, __m512i W) const {
+    __m512i tx = _mm512_add_epi64(*X, *Y);
+    __m512i ty = _mm512_sub_epi64(_mm512_add_epi64(*X, m_v_twice_modulus), *Y);
+    *X = _mm512_hexl_small_mod_epu64(tx, m_v_twice_modulus);
+    *Y = Multiply(ty, W);
+  }
+
+  uint64_t m_modulus;
+  __m512i m_v_modulus;
+  __m512i m_v_twice_modulus;
+  __m512i m_v_q_inv;
+};
+
+// Butterflies with BitShift-bit Montgomery multiplication whose inputs and
+// outputs are in [0, q), for moduli q < 2^BitShift too large for the lazy
+// reduction of AVX512MontgomeryKernel<BitShift>, i.e. at least 2^(BitShift -
+// 2)
+template <int BitShift>
+class AVX512LargeModulusKernel {
+ public:
+  explicit AVX512LargeModulusKernel(uint64_t modulus)
+      : m_modulus(modulus),
+        m_v_modulus(_mm512_set1_epi64(static_cast<int64_t>(modulus))),
+        m_v_q_inv(_mm512_set1_epi64(static_cast<int64_t>(
+            InverseModPowerOfTwo(modulus) & MaximumValue(BitShift)))) {}
+
+  uint64_t Modulus() const { return m_modulus; }
+
+  uint64_t MontgomeryForm(uint64_t x) const {
+    return ToMontgomeryForm(x, m_modulus, BitShift);
+  }
+
+  void FwdButterflies(uint64_t* X_r, uint64_t* Y_r, const uint64_t* X_op,
+                      const uint64_t* Y_op, size_t count, uint64_t W) const {
+    HEXL_CHECK(count % 8 == 0, "count " << count << " not a multiple of 8");
+    const __m512i v_W = _mm512_set1_epi64(static_cast<int64_t>(W));
+    const __m512i* v_X_op = reinterpret_cast<const __m512i*>(X_op);
+    const __m512i* v_Y_op = reinterpret_cast<const __m512i*>(Y_op);
+    __m512i* v_X_r = reinterpret_cast<__m512i*>(X_r);
+    __m512i* v_Y_r = reinterpret_cast<__m512i*>(Y_r);
+    for (size_t j = 0; j < count / 8; ++j) {
+      __m512i v_X = _mm512_loadu_si512(v_X_op + j);
+      __m512i v_Y = _mm512_loadu_si512(v_Y_op + j);
+      FwdButterfly(&v_X, &v_Y, v_W);
+      _mm512_storeu_si512(v_X_r + j, v_X);
+      _mm512_storeu_si512(v_Y_r + j, v_Y);
+    }
+  }
+
+  void FwdStage(uint64_t* result, const uint64_t* operand, size_t t, size_t m,
+                const uint64_t* W) const {
+    if (t >= 8) {
+      for (size_t i = 0; i < m; ++i) {
+        size_t offset = 2 * i * t;
+        FwdButterflies(result + offset, result + offset + t, operand + offset,
+                       operand + offset + t, t, W[i]);
+      }
+      return;
+    }
+    SmallStage(result, operand, t, 2 * t * m, W, [this](__m512i* X, __m512i* Y,
+                                                        __m512i v_W) {
+      FwdButterfly(X, Y, v_W);
+    });
+  }
+
+  void InvButterflies(uint64_t* X_r, uint64_t* Y_r, const uint64_t* X_op,
+                      const uint64_t* Y_op, size_t count, uint64_t W) const {
+    HEXL_CHECK(count % 8 == 0, "count " << count << " not a multiple of 8");
+    const __m512i v_W = _mm512_set1_epi64(static_cast<int64_t>(W));
+    const __m512i* v_X_op = reinterpret_cast<const __m512i*>(X_op);
+    const __m512i* v_Y_op = reinterpret_cast<const __m512i*>(Y_op);
+    __m512i* v_X_r = reinterpret_cast<__m512i*>(X_r);
+    __m512i* v_Y_r = reinterpret_cast<__m512i*>(Y_r);
+    for (size_t j = 0; j < count / 8; ++j) {
+      __m512i v_X = _mm512_loadu_si512(v_X_op + j);
+      __m512i v_Y = _mm512_loadu_si512(v_Y_op + j);
+      InvButterfly(&v_X, &v_Y, v_W);
+      _mm512_storeu_si512(v_X_r + j, v_X);
+      _mm512_storeu_si512(v_Y_r + j, v_Y);
+    }
+  }
+
+  void InvStage(uint64_t* result, const uint64_t* operand, size_t t, size_t m,
+                const uint64_t* W) const {
+    if (t >= 8) {
+      for (size_t i = 0; i < m; ++i) {
+        size_t offset = 2 * i * t;
+        InvButterflies(result + offset, result + offset + t, operand + offset,
+                       operand + offset + t, t, W[i]);
+      }
+      return;
+    }
+    SmallStage(result, operand, t, 2 * t * m, W, [this](__m512i* X, __m512i* Y,
+                                                        __m512i v_W) {
+      InvButterfly(X, Y, v_W);
+    });
+  }
+
+  // Outputs in [0, q) for any output_mod_factor
+  void InvFinalButterflies(uint64_t* X, uint64_t* Y, size_t count,
+                           uint64_t inv_n, uint64_t inv_n_w,
+                           uint64_t output_mod_factor) const {
+    HEXL_CHECK(count % 8 == 0, "count " << count << " not a multiple of 8");
+    HEXL_UNUSED(output_mod_factor);
+    const __m512i v_inv_n = _mm512_set1_epi64(static_cast<int64_t>(inv_n));
+    const __m512i v_inv_n_w = _mm512_set1_epi64(static_cast<int64_t>(inv_n_w));
+    __m512i* v_X_pt = reinterpret_cast<__m512i*>(X);
+    __m512i* v_Y_pt = reinterpret_cast<__m512i*>(Y);
+    for (size_t j = 0; j < count / 8; ++j) {
+      __m512i v_X = _mm512_loadu_si512(v_X_pt + j);
+      __m512i v_Y = _mm512_loadu_si512(v_Y_pt + j);
+      __m512i tx = AddMod(v_X, v_Y);
+      __m512i ty = SubMod(v_X, v_Y);
+      _mm512_storeu_si512(v_X_pt + j, Multiply(tx, v_inv_n));
+      _mm512_storeu_si512(v_Y_pt + j, Multiply(ty, v_inv_n_w));
+    }
+  }
+
+  // Reduces n values, a multiple of 8, from [0, input_mod_factor * q) to [0,
+  // q). Subtracts q repeatedly, since 2q may overflow 64 bits.
+  void ReduceMod(uint64_t* result, const uint64_t* operand, size_t n,
+                 uint64_t input_mod_factor) const {
+    const __m512i* v_op = reinterpret_cast<const __m512i*>(operand);
+    __m512i* v_result = reinterpret_cast<__m512i*>(result);
+    for (size_t i = 0; i < n / 8; ++i) {
+      __m512i v_x = _mm512_loadu_si512(v_op + i);
+      for (uint64_t k = 1; k < input_mod_factor; ++k) {
+        v_x = _mm512_hexl_small_mod_epu64(v_x, m_v_modulus);
+      }
+      _mm512_storeu_si512(v_result + i, v_x);
+    }
+  }
+
+ private:
+  // Returns x * y / 2^BitShift mod q in [0, q), for x, y in [0, q). As in
+  // MultiplyModMontgomery, x y < 2^BitShift q bounds both high words by q.
+  __m512i Multiply(__m512i x, __m512i y) const {
+    if (BitShift == 64) {
+      return _mm512_hexl_montgomery_mul_epu64(x, y, m_v_modulus, m_v_q_inv);
+    }
+    __m512i prod_hi = _mm512_hexl_mulhi_epi<BitShift>(x, y);
+    __m512i prod_lo = _mm512_hexl_mullo_epi<BitShift>(x, y);
+    __m512i m = _mm512_hexl_mullo_epi<BitShift>(prod_lo, m_v_q_inv);
+    __m512i mq_hi = _mm512_hexl_mulhi_epi<BitShift>(m, m_v_modulus);
+    __m512i v_diff = _mm512_sub_epi64(prod_hi, mq_hi);
+    __mmask8 borrow = _mm512_cmplt_epu64_mask(prod_hi, mq_hi);
+    return _mm512_mask_add_epi64(v_diff, borrow, v_diff, m_v_modulus);
+  }
+
+  // The small variants test the sign bit, which is unambiguous for q < 2^52
+  __m512i AddMod(__m512i x, __m512i y) const {
+    return (BitShift == 64)
+               ? _mm512_hexl_large_add_mod_epi64(x, y, m_v_modulus)
+               : _mm512_hexl_small_add_mod_epi64(x, y, m_v_modulus);
+  }
+
+  __m512i SubMod(__m512i x, __m512i y) const {
+    return (BitShift == 64)
+               ? _mm512_hexl_large_sub_mod_epi64(x, y, m_v_modulus)
+               : _mm512_hexl_small_sub_mod_epi64(x, y, m_v_modulus);
+  }
+
+  // X, Y in [0, q) => X + WY, X - WY in [0, q)
+  void FwdButterfly(__m512i* X, __m512i* Y, __m512i W) const {
+    __m512i T = Multiply(*Y, W);
+    __m512i tx = *X;
+    *X = AddMod(tx, T);
+    *Y = SubMod(tx, T);
+  }
+
+  // X, Y in [0, q) => X + Y, (X - Y) W in [0, q)
+  void InvButterfly(__m512i* X, __m512i* Y, __m512i W) const {
+    __m512i tx = AddMod(*X, *Y);
+    __m512i ty = SubMod(*X, *Y);
+    *X = tx;
+    *Y = Multiply(ty, W);
+  }
+
+  uint64_t m_modulus;
+  __m512i m_v_modulus;
+  __m512i m_v_q_inv;
+};
+
+}  // namespace
+
+template <int BitShift>
+void ForwardTransformToBitReverseMontgomeryAVX512(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* montgomery_root_of_unity_powers, uint64_t input_mod_factor,
+    uint64_t output_mod_factor) {
+  HEXL_CHECK(NTT::CheckArguments(n, modulus), "");
+  HEXL_CHECK(n >= 16, "n " << n << " must be at least 16");
+  HEXL_CHECK(modulus < (1ULL << (BitShift - 2)),
+             "modulus " << modulus << " too large for BitShift " << BitShift);
+  HEXL_CHECK(input_mod_factor == 1 || input_mod_factor == 2 ||
+                 input_mod_factor == 4,
+             "input_mod_factor must be 1, 2 or 4; got " << input_mod_factor);
+  HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 4,
+             "output_mod_factor must be 1 or 4; got " << output_mod_factor);
+  HEXL_CHECK_BOUNDS(operand, n, modulus * input_mod_factor,
+                    "operand exceeds bound " << modulus * input_mod_factor);
+  HEXL_UNUSED(input_mod_factor);
+
+  ForwardTransformMontgomery(AVX512MontgomeryKernel<BitShift>(modulus), result,
+                             operand, n, montgomery_root_of_unity_powers,
+                             output_mod_factor);
+}
+
+template <int BitShift>
+void InverseTransformFromBitReverseMontgomeryAVX512(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* montgomery_inv_root_of_unity_powers,
+    uint64_t input_mod_factor, uint64_t output_mod_factor) {
+  HEXL_CHECK(NTT::CheckArguments(n, modulus), "");
+  HEXL_CHECK(n >= 16, "n " << n << " must be at least 16");
+  HEXL_CHECK(modulus < (1ULL << (BitShift - 2)),
+             "modulus " << modulus << " too large for BitShift " << BitShift);
+  HEXL_CHECK(input_mod_factor == 1 || input_mod_factor == 2,
+             "input_mod_factor must be 1 or 2; got " << input_mod_factor);
+  HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 2,
+             "output_mod_factor must be 1 or 2; got " << output_mod_factor);
+  HEXL_CHECK_BOUNDS(operand, n, modulus * input_mod_factor,
+                    "operand exceeds bound " << modulus * input_mod_factor);
+  HEXL_UNUSED(input_mod_factor);
+
+  InverseTransformMontgomery(AVX512MontgomeryKernel<BitShift>(modulus), result,
+                             operand, n, montgomery_inv_root_of_unity_powers,
+                             output_mod_factor);
+}
+
+#ifdef HEXL_HAS_AVX512IFMA
+template void ForwardTransformToBitReverseMontgomeryAVX512<
+    NTT::s_ifma_shift_bits>(uint64_t* result, const uint64_t* operand,
+                            uint64_t n, uint64_t modulus,
+                            const uint64_t* montgomery_root_of_unity_powers,
+                            uint64_t input_mod_factor,
+                            uint64_t output_mod_factor);
+
+template void InverseTransformFromBitReverseMontgomeryAVX512<
+    NTT::s_ifma_shift_bits>(uint64_t* result, const uint64_t* operand,
+                            uint64_t n, uint64_t modulus,
+                            const uint64_t* montgomery_inv_root_of_unity_powers,
+                            uint64_t input_mod_factor,
+                            uint64_t output_mod_factor);
+#endif
+
+template void ForwardTransformToBitReverseMontgomeryAVX512<
+    NTT::s_default_shift_bits>(uint64_t* result, const uint64_t* operand,
+                               uint64_t n, uint64_t modulus,
+                               const uint64_t* montgomery_root_of_unity_powers,
+                               uint64_t input_mod_factor,
+                               uint64_t output_mod_factor);
+
+template void InverseTransformFromBitReverseMontgomeryAVX512<
+    NTT::s_default_shift_bits>(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* montgomery_inv_root_of_unity_powers,
+    uint64_t input_mod_factor, uint64_t output_mod_factor);
+
+template <int BitShift>
+void ForwardTransformToBitReverseLargeModulusAVX512(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* montgomery_root_of_unity_powers,
+    uint64_t input_mod_factor) {
+  HEXL_CHECK(NTT::CheckArguments(n, modulus), "");
+  HEXL_CHECK(n >= 16, "n " << n << " must be at least 16");
+  HEXL_CHECK(modulus <= MaximumValue(BitShift),
+             "modulus " << modulus << " too large for BitShift " << BitShift);
+  HEXL_CHECK(input_mod_factor == 1 || input_mod_factor == 2 ||
+                 input_mod_factor == 4,
+             "input_mod_factor must be 1, 2 or 4; got " << input_mod_factor);
+  HEXL_CHECK_BOUNDS(operand, n, ModFactorBound(modulus, input_mod_factor),
+                    "operand exceeds bound "
+                        << ModFactorBound(modulus, input_mod_factor));
+
+  AVX512LargeModulusKernel<BitShift> kernel(modulus);
+  if (input_mod_factor != 1) {
+    kernel.ReduceMod(result, operand, n, input_mod_factor);
+    operand = result;
+  }
+  // The outputs are in [0, q), so no final reduction is needed
+  ForwardTransformMontgomery(kernel, result, operand, n,
+                             montgomery_root_of_unity_powers, 4);
+}
+
+template <int BitShift>
+void InverseTransformFromBitReverseLargeModulusAVX512(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* montgomery_inv_root_of_unity_powers,
+    uint64_t input_mod_factor) {
+  HEXL_CHECK(NTT::CheckArguments(n, modulus), "");
+  HEXL_CHECK(n >= 16, "n " << n << " must be at least 16");
+  HEXL_CHECK(modulus <= MaximumValue(BitShift),
+             "modulus " << modulus << " too large for BitShift " << BitShift);
+  HEXL_CHECK(input_mod_factor == 1 || input_mod_factor == 2,
+             "input_mod_factor must be 1 or 2; got " << input_mod_factor);
+  HEXL_CHECK_BOUNDS(operand, n, ModFactorBound(modulus, input_mod_factor),
+                    "operand exceeds bound "
+                        << ModFactorBound(modulus, input_mod_factor));
+
+  AVX512LargeModulusKernel<BitShift> kernel(modulus);
+  if (input_mod_factor != 1) {
+    kernel.ReduceMod(result, operand, n, input_mod_factor);
+    operand = result;
+  }
+  InverseTransformMontgomery(kernel, result, operand, n,
+                             montgomery_inv_root_of_unity_powers, 1);
+}
+
+#ifdef HEXL_HAS_AVX512IFMA
+template void ForwardTransformToBitReverseLargeModulusAVX512<
+    NTT::s_ifma_shift_bits>(uint64_t* result, const uint64_t* operand,
+                            uint64_t n, uint64_t modulus,
+                            const uint64_t* montgomery_root_of_unity_powers,
+                            uint64_t input_mod_factor);
+
+template void InverseTransformFromBitReverseLargeModulusAVX512<
+    NTT::s_ifma_shift_bits>(uint64_t* result, const uint64_t* operand,
+                            uint64_t n, uint64_t modulus,
+                            const uint64_t* montgomery_inv_root_of_unity_powers,
+                            uint64_t input_mod_factor);
+#endif
+
+template void ForwardTransformToBitReverseLargeModulusAVX512<
+    NTT::s_default_shift_bits>(uint64_t* result, const uint64_t* operand,
+                               uint64_t n, uint64_t modulus,
+                               const uint64_t* montgomery_root_of_unity_powers,
+                               uint64_t input_mod_factor);
+
+template void InverseTransformFromBitReverseLargeModulusAVX512<
+    NTT::s_default_shift_bits>(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* montgomery_inv_root_of_unity_powers,
+    uint64_t input_mod_factor);
+
+}  // namespace hexl
+}  // namespace intel
+
+#endif  // HEXL_HAS_AVX512DQ
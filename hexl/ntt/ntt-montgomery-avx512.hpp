@@ -0,0 +1,80 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdint.h>
+
+#include "hexl/ntt/ntt.hpp"
+
+namespace intel {
+namespace hexl {
+
+#ifdef HEXL_HAS_AVX512DQ
+
+/// @brief AVX512 implementation of the forward NTT in Montgomery arithmetic
+/// @param[out] result Output data. Overwritten with NTT output
+/// @param[in] operand Input data.
+/// @param[in] n Size of the transform, i.e. the polynomial degree. Must be a
+/// power of two, at least 16.
+/// @param[in] modulus Prime modulus q. Must satisfy q == 1 mod 2n and q <
+/// 2^(BitShift - 2)
+/// @param[in] montgomery_root_of_unity_powers Powers of 2n'th root of unity in
+/// F_q, in bit-reversed order, in Montgomery form w * 2^BitShift mod q
+/// @param[in] input_mod_factor Upper bound for inputs; inputs must be in [0,
+/// input_mod_factor * q)
+/// @param[in] output_mod_factor Upper bound for result; result must be in [0,
+/// output_mod_factor * q)
+/// @details BitShift 52 uses the AVX512-IFMA multiply instructions; BitShift
+/// 64 emulates the high 64 bits of the products.
+template <int BitShift>
+void ForwardTransformToBitReverseMontgomeryAVX512(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* montgomery_root_of_unity_powers, uint64_t input_mod_factor,
+    uint64_t output_mod_factor);
+
+/// @brief AVX512 implementation of the inverse NTT in Montgomery arithmetic
+/// @param[out] result Output data. Overwritten with NTT output
+/// @param[in] operand Input data.
+/// @param[in] n Size of the transform, i.e. the polynomial degree. Must be a
+/// power of two, at least 16.
+/// @param[in] modulus Prime modulus q. Must satisfy q == 1 mod 2n and q <
+/// 2^(BitShift - 2)
+/// @param[in] montgomery_inv_root_of_unity_powers Powers of inverse 2n'th root
+/// of unity in F_q, in the layout of NTT::GetInvRootOfUnityPowers(), in
+/// Montgomery form w * 2^BitShift mod q
+/// @param[in] input_mod_factor Upper bound for inputs; inputs must be in [0,
+/// input_mod_factor * q). Must be 1 or 2.
+/// @param[in] output_mod_factor Upper bound for result; result must be in [0,
+/// output_mod_factor * q). Must be 1 or 2.
+template <int BitShift>
+void InverseTransformFromBitReverseMontgomeryAVX512(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* montgomery_inv_root_of_unity_powers,
+    uint64_t input_mod_factor, uint64_t output_mod_factor);
+
+/// @brief AVX512 implementation of the forward NTT for moduli of up to
+/// BitShift bits. See ForwardTransformToBitReverseLargeModulus. \p n must be
+/// at least 16.
+/// @details The butterflies keep all values in [0, q), so unlike
+/// ForwardTransformToBitReverseMontgomeryAVX512, BitShift 52 supports moduli
+/// q < 2^52 and BitShift 64 moduli q < 2^64.
+template <int BitShift>
+void ForwardTransformToBitReverseLargeModulusAVX512(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* montgomery_root_of_unity_powers,
+    uint64_t input_mod_factor);
+
+/// @brief AVX512 implementation of the inverse NTT for moduli of up to
+/// BitShift bits. See InverseTransformFromBitReverseLargeModulus. \p n must be
+/// at least 16.
+template <int BitShift>
+void InverseTransformFromBitReverseLargeModulusAVX512(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* montgomery_inv_root_of_unity_powers,
+    uint64_t input_mod_factor);
+
+#endif  // HEXL_HAS_AVX512DQ
+
+}  // namespace hexl
+}  // namespace intel
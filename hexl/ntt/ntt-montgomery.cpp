@@ -0,0 +1,282 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ntt/ntt-montgomery.hpp"
+
+#include "hexl/logging/logging.hpp"
+#include "hexl/number-theory/number-theory.hpp"
+#include "hexl/util/check.hpp"
+#include "ntt/ntt-internal.hpp"
+
+namespace intel {
+namespace hexl {
+
+namespace {
+
+// Butterflies with 64-bit Montgomery multiplication, i.e. R = 2^64
+class NativeMontgomeryKernel {
+ public:
+  explicit NativeMontgomeryKernel(uint64_t modulus)
+      : m_modulus(modulus),
+        m_twice_modulus(modulus << 1),
+        m_q_inv(InverseModPowerOfTwo(modulus)) {}
+
+  uint64_t Modulus() const { return m_modulus; }
+
+  uint64_t MontgomeryForm(uint64_t x) const {
+    return ToMontgomeryForm(x, m_modulus, 64);
+  }
+
+  // Inputs in [0, 4q); outputs in [0, 4q)
+  void FwdButterflies(uint64_t* X_r, uint64_t* Y_r, const uint64_t* X_op,
+                      const uint64_t* Y_op, size_t count, uint64_t W) const {
+    HEXL_LOOP_UNROLL_4
+    for (size_t j = 0; j < count; ++j) {
+      uint64_t tx = ReduceMod<2>(X_op[j], m_twice_modulus);
+      uint64_t T = Multiply(Y_op[j], W);
+      X_r[j] = tx + T;
+      Y_r[j] = tx + m_twice_modulus - T;
+    }
+  }
+
+  void FwdStage(uint64_t* result, const uint64_t* operand, size_t t, size_t m,
+                const uint64_t* W) const {
+    for (size_t i = 0; i < m; ++i) {
+      size_t offset = 2 * i * t;
+      FwdButterflies(result + offset, result + offset + t, operand + offset,
+                     operand + offset + t, t, W[i]);
+    }
+  }
+
+  // Inputs in [0, 2q); outputs in [0, 2q)
+  void InvButterflies(uint64_t* X_r, uint64_t* Y_r, const uint64_t* X_op,
+                      const uint64_t* Y_op, size_t count, uint64_t W) const {
+    HEXL_LOOP_UNROLL_4
+    for (size_t j = 0; j < count; ++j) {
+      uint64_t x = X_op[j];
+      uint64_t y = Y_op[j];
+      X_r[j] = ReduceMod<2>(x + y, m_twice_modulus);
+      Y_r[j] = Multiply(x + m_twice_modulus - y, W);
+    }
+  }
+
+  void InvStage(uint64_t* result, const uint64_t* operand, size_t t, size_t m,
+                const uint64_t* W) const {
+    for (size_t i = 0; i < m; ++i) {
+      size_t offset = 2 * i * t;
+      InvButterflies(result + offset, result + offset + t, operand + offset,
+                     operand + offset + t, t, W[i]);
+    }
+  }
+
+  void InvFinalButterflies(uint64_t* X, uint64_t* Y, size_t count,
+                           uint64_t inv_n, uint64_t inv_n_w,
+                           uint64_t output_mod_factor) const {
+    for (size_t j = 0; j < count; ++j) {
+      uint64_t x = X[j];
+      uint64_t y = Y[j];
+      X[j] = Multiply(x + y, inv_n);
+      Y[j] = Multiply(x + m_twice_modulus - y, inv_n_w);
+    }
+    if (output_mod_factor == 1) {
+      for (size_t j = 0; j < count; ++j) {
+        X[j] = ReduceMod<2>(X[j], m_modulus);
+        Y[j] = ReduceMod<2>(Y[j], m_modulus);
+      }
+    }
+  }
+
+ private:
+  uint64_t Multiply(uint64_t x, uint64_t y) const {
+    return MultiplyModMontgomeryLazy(x, y, m_modulus, m_q_inv);
+  }
+
+  uint64_t m_modulus;
+  uint64_t m_twice_modulus;
+  uint64_t m_q_inv;
+};
+
+// Butterflies with 64-bit Montgomery multiplication whose inputs and outputs
+// are in [0, q), for moduli too large for the lazy reduction of
+// NativeMontgomeryKernel
+class NativeLargeModulusKernel {
+ public:
+  explicit NativeLargeModulusKernel(uint64_t modulus)
+      : m_modulus(modulus), m_q_inv(InverseModPowerOfTwo(modulus)) {}
+
+  uint64_t Modulus() const { return m_modulus; }
+
+  uint64_t MontgomeryForm(uint64_t x) const {
+    return ToMontgomeryForm(x, m_modulus, 64);
+  }
+
+  void FwdButterflies(uint64_t* X_r, uint64_t* Y_r, const uint64_t* X_op,
+                      const uint64_t* Y_op, size_t count, uint64_t W) const {
+    HEXL_LOOP_UNROLL_4
+    for (size_t j = 0; j < count; ++j) {
+      uint64_t x = X_op[j];
+      uint64_t T = Multiply(Y_op[j], W);
+      X_r[j] = AddMod(x, T);
+      Y_r[j] = SubMod(x, T);
+    }
+  }
+
+  void FwdStage(uint64_t* result, const uint64_t* operand, size_t t, size_t m,
+                const uint64_t* W) const {
+    for (size_t i = 0; i < m; ++i) {
+      size_t offset = 2 * i * t;
+      FwdButterflies(result + offset, result + offset + t, operand + offset,
+                     operand + offset + t, t, W[i]);
+    }
+  }
+
+  void InvButterflies(uint64_t* X_r, uint64_t* Y_r, const uint64_t* X_op,
+                      const uint64_t* Y_op, size_t count, uint64_t W) const {
+    HEXL_LOOP_UNROLL_4
+    for (size_t j = 0; j < count; ++j) {
+      uint64_t x = X_op[j];
+      uint64_t y = Y_op[j];
+      X_r[j] = AddMod(x, y);
+      Y_r[j] = Multiply(SubMod(x, y), W);
+    }
+  }
+
+  void InvStage(uint64_t* result, const uint64_t* operand, size_t t, size_t m,
+                const uint64_t* W) const {
+    for (size_t i = 0; i < m; ++i) {
+      size_t offset = 2 * i * t;
+      InvButterflies(result + offset, result + offset + t, operand + offset,
+                     operand + offset + t, t, W[i]);
+    }
+  }
+
+  // Outputs in [0, q) for any output_mod_factor
+  void InvFinalButterflies(uint64_t* X, uint64_t* Y, size_t count,
+                           uint64_t inv_n, uint64_t inv_n_w,
+                           uint64_t output_mod_factor) const {
+    HEXL_UNUSED(output_mod_factor);
+    for (size_t j = 0; j < count; ++j) {
+      uint64_t x = X[j];
+      uint64_t y = Y[j];
+      X[j] = Multiply(AddMod(x, y), inv_n);
+      Y[j] = Multiply(SubMod(x, y), inv_n_w);
+    }
+  }
+
+ private:
+  uint64_t Multiply(uint64_t x, uint64_t y) const {
+    return MultiplyModMontgomery(x, y, m_modulus, m_q_inv);
+  }
+
+  // x + y may overflow, so compare x against q - y instead
+  uint64_t AddMod(uint64_t x, uint64_t y) const {
+    uint64_t diff = m_modulus - y;
+    return (x >= diff) ? x - diff : x + y;
+  }
+
+  uint64_t SubMod(uint64_t x, uint64_t y) const {
+    uint64_t diff = x - y;
+    return (x < y) ? diff + m_modulus : diff;
+  }
+
+  uint64_t m_modulus;
+  uint64_t m_q_inv;
+};
+
+// Reduces n values from [0, input_mod_factor * q) to [0, q), for moduli for
+// which 2q may overflow
+void ReduceLargeModulus(uint64_t* result, const uint64_t* operand, uint64_t n,
+                        uint64_t modulus, uint64_t input_mod_factor) {
+  for (size_t i = 0; i < n; ++i) {
+    uint64_t x = operand[i];
+    for (uint64_t k = 1; k < input_mod_factor; ++k) {
+      x = ReduceMod<2>(x, modulus);
+    }
+    result[i] = x;
+  }
+}
+
+}  // namespace
+
+void ForwardTransformToBitReverseMontgomery(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* montgomery_root_of_unity_powers, uint64_t input_mod_factor,
+    uint64_t output_mod_factor) {
+  HEXL_CHECK(NTT::CheckArguments(n, modulus), "");
+  HEXL_CHECK(modulus < (1ULL << 62), "modulus " << modulus << " too large");
+  HEXL_CHECK(input_mod_factor == 1 || input_mod_factor == 2 ||
+                 input_mod_factor == 4,
+             "input_mod_factor must be 1, 2 or 4; got " << input_mod_factor);
+  HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 4,
+             "output_mod_factor must be 1 or 4; got " << output_mod_factor);
+  HEXL_CHECK_BOUNDS(operand, n, modulus * input_mod_factor,
+                    "operand exceeds bound " << modulus * input_mod_factor);
+  HEXL_UNUSED(input_mod_factor);
+
+  ForwardTransformMontgomery(NativeMontgomeryKernel(modulus), result, operand,
+                             n, montgomery_root_of_unity_powers,
+                             output_mod_factor);
+}
+
+void InverseTransformFromBitReverseMontgomery(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* montgomery_inv_root_of_unity_powers,
+    uint64_t input_mod_factor, uint64_t output_mod_factor) {
+  HEXL_CHECK(NTT::CheckArguments(n, modulus), "");
+  HEXL_CHECK(modulus < (1ULL << 62), "modulus " << modulus << " too large");
+  HEXL_CHECK(input_mod_factor == 1 || input_mod_factor == 2,
+             "input_mod_factor must be 1 or 2; got " << input_mod_factor);
+  HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 2,
+             "output_mod_factor must be 1 or 2; got " << output_mod_factor);
+  HEXL_CHECK_BOUNDS(operand, n, modulus * input_mod_factor,
+                    "operand exceeds bound " << modulus * input_mod_factor);
+  HEXL_UNUSED(input_mod_factor);
+
+  InverseTransformMontgomery(NativeMontgomeryKernel(modulus), result, operand,
+                             n, montgomery_inv_root_of_unity_powers,
+                             output_mod_factor);
+}
+
+void ForwardTransformToBitReverseLargeModulus(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* montgomery_root_of_unity_powers,
+    uint64_t input_mod_factor) {
+  HEXL_CHECK(NTT::CheckArguments(n, modulus), "");
+  HEXL_CHECK(input_mod_factor == 1 || input_mod_factor == 2 ||
+                 input_mod_factor == 4,
+             "input_mod_factor must be 1, 2 or 4; got " << input_mod_factor);
+  HEXL_CHECK_BOUNDS(operand, n, ModFactorBound(modulus, input_mod_factor),
+                    "operand exceeds bound "
+                        << ModFactorBound(modulus, input_mod_factor));
+
+  if (input_mod_factor != 1) {
+    ReduceLargeModulus(result, operand, n, modulus, input_mod_factor);
+    operand = result;
+  }
+  // The outputs are in [0, q), so no final reduction is needed
+  ForwardTransformMontgomery(NativeLargeModulusKernel(modulus), result,
+                             operand, n, montgomery_root_of_unity_powers, 4);
+}
+
+void InverseTransformFromBitReverseLargeModulus(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* montgomery_inv_root_of_unity_powers,
+    uint64_t input_mod_factor) {
+  HEXL_CHECK(NTT::CheckArguments(n, modulus), "");
+  HEXL_CHECK(input_mod_factor == 1 || input_mod_factor == 2,
+             "input_mod_factor must be 1 or 2; got " << input_mod_factor);
+  HEXL_CHECK_BOUNDS(operand, n, ModFactorBound(modulus, input_mod_factor),
+                    "operand exceeds bound "
+                        << ModFactorBound(modulus, input_mod_factor));
+
+  if (input_mod_factor != 1) {
+    ReduceLargeModulus(result, operand, n, modulus, input_mod_factor);
+    operand = result;
+  }
+  InverseTransformMontgomery(NativeLargeModulusKernel(modulus), result,
+                             operand, n, montgomery_inv_root_of_unity_powers,
+                             1);
+}
+
+}  // namespace hexl
+}  // namespace intel
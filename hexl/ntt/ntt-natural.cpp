@@ -0,0 +1,248 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include <cstring>
+
+#include "hexl/logging/logging.hpp"
+#include "hexl/ntt/ntt.hpp"
+#include "hexl/number-theory/number-theory.hpp"
+#include "hexl/util/aligned-allocator.hpp"
+#include "hexl/util/check.hpp"
+#include "hexl/util/defines.hpp"
+#include "ntt/ntt-default.hpp"
+#include "ntt/ntt-internal.hpp"
+
+namespace intel {
+namespace hexl {
+
+namespace {
+
+// Computes the Stockham radix-2 stage of stride s of a transform of size n,
+// i.e. for p in [0, n / 2s) and j in [0, s),
+//   y[j + 2sp] = a + b, y[j + 2sp + s] = (a - b) * W[2sp],
+// where a = x[j + sp], b = x[j + sp + n / 2]. Assumes x in [0, 2q) and returns
+// y in [0, 2q).
+void StockhamStage(uint64_t* y, const uint64_t* x, uint64_t n, uint64_t s,
+                   const uint64_t* W, const uint64_t* W_precon,
+                   uint64_t modulus) {
+  const uint64_t twice_modulus = modulus << 1;
+  const uint64_t half_n = n >> 1;
+  if (s == 1) {
+    HEXL_LOOP_UNROLL_4
+    for (size_t p = 0; p < half_n; ++p) {
+      InvButterflyRadix2(&y[2 * p], &y[2 * p + 1], &x[p], &x[p + half_n],
+                         W[2 * p], W_precon[2 * p], modulus, twice_modulus);
+    }
+    return;
+  }
+  for (size_t p = 0; p < half_n / s; ++p) {
+    const uint64_t w = W[2 * s * p];
+    const uint64_t w_precon = W_precon[2 * s * p];
+    const uint64_t* X_op = x + s * p;
+    const uint64_t* Y_op = X_op + half_n;
+    uint64_t* X_r = y + 2 * s * p;
+    uint64_t* Y_r = X_r + s;
+    HEXL_LOOP_UNROLL_4
+    for (size_t j = 0; j < s; ++j) {
+      InvButterflyRadix2(X_r++, Y_r++, X_op++, Y_op++, w, w_precon, modulus,
+                         twice_modulus);
+    }
+  }
+}
+
+// Returns the buffer written by stage k of a Stockham transform with
+// num_stages stages, such that the last stage writes to result
+inline uint64_t* StageOutput(uint64_t* result, uint64_t* scratch,
+                             uint64_t num_stages, uint64_t k) {
+  return ((num_stages - 1 - k) % 2 == 0) ? result : scratch;
+}
+
+}  // namespace
+
+void ForwardTransformToNaturalStockham(
+    uint64_t* result, const uint64_t* operand, uint64_t* scratch, uint64_t n,
+    uint64_t modulus, const uint64_t* natural_root_of_unity_powers,
+    const uint64_t* precon_natural_root_of_unity_powers,
+    uint64_t input_mod_factor, uint64_t output_mod_factor) {
+  HEXL_CHECK(NTT::CheckArguments(n, modulus), "");
+  HEXL_CHECK_BOUNDS(operand, n, modulus * input_mod_factor,
+                    "operand exceeds bound " << modulus * input_mod_factor);
+  HEXL_CHECK(natural_root_of_unity_powers != nullptr,
+             "natural_root_of_unity_powers == nullptr");
+  HEXL_CHECK(precon_natural_root_of_unity_powers != nullptr,
+             "precon_natural_root_of_unity_powers == nullptr");
+  HEXL_CHECK(
+      input_mod_factor == 1 || input_mod_factor == 2 || input_mod_factor == 4,
+      "input_mod_factor must be 1, 2, or 4; got " << input_mod_factor);
+  HEXL_UNUSED(input_mod_factor);
+  HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 4,
+             "output_mod_factor must be 1 or 4; got " << output_mod_factor);
+
+  const uint64_t* W = natural_root_of_unity_powers;
+  const uint64_t* W_precon = precon_natural_root_of_unity_powers;
+  const uint64_t twice_modulus = modulus << 1;
+
+  if (n == 1) {
+    result[0] = ReduceMod<4>(operand[0], modulus, &twice_modulus);
+    return;
+  }
+
+  const uint64_t num_stages = Log2(n);
+  if (StageOutput(result, scratch, num_stages, 0) == operand) {
+    std::memcpy(scratch, operand, n * sizeof(uint64_t));
+    operand = scratch;
+  }
+
+  // First stage, with the twist by psi^i
+  {
+    const uint64_t half_n = n >> 1;
+    uint64_t* y = StageOutput(result, scratch, num_stages, 0);
+    HEXL_LOOP_UNROLL_4
+    for (size_t p = 0; p < half_n; ++p) {
+      uint64_t a = MultiplyModLazy<64>(operand[p], W[p], W_precon[p], modulus);
+      uint64_t b = MultiplyModLazy<64>(operand[p + half_n], W[p + half_n],
+                                       W_precon[p + half_n], modulus);
+      InvButterflyRadix2(&y[2 * p], &y[2 * p + 1], &a, &b, W[2 * p],
+                         W_precon[2 * p], modulus, twice_modulus);
+    }
+  }
+  for (uint64_t k = 1; k < num_stages; ++k) {
+    StockhamStage(StageOutput(result, scratch, num_stages, k),
+                  StageOutput(result, scratch, num_stages, k - 1), n, 1ULL << k,
+                  W, W_precon, modulus);
+  }
+
+  if (output_mod_factor == 1) {
+    for (size_t i = 0; i < n; ++i) {
+      result[i] = ReduceMod<2>(result[i], modulus);
+    }
+  }
+}
+
+void InverseTransformFromNaturalStockham(
+    uint64_t* result, const uint64_t* operand, uint64_t* scratch, uint64_t n,
+    uint64_t modulus, const uint64_t* natural_inv_root_of_unity_powers,
+    const uint64_t* precon_natural_inv_root_of_unity_powers,
+    uint64_t input_mod_factor, uint64_t output_mod_factor) {
+  HEXL_CHECK(NTT::CheckArguments(n, modulus), "");
+  HEXL_CHECK_BOUNDS(operand, n, modulus * input_mod_factor,
+                    "operand exceeds bound " << modulus * input_mod_factor);
+  HEXL_CHECK(natural_inv_root_of_unity_powers != nullptr,
+             "natural_inv_root_of_unity_powers == nullptr");
+  HEXL_CHECK(precon_natural_inv_root_of_unity_powers != nullptr,
+             "precon_natural_inv_root_of_unity_powers == nullptr");
+  HEXL_CHECK(input_mod_factor == 1 || input_mod_factor == 2,
+             "input_mod_factor must be 1 or 2; got " << input_mod_factor);
+  HEXL_UNUSED(input_mod_factor);
+  HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 2,
+             "output_mod_factor must be 1 or 2; got " << output_mod_factor);
+
+  const uint64_t* W = natural_inv_root_of_unity_powers;
+  const uint64_t* W_precon = precon_natural_inv_root_of_unity_powers;
+
+  if (n == 1) {
+    result[0] = ReduceMod<2>(operand[0], modulus);
+    return;
+  }
+
+  const uint64_t num_stages = Log2(n);
+  if (StageOutput(result, scratch, num_stages, 0) == operand) {
+    std::memcpy(scratch, operand, n * sizeof(uint64_t));
+    operand = scratch;
+  }
+
+  const uint64_t* x = operand;
+  for (uint64_t k = 0; k + 1 < num_stages; ++k) {
+    uint64_t* y = StageOutput(result, scratch, num_stages, k);
+    StockhamStage(y, x, n, 1ULL << k, W, W_precon, modulus);
+    x = y;
+  }
+
+  // Last stage, with the twist by psi^{-i} and the scaling by n^{-1}
+  const uint64_t half_n = n >> 1;
+  const uint64_t twice_modulus = modulus << 1;
+  const uint64_t inv_n = InverseMod(n, modulus);
+  const uint64_t inv_n_precon =
+      MultiplyFactor(inv_n, 64, modulus).BarrettFactor();
+  HEXL_LOOP_UNROLL_4
+  for (size_t j = 0; j < half_n; ++j) {
+    uint64_t a = x[j];
+    uint64_t b = x[j + half_n];
+    uint64_t sum = MultiplyModLazy<64>(a + b, W[j], W_precon[j], modulus);
+    uint64_t diff = MultiplyModLazy<64>(a + twice_modulus - b, W[j + half_n],
+                                        W_precon[j + half_n], modulus);
+    result[j] = MultiplyModLazy<64>(sum, inv_n, inv_n_precon, modulus);
+    result[j + half_n] =
+        MultiplyModLazy<64>(diff, inv_n, inv_n_precon, modulus);
+  }
+
+  if (output_mod_factor == 1) {
+    for (size_t i = 0; i < n; ++i) {
+      result[i] = ReduceMod<2>(result[i], modulus);
+    }
+  }
+}
+
+bool NTT::UsesStockham() const {
+  // The vectorized transforms followed by BitReversePermute outperform the
+  // scalar Stockham transforms. The natural-order tables would also undo the
+  // memory savings of the compact tables, and the scratch buffer of a
+  // four-step degree would not fit in cache. The Stockham transforms are
+  // negacyclic.
+  return !m_four_step && !m_cyclic && m_twiddle_mode == TwiddleMode::Full &&
+         !UsesAVX512Layout();
+}
+
+void NTT::ComputeForwardNatural(uint64_t* result, const uint64_t* operand,
+                                uint64_t input_mod_factor,
+                                uint64_t output_mod_factor) {
+  HEXL_CHECK(result != nullptr, "result == nullptr");
+  HEXL_CHECK(operand != nullptr, "operand == nullptr");
+  HEXL_CHECK(
+      input_mod_factor == 1 || input_mod_factor == 2 || input_mod_factor == 4,
+      "input_mod_factor must be 1, 2 or 4; got " << input_mod_factor);
+  HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 4,
+             "output_mod_factor must be 1 or 4; got " << output_mod_factor);
+
+  if (!UsesStockham()) {
+    ComputeForward(result, operand, input_mod_factor, output_mod_factor);
+    BitReversePermute(result, result, m_degree);
+    return;
+  }
+
+  HEXL_VLOG(3, "Calling ForwardTransformToNaturalStockham");
+  AlignedVector64<uint64_t> scratch(m_degree, 0, m_aligned_alloc);
+  ForwardTransformToNaturalStockham(
+      result, operand, scratch.data(), m_degree, m_q,
+      GetTableData(Table::NaturalRootOfUnityPowers),
+      GetTableData(Table::Precon64NaturalRootOfUnityPowers), input_mod_factor,
+      output_mod_factor);
+}
+
+void NTT::ComputeInverseNatural(uint64_t* result, const uint64_t* operand,
+                                uint64_t input_mod_factor,
+                                uint64_t output_mod_factor) {
+  HEXL_CHECK(result != nullptr, "result == nullptr");
+  HEXL_CHECK(operand != nullptr, "operand == nullptr");
+  HEXL_CHECK(input_mod_factor == 1 || input_mod_factor == 2,
+             "input_mod_factor must be 1 or 2; got " << input_mod_factor);
+  HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 2,
+             "output_mod_factor must be 1 or 2; got " << output_mod_factor);
+
+  if (!UsesStockham()) {
+    BitReversePermute(result, operand, m_degree);
+    ComputeInverse(result, result, input_mod_factor, output_mod_factor);
+    return;
+  }
+
+  HEXL_VLOG(3, "Calling InverseTransformFromNaturalStockham");
+  AlignedVector64<uint64_t> scratch(m_degree, 0, m_aligned_alloc);
+  InverseTransformFromNaturalStockham(
+      result, operand, scratch.data(), m_degree, m_q,
+      GetTableData(Table::NaturalInvRootOfUnityPowers),
+      GetTableData(Table::Precon64NaturalInvRootOfUnityPowers),
+      input_mod_factor, output_mod_factor);
+}
+
+}  // namespace hexl
+}  // namespace intel
@@ -3,12 +3,14 @@
 
 #include <cstring>
 
+#include "hexl/eltwise/eltwise-mult-mod.hpp"
 #include "hexl/logging/logging.hpp"
 #include "hexl/ntt/ntt.hpp"
 #include "hexl/number-theory/number-theory.hpp"
 #include "hexl/util/aligned-allocator.hpp"
 #include "hexl/util/check.hpp"
 #include "ntt/ntt-default.hpp"
+#include "ntt/ntt-internal.hpp"
 #include "util/cpu-features.hpp"
 
 namespace intel {
@@ -18,8 +20,9 @@ void ForwardTransformToBitReverseRadix4(
     uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
     const uint64_t* root_of_unity_powers,
     const uint64_t* precon_root_of_unity_powers, uint64_t input_mod_factor,
-    uint64_t output_mod_factor) {
-  HEXL_CHECK(NTT::CheckArguments(n, modulus), "");
+    uint64_t output_mod_factor, uint64_t recursion_depth,
+    uint64_t recursion_half) {
+  HEXL_CHECK(NTT::CheckCyclicArguments(n, modulus), "");
   HEXL_CHECK_BOUNDS(operand, n, modulus * input_mod_factor,
                     "operand exceeds bound " << modulus * input_mod_factor);
   HEXL_CHECK(root_of_unity_powers != nullptr,
@@ -41,6 +44,50 @@ void ForwardTransformToBitReverseRadix4(
   HEXL_VLOG(3, "root_of_unity_powers " << std::vector<uint64_t>(
                    root_of_unity_powers, root_of_unity_powers + n));
 
+  // Index of the root of unity of the first stage of this block
+  const uint64_t root_index = (1ULL << recursion_depth) + recursion_half;
+
+  const size_t base_ntt_size = NTT::GetBaseNTTSize();
+  if (n > base_ntt_size) {
+    const uint64_t parallel_levels =
+        (recursion_depth == 0) ? ParallelNTTLevels(n) : 0;
+    if (parallel_levels > 0) {
+      FwdParallelLevels(
+          result, operand, n, modulus, root_of_unity_powers,
+          precon_root_of_unity_powers, parallel_levels,
+          [&](uint64_t* block, uint64_t block_size, uint64_t depth,
+              uint64_t half) {
+            ForwardTransformToBitReverseRadix4(
+                block, block, block_size, modulus, root_of_unity_powers,
+                precon_root_of_unity_powers, 4, output_mod_factor, depth,
+                half);
+          });
+      return;
+    }
+
+    // Perform depth-first NTT via recursive calls, fusing two stages per pass
+    // over the block while it is at least four times the base size
+    uint64_t num_stages = (n >= 4 * base_ntt_size) ? 2 : 1;
+    FwdOuterStages(result, operand, n, modulus, root_of_unity_powers,
+                   precon_root_of_unity_powers, root_index, num_stages);
+
+    uint64_t block_size = n >> num_stages;
+    for (uint64_t block = 0; block < (1ULL << num_stages); ++block) {
+      uint64_t* block_result = result + block * block_size;
+      ForwardTransformToBitReverseRadix4(
+          block_result, block_result, block_size, modulus,
+          root_of_unity_powers, precon_root_of_unity_powers, 4,
+          output_mod_factor, recursion_depth + num_stages,
+          (recursion_half << num_stages) + block);
+    }
+    return;
+  }
+
+  // Out-of-place transforms copy in their first stage, which n == 1 lacks
+  if (n == 1 && result != operand) {
+    result[0] = operand[0];
+  }
+
   bool is_power_of_4 = IsPowerOfFour(n);
 
   uint64_t twice_modulus = modulus << 1;
@@ -52,8 +99,8 @@ void ForwardTransformToBitReverseRadix4(
 
     size_t t = (n >> 1);
 
-    const uint64_t W = root_of_unity_powers[1];
-    const uint64_t W_precon = precon_root_of_unity_powers[1];
+    const uint64_t W = root_of_unity_powers[root_index];
+    const uint64_t W_precon = precon_root_of_unity_powers[root_index];
 
     uint64_t* X_r = result;
     uint64_t* Y_r = X_r + t;
@@ -84,7 +131,7 @@ void ForwardTransformToBitReverseRadix4(
     const uint64_t* X_op2 = operand + 2 * t;
     const uint64_t* X_op3 = operand + 3 * t;
 
-    uint64_t W1_ind = 1;
+    uint64_t W1_ind = root_index;
     uint64_t W2_ind = 2 * W1_ind;
     uint64_t W3_ind = 2 * W1_ind + 1;
 
@@ -220,7 +267,7 @@ void ForwardTransformToBitReverseRadix4(
           const uint64_t* X_op2 = X_r2;
           const uint64_t* X_op3 = X_r3;
 
-          uint64_t W1_ind = m + i;
+          uint64_t W1_ind = root_index * m + i;
           uint64_t W2_ind = 2 * W1_ind;
           uint64_t W3_ind = 2 * W1_ind + 1;
 
@@ -266,7 +313,7 @@ void ForwardTransformToBitReverseRadix4(
           const uint64_t* X_op2 = X_r2;
           const uint64_t* X_op3 = X_r3;
 
-          uint64_t W1_ind = m + i;
+          uint64_t W1_ind = root_index * m + i;
           uint64_t W2_ind = 2 * W1_ind;
           uint64_t W3_ind = 2 * W1_ind + 1;
 
@@ -299,7 +346,7 @@ void ForwardTransformToBitReverseRadix4(
           const uint64_t* X_op2 = X_r2;
           const uint64_t* X_op3 = X_r3;
 
-          uint64_t W1_ind = m + i;
+          uint64_t W1_ind = root_index * m + i;
           uint64_t W2_ind = 2 * W1_ind;
           uint64_t W3_ind = 2 * W1_ind + 1;
 
@@ -399,23 +446,15 @@ void ForwardTransformToBitReverseRadix4(
   HEXL_VLOG(3, "outputs " << std::vector<uint64_t>(result, result + n));
 }
 
-void InverseTransformFromBitReverseRadix4(
+namespace {
+
+// Performs all but the final stage of the inverse NTT of a block of size n, at
+// depth recursion_depth of a transform of size N
+void InverseTransformStagesRadix4(
     uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
     const uint64_t* inv_root_of_unity_powers,
-    const uint64_t* precon_inv_root_of_unity_powers, uint64_t input_mod_factor,
-    uint64_t output_mod_factor) {
-  HEXL_CHECK(NTT::CheckArguments(n, modulus), "");
-  HEXL_CHECK(inv_root_of_unity_powers != nullptr,
-             "inv_root_of_unity_powers == nullptr");
-  HEXL_CHECK(precon_inv_root_of_unity_powers != nullptr,
-             "precon_inv_root_of_unity_powers == nullptr");
-  HEXL_CHECK(operand != nullptr, "operand == nullptr");
-  HEXL_CHECK(input_mod_factor == 1 || input_mod_factor == 2,
-             "input_mod_factor must be 1 or 2; got " << input_mod_factor);
-  HEXL_UNUSED(input_mod_factor);
-  HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 2,
-             "output_mod_factor must be 1 or 2; got " << output_mod_factor);
-
+    const uint64_t* precon_inv_root_of_unity_powers, uint64_t N,
+    uint64_t recursion_depth, uint64_t recursion_half) {
   uint64_t twice_modulus = modulus << 1;
   uint64_t n_div_2 = (n >> 1);
 
@@ -426,8 +465,10 @@ void InverseTransformFromBitReverseRadix4(
     uint64_t* Y_r = X_r + 1;
     const uint64_t* X_op = operand;
     const uint64_t* Y_op = X_op + 1;
-    const uint64_t* W = inv_root_of_unity_powers + 1;
-    const uint64_t* W_precon = precon_inv_root_of_unity_powers + 1;
+    uint64_t root_index =
+        InvRootIndex(N, n_div_2, recursion_depth, recursion_half);
+    const uint64_t* W = inv_root_of_unity_powers + root_index;
+    const uint64_t* W_precon = precon_inv_root_of_unity_powers + root_index;
 
     HEXL_LOOP_UNROLL_8
     for (size_t j = 0; j < n / 2; j++) {
@@ -444,9 +485,6 @@ void InverseTransformFromBitReverseRadix4(
   uint64_t m_start = n >> (is_power_of_4 ? 3 : 2);
   size_t t = is_power_of_4 ? 2 : 1;
 
-  size_t w1_root_index = 1 + (is_power_of_4 ? n_div_2 : 0);
-  size_t w3_root_index = n_div_2 + 1 + (is_power_of_4 ? (n / 4) : 0);
-
   HEXL_VLOG(4, "m_start " << m_start);
 
   for (size_t m = m_start; m > 0; m >>= 2) {
@@ -454,6 +492,9 @@ void InverseTransformFromBitReverseRadix4(
     HEXL_VLOG(4, "t " << t);
 
     size_t X0_offset = 0;
+    size_t w1_root_index =
+        InvRootIndex(N, 2 * m, recursion_depth, recursion_half);
+    size_t w3_root_index = InvRootIndex(N, m, recursion_depth, recursion_half);
 
     switch (t) {
       case 1: {
@@ -572,50 +613,118 @@ void InverseTransformFromBitReverseRadix4(
       }
     }
     t <<= 2;
-    w1_root_index += m;
-    w3_root_index += m / 2;
+  }
+}
+
+}  // namespace
+
+void InverseTransformFromBitReverseRadix4(
+    uint64_t* result, const uint64_t* operand, uint64_t n, uint64_t modulus,
+    const uint64_t* inv_root_of_unity_powers,
+    const uint64_t* precon_inv_root_of_unity_powers, uint64_t input_mod_factor,
+    uint64_t output_mod_factor, uint64_t recursion_depth,
+    uint64_t recursion_half, const uint64_t* mult_operand, uint64_t scalar,
+    uint64_t addend) {
+  HEXL_CHECK(NTT::CheckCyclicArguments(n, modulus), "");
+  HEXL_CHECK(inv_root_of_unity_powers != nullptr,
+             "inv_root_of_unity_powers == nullptr");
+  HEXL_CHECK(precon_inv_root_of_unity_powers != nullptr,
+             "precon_inv_root_of_unity_powers == nullptr");
+  HEXL_CHECK(operand != nullptr, "operand == nullptr");
+  HEXL_CHECK(input_mod_factor == 1 || input_mod_factor == 2 ||
+                 (mult_operand != nullptr && input_mod_factor == 4),
+             "input_mod_factor must be 1 or 2; got " << input_mod_factor);
+  HEXL_CHECK(output_mod_factor == 1 || output_mod_factor == 2,
+             "output_mod_factor must be 1 or 2; got " << output_mod_factor);
+
+  uint64_t n_div_2 = (n >> 1);
+
+  // Size of the full transform of which this is a block
+  const uint64_t N = n << recursion_depth;
+
+  const size_t base_ntt_size = NTT::GetBaseNTTSize();
+  if (n > base_ntt_size) {
+    const uint64_t parallel_levels =
+        (recursion_depth == 0) ? ParallelNTTLevels(n) : 0;
+    if (parallel_levels > 0) {
+      InvParallelLevels(
+          result, n, modulus, inv_root_of_unity_powers,
+          precon_inv_root_of_unity_powers, output_mod_factor, scalar, addend,
+          parallel_levels,
+          [&](uint64_t offset, uint64_t block_size, uint64_t depth,
+              uint64_t half) {
+            InverseTransformFromBitReverseRadix4(
+                result + offset, operand + offset, block_size, modulus,
+                inv_root_of_unity_powers, precon_inv_root_of_unity_powers,
+                input_mod_factor, 2, depth, half,
+                mult_operand ? mult_operand + offset : nullptr);
+          });
+      return;
+    }
+
+    // Perform depth-first InvNTT via recursive calls, fusing two stages per
+    // pass over the block while it is at least four times the base size
+    uint64_t num_stages = (n >= 4 * base_ntt_size) ? 2 : 1;
+    uint64_t block_size = n >> num_stages;
+    for (uint64_t block = 0; block < (1ULL << num_stages); ++block) {
+      uint64_t offset = block * block_size;
+      InverseTransformFromBitReverseRadix4(
+          result + offset, operand + offset, block_size, modulus,
+          inv_root_of_unity_powers, precon_inv_root_of_unity_powers,
+          input_mod_factor, 2, recursion_depth + num_stages,
+          (recursion_half << num_stages) + block,
+          mult_operand ? mult_operand + offset : nullptr);
+    }
+    if (num_stages == 2) {
+      uint64_t w1_index = InvRootIndex(N, 2, recursion_depth, recursion_half);
+      if (recursion_depth > 0) {
+        uint64_t w2_index = InvRootIndex(N, 1, recursion_depth, recursion_half);
+        InvOuterStagesRadix4(result, n, modulus,
+                             &inv_root_of_unity_powers[w1_index],
+                             &precon_inv_root_of_unity_powers[w1_index],
+                             inv_root_of_unity_powers[w2_index],
+                             precon_inv_root_of_unity_powers[w2_index]);
+        return;
+      }
+      InvStage(result, n, 2, modulus, &inv_root_of_unity_powers[w1_index],
+               &precon_inv_root_of_unity_powers[w1_index]);
+    }
+  } else {
+    if (mult_operand != nullptr) {
+      // Pointwise product, computed while the block is resident in cache
+      EltwiseMultMod(result, operand, mult_operand, n, modulus,
+                     input_mod_factor);
+      operand = result;
+    }
+    InverseTransformStagesRadix4(result, operand, n, modulus,
+                                 inv_root_of_unity_powers,
+                                 precon_inv_root_of_unity_powers, N,
+                                 recursion_depth, recursion_half);
+  }
+
+  if (recursion_depth > 0) {
+    // Final stage of a block, without multiplication by N^{-1}
+    uint64_t root_index = InvRootIndex(N, 1, recursion_depth, recursion_half);
+    InvStage(result, n, 1, modulus, &inv_root_of_unity_powers[root_index],
+             &precon_inv_root_of_unity_powers[root_index]);
+    return;
   }
 
   // When M is too short it only needs the final stage butterfly. Copying here
   // in the case of out-of-place.
-  if (result != operand && n == 2) {
+  if (result != operand && n <= 2) {
     std::memcpy(result, operand, n * sizeof(uint64_t));
   }
 
   HEXL_VLOG(4, "Starting final invNTT stage");
   HEXL_VLOG(4, "operand " << std::vector<uint64_t>(result, result + n));
 
-  // Fold multiplication by N^{-1} to final stage butterfly
+  // Fold multiplication by N^{-1} and the scalar to final stage butterfly
   const uint64_t W = inv_root_of_unity_powers[n - 1];
-  HEXL_VLOG(4, "final W " << W);
-
-  const uint64_t inv_n = InverseMod(n, modulus);
-  uint64_t inv_n_precon = MultiplyFactor(inv_n, 64, modulus).BarrettFactor();
+  const uint64_t inv_n = MultiplyMod(InverseMod(n, modulus), scalar, modulus);
   const uint64_t inv_n_w = MultiplyMod(inv_n, W, modulus);
-  uint64_t inv_n_w_precon =
-      MultiplyFactor(inv_n_w, 64, modulus).BarrettFactor();
-
-  uint64_t* X = result;
-  uint64_t* Y = X + n_div_2;
-  for (size_t j = 0; j < n_div_2; ++j) {
-    // Assume X, Y in [0, 2q) and compute
-    // X' = N^{-1} (X + Y) (mod q)
-    // Y' = N^{-1} * W * (X - Y) (mod q)
-    // with X', Y' in [0, 2q)
-    uint64_t tx = AddUIntMod(X[j], Y[j], twice_modulus);
-    uint64_t ty = X[j] + twice_modulus - Y[j];
-    X[j] = MultiplyModLazy<64>(tx, inv_n, inv_n_precon, modulus);
-    Y[j] = MultiplyModLazy<64>(ty, inv_n_w, inv_n_w_precon, modulus);
-  }
-
-  if (output_mod_factor == 1) {
-    // Reduce from [0, 2q) to [0,q)
-    for (size_t i = 0; i < n; ++i) {
-      result[i] = ReduceMod<2>(result[i], modulus);
-      HEXL_CHECK(result[i] < modulus, "Incorrect modulus reduction in InvNTT"
-                                          << result[i] << " >= " << modulus);
-    }
-  }
+  InvFinalButterflies(result, result + n_div_2, n_div_2, modulus, inv_n,
+                      inv_n_w, output_mod_factor, addend);
 }
 
 }  // namespace hexl
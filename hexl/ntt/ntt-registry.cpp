@@ -0,0 +1,281 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "hexl/ntt/ntt-registry.hpp"
+
+#include <array>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "hexl/logging/logging.hpp"
+#include "hexl/ntt/ntt.hpp"
+#include "hexl/util/check.hpp"
+
+namespace intel {
+namespace hexl {
+
+namespace {
+
+// An NTT in the per-thread cache of NTTRegistry::GetCached
+struct ThreadCacheSlot {
+  uint64_t registry_id = 0;
+  uint64_t generation = 0;
+  uint64_t degree = 0;
+  uint64_t modulus = 0;
+  uint64_t root_of_unity = 0;
+  // Owned by this thread only, so that copies do not write to memory shared
+  // with other threads. Holds a reference to the registered NTT and flag.
+  std::shared_ptr<NTT> ntt;
+  // Referenced flag of the registry entry, kept alive by ntt
+  std::atomic<bool>* referenced = nullptr;
+};
+
+struct ThreadCache {
+  std::array<ThreadCacheSlot, NTTRegistry::s_thread_cache_size> slots;
+  size_t next_slot = 0;
+};
+
+ThreadCache& GetThreadCache() {
+  static thread_local ThreadCache cache;
+  return cache;
+}
+
+uint64_t NextRegistryId() {
+  // Ids start at 1, since 0 marks empty cache slots
+  static std::atomic<uint64_t> next_id{1};
+  return next_id.fetch_add(1);
+}
+
+}  // namespace
+
+size_t NTTRegistry::KeyHash::operator()(const Key& key) const {
+  // Golden ratio hash combining
+  size_t hash = std::hash<uint64_t>{}(key.degree);
+  for (uint64_t value : {key.modulus, key.root_of_unity}) {
+    hash ^= std::hash<uint64_t>{}(value) + 0x9e3779b9 + (hash << 6) +
+            (hash >> 2);
+  }
+  return hash;
+}
+
+NTTRegistry::NTTRegistry(size_t byte_budget)
+    : m_id(NextRegistryId()), m_byte_budget(byte_budget) {}
+
+NTTRegistry& NTTRegistry::Global() {
+  static NTTRegistry registry;
+  return registry;
+}
+
+std::shared_ptr<NTT> NTTRegistry::Get(uint64_t degree, uint64_t modulus,
+                                      uint64_t root_of_unity) {
+  return Lookup(Key{degree, modulus, root_of_unity}, true);
+}
+
+std::shared_ptr<NTT> NTTRegistry::GetCached(uint64_t degree, uint64_t modulus,
+                                            uint64_t root_of_unity) {
+  ThreadCache& cache = GetThreadCache();
+  uint64_t generation = m_generation.load(std::memory_order_acquire);
+  bool stale = false;
+  for (ThreadCacheSlot& slot : cache.slots) {
+    if (slot.registry_id != m_id) {
+      continue;
+    }
+    if (slot.generation != generation) {
+      stale = true;
+    } else if (slot.degree == degree && slot.modulus == modulus &&
+               slot.root_of_unity == root_of_unity) {
+      // Only write the flag if needed, to keep its cache line shared
+      if (!slot.referenced->load(std::memory_order_relaxed)) {
+        slot.referenced->store(true, std::memory_order_relaxed);
+      }
+      return slot.ntt;
+    }
+  }
+  if (stale) {
+    // Release the NTTs cached before entries were removed
+    for (ThreadCacheSlot& slot : cache.slots) {
+      if (slot.registry_id == m_id && slot.generation != generation) {
+        slot = ThreadCacheSlot();
+      }
+    }
+  }
+
+  std::shared_ptr<std::atomic<bool>> referenced;
+  std::shared_ptr<NTT> ntt =
+      Lookup(Key{degree, modulus, root_of_unity}, true, &referenced);
+
+  ThreadCacheSlot& slot = cache.slots[cache.next_slot];
+  cache.next_slot = (cache.next_slot + 1) % cache.slots.size();
+  slot.registry_id = m_id;
+  // If an entry was removed since generation was read, the slot is refreshed
+  // on the next lookup
+  slot.generation = generation;
+  slot.degree = degree;
+  slot.modulus = modulus;
+  slot.root_of_unity = root_of_unity;
+  slot.referenced = referenced.get();
+  NTT* ntt_ptr = ntt.get();
+  slot.ntt = std::shared_ptr<NTT>(
+      ntt_ptr, [ntt, referenced](NTT*) mutable {
+        ntt.reset();
+        referenced.reset();
+      });
+  return slot.ntt;
+}
+
+void NTTRegistry::Prewarm(uint64_t degree, const std::vector<uint64_t>& moduli,
+                          bool all_tables) {
+  for (uint64_t modulus : moduli) {
+    Key key{degree, modulus, 0};
+    std::shared_ptr<NTT> ntt = Lookup(key, false);
+    if (!all_tables) {
+      continue;
+    }
+    ntt->GetPrecon32RootOfUnityPowers();
+    ntt->GetPrecon64RootOfUnityPowers();
+    ntt->GetAVX512Precon32RootOfUnityPowers();
+    ntt->GetAVX512Precon52RootOfUnityPowers();
+    ntt->GetAVX512Precon64RootOfUnityPowers();
+    ntt->GetPrecon32InvRootOfUnityPowers();
+    ntt->GetPrecon52InvRootOfUnityPowers();
+    ntt->GetPrecon64InvRootOfUnityPowers();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+      Touch(it->second);
+      EvictToBudget();
+    }
+  }
+}
+
+void NTTRegistry::Purge() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_entries.clear();
+  m_lru.clear();
+  m_num_bytes = 0;
+  m_generation.fetch_add(1, std::memory_order_release);
+}
+
+bool NTTRegistry::Purge(uint64_t degree, uint64_t modulus,
+                        uint64_t root_of_unity) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_entries.find(Key{degree, modulus, root_of_unity});
+  if (it == m_entries.end()) {
+    return false;
+  }
+  Erase(it->second);
+  return true;
+}
+
+size_t NTTRegistry::GetByteBudget() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_byte_budget;
+}
+
+void NTTRegistry::SetByteBudget(size_t byte_budget) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_byte_budget = byte_budget;
+  EvictToBudget();
+}
+
+NTTRegistry::Stats NTTRegistry::GetStats() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Stats stats = m_stats;
+  stats.num_entries = m_lru.size();
+  for (const Entry& entry : m_lru) {
+    stats.num_bytes += entry.ntt->GetTableMemoryBytes();
+  }
+  return stats;
+}
+
+void NTTRegistry::ResetStats() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_stats = Stats();
+}
+
+std::shared_ptr<NTT> NTTRegistry::Lookup(
+    const Key& key, bool count_stats,
+    std::shared_ptr<std::atomic<bool>>* referenced) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+      m_stats.hits += count_stats ? 1 : 0;
+      Touch(it->second);
+      EvictToBudget();
+      if (referenced != nullptr) {
+        *referenced = it->second->referenced;
+      }
+      return it->second->ntt;
+    }
+  }
+
+  // Construct the NTT without holding the lock, so that lookups of other NTTs
+  // are not blocked
+  std::shared_ptr<NTT> ntt =
+      (key.root_of_unity == 0)
+          ? std::make_shared<NTT>(key.degree, key.modulus)
+          : std::make_shared<NTT>(key.degree, key.modulus, key.root_of_unity);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_stats.misses += count_stats ? 1 : 0;
+  auto it = m_entries.find(key);
+  if (it != m_entries.end()) {
+    // Registered by another thread in the meantime
+    Touch(it->second);
+    EvictToBudget();
+    if (referenced != nullptr) {
+      *referenced = it->second->referenced;
+    }
+    return it->second->ntt;
+  }
+  size_t num_bytes = ntt->GetTableMemoryBytes();
+  m_lru.push_front(Entry{key, ntt, num_bytes,
+                         std::make_shared<std::atomic<bool>>(false)});
+  m_entries.emplace(key, m_lru.begin());
+  m_num_bytes += num_bytes;
+  EvictToBudget();
+  if (referenced != nullptr) {
+    *referenced = m_lru.front().referenced;
+  }
+  return ntt;
+}
+
+void NTTRegistry::Touch(std::list<Entry>::iterator entry) {
+  m_lru.splice(m_lru.begin(), m_lru, entry);
+  size_t num_bytes = entry->ntt->GetTableMemoryBytes();
+  m_num_bytes = m_num_bytes - entry->num_bytes + num_bytes;
+  entry->num_bytes = num_bytes;
+}
+
+void NTTRegistry::EvictToBudget() {
+  while (m_byte_budget != 0 && m_num_bytes > m_byte_budget &&
+         m_lru.size() > 1) {
+    auto entry = std::prev(m_lru.end());
+    if (entry->referenced->exchange(false, std::memory_order_relaxed)) {
+      // Used via GetCached since it was last considered; keep it, behind the
+      // most recently used entry. Terminates, since the flag is now clear.
+      m_lru.splice(std::next(m_lru.begin()), m_lru, entry);
+      continue;
+    }
+    HEXL_VLOG(3, "Evicting NTT with degree " << entry->key.degree
+                                             << ", modulus "
+                                             << entry->key.modulus);
+    Erase(entry);
+    ++m_stats.evictions;
+  }
+}
+
+void NTTRegistry::Erase(std::list<Entry>::iterator entry) {
+  m_num_bytes -= entry->num_bytes;
+  m_entries.erase(entry->key);
+  m_lru.erase(entry);
+  m_generation.fetch_add(1, std::memory_order_release);
+}
+
+}  // namespace hexl
+}  // namespace intel
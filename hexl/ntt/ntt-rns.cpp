@@ -0,0 +1,130 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <xmmintrin.h>
+#endif
+
+#include <algorithm>
+
+#include "hexl/ntt/ntt.hpp"
+#include "hexl/util/check.hpp"
+#include "util/thread-pool.hpp"
+
+namespace intel {
+namespace hexl {
+
+namespace {
+
+// Maximum number of uint64_t to prefetch from each stream, 32 KiB. The three
+// streams of a limb then stay well within the L2 cache alongside the limb being
+// transformed.
+const size_t s_max_prefetch_words = 4096;
+
+// Number of uint64_t per cache line
+const size_t s_cache_line_words = 8;
+
+inline void PrefetchLines(const uint64_t* ptr, size_t num_words) {
+#if defined(__x86_64__) || defined(_M_X64)
+  size_t prefetch_words = std::min(num_words, s_max_prefetch_words);
+  for (size_t i = 0; i < prefetch_words; i += s_cache_line_words) {
+    _mm_prefetch(reinterpret_cast<const char*>(ptr + i), _MM_HINT_T1);
+  }
+#else
+  (void)ptr;
+  (void)num_words;
+#endif
+}
+
+// Prefetches the working set of the first butterfly stages of an NTT of size
+// n: the first stage streams through both halves of the operand, and the
+// stages read the twiddle factor table from its start. Each stream is
+// prefetched up to s_max_prefetch_words, i.e. entirely for n <= 8192.
+inline void PrefetchLimb(const uint64_t* operand, const uint64_t* twiddles,
+                         uint64_t n) {
+  PrefetchLines(operand, n / 2);
+  PrefetchLines(operand + n / 2, n / 2);
+  if (twiddles != nullptr) {
+    PrefetchLines(twiddles, n);
+  }
+}
+
+// Compact tables are not prefetched; they are smaller than n and stay cached
+// across limbs
+const uint64_t* FwdTwiddles(const NTT& ntt) {
+  return (ntt.GetTwiddleMode() == NTT::TwiddleMode::Compact)
+             ? nullptr
+             : ntt.GetDispatchedRootOfUnityPowers();
+}
+
+const uint64_t* InvTwiddles(const NTT& ntt) {
+  return (ntt.GetTwiddleMode() == NTT::TwiddleMode::Compact)
+             ? nullptr
+             : ntt.GetDispatchedInvRootOfUnityPowers();
+}
+
+// Applies transform(ntt, result, operand) to each limb, assigning contiguous
+// ranges of limbs to each thread. While limb i is transformed, the working set
+// of the first stages of limb i + 1 is prefetched.
+template <typename Transform, typename GetTwiddles>
+void ComputeRNS(uint64_t* result, const uint64_t* operand, NTT* const* ntts,
+                size_t num_moduli, Transform transform,
+                GetTwiddles get_twiddles) {
+  HEXL_CHECK(result != nullptr, "result == nullptr");
+  HEXL_CHECK(operand != nullptr, "operand == nullptr");
+  HEXL_CHECK(ntts != nullptr, "ntts == nullptr");
+  if (num_moduli == 0) {
+    return;
+  }
+  const uint64_t n = ntts[0]->GetDegree();
+  for (size_t i = 0; i < num_moduli; ++i) {
+    HEXL_CHECK(ntts[i] != nullptr, "ntts[" << i << "] == nullptr");
+    HEXL_CHECK(ntts[i]->GetDegree() == n,
+               "ntts[" << i << "] has degree " << ntts[i]->GetDegree()
+                       << "; expected " << n);
+  }
+
+  ThreadPool& pool = ThreadPool::GetInstance();
+  const size_t num_tasks = std::min(pool.GetNumThreads(), num_moduli);
+  const size_t limbs_per_task = (num_moduli + num_tasks - 1) / num_tasks;
+
+  pool.ParallelFor(num_tasks, [&](size_t task) {
+    size_t begin = task * limbs_per_task;
+    size_t end = std::min(begin + limbs_per_task, num_moduli);
+    for (size_t i = begin; i < end; ++i) {
+      if (i + 1 < end) {
+        PrefetchLimb(&operand[(i + 1) * n], get_twiddles(*ntts[i + 1]), n);
+      }
+      transform(*ntts[i], &result[i * n], &operand[i * n]);
+    }
+  });
+}
+
+}  // namespace
+
+void ComputeForwardRNS(uint64_t* result, const uint64_t* operand,
+                       NTT* const* ntts, size_t num_moduli,
+                       uint64_t input_mod_factor, uint64_t output_mod_factor) {
+  ComputeRNS(
+      result, operand, ntts, num_moduli,
+      [=](NTT& ntt, uint64_t* limb_result, const uint64_t* limb_operand) {
+        ntt.ComputeForward(limb_result, limb_operand, input_mod_factor,
+                           output_mod_factor);
+      },
+      FwdTwiddles);
+}
+
+void ComputeInverseRNS(uint64_t* result, const uint64_t* operand,
+                       NTT* const* ntts, size_t num_moduli,
+                       uint64_t input_mod_factor, uint64_t output_mod_factor) {
+  ComputeRNS(
+      result, operand, ntts, num_moduli,
+      [=](NTT& ntt, uint64_t* limb_result, const uint64_t* limb_operand) {
+        ntt.ComputeInverse(limb_result, limb_operand, input_mod_factor,
+                           output_mod_factor);
+      },
+      InvTwiddles);
+}
+
+}  // namespace hexl
+}  // namespace intel
@@ -0,0 +1,246 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "hexl/ntt/ntt.hpp"
+#include "hexl/number-theory/number-theory.hpp"
+#include "hexl/util/aligned-allocator.hpp"
+#include "hexl/util/check.hpp"
+#include "ntt/ntt-internal.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define HEXL_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace intel {
+namespace hexl {
+
+// Serialized format, in host-order 64-bit words:
+//   magic, version, degree, modulus, root of unity, number of tables,
+//   (byte offset, number of elements) of each table,
+// padded to a multiple of 64 bytes, followed by each table, each starting at a
+// multiple of 64 bytes.
+
+namespace {
+
+// "HEXL_NTT" in little-endian byte order
+const uint64_t s_ntt_magic = 0x54544E5F4C584548ULL;
+
+const size_t s_header_words = 6;
+
+const size_t s_table_alignment = 64;
+
+size_t AlignUp(size_t num_bytes) {
+  return (num_bytes + s_table_alignment - 1) / s_table_alignment *
+         s_table_alignment;
+}
+
+void ThrowInvalid(const std::string& message) {
+  throw std::invalid_argument("Invalid serialized NTT: " + message);
+}
+
+}  // namespace
+
+size_t NTT::TableSize(Table table, uint64_t degree) {
+  switch (table) {
+    // The AVX512 layout repeats the roots at [N/8, N/4) four times and the
+    // roots at [N/4, N/2) twice
+    case Table::AVX512RootOfUnityPowers:
+    case Table::AVX512Precon32RootOfUnityPowers:
+    case Table::AVX512Precon52RootOfUnityPowers:
+    case Table::AVX512Precon64RootOfUnityPowers:
+      return degree / 8 + 4 * (degree / 4 - degree / 8) +
+             2 * (degree / 2 - degree / 4) + (degree - degree / 2);
+    case Table::CompactRootOfUnityPowers:
+    case Table::Precon52CompactRootOfUnityPowers:
+    case Table::Precon64CompactRootOfUnityPowers:
+    case Table::CompactInvRootOfUnityPowers:
+    case Table::Precon52CompactInvRootOfUnityPowers:
+    case Table::Precon64CompactInvRootOfUnityPowers:
+      return CompactRootTableSize(degree);
+    default:
+      return degree;
+  }
+}
+
+void NTT::Serialize(std::ostream& stream) const {
+  const size_t num_tables =
+      m_tables ? LazyTables::s_num_serialized_tables : 0;
+  const size_t header_bytes =
+      AlignUp((s_header_words + 2 * num_tables) * sizeof(uint64_t));
+
+  std::vector<const uint64_t*> data(num_tables);
+  std::vector<uint64_t> header{s_ntt_magic, s_serialization_version,
+                               m_degree,    m_q,
+                               m_w,         num_tables};
+  size_t offset = header_bytes;
+  for (size_t i = 0; i < num_tables; ++i) {
+    Table table = static_cast<Table>(i);
+    size_t size = TableSize(table, m_degree);
+    // The views of the inverse tables of a master NTT differ in the first
+    // element, so store the full tables of NTTs created by CreateSubNTT
+    data[i] = (m_tables->master != nullptr) ? GetTable(table).data()
+                                            : GetTableData(table);
+    header.push_back(offset);
+    header.push_back(size);
+    offset = AlignUp(offset + size * sizeof(uint64_t));
+  }
+  header.resize(header_bytes / sizeof(uint64_t), 0);
+
+  stream.write(reinterpret_cast<const char*>(header.data()),
+               static_cast<std::streamsize>(header_bytes));
+  const char padding[s_table_alignment] = {};
+  for (size_t i = 0; i < num_tables; ++i) {
+    size_t num_bytes = header[s_header_words + 2 * i + 1] * sizeof(uint64_t);
+    stream.write(reinterpret_cast<const char*>(data[i]),
+                 static_cast<std::streamsize>(num_bytes));
+    stream.write(padding, static_cast<std::streamsize>(AlignUp(num_bytes) -
+                                                       num_bytes));
+  }
+  if (!stream) {
+    throw std::runtime_error("Failed to write serialized NTT");
+  }
+}
+
+NTT NTT::Deserialize(const void* buffer, size_t size,
+                     std::shared_ptr<const void> buffer_owner,
+                     std::shared_ptr<AllocatorBase> alloc_ptr) {
+  if (buffer == nullptr || size < s_header_words * sizeof(uint64_t)) {
+    ThrowInvalid("buffer too small");
+  }
+  if (reinterpret_cast<uintptr_t>(buffer) % sizeof(uint64_t) != 0) {
+    ThrowInvalid("buffer is not 8-byte aligned");
+  }
+  const uint64_t* words = static_cast<const uint64_t*>(buffer);
+  if (words[0] != s_ntt_magic) {
+    ThrowInvalid("bad magic number");
+  }
+  if (words[1] != s_serialization_version) {
+    ThrowInvalid("unsupported version " + std::to_string(words[1]));
+  }
+  uint64_t degree = words[2];
+  uint64_t q = words[3];
+  uint64_t root_of_unity = words[4];
+  uint64_t num_tables = words[5];
+  if (!IsPowerOfTwo(degree) || degree > (1ULL << MaxDegreeBits())) {
+    ThrowInvalid("bad degree " + std::to_string(degree));
+  }
+  if (q < 3 || !IsPrime(q)) {
+    ThrowInvalid("bad modulus " + std::to_string(q));
+  }
+  // Cyclic NTTs are identified by a primitive degree'th root of unity
+  bool cyclic = degree >= 2 && root_of_unity < q &&
+                IsPrimitiveRoot(root_of_unity, degree, q);
+  if (cyclic && Log2(degree) > MaxDirectDegreeBits()) {
+    ThrowInvalid("bad degree " + std::to_string(degree) + " of cyclic NTT");
+  }
+  // As in CheckCyclicArguments and CheckArguments, i.e. q == 1 mod n for
+  // cyclic NTTs and q == 1 mod 2n otherwise, written to hold for n == 1
+  const uint64_t root_order = cyclic ? degree : 2 * degree;
+  if ((q - 1) % root_order != 0) {
+    ThrowInvalid("bad modulus " + std::to_string(q));
+  }
+  if (!cyclic && (root_of_unity >= q ||
+                  !IsPrimitiveRoot(root_of_unity, root_order, q))) {
+    ThrowInvalid("bad root of unity " + std::to_string(root_of_unity));
+  }
+
+  if (Log2(degree) > MaxDirectDegreeBits()) {
+    // The four-step NTT tables are small; recompute them
+    return NTT(degree, q, root_of_unity, std::move(alloc_ptr));
+  }
+
+  if (num_tables != LazyTables::s_num_serialized_tables) {
+    ThrowInvalid("expected " +
+                 std::to_string(LazyTables::s_num_serialized_tables) +
+                 " tables, got " + std::to_string(num_tables));
+  }
+  if (size < (s_header_words + 2 * num_tables) * sizeof(uint64_t)) {
+    ThrowInvalid("buffer too small");
+  }
+
+  NTT ntt;
+  ntt.m_degree = degree;
+  ntt.m_q = q;
+  ntt.m_w = root_of_unity;
+  ntt.m_degree_bits = Log2(degree);
+  ntt.m_w_inv = InverseMod(root_of_unity, q);
+  ntt.m_alloc = std::move(alloc_ptr);
+  ntt.m_aligned_alloc = AlignedAllocator<uint64_t, 64>(ntt.m_alloc);
+  ntt.m_tables = std::make_shared<LazyTables>(ntt.m_aligned_alloc);
+  ntt.m_cyclic = cyclic;
+  ntt.SetTwiddleMode(GetDefaultTwiddleMode());
+
+  LazyTables& tables = *ntt.m_tables;
+  for (size_t i = 0; i < num_tables; ++i) {
+    uint64_t offset = words[s_header_words + 2 * i];
+    uint64_t table_size = words[s_header_words + 2 * i + 1];
+    if (table_size != TableSize(static_cast<Table>(i), degree)) {
+      ThrowInvalid("table " + std::to_string(i) + " has size " +
+                   std::to_string(table_size));
+    }
+    if (offset % sizeof(uint64_t) != 0 || offset > size ||
+        table_size > (size - offset) / sizeof(uint64_t)) {
+      ThrowInvalid("table " + std::to_string(i) + " is out of bounds");
+    }
+    tables.views[i] = words + offset / sizeof(uint64_t);
+    tables.view_sizes[i] = table_size;
+    tables.num_bytes += table_size * sizeof(uint64_t);
+  }
+  tables.buffer = std::move(buffer_owner);
+
+  ntt.SelectNativeRadix();
+  return ntt;
+}
+
+NTT NTT::DeserializeMapped(const std::string& path,
+                           std::shared_ptr<AllocatorBase> alloc_ptr) {
+#ifdef HEXL_HAS_MMAP
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Failed to open " + path);
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0) {
+    close(fd);
+    throw std::runtime_error("Failed to read " + path);
+  }
+  size_t size = static_cast<size_t>(file_stat.st_size);
+  void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    throw std::runtime_error("Failed to map " + path);
+  }
+  std::shared_ptr<const void> owner(
+      mapped, [size](const void* p) { munmap(const_cast<void*>(p), size); });
+  return Deserialize(mapped, size, owner, std::move(alloc_ptr));
+#else
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    throw std::runtime_error("Failed to open " + path);
+  }
+  std::stringstream contents;
+  contents << file.rdbuf();
+  std::string bytes = contents.str();
+  auto owner = std::make_shared<AlignedVector64<uint64_t>>(
+      (bytes.size() + sizeof(uint64_t) - 1) / sizeof(uint64_t), 0);
+  std::memcpy(owner->data(), bytes.data(), bytes.size());
+  return Deserialize(owner->data(), bytes.size(), owner, std::move(alloc_ptr));
+#endif
+}
+
+}  // namespace hexl
+}  // namespace intel
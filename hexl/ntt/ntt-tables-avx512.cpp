@@ -0,0 +1,67 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ntt/ntt-tables-avx512.hpp"
+
+#include <immintrin.h>
+
+#include "hexl/number-theory/number-theory.hpp"
+#include "hexl/util/check.hpp"
+#include "util/avx512-util.hpp"
+
+namespace intel {
+namespace hexl {
+
+#ifdef HEXL_HAS_AVX512DQ
+
+void ComputeBarrettFactorsAVX512(uint64_t* result, const uint64_t* operand,
+                                 uint64_t n, uint64_t bit_shift,
+                                 uint64_t modulus) {
+  HEXL_CHECK(n % 8 == 0, "n must be a multiple of 8; got " << n);
+  HEXL_CHECK(bit_shift == 32 || bit_shift == 52 || bit_shift == 64,
+             "Unsupported BitShift " << bit_shift);
+  HEXL_CHECK(modulus % 2 == 1, "modulus " << modulus << " must be odd");
+
+  // See ComputeBarrettFactors for the method
+  uint64_t shift_mod = (bit_shift == 64) ? (0 - modulus) % modulus
+                                         : (1ULL << bit_shift) % modulus;
+  uint64_t shift_mod_precon =
+      MultiplyFactor(shift_mod, 64, modulus).BarrettFactor();
+  uint64_t inv_modulus = modulus;
+  for (size_t i = 0; i < 5; ++i) {
+    inv_modulus *= 2 - modulus * inv_modulus;
+  }
+
+  __m512i v_modulus = _mm512_set1_epi64(static_cast<int64_t>(modulus));
+  __m512i v_shift_mod = _mm512_set1_epi64(static_cast<int64_t>(shift_mod));
+  __m512i v_shift_mod_precon =
+      _mm512_set1_epi64(static_cast<int64_t>(shift_mod_precon));
+  __m512i v_inv_modulus = _mm512_set1_epi64(static_cast<int64_t>(inv_modulus));
+  // Shifting by 64 bits yields 0, the low 64 bits of x << 64
+  __m128i v_bit_shift = _mm_cvtsi64_si128(static_cast<int64_t>(bit_shift));
+
+  const __m512i* v_operand = reinterpret_cast<const __m512i*>(operand);
+  __m512i* v_result = reinterpret_cast<__m512i*>(result);
+  for (size_t i = n / 8; i > 0; --i) {
+    __m512i v_x = _mm512_loadu_si512(v_operand);
+
+    // (x << bit_shift) mod q
+    __m512i v_q = _mm512_hexl_mulhi_epi<64>(v_x, v_shift_mod_precon);
+    __m512i v_rem = _mm512_sub_epi64(_mm512_mullo_epi64(v_x, v_shift_mod),
+                                     _mm512_mullo_epi64(v_q, v_modulus));
+    v_rem = _mm512_hexl_small_mod_epu64(v_rem, v_modulus);
+
+    __m512i v_x_shift = _mm512_sll_epi64(v_x, v_bit_shift);
+    __m512i v_factor = _mm512_mullo_epi64(_mm512_sub_epi64(v_x_shift, v_rem),
+                                          v_inv_modulus);
+    _mm512_storeu_si512(v_result, v_factor);
+
+    ++v_operand;
+    ++v_result;
+  }
+}
+
+#endif  // HEXL_HAS_AVX512DQ
+
+}  // namespace hexl
+}  // namespace intel
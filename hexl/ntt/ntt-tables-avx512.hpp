@@ -0,0 +1,26 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdint.h>
+
+namespace intel {
+namespace hexl {
+
+#ifdef HEXL_HAS_AVX512DQ
+
+/// @brief AVX512 implementation of ComputeBarrettFactors
+/// @param[out] result Stores floor((operand[i] << bit_shift) / modulus)
+/// @param[in] operand Values in [0, modulus)
+/// @param[in] n Number of elements; must be a multiple of 8
+/// @param[in] bit_shift Must be 32, 52 or 64
+/// @param[in] modulus Odd modulus, less than 2^63
+void ComputeBarrettFactorsAVX512(uint64_t* result, const uint64_t* operand,
+                                 uint64_t n, uint64_t bit_shift,
+                                 uint64_t modulus);
+
+#endif  // HEXL_HAS_AVX512DQ
+
+}  // namespace hexl
+}  // namespace intel
@@ -0,0 +1,77 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdint.h>
+
+#include "hexl/number-theory/number-theory.hpp"
+#include "hexl/util/check.hpp"
+
+namespace intel {
+namespace hexl {
+
+/// @brief Returns q^{-1} mod 2^64 for odd \p q
+inline uint64_t InverseModPowerOfTwo(uint64_t q) {
+  HEXL_CHECK(q % 2 == 1, "q " << q << " must be odd");
+  // q * q == 1 mod 8, and each Newton iteration doubles the number of correct
+  // low bits
+  uint64_t q_inv = q;
+  for (size_t i = 0; i < 5; ++i) {
+    q_inv *= 2 - q * q_inv;
+  }
+  return q_inv;
+}
+
+/// @brief Returns the Montgomery form x * 2^bit_shift mod q of \p x
+/// @param[in] x Value in [0, q)
+/// @param[in] modulus Odd modulus q
+/// @param[in] bit_shift Must be 52 or 64
+inline uint64_t ToMontgomeryForm(uint64_t x, uint64_t modulus,
+                                 uint64_t bit_shift) {
+  HEXL_CHECK(bit_shift == 52 || bit_shift == 64,
+             "Unsupported bit_shift " << bit_shift);
+  uint64_t r = (bit_shift == 64) ? (0 - modulus) % modulus
+                                 : (1ULL << bit_shift) % modulus;
+  return MultiplyMod(x, r, modulus);
+}
+
+/// @brief Returns x * y * 2^{-64} mod q in [0, 2q), for \p y in Montgomery
+/// form, i.e. x times the value represented by \p y
+/// @param[in] x Multiplicand in [0, 4q)
+/// @param[in] y Multiplicand in [0, q), in Montgomery form
+/// @param[in] modulus Odd modulus q, less than 2^62
+/// @param[in] q_inv q^{-1} mod 2^64, as returned by InverseModPowerOfTwo
+/// @details Signed Montgomery reduction: with T = x y and m = T q^{-1} mod
+/// 2^64, the low words of T and m q cancel, so (T - m q) / 2^64 is the
+/// difference of the high words, which lies in (-q, q).
+inline uint64_t MultiplyModMontgomeryLazy(uint64_t x, uint64_t y,
+                                          uint64_t modulus, uint64_t q_inv) {
+  uint64_t prod_hi;
+  uint64_t prod_lo;
+  MultiplyUInt64(x, y, &prod_hi, &prod_lo);
+  uint64_t m = prod_lo * q_inv;
+  return prod_hi - MultiplyUInt64Hi<64>(m, modulus) + modulus;
+}
+
+/// @brief Returns x * y * 2^{-64} mod q in [0, q)
+/// @param[in] x Multiplicand, any 64-bit value
+/// @param[in] y Multiplicand in [0, q)
+/// @param[in] modulus Odd modulus q, up to 64 bits
+/// @param[in] q_inv q^{-1} mod 2^64, as returned by InverseModPowerOfTwo
+/// @details As MultiplyModMontgomeryLazy, but x y < 2^64 q bounds both high
+/// words by q, so the difference is corrected by a conditional addition
+/// rather than an offset, which would overflow for moduli of 63 or 64 bits.
+inline uint64_t MultiplyModMontgomery(uint64_t x, uint64_t y, uint64_t modulus,
+                                      uint64_t q_inv) {
+  uint64_t prod_hi;
+  uint64_t prod_lo;
+  MultiplyUInt64(x, y, &prod_hi, &prod_lo);
+  uint64_t m = prod_lo * q_inv;
+  uint64_t mq_hi = MultiplyUInt64Hi<64>(m, modulus);
+  uint64_t diff = prod_hi - mq_hi;
+  return (prod_hi < mq_hi) ? diff + modulus : diff;
+}
+
+}  // namespace hexl
+}  // namespace intel
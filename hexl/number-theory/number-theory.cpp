@@ -18,27 +18,28 @@ uint64_t InverseMod(uint64_t input, uint64_t modulus) {
     return 0;
   }
 
-  int64_t m0 = static_cast<int64_t>(modulus);
-  int64_t y = 0;
-  int64_t x = 1;
+  // The Bezout coefficients alternate in sign and are bounded in magnitude by
+  // the modulus, so tracking their magnitudes supports moduli up to 2^64
+  uint64_t m0 = modulus;
+  uint64_t y = 0;
+  uint64_t x = 1;
+  bool x_negative = false;
   while (a > 1) {
     // q is quotient
-    int64_t q = static_cast<int64_t>(a / modulus);
+    uint64_t q = a / modulus;
 
-    int64_t t = static_cast<int64_t>(modulus);
+    uint64_t t = modulus;
     modulus = a % modulus;
-    a = static_cast<uint64_t>(t);
+    a = t;
 
     // Update y and x
     t = y;
-    y = x - q * y;
+    y = x + q * y;
     x = t;
+    x_negative = !x_negative;
   }
 
-  // Make x positive
-  if (x < 0) x += m0;
-
-  return uint64_t(x);
+  return x_negative ? m0 - x : x;
 }
 
 uint64_t MultiplyMod(uint64_t x, uint64_t y, uint64_t modulus) {
@@ -53,6 +54,12 @@ uint64_t MultiplyMod(uint64_t x, uint64_t y, uint64_t modulus) {
 
 uint64_t MultiplyMod(uint64_t x, uint64_t y, uint64_t y_precon,
                      uint64_t modulus) {
+  if (modulus >> 63) {
+    // The pre-conditioned product lies in [0, 2q), which exceeds 64 bits
+    uint64_t prod_hi, prod_lo;
+    MultiplyUInt64(x, y, &prod_hi, &prod_lo);
+    return BarrettReduce128(prod_hi, prod_lo, modulus);
+  }
   uint64_t q = MultiplyUInt64Hi<64>(x, y_precon);
   q = x * y - q * modulus;
   return q >= modulus ? q - modulus : q;
@@ -61,15 +68,14 @@ uint64_t MultiplyMod(uint64_t x, uint64_t y, uint64_t y_precon,
 uint64_t AddUIntMod(uint64_t x, uint64_t y, uint64_t modulus) {
   HEXL_CHECK(x < modulus, "x " << x << " >= modulus " << modulus);
   HEXL_CHECK(y < modulus, "y " << y << " >= modulus " << modulus);
-  uint64_t sum = x + y;
-  return (sum >= modulus) ? (sum - modulus) : sum;
+  uint64_t diff = modulus - y;
+  return (x >= diff) ? (x - diff) : (x + y);
 }
 
 uint64_t SubUIntMod(uint64_t x, uint64_t y, uint64_t modulus) {
   HEXL_CHECK(x < modulus, "x " << x << " >= modulus " << modulus);
   HEXL_CHECK(y < modulus, "y " << y << " >= modulus " << modulus);
-  uint64_t diff = (x + modulus) - y;
-  return (diff >= modulus) ? (diff - modulus) : diff;
+  return (x >= y) ? (x - y) : (x + (modulus - y));
 }
 
 // Returns base^exp mod modulus
@@ -132,6 +138,8 @@ uint64_t MinimalPrimitiveRoot(uint64_t degree, uint64_t modulus) {
   uint64_t root = GeneratePrimitiveRoot(degree, modulus);
 
   uint64_t generator_sq = MultiplyMod(root, root, modulus);
+  uint64_t generator_sq_precon =
+      MultiplyFactor(generator_sq, 64, modulus).BarrettFactor();
   uint64_t current_generator = root;
 
   uint64_t min_root = root;
@@ -141,7 +149,12 @@ uint64_t MinimalPrimitiveRoot(uint64_t degree, uint64_t modulus) {
     if (current_generator < min_root) {
       min_root = current_generator;
     }
-    current_generator = MultiplyMod(current_generator, generator_sq, modulus);
+    // The pre-conditioned multiplication requires modulus < 2^63
+    current_generator =
+        (modulus >> 63)
+            ? MultiplyMod(current_generator, generator_sq, modulus)
+            : MultiplyMod(current_generator, generator_sq, generator_sq_precon,
+                          modulus);
   }
 
   return min_root;
@@ -220,22 +233,22 @@ std::vector<uint64_t> GeneratePrimes(size_t num_primes, size_t bit_size,
   HEXL_CHECK(Log2(ntt_size) < bit_size,
              "log2(ntt_size) " << Log2(ntt_size)
                                << " should be less than bit_size " << bit_size);
+  HEXL_CHECK(bit_size <= 63,
+             "bit_size " << bit_size << " should be at most 63");
 
-  int64_t prime_lower_bound = (1LL << bit_size) + 1LL;
-  int64_t prime_upper_bound = (1LL << (bit_size + 1LL)) - 1LL;
+  const uint64_t prime_lower_bound = (1ULL << bit_size) + 1ULL;
+  const uint64_t prime_upper_bound = MaximumValue(bit_size + 1);
+  // Ensure prime % 2 * ntt_size == 1
+  const uint64_t prime_candidate_step = 2 * static_cast<uint64_t>(ntt_size);
 
-  // Keep signed to enable negative step
-  int64_t prime_candidate =
+  uint64_t prime_candidate =
       prefer_small_primes
           ? prime_lower_bound
-          : prime_upper_bound - (prime_upper_bound % (2 * ntt_size)) + 1;
-  HEXL_CHECK(prime_candidate % (2 * ntt_size) == 1, "bad prime candidate");
-
-  // Ensure prime % 2 * ntt_size == 1
-  int64_t prime_candidate_step =
-      (prefer_small_primes ? 1 : -1) * 2 * static_cast<int64_t>(ntt_size);
+          : prime_upper_bound - (prime_upper_bound % prime_candidate_step) + 1;
+  HEXL_CHECK(prime_candidate % prime_candidate_step == 1,
+             "bad prime candidate");
 
-  auto continue_condition = [&](int64_t local_candidate_prime) {
+  auto continue_condition = [&](uint64_t local_candidate_prime) {
     if (prefer_small_primes) {
       return local_candidate_prime < prime_upper_bound;
     } else {
@@ -247,13 +260,22 @@ std::vector<uint64_t> GeneratePrimes(size_t num_primes, size_t bit_size,
 
   while (continue_condition(prime_candidate)) {
     if (IsPrime(prime_candidate)) {
-      HEXL_CHECK(prime_candidate % (2 * ntt_size) == 1, "bad prime candidate");
-      ret.emplace_back(static_cast<uint64_t>(prime_candidate));
+      HEXL_CHECK(prime_candidate % prime_candidate_step == 1,
+                 "bad prime candidate");
+      ret.emplace_back(prime_candidate);
       if (ret.size() == num_primes) {
         return ret;
       }
     }
-    prime_candidate += prime_candidate_step;
+    if (prefer_small_primes) {
+      // Avoid wrapping around for 64-bit primes
+      if (prime_upper_bound - prime_candidate <= prime_candidate_step) {
+        break;
+      }
+      prime_candidate += prime_candidate_step;
+    } else {
+      prime_candidate -= prime_candidate_step;
+    }
   }
 
   HEXL_CHECK(false, "Failed to find enough primes");
@@ -0,0 +1,155 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <immintrin.h>
+
+#include <vector>
+
+#include "hexl/logging/logging.hpp"
+#include "hexl/util/check.hpp"
+#include "hexl/util/defines.hpp"
+
+namespace intel {
+namespace hexl {
+
+#ifdef HEXL_HAS_AVX256
+
+/// @brief Returns the unsigned 64-bit integer values in x as a vector
+inline std::vector<uint64_t> ExtractValues(__m256i x) {
+  std::vector<uint64_t> xs{static_cast<uint64_t>(_mm256_extract_epi64(x, 0)),
+                           static_cast<uint64_t>(_mm256_extract_epi64(x, 1)),
+                           static_cast<uint64_t>(_mm256_extract_epi64(x, 2)),
+                           static_cast<uint64_t>(_mm256_extract_epi64(x, 3))};
+  return xs;
+}
+
+// Multiply packed unsigned BitShift-bit integers in each 64-bit element of x
+// and y to form a 2*BitShift-bit intermediate result.
+// Returns the high BitShift-bit unsigned integer from the intermediate result
+template <int BitShift>
+inline __m256i _mm256_hexl_mulhi_epi(__m256i x, __m256i y);
+
+template <>
+inline __m256i _mm256_hexl_mulhi_epi<32>(__m256i x, __m256i y) {
+  return _mm256_srli_epi64(_mm256_mul_epu32(x, y), 32);
+}
+
+template <>
+inline __m256i _mm256_hexl_mulhi_epi<64>(__m256i x, __m256i y) {
+  // See _mm512_hexl_mulhi_epi<64> for a description of the algorithm
+  const __m256i lo_mask = _mm256_set1_epi64x(0x00000000ffffffff);
+  __m256i x_hi = _mm256_srli_epi64(x, 32);
+  __m256i y_hi = _mm256_srli_epi64(y, 32);
+  __m256i z_lo_lo = _mm256_mul_epu32(x, y);        // x_lo * y_lo
+  __m256i z_lo_hi = _mm256_mul_epu32(x, y_hi);     // x_lo * y_hi
+  __m256i z_hi_lo = _mm256_mul_epu32(x_hi, y);     // x_hi * y_lo
+  __m256i z_hi_hi = _mm256_mul_epu32(x_hi, y_hi);  // x_hi * y_hi
+
+  __m256i z_lo_lo_shift = _mm256_srli_epi64(z_lo_lo, 32);
+  __m256i sum_tmp = _mm256_add_epi64(z_lo_hi, z_lo_lo_shift);
+  __m256i sum_lo = _mm256_and_si256(sum_tmp, lo_mask);
+  __m256i sum_mid = _mm256_srli_epi64(sum_tmp, 32);
+  __m256i sum_mid2 = _mm256_add_epi64(z_hi_lo, sum_lo);
+  __m256i sum_mid2_hi = _mm256_srli_epi64(sum_mid2, 32);
+  __m256i sum_hi = _mm256_add_epi64(z_hi_hi, sum_mid);
+  return _mm256_add_epi64(sum_hi, sum_mid2_hi);
+}
+
+// Multiply packed unsigned BitShift-bit integers in each 64-bit element of x
+// and y to form a 2*BitShift-bit intermediate result.
+// Returns the high BitShift-bit unsigned integer from the intermediate result,
+// with approximation error at most 1
+template <int BitShift>
+inline __m256i _mm256_hexl_mulhi_approx_epi(__m256i x, __m256i y);
+
+template <>
+inline __m256i _mm256_hexl_mulhi_approx_epi<32>(__m256i x, __m256i y) {
+  return _mm256_hexl_mulhi_epi<32>(x, y);
+}
+
+template <>
+inline __m256i _mm256_hexl_mulhi_approx_epi<64>(__m256i x, __m256i y) {
+  // See _mm512_hexl_mulhi_approx_epi<64> for a description of the algorithm
+  const __m256i lo_mask = _mm256_set1_epi64x(0x00000000ffffffff);
+  __m256i x_hi = _mm256_srli_epi64(x, 32);
+  __m256i y_hi = _mm256_srli_epi64(y, 32);
+  __m256i z_lo_hi = _mm256_mul_epu32(x, y_hi);     // x_lo * y_hi
+  __m256i z_hi_lo = _mm256_mul_epu32(x_hi, y);     // x_hi * y_lo
+  __m256i z_hi_hi = _mm256_mul_epu32(x_hi, y_hi);  // x_hi * y_hi
+
+  __m256i sum_lo = _mm256_and_si256(z_lo_hi, lo_mask);
+  __m256i sum_mid = _mm256_srli_epi64(z_lo_hi, 32);
+  __m256i sum_mid2 = _mm256_add_epi64(z_hi_lo, sum_lo);
+  __m256i sum_mid2_hi = _mm256_srli_epi64(sum_mid2, 32);
+  __m256i sum_hi = _mm256_add_epi64(z_hi_hi, sum_mid);
+  return _mm256_add_epi64(sum_hi, sum_mid2_hi);
+}
+
+// Multiply packed unsigned BitShift-bit integers in each 64-bit element of x
+// and y to form a 2*BitShift-bit intermediate result.
+// Returns the low 64 bits of the intermediate result. For BitShift == 32, the
+// inputs must be less than 2^32.
+template <int BitShift>
+inline __m256i _mm256_hexl_mullo_epi(__m256i x, __m256i y);
+
+template <>
+inline __m256i _mm256_hexl_mullo_epi<32>(__m256i x, __m256i y) {
+  return _mm256_mul_epu32(x, y);
+}
+
+template <>
+inline __m256i _mm256_hexl_mullo_epi<64>(__m256i x, __m256i y) {
+  // AVX2 lacks a 64-bit low multiply, so we compute
+  // x_lo * y_lo + ((x_lo * y_hi + x_hi * y_lo) << 32)
+  __m256i x_hi = _mm256_srli_epi64(x, 32);
+  __m256i y_hi = _mm256_srli_epi64(y, 32);
+  __m256i z_lo_lo = _mm256_mul_epu32(x, y);
+  __m256i z_lo_hi = _mm256_mul_epu32(x, y_hi);
+  __m256i z_hi_lo = _mm256_mul_epu32(x_hi, y);
+  __m256i z_mid = _mm256_slli_epi64(_mm256_add_epi64(z_lo_hi, z_hi_lo), 32);
+  return _mm256_add_epi64(z_lo_lo, z_mid);
+}
+
+// Returns (a > b) ? 0xFFFFFFFFFFFFFFFF : 0 across each unsigned 64-bit lane
+inline __m256i _mm256_hexl_cmpgt_epu64(__m256i a, __m256i b) {
+  const __m256i sign_bit =
+      _mm256_set1_epi64x(static_cast<int64_t>(1ULL << 63));
+  return _mm256_cmpgt_epi64(_mm256_xor_si256(a, sign_bit),
+                            _mm256_xor_si256(b, sign_bit));
+}
+
+// Returns x mod q across each 64-bit integer SIMD lanes
+// Assumes x < 2 * q in all lanes
+inline __m256i _mm256_hexl_small_mod_epu64(__m256i x, __m256i q) {
+  __m256i q_gt_x = _mm256_hexl_cmpgt_epu64(q, x);
+  return _mm256_sub_epi64(x, _mm256_andnot_si256(q_gt_x, q));
+}
+
+// Returns x mod q across each 64-bit integer SIMD lanes, where x is interpreted
+// as a signed integer. Assumes -q <= x < q in all lanes
+inline __m256i _mm256_hexl_signed_small_mod_epi64(__m256i x, __m256i q) {
+  __m256i sign_bits = _mm256_cmpgt_epi64(_mm256_setzero_si256(), x);
+  return _mm256_add_epi64(x, _mm256_and_si256(sign_bits, q));
+}
+
+// Returns the high 32 bits of the 64-bit product x * y across each unsigned
+// 32-bit lane
+inline __m256i _mm256_hexl_mulhi_epu32(__m256i x, __m256i y) {
+  __m256i prod_even = _mm256_mul_epu32(x, y);
+  __m256i prod_odd =
+      _mm256_mul_epu32(_mm256_srli_epi64(x, 32), _mm256_srli_epi64(y, 32));
+  return _mm256_blend_epi32(_mm256_srli_epi64(prod_even, 32), prod_odd, 0xAA);
+}
+
+// Returns x mod q across each 32-bit integer SIMD lanes
+// Assumes x < 2 * q in all lanes
+inline __m256i _mm256_hexl_small_mod_epu32(__m256i x, __m256i q) {
+  return _mm256_min_epu32(x, _mm256_sub_epi32(x, q));
+}
+
+#endif  // HEXL_HAS_AVX256
+
+}  // namespace hexl
+}  // namespace intel
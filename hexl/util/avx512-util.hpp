@@ -288,6 +288,22 @@ inline __m512i _mm512_hexl_small_mod_epu64(__m512i x, __m512i q,
   return x;  // Return dummy value
 }
 
+// Returns the high 32 bits of the 64-bit product x * y across each unsigned
+// 32-bit lane
+inline __m512i _mm512_hexl_mulhi_epu32(__m512i x, __m512i y) {
+  __m512i prod_even = _mm512_mul_epu32(x, y);
+  __m512i prod_odd =
+      _mm512_mul_epu32(_mm512_srli_epi64(x, 32), _mm512_srli_epi64(y, 32));
+  return _mm512_mask_blend_epi32(0xAAAA, _mm512_srli_epi64(prod_even, 32),
+                                 prod_odd);
+}
+
+// Returns x mod q across each 32-bit integer SIMD lanes
+// Assumes x < 2 * q in all lanes
+inline __m512i _mm512_hexl_small_mod_epu32(__m512i x, __m512i q) {
+  return _mm512_min_epu32(x, _mm512_sub_epi32(x, q));
+}
+
 // Returns (x + y) mod q; assumes 0 < x, y < q
 inline __m512i _mm512_hexl_small_add_mod_epi64(__m512i x, __m512i y,
                                                __m512i q) {
@@ -323,6 +339,41 @@ inline __m512i _mm512_hexl_small_sub_mod_epi64(__m512i x, __m512i y,
   return _mm512_mask_add_epi64(v_diff, sign_bits, v_diff, q);
 }
 
+// Returns (x + y) mod q; assumes 0 <= x, y < q. Unlike
+// _mm512_hexl_small_add_mod_epi64, supports any q < 2^64, for which x + y may
+// overflow
+inline __m512i _mm512_hexl_large_add_mod_epi64(__m512i x, __m512i y,
+                                               __m512i q) {
+  // return (x >= q - y) ? x - (q - y) : x + y
+  __m512i v_diff = _mm512_sub_epi64(q, y);
+  __mmask8 wrap = _mm512_cmpge_epu64_mask(x, v_diff);
+  return _mm512_mask_sub_epi64(_mm512_add_epi64(x, y), wrap, x, v_diff);
+}
+
+// Returns (x - y) mod q; assumes 0 <= x, y < q. Unlike
+// _mm512_hexl_small_sub_mod_epi64, supports any q < 2^64, for which the sign
+// bit of x - y is ambiguous
+inline __m512i _mm512_hexl_large_sub_mod_epi64(__m512i x, __m512i y,
+                                               __m512i q) {
+  __m512i v_diff = _mm512_sub_epi64(x, y);
+  __mmask8 borrow = _mm512_cmplt_epu64_mask(x, y);
+  return _mm512_mask_add_epi64(v_diff, borrow, v_diff, q);
+}
+
+// Returns x * y * 2^{-64} mod q in [0, q) across each 64-bit lane, for odd q
+// < 2^64, any 64-bit x and y in [0, q). q_inv is q^{-1} mod 2^64. See
+// MultiplyModMontgomery.
+inline __m512i _mm512_hexl_montgomery_mul_epu64(__m512i x, __m512i y,
+                                                __m512i q, __m512i q_inv) {
+  __m512i prod_hi = _mm512_hexl_mulhi_epi<64>(x, y);
+  __m512i prod_lo = _mm512_hexl_mullo_epi<64>(x, y);
+  __m512i m = _mm512_hexl_mullo_epi<64>(prod_lo, q_inv);
+  __m512i mq_hi = _mm512_hexl_mulhi_epi<64>(m, q);
+  __m512i v_diff = _mm512_sub_epi64(prod_hi, mq_hi);
+  __mmask8 borrow = _mm512_cmplt_epu64_mask(prod_hi, mq_hi);
+  return _mm512_mask_add_epi64(v_diff, borrow, v_diff, q);
+}
+
 inline __mmask8 _mm512_hexl_cmp_epu64_mask(__m512i a, __m512i b, CMPINT cmp) {
   switch (cmp) {
     case CMPINT::EQ:
@@ -0,0 +1,28 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "util/cache-info.hpp"
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+namespace intel {
+namespace hexl {
+
+size_t GetL1DataCacheSize() {
+  constexpr size_t default_size = 32 * 1024;
+#if defined(__linux__) && defined(_SC_LEVEL1_DCACHE_SIZE)
+  static const size_t size = []() {
+    long detected_size = sysconf(_SC_LEVEL1_DCACHE_SIZE);  // NOLINT
+    return detected_size > 0 ? static_cast<size_t>(detected_size)
+                             : default_size;
+  }();
+  return size;
+#else
+  return default_size;
+#endif
+}
+
+}  // namespace hexl
+}  // namespace intel
@@ -0,0 +1,16 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stddef.h>
+
+namespace intel {
+namespace hexl {
+
+/// @brief Returns the size in bytes of the level-1 data cache of one core, or
+/// 32 KB if it cannot be detected
+size_t GetL1DataCacheSize();
+
+}  // namespace hexl
+}  // namespace intel
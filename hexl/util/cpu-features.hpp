@@ -12,6 +12,9 @@
 namespace intel {
 namespace hexl {
 
+// Use to disable avx2 dispatching at runtime
+static const bool disable_avx2 = (std::getenv("HEXL_DISABLE_AVX2") != nullptr);
+
 // Use to disable avx512 dispatching at runtime
 static const bool disable_avx512dq =
     (std::getenv("HEXL_DISABLE_AVX512DQ") != nullptr);
@@ -23,6 +26,8 @@ static const bool disable_avx512vbmi2 =
 static const cpu_features::X86Features features =
     cpu_features::GetX86Info().features;
 
+static const bool has_avx2 = features.avx2 && !disable_avx2;
+
 static const bool has_avx512dq = features.avx512f && features.avx512dq &&
                                  features.avx512vl && !disable_avx512dq;
 
@@ -0,0 +1,181 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "util/thread-pool.hpp"
+
+#include <cstdlib>
+#include <stdexcept>
+
+#include "hexl/util/util.hpp"
+
+namespace intel {
+namespace hexl {
+
+namespace {
+// True while the current thread executes tasks of the pool
+thread_local bool t_in_parallel_region = false;
+}  // namespace
+
+ThreadPool& ThreadPool::GetInstance() {
+  static ThreadPool pool;
+  return pool;
+}
+
+ThreadPool::ThreadPool(size_t num_threads) {
+  m_num_threads = (num_threads == 0) ? DefaultNumThreads() : num_threads;
+  StartWorkers();
+}
+
+ThreadPool::~ThreadPool() { StopWorkers(); }
+
+size_t ThreadPool::DefaultNumThreads() {
+  const char* env_num_threads = std::getenv("HEXL_NUM_THREADS");
+  if (env_num_threads != nullptr) {
+    size_t num_threads = std::strtoul(env_num_threads, nullptr, 10);
+    if (num_threads > 0) {
+      return num_threads;
+    }
+  }
+  size_t hw_threads = std::thread::hardware_concurrency();
+  return (hw_threads == 0) ? 1 : hw_threads;
+}
+
+void ThreadPool::SetNumThreads(size_t num_threads) {
+  if (t_in_parallel_region) {
+    throw std::logic_error(
+        "SetNumThreads cannot be called from within a ParallelFor task");
+  }
+  std::lock_guard<std::mutex> submit_lock(m_submit_mutex);
+  StopWorkers();
+  m_num_threads = (num_threads == 0) ? DefaultNumThreads() : num_threads;
+  StartWorkers();
+}
+
+void ThreadPool::StartWorkers() {
+  m_stop = false;
+  for (size_t i = 1; i < m_num_threads; ++i) {
+    m_workers.emplace_back([this]() { WorkerLoop(); });
+  }
+}
+
+void ThreadPool::StopWorkers() {
+  {
+    std::lock_guard<std::mutex> lock(m_job_mutex);
+    m_stop = true;
+  }
+  m_job_cv.notify_all();
+  for (auto& worker : m_workers) {
+    worker.join();
+  }
+  m_workers.clear();
+}
+
+void ThreadPool::RunTasks(const std::function<void(size_t)>& task,
+                          size_t num_tasks) {
+  for (size_t i = m_next_task++; i < num_tasks; i = m_next_task++) {
+    try {
+      task(i);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(m_job_mutex);
+      if (!m_exception) {
+        m_exception = std::current_exception();
+      }
+      // Skip remaining tasks
+      m_next_task = num_tasks;
+    }
+  }
+}
+
+void ThreadPool::WorkerLoop() {
+  t_in_parallel_region = true;
+  uint64_t seen_generation = 0;
+  std::unique_lock<std::mutex> lock(m_job_mutex);
+  while (true) {
+    m_job_cv.wait(lock, [&]() {
+      return m_stop || (m_generation != seen_generation);
+    });
+    if (m_stop) {
+      return;
+    }
+    seen_generation = m_generation;
+    if (m_task == nullptr) {
+      // Job already completed by the other threads
+      continue;
+    }
+    const std::function<void(size_t)>* task = m_task;
+    size_t num_tasks = m_num_tasks;
+    ++m_active_workers;
+    lock.unlock();
+
+    RunTasks(*task, num_tasks);
+
+    lock.lock();
+    if (--m_active_workers == 0) {
+      m_done_cv.notify_all();
+    }
+  }
+}
+
+void ThreadPool::ParallelFor(size_t num_tasks,
+                             const std::function<void(size_t)>& task) {
+  // Tasks run serially still count as within the parallel region, so they see
+  // the same restrictions as tasks run by the workers
+  auto run_serial = [&]() {
+    bool in_parallel_region = t_in_parallel_region;
+    t_in_parallel_region = true;
+    try {
+      for (size_t i = 0; i < num_tasks; ++i) {
+        task(i);
+      }
+    } catch (...) {
+      t_in_parallel_region = in_parallel_region;
+      throw;
+    }
+    t_in_parallel_region = in_parallel_region;
+  };
+
+  if (num_tasks <= 1 || t_in_parallel_region) {
+    run_serial();
+    return;
+  }
+  std::unique_lock<std::mutex> submit_lock(m_submit_mutex, std::try_to_lock);
+  if (!submit_lock.owns_lock() || m_workers.empty()) {
+    run_serial();
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_job_mutex);
+    m_task = &task;
+    m_num_tasks = num_tasks;
+    m_next_task = 0;
+    m_exception = nullptr;
+    ++m_generation;
+  }
+  m_job_cv.notify_all();
+
+  t_in_parallel_region = true;
+  RunTasks(task, num_tasks);
+  t_in_parallel_region = false;
+
+  std::exception_ptr exception;
+  {
+    std::unique_lock<std::mutex> lock(m_job_mutex);
+    m_done_cv.wait(lock, [&]() { return m_active_workers == 0; });
+    m_task = nullptr;
+    m_num_tasks = 0;
+    std::swap(exception, m_exception);
+  }
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+}
+
+void SetNumThreads(size_t num_threads) {
+  ThreadPool::GetInstance().SetNumThreads(num_threads);
+}
+
+size_t GetNumThreads() { return ThreadPool::GetInstance().GetNumThreads(); }
+
+}  // namespace hexl
+}  // namespace intel
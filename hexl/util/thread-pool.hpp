@@ -0,0 +1,85 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace intel {
+namespace hexl {
+
+/// @brief Persistent pool of worker threads used to parallelize HEXL routines
+/// @details Work is submitted via ParallelFor, which blocks until all tasks
+/// have completed. The calling thread participates in executing the tasks.
+/// Calls to ParallelFor made from within a task, or while another thread is
+/// already using the pool, are executed serially on the calling thread, so
+/// nested parallelism can never dead-lock.
+class ThreadPool {
+ public:
+  /// @brief Returns the process-wide thread pool
+  static ThreadPool& GetInstance();
+
+  /// @brief Constructs a pool using \p num_threads threads in total, including
+  /// the calling thread. A value of 0 uses DefaultNumThreads().
+  explicit ThreadPool(size_t num_threads = 0);
+
+  ~ThreadPool();
+
+  /// @brief Runs task(i) for each i in [0, num_tasks), distributing the tasks
+  /// across the threads of the pool
+  void ParallelFor(size_t num_tasks, const std::function<void(size_t)>& task);
+
+  /// @brief Sets the number of threads, including the calling thread. A value
+  /// of 0 restores DefaultNumThreads().
+  /// @details Waits for a ParallelFor running on another thread to complete.
+  /// Throws std::logic_error if called from within a task of the pool, since
+  /// the workers cannot be restarted while they execute the task.
+  void SetNumThreads(size_t num_threads);
+
+  /// @brief Returns the number of threads, including the calling thread
+  size_t GetNumThreads() const { return m_num_threads; }
+
+  /// @brief Returns the value of the HEXL_NUM_THREADS environment variable if
+  /// set, and the number of hardware threads otherwise
+  static size_t DefaultNumThreads();
+
+ private:
+  ThreadPool(const ThreadPool& copy) = delete;
+  ThreadPool& operator=(const ThreadPool& assign) = delete;
+
+  void StartWorkers();
+  void StopWorkers();
+  void WorkerLoop();
+  void RunTasks(const std::function<void(size_t)>& task, size_t num_tasks);
+
+  // Written under m_submit_mutex; atomic so GetNumThreads does not lock
+  std::atomic<size_t> m_num_threads{1};
+  std::vector<std::thread> m_workers;
+
+  // Serializes concurrent ParallelFor and SetNumThreads calls
+  std::mutex m_submit_mutex;
+
+  // Protects the job state below
+  std::mutex m_job_mutex;
+  std::condition_variable m_job_cv;
+  std::condition_variable m_done_cv;
+  const std::function<void(size_t)>* m_task{nullptr};
+  size_t m_num_tasks{0};
+  std::atomic<size_t> m_next_task{0};
+  size_t m_active_workers{0};
+  uint64_t m_generation{0};
+  std::exception_ptr m_exception;
+  bool m_stop{false};
+};
+
+}  // namespace hexl
+}  // namespace intel
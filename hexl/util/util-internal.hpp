@@ -4,6 +4,7 @@
 #pragma once
 
 #include <algorithm>
+#include <limits>
 #include <random>
 #include <utility>
 
@@ -41,6 +42,39 @@ inline bool Compare(CMPINT cmp, uint64_t lhs, uint64_t rhs) {
   }
 }
 
+/// @brief Returns mod_factor * modulus, saturated to 2^64 - 1, i.e. the
+/// exclusive bound of values in [0, mod_factor * modulus) for moduli of up to
+/// 64 bits
+inline uint64_t ModFactorBound(uint64_t modulus, uint64_t mod_factor) {
+  const uint64_t max_value = (std::numeric_limits<uint64_t>::max)();
+  return (modulus > max_value / mod_factor) ? max_value : mod_factor * modulus;
+}
+
+/// @brief 64-byte aligned scratch buffer of uint64_t, left uninitialized
+/// @details Unlike AlignedVector64, does not zero-fill its values, so suits
+/// scratch space which is fully written before it is read
+class ScratchBuffer {
+ public:
+  ScratchBuffer(size_t size, const AlignedAllocator<uint64_t, 64>& alloc)
+      : m_alloc(alloc), m_size(size), m_data(m_alloc.allocate(size)) {}
+
+  ~ScratchBuffer() { m_alloc.deallocate(m_data, m_size); }
+
+  ScratchBuffer(const ScratchBuffer& copy) = delete;
+  ScratchBuffer& operator=(const ScratchBuffer& assign) = delete;
+
+  uint64_t* data() { return m_data; }
+
+  uint64_t& operator[](size_t i) { return m_data[i]; }
+
+  size_t size() const { return m_size; }
+
+ private:
+  AlignedAllocator<uint64_t, 64> m_alloc;
+  size_t m_size;
+  uint64_t* m_data;
+};
+
 /// Generates a vector of size random values drawn uniformly from [min_value,
 /// max_value)
 /// NOTE: this function is not a cryptographically secure random number
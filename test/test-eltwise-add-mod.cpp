@@ -109,5 +109,30 @@ TEST(EltwiseAddMod, vector_scalar_native_big) {
   CheckEqual(op1, exp_out);
 }
 
+// Sums of operands below a 64-bit modulus overflow 64 bits
+TEST(EltwiseAddMod, vector_vector_64bit_modulus) {
+  uint64_t modulus = 0xFFFFFFFFFFFFFFC5ULL;
+
+  std::vector<uint64_t> op1{modulus - 1, modulus - 1, modulus - 2,
+                            0,           1,           modulus - 3,
+                            2,           modulus - 4, 7};
+  std::vector<uint64_t> op2{modulus - 1, 1, 2, modulus - 1, modulus - 1,
+                            modulus - 5, 3, 4, modulus - 8};
+  std::vector<uint64_t> exp_out{modulus - 2, 0, 0, modulus - 1, 0,
+                                modulus - 8, 5, 0, modulus - 1};
+
+  std::vector<uint64_t> result(op1.size(), 0);
+  EltwiseAddModNative(result.data(), op1.data(), op2.data(), op1.size(),
+                      modulus);
+  CheckEqual(result, exp_out);
+  EltwiseAddMod(result.data(), op1.data(), op2.data(), op1.size(), modulus);
+  CheckEqual(result, exp_out);
+
+  EltwiseAddMod(result.data(), op1.data(), modulus - 1, op1.size(), modulus);
+  for (size_t i = 0; i < op1.size(); ++i) {
+    ASSERT_EQ(result[i], SubUIntMod(op1[i], 1, modulus));
+  }
+}
+
 }  // namespace hexl
 }  // namespace intel
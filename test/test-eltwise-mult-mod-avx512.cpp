@@ -208,6 +208,35 @@ TEST(EltwiseMultMod, avx512dqint_big) {
 }
 
 // Checks Montgomery and AVX512DQInt eltwise mult implementations match
+// Checks AVX512 and native large-modulus implementations match
+TEST(EltwiseMultMod, avx512_large_modulus) {
+  if (!has_avx512dq) {
+    GTEST_SKIP();
+  }
+
+  for (size_t length : {1, 8, 1027}) {
+    for (size_t bits = 60; bits <= 63; ++bits) {
+      uint64_t modulus = GeneratePrimes(1, bits, false, 1024)[0];
+      auto op1 = GenerateInsecureUniformIntRandomValues(length, 0,
+                                                        MaximumValue(64));
+      auto op2 = GenerateInsecureUniformIntRandomValues(length, 0,
+                                                        MaximumValue(64));
+      std::vector<uint64_t> out_native(length, 0);
+      std::vector<uint64_t> out_avx(length, 0);
+
+      EltwiseMultModLargeModulusNative(out_native.data(), op1.data(),
+                                       op2.data(), length, modulus);
+      EltwiseMultModLargeModulusAVX512(out_avx.data(), op1.data(), op2.data(),
+                                       length, modulus);
+      ASSERT_EQ(out_avx, out_native);
+      for (size_t i = 0; i < length; ++i) {
+        ASSERT_EQ(out_native[i], MultiplyMod(op1[i] % modulus,
+                                             op2[i] % modulus, modulus));
+      }
+    }
+  }
+}
+
 TEST(EltwiseMultModMont_EConv, avx512dqint_big) {
   if (!has_avx512dq) {
     GTEST_SKIP();
@@ -11,6 +11,7 @@
 #include "hexl/number-theory/number-theory.hpp"
 #include "ntt/ntt-internal.hpp"
 #include "test/test-util.hpp"
+#include "util/util-internal.hpp"
 
 namespace intel {
 namespace hexl {
@@ -209,6 +210,39 @@ TEST(EltwiseMultMod, 9) {
   CheckEqual(result, exp_out);
 }
 
+// Moduli of at least 2^62, or whose input bound input_mod_factor * modulus is
+// at least 2^63, use Montgomery multiplication
+TEST(EltwiseMultMod, large_modulus) {
+  std::vector<uint64_t> moduli{GeneratePrimes(1, 61, false, 1024)[0],
+                               GeneratePrimes(1, 62, true, 1024)[0],
+                               GeneratePrimes(1, 63, false, 1024)[0],
+                               0xFFFFFFFFFFFFFFC5ULL};
+  uint64_t length = 1027;
+  for (uint64_t modulus : moduli) {
+    for (uint64_t input_mod_factor : {1, 2, 4}) {
+      uint64_t bound = ModFactorBound(modulus, input_mod_factor);
+      auto op1 = GenerateInsecureUniformIntRandomValues(length, 0, bound);
+      auto op2 = GenerateInsecureUniformIntRandomValues(length, 0, bound);
+      op1[0] = bound - 1;
+      op2[0] = bound - 1;
+
+      std::vector<uint64_t> expected(length, 0);
+      for (size_t i = 0; i < length; ++i) {
+        expected[i] =
+            MultiplyMod(op1[i] % modulus, op2[i] % modulus, modulus);
+      }
+
+      std::vector<uint64_t> result(length, 0);
+      EltwiseMultModLargeModulusNative(result.data(), op1.data(), op2.data(),
+                                       length, modulus);
+      ASSERT_EQ(result, expected);
+      EltwiseMultMod(result.data(), op1.data(), op2.data(), length, modulus,
+                     input_mod_factor);
+      ASSERT_EQ(result, expected);
+    }
+  }
+}
+
 struct ModulusInputModData {
   explicit ModulusInputModData(std::tuple<uint64_t, bool, uint64_t> param) {
     modulus_bits = std::get<0>(param);
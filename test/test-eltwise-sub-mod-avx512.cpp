@@ -93,7 +93,7 @@ TEST(EltwiseSubMod, vector_vector_avx512_native_match) {
 
   size_t length = 173;
 
-  for (size_t bits = 1; bits <= 62; ++bits) {
+  for (size_t bits = 1; bits <= 63; ++bits) {
     uint64_t modulus = 1ULL << bits;
 
 #ifdef HEXL_DEBUG
@@ -130,7 +130,7 @@ TEST(EltwiseSubMod, vector_scalar_avx512_native_match) {
 
   size_t length = 173;
 
-  for (size_t bits = 1; bits <= 62; ++bits) {
+  for (size_t bits = 1; bits <= 63; ++bits) {
     uint64_t modulus = 1ULL << bits;
 
 #ifdef HEXL_DEBUG
@@ -107,5 +107,31 @@ TEST(EltwiseSubMod, vector_scalar_native_big) {
   CheckEqual(op1, exp_out);
 }
 
+// Differences of operands below a 64-bit modulus are ambiguous in sign
+TEST(EltwiseSubMod, vector_vector_64bit_modulus) {
+  uint64_t modulus = 0xFFFFFFFFFFFFFFC5ULL;
+
+  std::vector<uint64_t> op1{0,           1,           modulus - 1,
+                            modulus - 1, 2,           modulus - 3,
+                            3,           5,           modulus - 2};
+  std::vector<uint64_t> op2{modulus - 1, modulus - 1, 0, 1, 3, 2,
+                            modulus - 1, 5,           modulus - 1};
+  std::vector<uint64_t> exp_out{1,           2,           modulus - 1,
+                                modulus - 2, modulus - 1, modulus - 5,
+                                4,           0,           modulus - 1};
+
+  std::vector<uint64_t> result(op1.size(), 0);
+  EltwiseSubModNative(result.data(), op1.data(), op2.data(), op1.size(),
+                      modulus);
+  CheckEqual(result, exp_out);
+  EltwiseSubMod(result.data(), op1.data(), op2.data(), op1.size(), modulus);
+  CheckEqual(result, exp_out);
+
+  EltwiseSubMod(result.data(), op1.data(), modulus - 1, op1.size(), modulus);
+  for (size_t i = 0; i < op1.size(); ++i) {
+    ASSERT_EQ(result[i], AddUIntMod(op1[i], 1, modulus));
+  }
+}
+
 }  // namespace hexl
 }  // namespace intel
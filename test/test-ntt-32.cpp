@@ -0,0 +1,163 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "hexl/ntt/ntt-32.hpp"
+#include "hexl/ntt/ntt.hpp"
+#include "hexl/number-theory/number-theory.hpp"
+#include "ntt/ntt-32-internal.hpp"
+#include "test/test-util.hpp"
+#include "util/cpu-features.hpp"
+#include "util/util-internal.hpp"
+
+namespace intel {
+namespace hexl {
+
+namespace {
+
+std::vector<uint32_t> GenerateValues32(uint64_t n, uint64_t bound) {
+  AlignedVector64<uint64_t> values =
+      GenerateInsecureUniformIntRandomValues(n, 0, bound);
+  return std::vector<uint32_t>(values.begin(), values.end());
+}
+
+std::vector<uint32_t> Reduce32(std::vector<uint32_t> values, uint32_t q) {
+  for (auto& value : values) {
+    value %= q;
+  }
+  return values;
+}
+
+std::vector<uint64_t> Widen(const std::vector<uint32_t>& values) {
+  return std::vector<uint64_t>(values.begin(), values.end());
+}
+
+}  // namespace
+
+// Checks the transforms equal those of the 64-bit NTT for all supported mod
+// factors
+TEST(NTT32, matches_ntt) {
+  for (uint64_t N : {2, 4, 8, 16, 32, 64, 128, 1024, 4096}) {
+    std::vector<uint64_t> moduli{65537, GeneratePrimes(1, 29, true, N)[0]};
+    for (uint64_t q : moduli) {
+      NTT32 ntt32(N, static_cast<uint32_t>(q));
+      NTT ntt(N, q);
+      ASSERT_EQ(ntt32.GetMinimalRootOfUnity(), ntt.GetMinimalRootOfUnity());
+
+      for (uint64_t input_mod_factor : {1, 2, 4}) {
+        std::vector<uint32_t> input = GenerateValues32(N, input_mod_factor * q);
+        std::vector<uint64_t> expected(N);
+        std::vector<uint64_t> reduced = Widen(Reduce32(input, q));
+        ntt.ComputeForward(expected.data(), reduced.data(), 1, 1);
+
+        for (uint64_t output_mod_factor : {1, 4}) {
+          std::vector<uint32_t> result(N);
+          ntt32.ComputeForward(result.data(), input.data(), input_mod_factor,
+                               output_mod_factor);
+          for (uint32_t x : result) {
+            ASSERT_LT(x, output_mod_factor * q);
+          }
+          AssertEqual(Widen(Reduce32(result, q)), expected);
+        }
+      }
+
+      for (uint64_t input_mod_factor : {1, 2}) {
+        std::vector<uint32_t> input = GenerateValues32(N, input_mod_factor * q);
+        std::vector<uint64_t> expected(N);
+        std::vector<uint64_t> reduced = Widen(Reduce32(input, q));
+        ntt.ComputeInverse(expected.data(), reduced.data(), 1, 1);
+
+        for (uint64_t output_mod_factor : {1, 2}) {
+          std::vector<uint32_t> result(N);
+          ntt32.ComputeInverse(result.data(), input.data(), input_mod_factor,
+                               output_mod_factor);
+          for (uint32_t x : result) {
+            ASSERT_LT(x, output_mod_factor * q);
+          }
+          AssertEqual(Widen(Reduce32(result, q)), expected);
+        }
+      }
+    }
+  }
+}
+
+TEST(NTT32, in_place_round_trip) {
+  for (uint64_t N : {1, 2, 16, 64, 2048}) {
+    uint32_t q = static_cast<uint32_t>(GeneratePrimes(1, 29, true, N)[0]);
+    NTT32 ntt32(N, q);
+    std::vector<uint32_t> input = GenerateValues32(N, q);
+    std::vector<uint32_t> data = input;
+    ntt32.ComputeForward(data.data(), data.data(), 1, 1);
+    ntt32.ComputeInverse(data.data(), data.data(), 1, 1);
+    AssertEqual(data, input);
+  }
+}
+
+// Checks the vectorized transforms match the native transforms exactly,
+// including the lazily reduced outputs
+TEST(NTT32, kernels) {
+  for (uint64_t N : {32, 64, 128, 512, 4096}) {
+    uint32_t q = static_cast<uint32_t>(GeneratePrimes(1, 29, true, N)[0]);
+    NTT32 ntt32(N, q);
+    const uint32_t* W = ntt32.GetRootOfUnityPowers().data();
+    const uint32_t* W_precon = ntt32.GetPreconRootOfUnityPowers().data();
+    const uint32_t* inv_W = ntt32.GetInvRootOfUnityPowers().data();
+    const uint32_t* inv_W_precon = ntt32.GetPreconInvRootOfUnityPowers().data();
+
+    std::vector<uint32_t> fwd_input = GenerateValues32(N, 4 * q);
+    std::vector<uint32_t> inv_input = GenerateValues32(N, 2 * q);
+
+    for (uint64_t output_mod_factor : {1, 4}) {
+      std::vector<uint32_t> expected(N);
+      ForwardTransformToBitReverse32(expected.data(), fwd_input.data(), N, q, W,
+                                     W_precon, output_mod_factor);
+#ifdef HEXL_HAS_AVX256
+      if (has_avx2) {
+        std::vector<uint32_t> result(N);
+        ForwardTransformToBitReverse32AVX2(result.data(), fwd_input.data(), N,
+                                           q, W, W_precon, output_mod_factor);
+        AssertEqual(result, expected);
+      }
+#endif
+#ifdef HEXL_HAS_AVX512DQ
+      if (has_avx512dq) {
+        std::vector<uint32_t> result(N);
+        ForwardTransformToBitReverse32AVX512(result.data(), fwd_input.data(),
+                                             N, q, W, W_precon,
+                                             output_mod_factor);
+        AssertEqual(result, expected);
+      }
+#endif
+    }
+
+    for (uint64_t output_mod_factor : {1, 2}) {
+      std::vector<uint32_t> expected(N);
+      InverseTransformFromBitReverse32(expected.data(), inv_input.data(), N, q,
+                                       inv_W, inv_W_precon, output_mod_factor);
+#ifdef HEXL_HAS_AVX256
+      if (has_avx2) {
+        std::vector<uint32_t> result(N);
+        InverseTransformFromBitReverse32AVX2(result.data(), inv_input.data(),
+                                             N, q, inv_W, inv_W_precon,
+                                             output_mod_factor);
+        AssertEqual(result, expected);
+      }
+#endif
+#ifdef HEXL_HAS_AVX512DQ
+      if (has_avx512dq) {
+        std::vector<uint32_t> result(N);
+        InverseTransformFromBitReverse32AVX512(result.data(), inv_input.data(),
+                                               N, q, inv_W, inv_W_precon,
+                                               output_mod_factor);
+        AssertEqual(result, expected);
+      }
+#endif
+    }
+  }
+}
+
+}  // namespace hexl
+}  // namespace intel
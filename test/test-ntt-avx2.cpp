@@ -0,0 +1,236 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <tuple>
+#include <vector>
+
+#include "hexl/ntt/ntt.hpp"
+#include "hexl/number-theory/number-theory.hpp"
+#include "ntt/fwd-ntt-avx2.hpp"
+#include "ntt/inv-ntt-avx2.hpp"
+#include "ntt/ntt-avx2-util.hpp"
+#include "ntt/ntt-internal.hpp"
+#include "test/test-ntt-util.hpp"
+#include "test/test-util.hpp"
+#include "util/cpu-features.hpp"
+
+namespace intel {
+namespace hexl {
+
+#ifdef HEXL_HAS_AVX256
+TEST(NTT, LoadInterleavedT1AVX2) {
+  if (!has_avx2) {
+    GTEST_SKIP();
+  }
+
+  AlignedVector64<uint64_t> arg{0, 1, 2, 3, 4, 5, 6, 7};
+  __m256i out1;
+  __m256i out2;
+
+  LoadInterleavedT1(arg.data(), &out1, &out2);
+
+  __m256i exp1 = _mm256_set_epi64x(6, 2, 4, 0);
+  __m256i exp2 = _mm256_set_epi64x(7, 3, 5, 1);
+  AssertEqual(ExtractValues(out1), ExtractValues(exp1));
+  AssertEqual(ExtractValues(out2), ExtractValues(exp2));
+
+  AlignedVector64<uint64_t> out(8, 0);
+  WriteInterleavedT1(out1, out2, reinterpret_cast<__m256i*>(&out[0]));
+  AssertEqual(arg, out);
+}
+
+TEST(NTT, LoadInterleavedT2AVX2) {
+  if (!has_avx2) {
+    GTEST_SKIP();
+  }
+
+  AlignedVector64<uint64_t> arg{0, 1, 2, 3, 4, 5, 6, 7};
+  __m256i out1;
+  __m256i out2;
+
+  LoadInterleavedT2(arg.data(), &out1, &out2);
+
+  __m256i exp1 = _mm256_set_epi64x(5, 4, 1, 0);
+  __m256i exp2 = _mm256_set_epi64x(7, 6, 3, 2);
+  AssertEqual(ExtractValues(out1), ExtractValues(exp1));
+  AssertEqual(ExtractValues(out2), ExtractValues(exp2));
+
+  AlignedVector64<uint64_t> out(8, 0);
+  WriteInterleavedT2(out1, out2, reinterpret_cast<__m256i*>(&out[0]));
+  AssertEqual(arg, out);
+}
+
+TEST(NTT, LoadWOpAVX2) {
+  if (!has_avx2) {
+    GTEST_SKIP();
+  }
+
+  AlignedVector64<uint64_t> arg{0, 1, 2, 3};
+
+  __m256i exp1 = _mm256_set_epi64x(3, 1, 2, 0);
+  AssertEqual(ExtractValues(LoadWOpT1(arg.data())), ExtractValues(exp1));
+
+  __m256i exp2 = _mm256_set_epi64x(1, 1, 0, 0);
+  AssertEqual(ExtractValues(LoadWOpT2(arg.data())), ExtractValues(exp2));
+}
+
+class NttAVX2Test : public DegreeModulusBoolTest {};
+
+// Checks 32-bit AVX2 and native forward NTT implementations match
+TEST_P(NttAVX2Test, FwdNTT_AVX2_32) {
+  if (!has_avx2 || (m_modulus >= NTT::s_max_fwd_modulus(32))) {
+    GTEST_SKIP();
+  }
+
+  for (size_t trial = 0; trial < m_num_trials; ++trial) {
+    AlignedVector64<uint64_t> input =
+        GenerateInsecureUniformIntRandomValues(m_N, 0, m_modulus);
+    AlignedVector64<uint64_t> input_avx = input;
+    AlignedVector64<uint64_t> input_avx_lazy = input;
+
+    ForwardTransformToBitReverseRadix2(
+        input.data(), input.data(), m_N, m_modulus,
+        m_ntt.GetRootOfUnityPowers().data(),
+        m_ntt.GetPrecon64RootOfUnityPowers().data(), 2, 1);
+
+    ForwardTransformToBitReverseAVX2<32>(
+        input_avx.data(), input_avx.data(), m_N, m_ntt.GetModulus(),
+        m_ntt.GetAVX512RootOfUnityPowers().data(),
+        m_ntt.GetAVX512Precon32RootOfUnityPowers().data(), 2, 1);
+
+    // Compute lazy
+    ForwardTransformToBitReverseAVX2<32>(
+        input_avx_lazy.data(), input_avx_lazy.data(), m_N, m_ntt.GetModulus(),
+        m_ntt.GetAVX512RootOfUnityPowers().data(),
+        m_ntt.GetAVX512Precon32RootOfUnityPowers().data(), 2, 4);
+    for (auto& elem : input_avx_lazy) {
+      elem = elem % m_modulus;
+    }
+
+    ASSERT_EQ(input, input_avx);
+    ASSERT_EQ(input, input_avx_lazy);
+  }
+}
+
+// Checks 64-bit AVX2 and native forward NTT implementations match
+TEST_P(NttAVX2Test, FwdNTT_AVX2_64) {
+  if (!has_avx2 || (m_modulus >= NTT::s_max_fwd_modulus(64))) {
+    GTEST_SKIP();
+  }
+
+  for (size_t trial = 0; trial < m_num_trials; ++trial) {
+    AlignedVector64<uint64_t> input =
+        GenerateInsecureUniformIntRandomValues(m_N, 0, m_modulus);
+    AlignedVector64<uint64_t> input_avx = input;
+    AlignedVector64<uint64_t> input_avx_lazy = input;
+
+    ForwardTransformToBitReverseRadix2(
+        input.data(), input.data(), m_N, m_modulus,
+        m_ntt.GetRootOfUnityPowers().data(),
+        m_ntt.GetPrecon64RootOfUnityPowers().data(), 2, 1);
+
+    ForwardTransformToBitReverseAVX2<64>(
+        input_avx.data(), input_avx.data(), m_N, m_ntt.GetModulus(),
+        m_ntt.GetAVX512RootOfUnityPowers().data(),
+        m_ntt.GetAVX512Precon64RootOfUnityPowers().data(), 2, 1);
+
+    // Compute lazy
+    ForwardTransformToBitReverseAVX2<64>(
+        input_avx_lazy.data(), input_avx_lazy.data(), m_N, m_ntt.GetModulus(),
+        m_ntt.GetAVX512RootOfUnityPowers().data(),
+        m_ntt.GetAVX512Precon64RootOfUnityPowers().data(), 2, 4);
+    for (auto& elem : input_avx_lazy) {
+      elem = elem % m_modulus;
+    }
+
+    ASSERT_EQ(input, input_avx);
+    ASSERT_EQ(input, input_avx_lazy);
+  }
+}
+
+// Checks 32-bit AVX2 and native InvNTT implementations match
+TEST_P(NttAVX2Test, InvNTT_AVX2_32) {
+  if (!has_avx2 || (m_modulus >= NTT::s_max_inv_modulus(32))) {
+    GTEST_SKIP();
+  }
+
+  for (size_t trial = 0; trial < m_num_trials; ++trial) {
+    AlignedVector64<uint64_t> input =
+        GenerateInsecureUniformIntRandomValues(m_N, 0, m_modulus);
+    AlignedVector64<uint64_t> input_avx = input;
+    AlignedVector64<uint64_t> input_avx_lazy = input;
+
+    InverseTransformFromBitReverseRadix2(
+        input.data(), input.data(), m_N, m_modulus,
+        m_ntt.GetInvRootOfUnityPowers().data(),
+        m_ntt.GetPrecon64InvRootOfUnityPowers().data(), 1, 1);
+
+    InverseTransformFromBitReverseAVX2<32>(
+        input_avx.data(), input_avx.data(), m_N, m_ntt.GetModulus(),
+        m_ntt.GetInvRootOfUnityPowers().data(),
+        m_ntt.GetPrecon32InvRootOfUnityPowers().data(), 1, 1);
+
+    // Compute lazy
+    InverseTransformFromBitReverseAVX2<32>(
+        input_avx_lazy.data(), input_avx_lazy.data(), m_N, m_ntt.GetModulus(),
+        m_ntt.GetInvRootOfUnityPowers().data(),
+        m_ntt.GetPrecon32InvRootOfUnityPowers().data(), 1, 2);
+    for (auto& elem : input_avx_lazy) {
+      elem = elem % m_modulus;
+    }
+
+    ASSERT_EQ(input, input_avx);
+    ASSERT_EQ(input, input_avx_lazy);
+  }
+}
+
+// Checks 64-bit AVX2 and native InvNTT implementations match
+TEST_P(NttAVX2Test, InvNTT_AVX2_64) {
+  if (!has_avx2 || (m_modulus >= NTT::s_max_inv_modulus(64))) {
+    GTEST_SKIP();
+  }
+
+  for (size_t trial = 0; trial < m_num_trials; ++trial) {
+    AlignedVector64<uint64_t> input =
+        GenerateInsecureUniformIntRandomValues(m_N, 0, 2 * m_modulus);
+    AlignedVector64<uint64_t> input_avx = input;
+    AlignedVector64<uint64_t> input_avx_lazy = input;
+
+    InverseTransformFromBitReverseRadix2(
+        input.data(), input.data(), m_N, m_modulus,
+        m_ntt.GetInvRootOfUnityPowers().data(),
+        m_ntt.GetPrecon64InvRootOfUnityPowers().data(), 2, 1);
+
+    InverseTransformFromBitReverseAVX2<64>(
+        input_avx.data(), input_avx.data(), m_N, m_ntt.GetModulus(),
+        m_ntt.GetInvRootOfUnityPowers().data(),
+        m_ntt.GetPrecon64InvRootOfUnityPowers().data(), 2, 1);
+
+    // Compute lazy
+    InverseTransformFromBitReverseAVX2<64>(
+        input_avx_lazy.data(), input_avx_lazy.data(), m_N, m_ntt.GetModulus(),
+        m_ntt.GetInvRootOfUnityPowers().data(),
+        m_ntt.GetPrecon64InvRootOfUnityPowers().data(), 2, 2);
+    for (auto& elem : input_avx_lazy) {
+      elem = elem % m_modulus;
+    }
+
+    ASSERT_EQ(input, input_avx);
+    ASSERT_EQ(input, input_avx_lazy);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    NTT, NttAVX2Test,
+    ::testing::Combine(::testing::ValuesIn(AlignedVector64<uint64_t>{
+                           1 << 4, 1 << 5, 1 << 10, 1 << 11, 1 << 13}),
+                       ::testing::ValuesIn(AlignedVector64<uint64_t>{
+                           27, 28, 29, 30, 31, 32, 33, 48, 49, 50, 51, 58, 59,
+                           60, 62}),
+                       ::testing::ValuesIn(std::vector<bool>{false, true})));
+#endif  // HEXL_HAS_AVX256
+
+}  // namespace hexl
+}  // namespace intel
@@ -0,0 +1,203 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "hexl/ntt/ntt.hpp"
+#include "hexl/number-theory/number-theory.hpp"
+#include "ntt/ntt-batch-internal.hpp"
+#include "test/test-util.hpp"
+#include "util/cpu-features.hpp"
+#include "util/util-internal.hpp"
+
+namespace intel {
+namespace hexl {
+
+namespace {
+
+// Returns polynomial p of the coefficient-major batch data
+AlignedVector64<uint64_t> ExtractPoly(const AlignedVector64<uint64_t>& data,
+                                      uint64_t N, size_t num_polys, size_t p) {
+  AlignedVector64<uint64_t> poly(N);
+  for (size_t i = 0; i < N; ++i) {
+    poly[i] = data[i * num_polys + p];
+  }
+  return poly;
+}
+
+AlignedVector64<uint64_t> Reduce(AlignedVector64<uint64_t> values,
+                                 uint64_t q) {
+  for (auto& value : values) {
+    value %= q;
+  }
+  return values;
+}
+
+}  // namespace
+
+// Checks each polynomial of the batch transforms equals its transform by
+// ComputeForward and ComputeInverse
+TEST(NTTBatch, matches_ntt) {
+  for (uint64_t N : {1, 2, 4, 8, 16, 64}) {
+    for (size_t modulus_bits : {29, 49, 59, 62}) {
+      uint64_t q = GeneratePrimes(1, modulus_bits, true, N)[0];
+      for (bool cyclic : {false, true}) {
+        if (cyclic && N == 1) {
+          continue;
+        }
+        NTT ntt = cyclic ? NTT::CreateCyclic(N, q) : NTT(N, q);
+        for (size_t num_polys : {1, 3, 4, 8, 13}) {
+          SCOPED_TRACE("N = " + std::to_string(N) +
+                       ", bits = " + std::to_string(modulus_bits) +
+                       ", cyclic = " + std::to_string(cyclic) +
+                       ", num_polys = " + std::to_string(num_polys));
+
+          for (uint64_t input_mod_factor : {1, 2, 4}) {
+            auto input = GenerateInsecureUniformIntRandomValues(
+                N * num_polys, 0, ModFactorBound(q, input_mod_factor));
+            for (uint64_t output_mod_factor : {1, 4}) {
+              AlignedVector64<uint64_t> result(N * num_polys);
+              ntt.ComputeForwardBatch(result.data(), input.data(), num_polys,
+                                      input_mod_factor, output_mod_factor);
+              for (uint64_t x : result) {
+                ASSERT_LT(x, ModFactorBound(q, output_mod_factor));
+              }
+              for (size_t p = 0; p < num_polys; ++p) {
+                auto expected = Reduce(ExtractPoly(input, N, num_polys, p), q);
+                ntt.ComputeForward(expected.data(), expected.data(), 1, 1);
+                AssertEqual(Reduce(ExtractPoly(result, N, num_polys, p), q),
+                            expected);
+              }
+            }
+          }
+
+          for (uint64_t input_mod_factor : {1, 2}) {
+            auto input = GenerateInsecureUniformIntRandomValues(
+                N * num_polys, 0, ModFactorBound(q, input_mod_factor));
+            for (uint64_t output_mod_factor : {1, 2}) {
+              AlignedVector64<uint64_t> result(N * num_polys);
+              ntt.ComputeInverseBatch(result.data(), input.data(), num_polys,
+                                      input_mod_factor, output_mod_factor);
+              for (uint64_t x : result) {
+                ASSERT_LT(x, ModFactorBound(q, output_mod_factor));
+              }
+              for (size_t p = 0; p < num_polys; ++p) {
+                auto expected = Reduce(ExtractPoly(input, N, num_polys, p), q);
+                ntt.ComputeInverse(expected.data(), expected.data(), 1, 1);
+                AssertEqual(Reduce(ExtractPoly(result, N, num_polys, p), q),
+                            expected);
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(NTTBatch, in_place_round_trip) {
+  for (uint64_t N : {1, 4, 32, 1024}) {
+    uint64_t q = GeneratePrimes(1, 49, true, N)[0];
+    NTT ntt(N, q);
+    for (size_t num_polys : {5, 16}) {
+      auto input = GenerateInsecureUniformIntRandomValues(N * num_polys, 0, q);
+      auto data = input;
+      ntt.ComputeForwardBatch(data.data(), data.data(), num_polys, 1, 1);
+      ntt.ComputeInverseBatch(data.data(), data.data(), num_polys, 1, 1);
+      AssertEqual(data, input);
+    }
+  }
+}
+
+// Checks the vectorized kernels match the native kernels modulo q, for all the
+// lane counts, with outputs within the lazy bounds
+TEST(NTTBatch, kernels) {
+  for (uint64_t N : {1, 2, 8, 32}) {
+    for (size_t modulus_bits : {29, 59}) {
+      uint64_t q = GeneratePrimes(1, modulus_bits, true, N)[0];
+      NTT ntt(N, q);
+      const uint64_t* W = ntt.GetRootOfUnityPowers().data();
+      const uint64_t* W_precon = ntt.GetPrecon64RootOfUnityPowers().data();
+      const uint64_t* inv_W = ntt.GetInvRootOfUnityPowers().data();
+      const uint64_t* inv_W_precon =
+          ntt.GetPrecon64InvRootOfUnityPowers().data();
+
+      for (size_t num_polys : {1, 4, 7, 8, 19}) {
+        auto fwd_input =
+            GenerateInsecureUniformIntRandomValues(N * num_polys, 0, 4 * q);
+        auto inv_input =
+            GenerateInsecureUniformIntRandomValues(N * num_polys, 0, 2 * q);
+
+        for (uint64_t output_mod_factor : {1, 4}) {
+          AlignedVector64<uint64_t> expected(N * num_polys);
+          ForwardTransformToBitReverseBatch(expected.data(), fwd_input.data(),
+                                            N, num_polys, q, W, W_precon,
+                                            output_mod_factor);
+          std::vector<AlignedVector64<uint64_t>> results;
+#ifdef HEXL_HAS_AVX256
+          if (has_avx2) {
+            AlignedVector64<uint64_t> result(N * num_polys);
+            ForwardTransformToBitReverseBatchAVX2(
+                result.data(), fwd_input.data(), N, num_polys, q, W, W_precon,
+                output_mod_factor);
+            results.push_back(result);
+          }
+#endif
+#ifdef HEXL_HAS_AVX512DQ
+          if (has_avx512dq) {
+            AlignedVector64<uint64_t> result(N * num_polys);
+            ForwardTransformToBitReverseBatchAVX512(
+                result.data(), fwd_input.data(), N, num_polys, q, W, W_precon,
+                output_mod_factor);
+            results.push_back(result);
+          }
+#endif
+          for (const auto& result : results) {
+            for (uint64_t x : result) {
+              ASSERT_LT(x, output_mod_factor * q);
+            }
+            AssertEqual(Reduce(result, q), Reduce(expected, q));
+          }
+        }
+
+        for (uint64_t output_mod_factor : {1, 2}) {
+          AlignedVector64<uint64_t> expected(N * num_polys);
+          InverseTransformFromBitReverseBatch(
+              expected.data(), inv_input.data(), N, num_polys, q, inv_W,
+              inv_W_precon, output_mod_factor);
+          std::vector<AlignedVector64<uint64_t>> results;
+#ifdef HEXL_HAS_AVX256
+          if (has_avx2) {
+            AlignedVector64<uint64_t> result(N * num_polys);
+            InverseTransformFromBitReverseBatchAVX2(
+                result.data(), inv_input.data(), N, num_polys, q, inv_W,
+                inv_W_precon, output_mod_factor);
+            results.push_back(result);
+          }
+#endif
+#ifdef HEXL_HAS_AVX512DQ
+          if (has_avx512dq) {
+            AlignedVector64<uint64_t> result(N * num_polys);
+            InverseTransformFromBitReverseBatchAVX512(
+                result.data(), inv_input.data(), N, num_polys, q, inv_W,
+                inv_W_precon, output_mod_factor);
+            results.push_back(result);
+          }
+#endif
+          for (const auto& result : results) {
+            for (uint64_t x : result) {
+              ASSERT_LT(x, output_mod_factor * q);
+            }
+            AssertEqual(Reduce(result, q), Reduce(expected, q));
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace hexl
+}  // namespace intel
@@ -0,0 +1,137 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "hexl/ntt/ntt.hpp"
+#include "hexl/number-theory/number-theory.hpp"
+#include "ntt/ntt-four-step.hpp"
+#include "ntt/ntt-internal.hpp"
+#include "test/test-ntt-util.hpp"
+#include "test/test-util.hpp"
+
+namespace intel {
+namespace hexl {
+
+class FourStepNttTest : public DegreeModulusBoolTest {};
+
+TEST_P(FourStepNttTest, Forward) {
+  FourStepNTT four_step(m_N, m_modulus, m_ntt.GetMinimalRootOfUnity());
+  EXPECT_EQ(four_step.GetRowSize() * four_step.GetColumnSize(), m_N);
+
+  for (size_t trial = 0; trial < m_num_trials; ++trial) {
+    auto input = GenerateInsecureUniformIntRandomValues(m_N, 0, m_modulus);
+    auto exp_output = input;
+    ReferenceForwardTransformToBitReverse(
+        exp_output.data(), m_N, m_modulus, m_ntt.GetRootOfUnityPowers().data());
+
+    std::vector<uint64_t> output(m_N, 0);
+    four_step.ComputeForward(output.data(), input.data(), 1, 1);
+    AssertEqual(output, exp_output);
+
+    // In-place, lazy
+    four_step.ComputeForward(input.data(), input.data(), 1, 4);
+    for (size_t i = 0; i < m_N; ++i) {
+      ASSERT_LT(input[i], 4 * m_modulus);
+      input[i] %= m_modulus;
+    }
+    AssertEqual(input, exp_output);
+  }
+}
+
+TEST_P(FourStepNttTest, Inverse) {
+  FourStepNTT four_step(m_N, m_modulus, m_ntt.GetMinimalRootOfUnity());
+
+  for (size_t trial = 0; trial < m_num_trials; ++trial) {
+    auto input = GenerateInsecureUniformIntRandomValues(m_N, 0, m_modulus);
+    auto exp_output = input;
+    InverseTransformFromBitReverseRadix2(
+        exp_output.data(), exp_output.data(), m_N, m_modulus,
+        m_ntt.GetInvRootOfUnityPowers().data(),
+        m_ntt.GetPrecon64InvRootOfUnityPowers().data(), 1, 1);
+
+    std::vector<uint64_t> output(m_N, 0);
+    four_step.ComputeInverse(output.data(), input.data(), 1, 1);
+    AssertEqual(output, exp_output);
+
+    // In-place, lazy
+    four_step.ComputeInverse(input.data(), input.data(), 1, 2);
+    for (size_t i = 0; i < m_N; ++i) {
+      ASSERT_LT(input[i], 2 * m_modulus);
+      input[i] %= m_modulus;
+    }
+    AssertEqual(input, exp_output);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    NTT, FourStepNttTest,
+    ::testing::Combine(
+        ::testing::ValuesIn(std::vector<uint64_t>{
+            1 << 2, 1 << 3, 1 << 4, 1 << 5, 1 << 6, 1 << 9, 1 << 10, 1 << 13}),
+        ::testing::ValuesIn(std::vector<uint64_t>{30, 50, 60}),
+        ::testing::ValuesIn(std::vector<bool>{false, true})));
+
+// The row and column NTTs and the twiddle products support moduli of up to 64
+// bits
+TEST(NTT, FourStepLargeModulus) {
+  for (uint64_t N : {1 << 4, 1 << 10}) {
+    uint64_t modulus = GeneratePrimes(1, 63, false, N)[0];
+    NTT ntt(N, modulus);
+    FourStepNTT four_step(N, modulus, ntt.GetMinimalRootOfUnity());
+
+    auto input = GenerateInsecureUniformIntRandomValues(N, 0, modulus);
+    auto exp_output = input;
+    ReferenceForwardTransformToBitReverse(exp_output.data(), N, modulus,
+                                          ntt.GetRootOfUnityPowers().data());
+    std::vector<uint64_t> output(N, 0);
+    four_step.ComputeForward(output.data(), input.data(), 1, 1);
+    AssertEqual(output, exp_output);
+    four_step.ComputeInverse(output.data(), output.data(), 1, 1);
+    AssertEqual(output, input);
+  }
+}
+
+// Checks a degree above 2^MaxDirectDegreeBits(), which uses the four-step
+// decomposition
+TEST(NTT, FourStepLargeDegree) {
+  uint64_t N = 1ULL << (NTT::MaxDirectDegreeBits() + 1);
+  uint64_t modulus = GeneratePrimes(1, 50, true, N)[0];
+  NTT ntt(N, modulus);
+  EXPECT_TRUE(ntt.IsFourStep());
+  EXPECT_GT(ntt.GetTableMemoryBytes(), 2 * N * sizeof(uint64_t));
+
+  // The forward transform of X evaluates X at the roots of unity
+  // w^(2 * bit_reverse(j) + 1)
+  std::vector<uint64_t> input(N, 0);
+  input[1] = 1;
+  std::vector<uint64_t> output(N, 0);
+  ntt.ComputeForward(output.data(), input.data(), 1, 1);
+
+  uint64_t w = ntt.GetMinimalRootOfUnity();
+  uint64_t degree_bits = Log2(N);
+  for (size_t j = 0; j < N; j += N / 256 + 1) {
+    uint64_t exponent = 2 * ReverseBits(j, degree_bits) + 1;
+    ASSERT_EQ(output[j], PowMod(w, exponent, modulus)) << "j = " << j;
+  }
+
+  ntt.ComputeInverse(output.data(), output.data(), 1, 1);
+  AssertEqual(output, input);
+
+  auto random_input = GenerateInsecureUniformIntRandomValues(N, 0, modulus);
+  ntt.ComputeForward(output.data(), random_input.data(), 1, 1);
+  ntt.ComputeInverse(output.data(), output.data(), 1, 1);
+  AssertEqual(output, random_input);
+
+  // Multiplying by X shifts the coefficients, negating the wrapped one
+  ntt.Multiply(output.data(), random_input.data(), input.data(), 1, 1);
+  EXPECT_EQ(output[0], (modulus - random_input[N - 1]) % modulus);
+  for (size_t i = 1; i < N; ++i) {
+    ASSERT_EQ(output[i], random_input[i - 1]) << "i = " << i;
+  }
+}
+
+}  // namespace hexl
+}  // namespace intel
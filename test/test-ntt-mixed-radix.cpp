@@ -0,0 +1,137 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <vector>
+
+#include "hexl/ntt/ntt-mixed-radix.hpp"
+#include "hexl/number-theory/number-theory.hpp"
+#include "test/test-util.hpp"
+#include "util/util-internal.hpp"
+
+namespace intel {
+namespace hexl {
+
+namespace {
+
+// Returns a prime q < 2^modulus_bits satisfying MixedRadixNTT::CheckArguments
+uint64_t GenerateMixedRadixPrime(uint64_t n, size_t modulus_bits) {
+  uint64_t factor = n;
+  if (MixedRadixNTT::UsesBluestein(n)) {
+    uint64_t length = 1;
+    while (length < 2 * n - 1) {
+      length <<= 1;
+    }
+    factor = std::lcm(std::lcm(n, length), (n % 2 == 0) ? 2 * n : n);
+  }
+  uint64_t k = ((1ULL << modulus_bits) - 1) / factor;
+  while (!IsPrime(k * factor + 1)) {
+    --k;
+  }
+  return k * factor + 1;
+}
+
+// Returns sum_j operand[j] * w^(j k) for k < n
+std::vector<uint64_t> ReferenceTransform(const uint64_t* operand, uint64_t n,
+                                         uint64_t w, uint64_t modulus) {
+  std::vector<uint64_t> result(n, 0);
+  uint64_t w_k = 1;
+  for (size_t k = 0; k < n; ++k) {
+    for (size_t j = n; j-- > 0;) {
+      result[k] = AddUIntMod(MultiplyMod(result[k], w_k, modulus), operand[j],
+                             modulus);
+    }
+    w_k = MultiplyMod(w_k, w, modulus);
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST(MixedRadixNTT, check_arguments) {
+  EXPECT_FALSE(MixedRadixNTT::CheckArguments(0, 769));
+  // 769 = 1 + 3 * 2^8
+  EXPECT_TRUE(MixedRadixNTT::CheckArguments(48, 769));
+  EXPECT_TRUE(MixedRadixNTT::CheckArguments(768, 769));
+  EXPECT_FALSE(MixedRadixNTT::CheckArguments(5, 769));
+  EXPECT_FALSE(MixedRadixNTT::CheckArguments(48, 771));
+  // 7681 = 1 + 15 * 2^9
+  EXPECT_TRUE(MixedRadixNTT::CheckArguments(15, 7681));
+  EXPECT_FALSE(MixedRadixNTT::UsesBluestein(15));
+  EXPECT_TRUE(MixedRadixNTT::UsesBluestein(7));
+  EXPECT_TRUE(MixedRadixNTT::UsesBluestein(14));
+  // 29 = 1 + 7 * 4 is not 1 mod 16
+  EXPECT_FALSE(MixedRadixNTT::CheckArguments(7, 29));
+  EXPECT_TRUE(
+      MixedRadixNTT::CheckArguments(7, GenerateMixedRadixPrime(7, 30)));
+  EXPECT_FALSE(
+      MixedRadixNTT::CheckArguments(48, GenerateMixedRadixPrime(48, 62)));
+}
+
+TEST(MixedRadixNTT, forward_inverse) {
+  for (uint64_t n : {1, 2, 3, 5, 6, 9, 12, 15, 25, 40, 45, 48, 75, 96, 135,
+                     320, 7, 11, 14, 21, 22, 77}) {
+    for (size_t modulus_bits : {30, 50, 60}) {
+      SCOPED_TRACE("n = " + std::to_string(n) +
+                   ", bits = " + std::to_string(modulus_bits));
+      uint64_t modulus = GenerateMixedRadixPrime(n, modulus_bits);
+      ASSERT_TRUE(MixedRadixNTT::CheckArguments(n, modulus));
+      MixedRadixNTT ntt(n, modulus);
+      EXPECT_EQ(ntt.GetDegree(), n);
+      EXPECT_EQ(ntt.GetModulus(), modulus);
+
+      uint64_t w = ntt.GetRootOfUnity();
+      EXPECT_EQ(PowMod(w, n, modulus), 1);
+      for (uint64_t p : {2, 3, 5, 7, 11}) {
+        if (n % p == 0) {
+          EXPECT_NE(PowMod(w, n / p, modulus), 1);
+        }
+      }
+
+      auto input = GenerateInsecureUniformIntRandomValues(n, 0, modulus);
+      std::vector<uint64_t> output(n, 0);
+      ntt.ComputeForward(output.data(), input.data());
+      AssertEqual(output, ReferenceTransform(input.data(), n, w, modulus));
+
+      std::vector<uint64_t> inverse(n, 0);
+      ntt.ComputeInverse(inverse.data(), output.data());
+      AssertEqual(inverse, input);
+
+      // In-place
+      auto data = input;
+      ntt.ComputeForward(data.data(), data.data());
+      AssertEqual(data, output);
+      ntt.ComputeInverse(data.data(), data.data());
+      AssertEqual(data, input);
+    }
+  }
+}
+
+TEST(MixedRadixNTT, large) {
+  for (uint64_t n : {15 * 1024, 3 * 3 * 3 * 5 * 256, 7 * 128, 1000, 3 * 4096}) {
+    uint64_t modulus = GenerateMixedRadixPrime(n, 50);
+    MixedRadixNTT ntt(n, modulus);
+    uint64_t w = ntt.GetRootOfUnity();
+
+    auto input = GenerateInsecureUniformIntRandomValues(n, 0, modulus);
+    std::vector<uint64_t> output(n, 0);
+    ntt.ComputeForward(output.data(), input.data());
+    for (uint64_t k : {uint64_t(0), uint64_t(1), n / 3, n / 2, n - 1}) {
+      uint64_t x = PowMod(w, k, modulus);
+      uint64_t expected = 0;
+      for (size_t j = n; j-- > 0;) {
+        expected = AddUIntMod(MultiplyMod(expected, x, modulus), input[j],
+                              modulus);
+      }
+      ASSERT_EQ(output[k], expected) << "n = " << n << ", k = " << k;
+    }
+
+    ntt.ComputeInverse(output.data(), output.data());
+    AssertEqual(output, input);
+  }
+}
+
+}  // namespace hexl
+}  // namespace intel
@@ -0,0 +1,247 @@
+// Copyright (C) 2020 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "hexl/ntt/ntt-registry.hpp"
+#include "hexl/ntt/ntt.hpp"
+#include "hexl/number-theory/number-theory.hpp"
+#include "test/test-util.hpp"
+#include "util/util-internal.hpp"
+
+namespace intel {
+namespace hexl {
+
+TEST(NTTRegistry, get) {
+  uint64_t N = 1024;
+  auto moduli = GeneratePrimes(2, 50, true, N);
+  NTTRegistry registry;
+
+  std::shared_ptr<NTT> ntt = registry.Get(N, moduli[0]);
+  EXPECT_EQ(ntt->GetDegree(), N);
+  EXPECT_EQ(ntt->GetModulus(), moduli[0]);
+  EXPECT_EQ(registry.Get(N, moduli[0]), ntt);
+  EXPECT_NE(registry.Get(N, moduli[1]), ntt);
+
+  // An explicit root of unity is a separate parameter set
+  uint64_t root = ntt->GetMinimalRootOfUnity();
+  std::shared_ptr<NTT> root_ntt = registry.Get(N, moduli[0], root);
+  EXPECT_NE(root_ntt, ntt);
+  EXPECT_EQ(root_ntt->GetMinimalRootOfUnity(), root);
+
+  NTTRegistry::Stats stats = registry.GetStats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 3);
+  EXPECT_EQ(stats.evictions, 0);
+  EXPECT_EQ(stats.num_entries, 3);
+  EXPECT_EQ(stats.num_bytes, 3 * ntt->GetTableMemoryBytes());
+
+  registry.ResetStats();
+  stats = registry.GetStats();
+  EXPECT_EQ(stats.hits, 0);
+  EXPECT_EQ(stats.misses, 0);
+  EXPECT_EQ(stats.num_entries, 3);
+}
+
+TEST(NTTRegistry, byte_budget) {
+  uint64_t N = 1024;
+  auto moduli = GeneratePrimes(4, 50, true, N);
+  size_t ntt_bytes = NTT(N, moduli[0]).GetTableMemoryBytes();
+
+  // Room for two NTTs
+  NTTRegistry registry(2 * ntt_bytes + ntt_bytes / 2);
+  std::shared_ptr<NTT> ntt0 = registry.Get(N, moduli[0]);
+  registry.Get(N, moduli[1]);
+  registry.Get(N, moduli[0]);
+  registry.Get(N, moduli[2]);
+
+  // moduli[1] was least recently used
+  NTTRegistry::Stats stats = registry.GetStats();
+  EXPECT_EQ(stats.evictions, 1);
+  EXPECT_EQ(stats.num_entries, 2);
+  EXPECT_LE(stats.num_bytes, registry.GetByteBudget());
+  EXPECT_EQ(registry.Get(N, moduli[0]), ntt0);
+  EXPECT_EQ(registry.GetStats().hits, 2);
+  EXPECT_FALSE(registry.Purge(N, moduli[1]));
+
+  // Evicted NTTs remain valid for their users
+  registry.SetByteBudget(1);
+  stats = registry.GetStats();
+  EXPECT_EQ(stats.num_entries, 1);
+  EXPECT_EQ(stats.evictions, 2);
+  std::shared_ptr<NTT> ntt3 = registry.Get(N, moduli[3]);
+  EXPECT_EQ(registry.GetStats().num_entries, 1);
+  auto input = GenerateInsecureUniformIntRandomValues(N, 0, moduli[0]);
+  auto output = input;
+  ntt0->ComputeForward(output.data(), input.data(), 1, 1);
+  ntt0->ComputeInverse(output.data(), output.data(), 1, 1);
+  AssertEqual(output, input);
+
+  // Unlimited budget
+  registry.SetByteBudget(0);
+  registry.Get(N, moduli[0]);
+  registry.Get(N, moduli[1]);
+  EXPECT_EQ(registry.GetStats().num_entries, 3);
+}
+
+TEST(NTTRegistry, prewarm_purge) {
+  uint64_t N = 512;
+  auto moduli = GeneratePrimes(3, 40, true, N);
+  NTTRegistry registry;
+
+  registry.Prewarm(N, moduli);
+  NTTRegistry::Stats stats = registry.GetStats();
+  EXPECT_EQ(stats.hits, 0);
+  EXPECT_EQ(stats.misses, 0);
+  EXPECT_EQ(stats.num_entries, 3);
+  size_t dispatched_bytes = stats.num_bytes;
+
+  registry.Prewarm(N, moduli, true);
+  stats = registry.GetStats();
+  EXPECT_EQ(stats.num_entries, 3);
+  EXPECT_GT(stats.num_bytes, dispatched_bytes);
+
+  registry.Get(N, moduli[2]);
+  EXPECT_EQ(registry.GetStats().hits, 1);
+
+  EXPECT_TRUE(registry.Purge(N, moduli[1]));
+  EXPECT_FALSE(registry.Purge(N, moduli[1]));
+  EXPECT_EQ(registry.GetStats().num_entries, 2);
+
+  registry.Purge();
+  stats = registry.GetStats();
+  EXPECT_EQ(stats.num_entries, 0);
+  EXPECT_EQ(stats.num_bytes, 0);
+  registry.Get(N, moduli[0]);
+  EXPECT_EQ(registry.GetStats().misses, 1);
+}
+
+TEST(NTTRegistry, get_cached) {
+  uint64_t N = 1024;
+  auto moduli = GeneratePrimes(3, 50, true, N);
+  size_t ntt_bytes = NTT(N, moduli[0]).GetTableMemoryBytes();
+  NTTRegistry registry(2 * ntt_bytes);
+
+  std::shared_ptr<NTT> ntt0 = registry.GetCached(N, moduli[0]);
+  EXPECT_EQ(ntt0.get(), registry.Get(N, moduli[0]).get());
+  for (size_t i = 0; i < 10; ++i) {
+    EXPECT_EQ(registry.GetCached(N, moduli[0]).get(), ntt0.get());
+  }
+  // Cached lookups are not counted
+  NTTRegistry::Stats stats = registry.GetStats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 1);
+
+  // moduli[0] is least recently used via Get, but referenced via GetCached,
+  // so moduli[1] is evicted first
+  registry.Get(N, moduli[1]);
+  EXPECT_EQ(registry.GetCached(N, moduli[0]).get(), ntt0.get());
+  registry.Get(N, moduli[2]);
+  EXPECT_FALSE(registry.Purge(N, moduli[1]));
+  EXPECT_EQ(registry.Get(N, moduli[0]).get(), ntt0.get());
+
+  // Removing entries invalidates the per-thread caches
+  registry.Purge();
+  std::shared_ptr<NTT> new_ntt0 = registry.GetCached(N, moduli[0]);
+  EXPECT_NE(new_ntt0.get(), ntt0.get());
+  EXPECT_EQ(registry.Get(N, moduli[0]).get(), new_ntt0.get());
+
+  // Separate registries have separate cache entries
+  NTTRegistry other_registry;
+  EXPECT_NE(other_registry.GetCached(N, moduli[0]).get(), new_ntt0.get());
+
+  // More NTTs than fit in the per-thread cache
+  auto many_moduli =
+      GeneratePrimes(NTTRegistry::s_thread_cache_size + 4, 50, true, N);
+  for (size_t round = 0; round < 2; ++round) {
+    for (uint64_t modulus : many_moduli) {
+      EXPECT_EQ(other_registry.GetCached(N, modulus)->GetModulus(), modulus);
+    }
+  }
+}
+
+TEST(NTTRegistry, threads) {
+  uint64_t N = 256;
+  auto moduli = GeneratePrimes(4, 45, true, N);
+  size_t ntt_bytes = NTT(N, moduli[0]).GetTableMemoryBytes();
+  NTTRegistry registry(3 * ntt_bytes);
+
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t]() {
+      auto input = GenerateInsecureUniformIntRandomValues(
+          N, 0, *std::min_element(moduli.begin(), moduli.end()));
+      auto output = input;
+      for (size_t i = 0; i < 50; ++i) {
+        uint64_t modulus = moduli[(t + i) % moduli.size()];
+        std::shared_ptr<NTT> ntt = registry.Get(N, modulus);
+        ASSERT_EQ(ntt->GetModulus(), modulus);
+        ntt->ComputeForward(output.data(), input.data(), 1, 1);
+        ntt->ComputeInverse(output.data(), output.data(), 1, 1);
+        ASSERT_EQ(output, input);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  NTTRegistry::Stats stats = registry.GetStats();
+  EXPECT_EQ(stats.hits + stats.misses, 200);
+  EXPECT_LE(stats.num_entries, 3);
+  EXPECT_LE(stats.num_bytes, 3 * ntt_bytes);
+}
+
+TEST(NTTRegistry, threads_cached) {
+  uint64_t N = 256;
+  auto moduli = GeneratePrimes(4, 45, true, N);
+  // No byte budget, so no entry is removed and the per-thread caches stay
+  // valid
+  NTTRegistry registry;
+  for (uint64_t modulus : moduli) {
+    registry.Get(N, modulus);
+  }
+
+  const size_t num_threads = 4;
+  const size_t num_iters = 50;
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      auto input = GenerateInsecureUniformIntRandomValues(
+          N, 0, *std::min_element(moduli.begin(), moduli.end()));
+      auto output = input;
+      for (size_t i = 0; i < num_iters; ++i) {
+        uint64_t modulus = moduli[(t + i) % moduli.size()];
+        std::shared_ptr<NTT> ntt = (i % 2 == 0)
+                                       ? registry.Get(N, modulus)
+                                       : registry.GetCached(N, modulus);
+        ASSERT_EQ(ntt->GetModulus(), modulus);
+        ntt->ComputeForward(output.data(), input.data(), 1, 1);
+        ntt->ComputeInverse(output.data(), output.data(), 1, 1);
+        ASSERT_EQ(output, input);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // Each Get is a hit. GetCached is called with 2 distinct moduli per thread,
+  // so each thread misses its cache and hits the registry twice; the
+  // remaining GetCached calls are served by the per-thread caches and not
+  // counted.
+  const size_t num_get = num_threads * num_iters / 2;
+  const size_t num_cached_lookups = num_threads * 2;
+  NTTRegistry::Stats stats = registry.GetStats();
+  EXPECT_EQ(stats.misses, moduli.size());
+  EXPECT_EQ(stats.hits, num_get + num_cached_lookups);
+  EXPECT_EQ(stats.num_entries, moduli.size());
+}
+
+}  // namespace hexl
+}  // namespace intel
@@ -3,17 +3,35 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 #include "hexl/logging/logging.hpp"
 #include "hexl/ntt/ntt.hpp"
 #include "hexl/number-theory/number-theory.hpp"
 #include "hexl/util/defines.hpp"
+#include "hexl/util/util.hpp"
+#include "ntt/ntt-compact-avx2.hpp"
+#include "ntt/ntt-compact-avx512.hpp"
 #include "ntt/ntt-internal.hpp"
+#include "ntt/ntt-montgomery-avx512.hpp"
+#include "ntt/ntt-montgomery.hpp"
 #include "test/test-ntt-util.hpp"
 #include "test/test-util.hpp"
 #include "util/cpu-features.hpp"
+#include "util/util-internal.hpp"
 
 namespace intel {
 namespace hexl {
@@ -227,6 +245,1419 @@ TEST(NTT, root_of_unity2) {
   EXPECT_EQ(ntt.GetInvRootOfUnityPower(0), ntt.GetInvRootOfUnityPowers()[0]);
 }
 
+TEST(NTT, barrett_factors) {
+  for (size_t modulus_bits : {20, 30, 50, 60, 62}) {
+    uint64_t modulus = GeneratePrimes(1, modulus_bits, true, 1024)[0];
+    // Not a multiple of the SIMD width, including the extreme values
+    auto values = GenerateInsecureUniformIntRandomValues(1021, 0, modulus);
+    values[0] = 0;
+    values[1] = 1;
+    values[2] = modulus - 1;
+    for (uint64_t bit_shift : {32, 52, 64}) {
+      std::vector<uint64_t> exp_factors;
+      for (uint64_t value : values) {
+        exp_factors.push_back(
+            MultiplyFactor(value, bit_shift, modulus).BarrettFactor());
+      }
+      std::vector<uint64_t> factors(values.size(), 0);
+      ComputeBarrettFactors(factors.data(), values.data(), values.size(),
+                            bit_shift, modulus);
+      AssertEqual(factors, exp_factors);
+    }
+  }
+}
+
+TEST(NTT, lazy_tables) {
+  // The table sizes below are those of Full mode
+  NTT::TwiddleMode default_mode = NTT::GetDefaultTwiddleMode();
+  NTT::SetDefaultTwiddleMode(NTT::TwiddleMode::Full);
+
+  uint64_t N = 1024;
+  uint64_t modulus = GeneratePrimes(1, 49, true, N)[0];
+  NTT ntt(N, modulus);
+  NTT expected_ntt(N, modulus);
+  EXPECT_EQ(NTT().GetTableMemoryBytes(), 0);
+
+  // Only the tables of one backend are built at construction
+  size_t initial_bytes = ntt.GetTableMemoryBytes();
+  EXPECT_GE(initial_bytes, 4 * N * sizeof(uint64_t));
+  EXPECT_LT(initial_bytes, 7 * N * sizeof(uint64_t));
+
+  auto get_tables = [](const NTT& table_ntt) {
+    return std::vector<const AlignedVector64<uint64_t>*>{
+        &table_ntt.GetRootOfUnityPowers(),
+        &table_ntt.GetPrecon32RootOfUnityPowers(),
+        &table_ntt.GetPrecon64RootOfUnityPowers(),
+        &table_ntt.GetAVX512RootOfUnityPowers(),
+        &table_ntt.GetAVX512Precon32RootOfUnityPowers(),
+        &table_ntt.GetAVX512Precon52RootOfUnityPowers(),
+        &table_ntt.GetAVX512Precon64RootOfUnityPowers(),
+        &table_ntt.GetInvRootOfUnityPowers(),
+        &table_ntt.GetPrecon32InvRootOfUnityPowers(),
+        &table_ntt.GetPrecon52InvRootOfUnityPowers(),
+        &table_ntt.GetPrecon64InvRootOfUnityPowers()};
+  };
+
+  // Copies share their tables, which are built once across threads
+  NTT ntt_copy = ntt;
+  std::vector<std::vector<const AlignedVector64<uint64_t>*>> thread_tables(4);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < thread_tables.size(); ++i) {
+    threads.emplace_back([&, i]() {
+      thread_tables[i] = get_tables((i % 2 == 0) ? ntt : ntt_copy);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto expected_tables = get_tables(expected_ntt);
+  size_t total_bytes = 0;
+  for (size_t j = 0; j < expected_tables.size(); ++j) {
+    EXPECT_GE(expected_tables[j]->size(), N);
+    total_bytes += expected_tables[j]->size() * sizeof(uint64_t);
+    for (const auto& tables : thread_tables) {
+      EXPECT_EQ(tables[j], thread_tables[0][j]);
+      AssertEqual(*tables[j], *expected_tables[j]);
+    }
+  }
+  EXPECT_EQ(ntt.GetTableMemoryBytes(), total_bytes);
+  EXPECT_EQ(ntt_copy.GetTableMemoryBytes(), total_bytes);
+  EXPECT_EQ(expected_ntt.GetTableMemoryBytes(), total_bytes);
+
+  NTT::SetDefaultTwiddleMode(default_mode);
+}
+
+TEST(NTT, native_radix) {
+  EXPECT_EQ(NTT::DefaultNativeRadix(1024), NTT::NativeRadix::Radix2);
+  EXPECT_EQ(NTT::DefaultNativeRadix(8192), NTT::NativeRadix::Radix4);
+
+  uint64_t N = 8192;
+  uint64_t modulus = GeneratePrimes(1, 45, true, N)[0];
+  NTT ntt(N, modulus);
+  if (!NTT::GetMeasureNativeRadix()) {
+    EXPECT_EQ(ntt.GetFwdNativeRadix(), NTT::NativeRadix::Radix4);
+    EXPECT_EQ(ntt.GetInvNativeRadix(), NTT::NativeRadix::Radix4);
+  }
+
+  ntt.SetNativeRadix(NTT::NativeRadix::Radix2, NTT::NativeRadix::Radix2);
+  EXPECT_EQ(ntt.GetFwdNativeRadix(), NTT::NativeRadix::Radix2);
+  EXPECT_EQ(ntt.GetInvNativeRadix(), NTT::NativeRadix::Radix2);
+  ntt.SetNativeRadix(NTT::NativeRadix::Radix4, NTT::NativeRadix::Radix4);
+  EXPECT_EQ(ntt.GetFwdNativeRadix(), NTT::NativeRadix::Radix4);
+  EXPECT_EQ(ntt.GetInvNativeRadix(), NTT::NativeRadix::Radix4);
+
+  // ComputeForward and ComputeInverse dispatch to the SIMD transforms where
+  // available, so compare the native transforms directly
+  const uint64_t* W = ntt.GetRootOfUnityPowers().data();
+  const uint64_t* W_precon = ntt.GetPrecon64RootOfUnityPowers().data();
+  const uint64_t* inv_W = ntt.GetInvRootOfUnityPowers().data();
+  const uint64_t* inv_W_precon = ntt.GetPrecon64InvRootOfUnityPowers().data();
+
+  auto input = GenerateInsecureUniformIntRandomValues(N, 0, modulus);
+  std::vector<uint64_t> exp_output(N, 0);
+  std::vector<uint64_t> output(N, 0);
+  ForwardTransformToBitReverseRadix2(exp_output.data(), input.data(), N,
+                                     modulus, W, W_precon, 1, 1);
+  ForwardTransformToBitReverseRadix4(output.data(), input.data(), N, modulus,
+                                     W, W_precon, 1, 1);
+  AssertEqual(output, exp_output);
+
+  std::vector<uint64_t> inv_output(N, 0);
+  InverseTransformFromBitReverseRadix2(exp_output.data(), output.data(), N,
+                                       modulus, inv_W, inv_W_precon, 1, 1);
+  InverseTransformFromBitReverseRadix4(inv_output.data(), output.data(), N,
+                                       modulus, inv_W, inv_W_precon, 1, 1);
+  AssertEqual(exp_output, input);
+  AssertEqual(inv_output, input);
+
+  // The public API matches the native transforms whichever path it takes
+  ntt.ComputeForward(exp_output.data(), input.data(), 1, 1);
+  AssertEqual(exp_output, output);
+}
+
+TEST(NTT, measure_native_radix) {
+  bool measure = NTT::GetMeasureNativeRadix();
+  NTT::SetMeasureNativeRadix(true);
+  EXPECT_TRUE(NTT::GetMeasureNativeRadix());
+
+  uint64_t N = 1024;
+  uint64_t modulus = GeneratePrimes(1, 50, true, N)[0];
+  NTT ntt1(N, modulus);
+  NTT ntt2(N, modulus);
+  NTT::SetMeasureNativeRadix(false);
+  NTT unmeasured_ntt(N, modulus);
+  NTT::SetMeasureNativeRadix(measure);
+
+  // The measurement is cached per (degree, modulus bit-width)
+  EXPECT_EQ(ntt1.GetFwdNativeRadix(), ntt2.GetFwdNativeRadix());
+  EXPECT_EQ(ntt1.GetInvNativeRadix(), ntt2.GetInvNativeRadix());
+
+  // The AVX512 and AVX2 transforms do not use the native radix, so it is not
+  // measured, nor are the native tables built
+  bool has_simd = false;
+#ifdef HEXL_HAS_AVX512DQ
+  has_simd = has_simd || has_avx512dq;
+#endif
+#ifdef HEXL_HAS_AVX256
+  has_simd = has_simd || has_avx2;
+#endif
+  if (has_simd) {
+    EXPECT_EQ(ntt1.GetFwdNativeRadix(), NTT::DefaultNativeRadix(N));
+    EXPECT_EQ(ntt1.GetInvNativeRadix(), NTT::DefaultNativeRadix(N));
+    EXPECT_EQ(ntt1.GetTableMemoryBytes(), unmeasured_ntt.GetTableMemoryBytes());
+  }
+
+  auto input = GenerateInsecureUniformIntRandomValues(N, 0, modulus);
+  std::vector<uint64_t> output(N, 0);
+  ntt1.ComputeForward(output.data(), input.data(), 1, 1);
+  ntt1.ComputeInverse(output.data(), output.data(), 1, 1);
+  AssertEqual(output, input);
+}
+
+TEST(NTT, base_ntt_size) {
+  size_t base_ntt_size = NTT::GetBaseNTTSize();
+  EXPECT_TRUE(IsPowerOfTwo(NTT::DefaultBaseNTTSize()));
+  EXPECT_GE(NTT::DefaultBaseNTTSize(), 16);
+
+  // Small base sizes exercise the depth-first recursion, including the fused
+  // radix-4 passes over blocks at least four times the base size
+  for (size_t base : {16, 64}) {
+    NTT::SetBaseNTTSize(base);
+    EXPECT_EQ(NTT::GetBaseNTTSize(), base);
+
+    for (uint64_t N : {32, 128, 2048, 8192}) {
+      uint64_t modulus = GeneratePrimes(1, 50, true, N)[0];
+      NTT ntt(N, modulus);
+      const uint64_t* W = ntt.GetRootOfUnityPowers().data();
+      const uint64_t* W_precon = ntt.GetPrecon64RootOfUnityPowers().data();
+      const uint64_t* inv_W = ntt.GetInvRootOfUnityPowers().data();
+      const uint64_t* inv_W_precon =
+          ntt.GetPrecon64InvRootOfUnityPowers().data();
+
+      auto input = GenerateInsecureUniformIntRandomValues(N, 0, modulus);
+      auto exp_output = input;
+      ReferenceForwardTransformToBitReverse(exp_output.data(), N, modulus, W);
+
+      std::vector<uint64_t> output(N, 0);
+      ForwardTransformToBitReverseRadix2(output.data(), input.data(), N,
+                                         modulus, W, W_precon, 1, 1);
+      AssertEqual(output, exp_output);
+      ForwardTransformToBitReverseRadix4(output.data(), input.data(), N,
+                                         modulus, W, W_precon, 1, 1);
+      AssertEqual(output, exp_output);
+      ntt.ComputeForward(output.data(), input.data(), 1, 1);
+      AssertEqual(output, exp_output);
+
+      auto exp_inv_output = exp_output;
+      ReferenceInverseTransformFromBitReverse(exp_inv_output.data(), N,
+                                              modulus, inv_W);
+      AssertEqual(exp_inv_output, input);
+
+      InverseTransformFromBitReverseRadix2(output.data(), exp_output.data(), N,
+                                           modulus, inv_W, inv_W_precon, 1, 1);
+      AssertEqual(output, input);
+      InverseTransformFromBitReverseRadix4(output.data(), exp_output.data(), N,
+                                           modulus, inv_W, inv_W_precon, 1, 1);
+      AssertEqual(output, input);
+      ntt.ComputeInverse(output.data(), exp_output.data(), 1, 1);
+      AssertEqual(output, input);
+    }
+  }
+
+  NTT::SetBaseNTTSize(0);
+  EXPECT_EQ(NTT::GetBaseNTTSize(), NTT::DefaultBaseNTTSize());
+  NTT::SetBaseNTTSize(base_ntt_size);
+}
+
+TEST(NTT, parallel) {
+  uint64_t parallel_cutoff = NTT::GetParallelCutoff();
+  size_t base_ntt_size = NTT::GetBaseNTTSize();
+  EXPECT_EQ(NTT::DefaultParallelCutoff() == 0,
+            std::getenv("HEXL_NTT_PARALLEL_CUTOFF") == nullptr);
+
+  for (size_t num_threads : {1, 3, 4}) {
+    SetNumThreads(num_threads);
+    for (uint64_t N : {1024, 8192}) {
+      uint64_t modulus = GeneratePrimes(1, 50, true, N)[0];
+      NTT ntt(N, modulus);
+      const uint64_t* W = ntt.GetRootOfUnityPowers().data();
+      const uint64_t* W_precon = ntt.GetPrecon64RootOfUnityPowers().data();
+      const uint64_t* inv_W = ntt.GetInvRootOfUnityPowers().data();
+      const uint64_t* inv_W_precon =
+          ntt.GetPrecon64InvRootOfUnityPowers().data();
+
+      auto input = GenerateInsecureUniformIntRandomValues(N, 0, modulus);
+      auto exp_output = input;
+      ReferenceForwardTransformToBitReverse(exp_output.data(), N, modulus, W);
+
+      NTT::SetBaseNTTSize(64);
+      NTT::SetParallelCutoff(N);
+      EXPECT_EQ(ParallelNTTLevels(N) > 0, num_threads > 1);
+      EXPECT_EQ(ParallelNTTLevels(N / 2), 0);
+
+      std::vector<uint64_t> output(N, 0);
+      ntt.ComputeForward(output.data(), input.data(), 1, 1);
+      AssertEqual(output, exp_output);
+      ntt.ComputeInverse(output.data(), output.data(), 1, 1);
+      AssertEqual(output, input);
+
+      ForwardTransformToBitReverseRadix2(output.data(), input.data(), N,
+                                         modulus, W, W_precon, 1, 1);
+      AssertEqual(output, exp_output);
+      ForwardTransformToBitReverseRadix4(output.data(), input.data(), N,
+                                         modulus, W, W_precon, 1, 1);
+      AssertEqual(output, exp_output);
+      InverseTransformFromBitReverseRadix2(output.data(), exp_output.data(), N,
+                                           modulus, inv_W, inv_W_precon, 1, 1);
+      AssertEqual(output, input);
+      InverseTransformFromBitReverseRadix4(output.data(), exp_output.data(), N,
+                                           modulus, inv_W, inv_W_precon, 1, 1);
+      AssertEqual(output, input);
+
+      // Lazy, in-place
+      output.assign(input.begin(), input.end());
+      ntt.ComputeForward(output.data(), output.data(), 1, 4);
+      for (auto& elem : output) {
+        ASSERT_LT(elem, 4 * modulus);
+        elem %= modulus;
+      }
+      AssertEqual(output, exp_output);
+      ntt.ComputeInverse(output.data(), output.data(), 1, 2);
+      for (auto& elem : output) {
+        ASSERT_LT(elem, 2 * modulus);
+        elem %= modulus;
+      }
+      AssertEqual(output, input);
+    }
+  }
+
+  SetNumThreads(0);
+  NTT::SetParallelCutoff(parallel_cutoff);
+  NTT::SetBaseNTTSize(base_ntt_size);
+}
+
+namespace {
+
+// Schoolbook product of x and y mod (X^N + 1, modulus)
+std::vector<uint64_t> NegacyclicMultiply(const uint64_t* x, const uint64_t* y,
+                                         size_t N, uint64_t modulus) {
+  std::vector<uint64_t> product(N, 0);
+  for (size_t i = 0; i < N; ++i) {
+    for (size_t j = 0; j < N; ++j) {
+      uint64_t term = MultiplyMod(x[i] % modulus, y[j] % modulus, modulus);
+      if (i + j < N) {
+        product[i + j] = AddUIntMod(product[i + j], term, modulus);
+      } else {
+        product[i + j - N] = SubUIntMod(product[i + j - N], term, modulus);
+      }
+    }
+  }
+  return product;
+}
+
+}  // namespace
+
+TEST(NTT, multiply) {
+  size_t base_ntt_size = NTT::GetBaseNTTSize();
+
+  for (size_t base : {size_t(0), size_t(16)}) {
+    NTT::SetBaseNTTSize(base);
+    for (uint64_t N : {2, 8, 64, 512}) {
+      for (size_t modulus_bits : {30, 50, 60}) {
+        uint64_t modulus = GeneratePrimes(1, modulus_bits, true, N)[0];
+        NTT ntt(N, modulus);
+
+        auto x = GenerateInsecureUniformIntRandomValues(N, 0, modulus);
+        auto y = GenerateInsecureUniformIntRandomValues(N, 0, modulus);
+        auto exp_output = NegacyclicMultiply(x.data(), y.data(), N, modulus);
+
+        std::vector<uint64_t> output(N, 0);
+        ntt.Multiply(output.data(), x.data(), y.data(), 1, 1);
+        AssertEqual(output, exp_output);
+
+        // Lazy inputs and outputs
+        auto x_lazy = x;
+        auto y_lazy = y;
+        for (size_t i = 0; i < N; ++i) {
+          x_lazy[i] += (i % 4) * modulus;
+          y_lazy[i] += ((i + 1) % 4) * modulus;
+        }
+        ntt.Multiply(output.data(), x_lazy.data(), y_lazy.data(), 4, 2);
+        for (auto& elem : output) {
+          ASSERT_LT(elem, 2 * modulus);
+          elem %= modulus;
+        }
+        AssertEqual(output, exp_output);
+
+        // Second operand in lazy NTT form, in-place
+        std::vector<uint64_t> y_ntt(N, 0);
+        ntt.ComputeForward(y_ntt.data(), y.data(), 1, 4);
+        output.assign(x.begin(), x.end());
+        ntt.MultiplyTransformed(output.data(), output.data(), y_ntt.data(), 1,
+                                1);
+        AssertEqual(output, exp_output);
+
+        // Result aliasing the second operand
+        output.assign(y.begin(), y.end());
+        ntt.Multiply(output.data(), x.data(), output.data(), 1, 1);
+        AssertEqual(output, exp_output);
+
+        // Native radix-4 implementation
+        ntt.SetNativeRadix(NTT::NativeRadix::Radix4, NTT::NativeRadix::Radix4);
+        ntt.Multiply(output.data(), x.data(), y.data(), 1, 1);
+        AssertEqual(output, exp_output);
+      }
+    }
+  }
+
+  NTT::SetBaseNTTSize(base_ntt_size);
+}
+
+TEST(NTT, sub_ntt) {
+  // Sub-NTTs share the Full tables of the master NTT
+  NTT::TwiddleMode default_mode = NTT::GetDefaultTwiddleMode();
+  NTT::SetDefaultTwiddleMode(NTT::TwiddleMode::Full);
+
+  uint64_t master_degree = 4096;
+  for (size_t modulus_bits : {30, 50}) {
+    uint64_t modulus = GeneratePrimes(1, modulus_bits, true, master_degree)[0];
+    auto master = std::make_shared<NTT>(master_degree, modulus);
+    NTT sub_sub_ntt = master->CreateSubNTT(1024).CreateSubNTT(256);
+
+    for (uint64_t N : {2, 8, 16, 256, 1024, 4096}) {
+      NTT sub_ntt = master->CreateSubNTT(N);
+      uint64_t root = PowMod(master->GetMinimalRootOfUnity(), master_degree / N,
+                             modulus);
+      EXPECT_EQ(sub_ntt.GetDegree(), N);
+      EXPECT_EQ(sub_ntt.GetModulus(), modulus);
+      EXPECT_EQ(sub_ntt.GetMinimalRootOfUnity(), root);
+      NTT expected_ntt(N, modulus, root);
+      if (N >= 16) {
+        // Only the AVX512 layout, if any, is not shared
+        EXPECT_LT(sub_ntt.GetTableMemoryBytes(),
+                  expected_ntt.GetTableMemoryBytes());
+      }
+
+      auto input = GenerateInsecureUniformIntRandomValues(N, 0, modulus);
+      auto other = GenerateInsecureUniformIntRandomValues(N, 0, modulus);
+      std::vector<uint64_t> expected(N, 0);
+      std::vector<uint64_t> output(N, 0);
+      for (uint64_t output_mod_factor : {1, 4}) {
+        expected_ntt.ComputeForward(expected.data(), input.data(), 1,
+                                    output_mod_factor);
+        sub_ntt.ComputeForward(output.data(), input.data(), 1,
+                               output_mod_factor);
+        AssertEqual(output, expected);
+      }
+      for (uint64_t output_mod_factor : {1, 2}) {
+        expected_ntt.ComputeInverse(expected.data(), input.data(), 1,
+                                    output_mod_factor);
+        sub_ntt.ComputeInverse(output.data(), input.data(), 1,
+                               output_mod_factor);
+        AssertEqual(output, expected);
+      }
+      sub_ntt.Multiply(output.data(), input.data(), other.data(), 1, 1);
+      AssertEqual(output, NegacyclicMultiply(input.data(), other.data(), N,
+                                             modulus));
+
+      // The public tables are complete
+      AssertEqual(sub_ntt.GetRootOfUnityPowers(),
+                  expected_ntt.GetRootOfUnityPowers());
+      AssertEqual(sub_ntt.GetAVX512Precon64RootOfUnityPowers(),
+                  expected_ntt.GetAVX512Precon64RootOfUnityPowers());
+      AssertEqual(sub_ntt.GetInvRootOfUnityPowers(),
+                  expected_ntt.GetInvRootOfUnityPowers());
+      AssertEqual(sub_ntt.GetPrecon52InvRootOfUnityPowers(),
+                  expected_ntt.GetPrecon52InvRootOfUnityPowers());
+
+      std::stringstream stream;
+      sub_ntt.Serialize(stream);
+      std::string bytes = stream.str();
+      AlignedVector64<uint64_t> buffer(bytes.size() / sizeof(uint64_t));
+      std::memcpy(buffer.data(), bytes.data(), bytes.size());
+      AssertEqual(NTT::Deserialize(buffer.data(), bytes.size())
+                      .GetPrecon64InvRootOfUnityPowers(),
+                  expected_ntt.GetPrecon64InvRootOfUnityPowers());
+    }
+
+    // Sub-NTTs keep the tables of the master NTT alive
+    master.reset();
+    uint64_t N = sub_sub_ntt.GetDegree();
+    NTT expected_ntt(N, modulus, sub_sub_ntt.GetMinimalRootOfUnity());
+    auto input = GenerateInsecureUniformIntRandomValues(N, 0, modulus);
+    std::vector<uint64_t> expected(N, 0);
+    std::vector<uint64_t> output(N, 0);
+    expected_ntt.ComputeForward(expected.data(), input.data(), 1, 1);
+    sub_sub_ntt.ComputeForward(output.data(), input.data(), 1, 1);
+    AssertEqual(output, expected);
+    sub_sub_ntt.ComputeInverse(output.data(), output.data(), 1, 1);
+    AssertEqual(output, input);
+  }
+
+  NTT::SetDefaultTwiddleMode(default_mode);
+}
+
+TEST(NTT, serialize) {
+  // (degree, modulus bits, cyclic)
+  std::vector<std::tuple<uint64_t, size_t, bool>> params{
+      {1, 20, false},
+      {1, 50, false},
+      {1, 61, false},
+      {8, 50, false},
+      {1024, 50, false},
+      {1 << 21, 50, false},
+      {2, 50, true},
+      {1024, 50, true},
+  };
+  for (const auto& param : params) {
+    uint64_t N = std::get<0>(param);
+    bool cyclic = std::get<2>(param);
+    SCOPED_TRACE("N = " + std::to_string(N) +
+                 ", bits = " + std::to_string(std::get<1>(param)) +
+                 ", cyclic = " + std::to_string(cyclic));
+    uint64_t modulus = GeneratePrimes(1, std::get<1>(param), true, N)[0];
+    NTT ntt = cyclic ? NTT::CreateCyclic(N, modulus) : NTT(N, modulus);
+
+    std::stringstream stream;
+    ntt.Serialize(stream);
+    std::string bytes = stream.str();
+    ASSERT_EQ(bytes.size() % 64, 0);
+    AlignedVector64<uint64_t> buffer(bytes.size() / sizeof(uint64_t));
+    std::memcpy(buffer.data(), bytes.data(), bytes.size());
+
+    std::string path = ::testing::TempDir() + "hexl_ntt_serialize.bin";
+    {
+      std::ofstream file(path, std::ios::binary);
+      file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    NTT loaded_ntt = NTT::Deserialize(buffer.data(), bytes.size());
+    NTT mapped_ntt = NTT::DeserializeMapped(path);
+    if (N < (1 << 21) &&
+        loaded_ntt.GetTwiddleMode() != NTT::TwiddleMode::Compact) {
+      // The transforms read the loaded tables in place. The compact tables are
+      // recomputed.
+      const uint64_t* inv_powers =
+          loaded_ntt.GetDispatchedInvRootOfUnityPowers();
+      EXPECT_GE(inv_powers, buffer.data());
+      EXPECT_LT(inv_powers, buffer.data() + buffer.size());
+    }
+
+    for (NTT* test_ntt : {&loaded_ntt, &mapped_ntt}) {
+      EXPECT_EQ(test_ntt->GetDegree(), N);
+      EXPECT_EQ(test_ntt->GetModulus(), modulus);
+      EXPECT_EQ(test_ntt->GetMinimalRootOfUnity(), ntt.GetMinimalRootOfUnity());
+      EXPECT_EQ(test_ntt->IsCyclic(), cyclic);
+
+      auto input = GenerateInsecureUniformIntRandomValues(N, 0, modulus);
+      std::vector<uint64_t> expected(N, 0);
+      std::vector<uint64_t> output(N, 0);
+      ntt.ComputeForward(expected.data(), input.data(), 1, 1);
+      test_ntt->ComputeForward(output.data(), input.data(), 1, 1);
+      AssertEqual(output, expected);
+      test_ntt->ComputeInverse(output.data(), output.data(), 1, 1);
+      AssertEqual(output, input);
+
+      // Tables loaded in place are copied by the getters
+      AssertEqual(test_ntt->GetRootOfUnityPowers(), ntt.GetRootOfUnityPowers());
+      AssertEqual(test_ntt->GetAVX512Precon52RootOfUnityPowers(),
+                  ntt.GetAVX512Precon52RootOfUnityPowers());
+      AssertEqual(test_ntt->GetPrecon64InvRootOfUnityPowers(),
+                  ntt.GetPrecon64InvRootOfUnityPowers());
+    }
+    std::remove(path.c_str());
+  }
+
+  // Corrupted headers are rejected
+  NTT ntt(64, GeneratePrimes(1, 50, true, 64)[0]);
+  std::stringstream stream;
+  ntt.Serialize(stream);
+  std::string bytes = stream.str();
+  AlignedVector64<uint64_t> buffer(bytes.size() / sizeof(uint64_t));
+  for (size_t word : {0, 1, 2, 3, 4, 5, 6, 7}) {
+    std::memcpy(buffer.data(), bytes.data(), bytes.size());
+    buffer[word] += 1;
+    EXPECT_THROW(NTT::Deserialize(buffer.data(), bytes.size()),
+                 std::invalid_argument);
+  }
+  std::memcpy(buffer.data(), bytes.data(), bytes.size());
+  EXPECT_THROW(NTT::Deserialize(buffer.data(), bytes.size() - 64),
+               std::invalid_argument);
+  EXPECT_THROW(NTT::Deserialize(buffer.data(), 16), std::invalid_argument);
+  EXPECT_THROW(NTT::DeserializeMapped(::testing::TempDir() + "missing.bin"),
+               std::runtime_error);
+}
+
+TEST(NTT, compact_twiddle_mode) {
+  size_t base_ntt_size = NTT::GetBaseNTTSize();
+  NTT::TwiddleMode default_mode = NTT::GetDefaultTwiddleMode();
+
+  for (size_t base : {size_t(0), size_t(16)}) {
+    NTT::SetBaseNTTSize(base);
+    for (uint64_t N : {2, 8, 16, 32, 64, 1024, 8192}) {
+      for (size_t modulus_bits : {30, 49, 60}) {
+        uint64_t modulus = GeneratePrimes(1, modulus_bits, true, N)[0];
+        NTT::SetDefaultTwiddleMode(NTT::TwiddleMode::Full);
+        NTT full_ntt(N, modulus);
+        NTT::SetDefaultTwiddleMode(NTT::TwiddleMode::Compact);
+        NTT ntt(N, modulus);
+        ASSERT_EQ(ntt.GetTwiddleMode(), NTT::TwiddleMode::Compact);
+        if (N >= 1024) {
+          EXPECT_LT(8 * ntt.GetTableMemoryBytes(),
+                    full_ntt.GetTableMemoryBytes());
+        }
+
+        auto input = GenerateInsecureUniformIntRandomValues(N, 0, modulus);
+        std::vector<uint64_t> expected(N, 0);
+        std::vector<uint64_t> output(N, 0);
+        full_ntt.ComputeForward(expected.data(), input.data(), 1, 1);
+        ntt.ComputeForward(output.data(), input.data(), 1, 1);
+        AssertEqual(output, expected);
+        ntt.ComputeInverse(output.data(), output.data(), 1, 1);
+        AssertEqual(output, input);
+
+        // Lazy inputs and outputs
+        auto lazy_input = input;
+        for (size_t i = 0; i < N; ++i) {
+          lazy_input[i] += (i % 4) * modulus;
+        }
+        ntt.ComputeForward(output.data(), lazy_input.data(), 4, 4);
+        for (size_t i = 0; i < N; ++i) {
+          ASSERT_LT(output[i], 4 * modulus);
+          ASSERT_EQ(output[i] % modulus, expected[i]);
+        }
+        for (size_t i = 0; i < N; ++i) {
+          output[i] = expected[i] + (i % 2) * modulus;
+        }
+        ntt.ComputeInverse(output.data(), output.data(), 2, 2);
+        for (size_t i = 0; i < N; ++i) {
+          ASSERT_LT(output[i], 2 * modulus);
+          ASSERT_EQ(output[i] % modulus, input[i]);
+        }
+
+        // Fused pointwise product
+        if (N <= 1024) {
+          auto y = GenerateInsecureUniformIntRandomValues(N, 0, modulus);
+          auto exp_product =
+              NegacyclicMultiply(input.data(), y.data(), N, modulus);
+          ntt.Multiply(output.data(), input.data(), y.data(), 1, 1);
+          AssertEqual(output, exp_product);
+        }
+
+        // Switching modes builds the tables of the new mode
+        ntt.SetTwiddleMode(NTT::TwiddleMode::Full);
+        ntt.ComputeForward(output.data(), input.data(), 1, 1);
+        AssertEqual(output, expected);
+      }
+    }
+  }
+
+  NTT::SetDefaultTwiddleMode(default_mode);
+  NTT::SetBaseNTTSize(base_ntt_size);
+}
+
+TEST(NTT, montgomery_twiddle_mode) {
+  size_t base_ntt_size = NTT::GetBaseNTTSize();
+  uint64_t parallel_cutoff = NTT::GetParallelCutoff();
+  NTT::TwiddleMode default_mode = NTT::GetDefaultTwiddleMode();
+
+  for (size_t num_threads : {1, 4}) {
+    SetNumThreads(num_threads);
+    NTT::SetParallelCutoff(num_threads > 1 ? 1024 : 0);
+    for (size_t base : {size_t(0), size_t(16)}) {
+      NTT::SetBaseNTTSize(base);
+      for (uint64_t N : {2, 8, 16, 64, 1024, 8192}) {
+        for (size_t modulus_bits : {30, 49, 50, 61}) {
+          SCOPED_TRACE("N = " + std::to_string(N) +
+                       ", bits = " + std::to_string(modulus_bits));
+          uint64_t modulus = GeneratePrimes(1, modulus_bits, true, N)[0];
+          NTT::SetDefaultTwiddleMode(NTT::TwiddleMode::Full);
+          NTT full_ntt(N, modulus);
+          NTT::SetDefaultTwiddleMode(NTT::TwiddleMode::Montgomery);
+          NTT ntt(N, modulus);
+          ASSERT_EQ(ntt.GetTwiddleMode(), NTT::TwiddleMode::Montgomery);
+          // A single table per direction
+          EXPECT_EQ(ntt.GetTableMemoryBytes(), 2 * N * sizeof(uint64_t));
+
+          auto input = GenerateInsecureUniformIntRandomValues(N, 0, modulus);
+          std::vector<uint64_t> expected(N, 0);
+          std::vector<uint64_t> output(N, 0);
+          full_ntt.ComputeForward(expected.data(), input.data(), 1, 1);
+          ntt.ComputeForward(output.data(), input.data(), 1, 1);
+          AssertEqual(output, expected);
+          ntt.ComputeInverse(output.data(), output.data(), 1, 1);
+          AssertEqual(output, input);
+
+          // Lazy inputs and outputs
+          auto lazy_input = input;
+          for (size_t i = 0; i < N; ++i) {
+            lazy_input[i] += (i % 4) * modulus;
+          }
+          ntt.ComputeForward(output.data(), lazy_input.data(), 4, 4);
+          for (size_t i = 0; i < N; ++i) {
+            ASSERT_LT(output[i], 4 * modulus);
+            ASSERT_EQ(output[i] % modulus, expected[i]);
+          }
+          for (size_t i = 0; i < N; ++i) {
+            output[i] = expected[i] + (i % 2) * modulus;
+          }
+          ntt.ComputeInverse(output.data(), output.data(), 2, 2);
+          for (size_t i = 0; i < N; ++i) {
+            ASSERT_LT(output[i], 2 * modulus);
+            ASSERT_EQ(output[i] % modulus, input[i]);
+          }
+
+          // Fused pointwise product
+          if (N <= 1024) {
+            auto y = GenerateInsecureUniformIntRandomValues(N, 0, modulus);
+            auto exp_product =
+                NegacyclicMultiply(input.data(), y.data(), N, modulus);
+            ntt.Multiply(output.data(), input.data(), y.data(), 1, 1);
+            AssertEqual(output, exp_product);
+          }
+
+          // Sub-NTTs read views of the tables of the master NTT
+          NTT sub_ntt = ntt.CreateSubNTT(N / 2);
+          NTT exp_sub_ntt(N / 2, modulus,
+                          MultiplyMod(full_ntt.GetMinimalRootOfUnity(),
+                                      full_ntt.GetMinimalRootOfUnity(),
+                                      modulus));
+          std::vector<uint64_t> sub_input(input.begin(),
+                                          input.begin() + N / 2);
+          std::vector<uint64_t> sub_output = sub_input;
+          std::vector<uint64_t> exp_sub_output = sub_input;
+          sub_ntt.ComputeForward(sub_output.data(), sub_output.data(), 1, 1);
+          exp_sub_ntt.ComputeForward(exp_sub_output.data(),
+                                     exp_sub_output.data(), 1, 1);
+          AssertEqual(sub_output, exp_sub_output);
+          sub_ntt.ComputeInverse(sub_output.data(), sub_output.data(), 1, 1);
+          AssertEqual(sub_output, sub_input);
+        }
+      }
+    }
+  }
+
+  NTT::SetDefaultTwiddleMode(default_mode);
+  SetNumThreads(0);
+  NTT::SetParallelCutoff(parallel_cutoff);
+  NTT::SetBaseNTTSize(base_ntt_size);
+}
+
+TEST(NTT, montgomery_kernels) {
+  for (uint64_t N : {16, 32, 64, 1024, 8192}) {
+    for (size_t modulus_bits : {30, 49, 61}) {
+      uint64_t modulus = GeneratePrimes(1, modulus_bits, true, N)[0];
+      NTT ntt(N, modulus);
+      auto to_montgomery = [&](const AlignedVector64<uint64_t>& powers,
+                               uint64_t bit_shift) {
+        std::vector<uint64_t> montgomery_powers(powers.size());
+        for (size_t i = 0; i < powers.size(); ++i) {
+          montgomery_powers[i] =
+              ToMontgomeryForm(powers[i], modulus, bit_shift);
+        }
+        return montgomery_powers;
+      };
+
+      auto input = GenerateInsecureUniformIntRandomValues(N, 0, modulus);
+      std::vector<uint64_t> expected(N, 0);
+      ntt.ComputeForward(expected.data(), input.data(), 1, 1);
+      std::vector<uint64_t> output(N, 0);
+
+      auto W = to_montgomery(ntt.GetRootOfUnityPowers(), 64);
+      auto inv_W = to_montgomery(ntt.GetInvRootOfUnityPowers(), 64);
+      ForwardTransformToBitReverseMontgomery(output.data(), input.data(), N,
+                                             modulus, W.data(), 1, 1);
+      AssertEqual(output, expected);
+      InverseTransformFromBitReverseMontgomery(output.data(), output.data(), N,
+                                               modulus, inv_W.data(), 1, 1);
+      AssertEqual(output, input);
+
+#ifdef HEXL_HAS_AVX512DQ
+      if (has_avx512dq) {
+        ForwardTransformToBitReverseMontgomeryAVX512<64>(
+            output.data(), input.data(), N, modulus, W.data(), 1, 1);
+        AssertEqual(output, expected);
+        InverseTransformFromBitReverseMontgomeryAVX512<64>(
+            output.data(), output.data(), N, modulus, inv_W.data(), 1, 1);
+        AssertEqual(output, input);
+      }
+#endif
+#ifdef HEXL_HAS_AVX512IFMA
+      if (has_avx512ifma && modulus < NTT::s_max_fwd_ifma_modulus) {
+        auto W52 = to_montgomery(ntt.GetRootOfUnityPowers(), 52);
+        auto inv_W52 = to_montgomery(ntt.GetInvRootOfUnityPowers(), 52);
+        ForwardTransformToBitReverseMontgomeryAVX512<52>(
+            output.data(), input.data(), N, modulus, W52.data(), 1, 1);
+        AssertEqual(output, expected);
+        InverseTransformFromBitReverseMontgomeryAVX512<52>(
+            output.data(), output.data(), N, modulus, inv_W52.data(), 1, 1);
+        AssertEqual(output, input);
+      }
+#endif
+    }
+  }
+}
+
+// Compares the compact-table kernels, reading compact tables built from the
+// Full tables, with the Full-mode transforms
+TEST(NTT, compact_kernels) {
+  size_t base_ntt_size = NTT::GetBaseNTTSize();
+  uint64_t parallel_cutoff = NTT::GetParallelCutoff();
+
+  for (size_t num_threads : {1, 4}) {
+    SetNumThreads(num_threads);
+    NTT::SetParallelCutoff(num_threads > 1 ? 1024 : 0);
+    for (size_t base : {size_t(0), size_t(16)}) {
+      NTT::SetBaseNTTSize(base);
+      for (uint64_t N : {16, 32, 64, 1024, 8192}) {
+        for (size_t modulus_bits : {30, 49, 61}) {
+          SCOPED_TRACE("N = " + std::to_string(N) +
+                       ", bits = " + std::to_string(modulus_bits) +
+                       ", threads = " + std::to_string(num_threads));
+          uint64_t modulus = GeneratePrimes(1, modulus_bits, true, N)[0];
+          NTT ntt(N, modulus);
+
+          // W[k] for k < 2^b, followed by W[j * 2^b]
+          const uint64_t low_size = 1ULL << CompactRootLowBits(N);
+          std::vector<uint64_t> W;
+          for (size_t k = 0; k < low_size; ++k) {
+            W.push_back(ntt.GetRootOfUnityPowers()[k]);
+          }
+          for (size_t k = 0; k < N; k += low_size) {
+            W.push_back(ntt.GetRootOfUnityPowers()[k]);
+          }
+          std::vector<uint64_t> inv_W(W.size());
+          for (size_t i = 0; i < W.size(); ++i) {
+            inv_W[i] = InverseMod(W[i], modulus);
+          }
+          auto precon = [&](const std::vector<uint64_t>& powers,
+                            uint64_t bit_shift) {
+            std::vector<uint64_t> precon_powers(powers.size());
+            for (size_t i = 0; i < powers.size(); ++i) {
+              precon_powers[i] =
+                  MultiplyFactor(powers[i], bit_shift, modulus).BarrettFactor();
+            }
+            return precon_powers;
+          };
+          auto W_precon = precon(W, 64);
+          auto inv_W_precon = precon(inv_W, 64);
+
+          auto input = GenerateInsecureUniformIntRandomValues(N, 0, modulus);
+          std::vector<uint64_t> expected(N, 0);
+          ntt.ComputeForward(expected.data(), input.data(), 1, 1);
+          std::vector<uint64_t> output(N, 0);
+
+          ForwardTransformToBitReverseCompact(output.data(), input.data(), N,
+                                              modulus, W.data(),
+                                              W_precon.data(), 1, 1);
+          AssertEqual(output, expected);
+          InverseTransformFromBitReverseCompact(output.data(), output.data(),
+                                                N, modulus, inv_W.data(),
+                                                inv_W_precon.data(), 1, 1);
+          AssertEqual(output, input);
+
+#ifdef HEXL_HAS_AVX512DQ
+          if (has_avx512dq && N >= 32) {
+            ForwardTransformToBitReverseCompactAVX512<64>(
+                output.data(), input.data(), N, modulus, W.data(),
+                W_precon.data(), 1, 1);
+            AssertEqual(output, expected);
+            InverseTransformFromBitReverseCompactAVX512<64>(
+                output.data(), output.data(), N, modulus, inv_W.data(),
+                inv_W_precon.data(), 1, 1);
+            AssertEqual(output, input);
+          }
+#endif
+#ifdef HEXL_HAS_AVX512IFMA
+          if (has_avx512ifma && N >= 32 &&
+              modulus < NTT::s_max_fwd_ifma_modulus) {
+            auto W_precon52 = precon(W, 52);
+            auto inv_W_precon52 = precon(inv_W, 52);
+            ForwardTransformToBitReverseCompactAVX512<52>(
+                output.data(), input.data(), N, modulus, W.data(),
+                W_precon52.data(), 1, 1);
+            AssertEqual(output, expected);
+            InverseTransformFromBitReverseCompactAVX512<52>(
+                output.data(), output.data(), N, modulus, inv_W.data(),
+                inv_W_precon52.data(), 1, 1);
+            AssertEqual(output, input);
+          }
+#endif
+#ifdef HEXL_HAS_AVX256
+          if (has_avx2) {
+            ForwardTransformToBitReverseCompactAVX2(
+                output.data(), input.data(), N, modulus, W.data(),
+                W_precon.data(), 1, 1);
+            AssertEqual(output, expected);
+            InverseTransformFromBitReverseCompactAVX2(
+                output.data(), output.data(), N, modulus, inv_W.data(),
+                inv_W_precon.data(), 1, 1);
+            AssertEqual(output, input);
+          }
+#endif
+        }
+      }
+    }
+  }
+
+  SetNumThreads(0);
+  NTT::SetParallelCutoff(parallel_cutoff);
+  NTT::SetBaseNTTSize(base_ntt_size);
+}
+
+// Moduli of at least NTT::s_max_lazy_modulus use fully reduced Montgomery
+// butterflies; lazy inputs may take any value below input_mod_factor * q or
+// 2^64, whichever is smaller
+TEST(NTT, large_modulus) {
+  for (uint64_t N : {2, 8, 16, 64, 1024, 8192}) {
+    for (size_t modulus_bits : {62, 63}) {
+      for (bool prefer_small_primes : {true, false}) {
+        SCOPED_TRACE("N = " + std::to_string(N) +
+                     ", bits = " + std::to_string(modulus_bits) +
+                     ", small = " + std::to_string(prefer_small_primes));
+        uint64_t modulus =
+            GeneratePrimes(1, modulus_bits, prefer_small_primes, N)[0];
+        ASSERT_TRUE(modulus >= NTT::s_max_lazy_modulus);
+        NTT ntt(N, modulus);
+        ASSERT_EQ(ntt.GetTwiddleMode(), NTT::TwiddleMode::Montgomery);
+        ntt.SetTwiddleMode(NTT::TwiddleMode::Full);
+        EXPECT_EQ(ntt.GetTwiddleMode(), NTT::TwiddleMode::Montgomery);
+
+        auto input = GenerateInsecureUniformIntRandomValues(N, 0, modulus);
+        auto expected = input;
+        ReferenceForwardTransformToBitReverse(
+            expected.data(), N, modulus, ntt.GetRootOfUnityPowers().data());
+        std::vector<uint64_t> output(N, 0);
+        ntt.ComputeForward(output.data(), input.data(), 1, 1);
+        AssertEqual(output, expected);
+        ntt.ComputeInverse(output.data(), output.data(), 1, 1);
+        AssertEqual(output, input);
+
+        // Lazy inputs; the outputs are fully reduced for any output mod factor
+        auto fwd_input = GenerateInsecureUniformIntRandomValues(
+            N, 0, ModFactorBound(modulus, 4));
+        auto inv_input = GenerateInsecureUniformIntRandomValues(
+            N, 0, ModFactorBound(modulus, 2));
+        std::vector<uint64_t> fwd_expected(N, 0);
+        std::vector<uint64_t> inv_expected(N, 0);
+        for (size_t i = 0; i < N; ++i) {
+          fwd_expected[i] = fwd_input[i] % modulus;
+          inv_expected[i] = inv_input[i] % modulus;
+        }
+        ntt.ComputeForward(fwd_expected.data(), fwd_expected.data(), 1, 1);
+        ntt.ComputeInverse(inv_expected.data(), inv_expected.data(), 1, 1);
+
+        ntt.ComputeForward(output.data(), fwd_input.data(), 4, 4);
+        AssertEqual(output, fwd_expected);
+        ntt.ComputeInverse(output.data(), inv_input.data(), 2, 2);
+        AssertEqual(output, inv_expected);
+
+        std::vector<uint64_t> W(N);
+        std::vector<uint64_t> inv_W(N);
+        for (size_t i = 0; i < N; ++i) {
+          W[i] = ToMontgomeryForm(ntt.GetRootOfUnityPowers()[i], modulus, 64);
+          inv_W[i] =
+              ToMontgomeryForm(ntt.GetInvRootOfUnityPowers()[i], modulus, 64);
+        }
+        ForwardTransformToBitReverseLargeModulus(
+            output.data(), fwd_input.data(), N, modulus, W.data(), 4);
+        AssertEqual(output, fwd_expected);
+        InverseTransformFromBitReverseLargeModulus(
+            output.data(), inv_input.data(), N, modulus, inv_W.data(), 2);
+        AssertEqual(output, inv_expected);
+#ifdef HEXL_HAS_AVX512DQ
+        if (has_avx512dq && N >= 16) {
+          ForwardTransformToBitReverseLargeModulusAVX512<
+              NTT::s_default_shift_bits>(output.data(), fwd_input.data(), N,
+                                         modulus, W.data(), 4);
+          AssertEqual(output, fwd_expected);
+          InverseTransformFromBitReverseLargeModulusAVX512<
+              NTT::s_default_shift_bits>(output.data(), inv_input.data(), N,
+                                         modulus, inv_W.data(), 2);
+          AssertEqual(output, inv_expected);
+        }
+#endif
+
+        if (N <= 1024) {
+          auto y = GenerateInsecureUniformIntRandomValues(N, 0, modulus);
+          auto exp_product =
+              NegacyclicMultiply(input.data(), y.data(), N, modulus);
+          ntt.Multiply(output.data(), input.data(), y.data(), 1, 1);
+          AssertEqual(output, exp_product);
+        }
+      }
+    }
+  }
+}
+
+// Moduli in [2^50, 2^52) use the fully reduced AVX512-IFMA transforms, in
+// both Full and Montgomery mode
+TEST(NTT, ifma_52bit_modulus) {
+  for (size_t N : {16, 32, 256, 4096}) {
+    for (size_t modulus_bits : {50, 51}) {
+      for (bool prefer_small_primes : {true, false}) {
+        SCOPED_TRACE("N = " + std::to_string(N) +
+                     ", bits = " + std::to_string(modulus_bits) +
+                     ", small = " + std::to_string(prefer_small_primes));
+        uint64_t modulus =
+            GeneratePrimes(1, modulus_bits, prefer_small_primes, N)[0];
+        ASSERT_TRUE(modulus >= NTT::s_max_fwd_ifma_modulus);
+        ASSERT_TRUE(modulus < NTT::s_max_ifma_modulus);
+
+        auto input = GenerateInsecureUniformIntRandomValues(N, 0, modulus);
+        auto fwd_input =
+            GenerateInsecureUniformIntRandomValues(N, 0, 4 * modulus);
+        auto inv_input =
+            GenerateInsecureUniformIntRandomValues(N, 0, 2 * modulus);
+        auto y = GenerateInsecureUniformIntRandomValues(N, 0, modulus);
+        auto exp_product =
+            NegacyclicMultiply(input.data(), y.data(), N, modulus);
+
+        for (auto mode :
+             {NTT::TwiddleMode::Full, NTT::TwiddleMode::Montgomery}) {
+          NTT ntt(N, modulus);
+          ntt.SetTwiddleMode(mode);
+
+          auto expected = input;
+          ReferenceForwardTransformToBitReverse(
+              expected.data(), N, modulus, ntt.GetRootOfUnityPowers().data());
+          std::vector<uint64_t> output(N, 0);
+          ntt.ComputeForward(output.data(), input.data(), 1, 1);
+          AssertEqual(output, expected);
+          ntt.ComputeInverse(output.data(), output.data(), 1, 1);
+          AssertEqual(output, input);
+
+          std::vector<uint64_t> fwd_expected(N, 0);
+          std::vector<uint64_t> inv_expected(N, 0);
+          for (size_t i = 0; i < N; ++i) {
+            fwd_expected[i] = fwd_input[i] % modulus;
+            inv_expected[i] = inv_input[i] % modulus;
+          }
+          ntt.ComputeForward(fwd_expected.data(), fwd_expected.data(), 1, 1);
+          ntt.ComputeInverse(inv_expected.data(), inv_expected.data(), 1, 1);
+          for (uint64_t output_mod_factor : {1, 4}) {
+            ntt.ComputeForward(output.data(), fwd_input.data(), 4,
+                               output_mod_factor);
+            for (auto& x : output) {
+              ASSERT_LT(x, output_mod_factor * modulus);
+              x %= modulus;
+            }
+            AssertEqual(output, fwd_expected);
+          }
+          for (uint64_t output_mod_factor : {1, 2}) {
+            ntt.ComputeInverse(output.data(), inv_input.data(), 2,
+                               output_mod_factor);
+            for (auto& x : output) {
+              ASSERT_LT(x, output_mod_factor * modulus);
+              x %= modulus;
+            }
+            AssertEqual(output, inv_expected);
+          }
+
+          ntt.Multiply(output.data(), input.data(), y.data(), 1, 1);
+          AssertEqual(output, exp_product);
+
+#ifdef HEXL_HAS_AVX512IFMA
+          if (has_avx512ifma) {
+            std::vector<uint64_t> W(N);
+            std::vector<uint64_t> inv_W(N);
+            for (size_t i = 0; i < N; ++i) {
+              W[i] =
+                  ToMontgomeryForm(ntt.GetRootOfUnityPowers()[i], modulus, 52);
+              inv_W[i] = ToMontgomeryForm(ntt.GetInvRootOfUnityPowers()[i],
+                                          modulus, 52);
+            }
+            ForwardTransformToBitReverseLargeModulusAVX512<
+                NTT::s_ifma_shift_bits>(output.data(), fwd_input.data(), N,
+                                        modulus, W.data(), 4);
+            AssertEqual(output, fwd_expected);
+            InverseTransformFromBitReverseLargeModulusAVX512<
+                NTT::s_ifma_shift_bits>(output.data(), inv_input.data(), N,
+                                        modulus, inv_W.data(), 2);
+            AssertEqual(output, inv_expected);
+          }
+#endif
+        }
+      }
+    }
+  }
+}
+
+// Checks ComputeForwardFromUnreduced matches reducing the inputs and calling
+// ComputeForward, for inputs of any 64-bit value
+TEST(NTT, forward_from_unreduced) {
+  for (size_t N : {1, 2, 16, 32, 64, 1024, 8192}) {
+    for (size_t modulus_bits : {29, 48, 50, 59, 62}) {
+      SCOPED_TRACE("N = " + std::to_string(N) +
+                   ", bits = " + std::to_string(modulus_bits));
+      uint64_t modulus = GeneratePrimes(1, modulus_bits, true, N)[0];
+      auto input = GenerateInsecureUniformIntRandomValues(
+          N, 0, std::numeric_limits<uint64_t>::max());
+      std::vector<uint64_t> reduced(N);
+      for (size_t i = 0; i < N; ++i) {
+        reduced[i] = input[i] % modulus;
+      }
+
+      for (auto mode : {NTT::TwiddleMode::Full, NTT::TwiddleMode::Compact,
+                        NTT::TwiddleMode::Montgomery}) {
+        NTT ntt(N, modulus);
+        ntt.SetTwiddleMode(mode);
+        auto expected = reduced;
+        ntt.ComputeForward(expected.data(), expected.data(), 1, 1);
+
+        for (uint64_t output_mod_factor : {1, 4}) {
+          std::vector<uint64_t> output(N);
+          ntt.ComputeForwardFromUnreduced(output.data(), input.data(),
+                                          output_mod_factor);
+          for (auto& x : output) {
+            ASSERT_LT(x, ModFactorBound(modulus, output_mod_factor));
+            x %= modulus;
+          }
+          AssertEqual(output, expected);
+        }
+
+        auto in_place = input;
+        ntt.ComputeForwardFromUnreduced(in_place.data(), in_place.data(), 1);
+        AssertEqual(in_place, expected);
+      }
+    }
+  }
+}
+
+// Checks ComputeInverseScaled matches ComputeInverse followed by a separate
+// multiplication by the scalar and addition of the addend
+TEST(NTT, inverse_scaled) {
+  for (size_t N : {1, 2, 16, 32, 64, 1024, 8192}) {
+    for (size_t modulus_bits : {29, 48, 50, 59, 62}) {
+      SCOPED_TRACE("N = " + std::to_string(N) +
+                   ", bits = " + std::to_string(modulus_bits));
+      uint64_t modulus = GeneratePrimes(1, modulus_bits, true, N)[0];
+      auto constants = GenerateInsecureUniformIntRandomValues(2, 0, modulus);
+      std::vector<std::pair<uint64_t, uint64_t>> scalars_addends{
+          {1, 0}, {constants[0], 0}, {1, constants[1]},
+          {constants[0], constants[1]}};
+
+      for (auto mode : {NTT::TwiddleMode::Full, NTT::TwiddleMode::Compact,
+                        NTT::TwiddleMode::Montgomery}) {
+        NTT ntt(N, modulus);
+        ntt.SetTwiddleMode(mode);
+        for (uint64_t input_mod_factor : {1, 2}) {
+          auto input = GenerateInsecureUniformIntRandomValues(
+              N, 0, ModFactorBound(modulus, input_mod_factor));
+          auto inverse = input;
+          ntt.ComputeInverse(inverse.data(), inverse.data(), input_mod_factor,
+                             1);
+
+          for (const auto& scalar_addend : scalars_addends) {
+            uint64_t scalar = scalar_addend.first;
+            uint64_t addend = scalar_addend.second;
+            std::vector<uint64_t> expected(N);
+            for (size_t i = 0; i < N; ++i) {
+              expected[i] = AddUIntMod(MultiplyMod(inverse[i], scalar, modulus),
+                                       addend, modulus);
+            }
+
+            for (uint64_t output_mod_factor : {1, 2}) {
+              std::vector<uint64_t> output(N);
+              ntt.ComputeInverseScaled(output.data(), input.data(), scalar,
+                                       addend, input_mod_factor,
+                                       output_mod_factor);
+              for (auto& x : output) {
+                ASSERT_LT(x, ModFactorBound(modulus, output_mod_factor));
+                x %= modulus;
+              }
+              AssertEqual(output, expected);
+            }
+
+            auto in_place = input;
+            ntt.ComputeInverseScaled(in_place.data(), in_place.data(), scalar,
+                                     addend, input_mod_factor, 1);
+            AssertEqual(in_place, expected);
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(NTT, multi) {
+  for (size_t N : {1, 8, 16, 32, 64, 1024, 8192}) {
+    for (size_t modulus_bits : {29, 49, 50, 59}) {
+      SCOPED_TRACE("N = " + std::to_string(N) +
+                   ", bits = " + std::to_string(modulus_bits));
+      uint64_t modulus = GeneratePrimes(1, modulus_bits, true, N)[0];
+
+      for (auto mode : {NTT::TwiddleMode::Full, NTT::TwiddleMode::Compact}) {
+        NTT ntt(N, modulus);
+        ntt.SetTwiddleMode(mode);
+        for (size_t num_polys : {1, 2, 3}) {
+          std::vector<AlignedVector64<uint64_t>> inputs(num_polys);
+          std::vector<AlignedVector64<uint64_t>> outputs(
+              num_polys, AlignedVector64<uint64_t>(N));
+          std::vector<const uint64_t*> operand(num_polys);
+          std::vector<uint64_t*> result(num_polys);
+          for (size_t p = 0; p < num_polys; ++p) {
+            inputs[p] = GenerateInsecureUniformIntRandomValues(N, 0, modulus);
+            operand[p] = inputs[p].data();
+            result[p] = outputs[p].data();
+          }
+
+          for (uint64_t output_mod_factor : {1, 4}) {
+            ntt.ComputeForwardMulti(result.data(), operand.data(), num_polys,
+                                    1, output_mod_factor);
+            for (size_t p = 0; p < num_polys; ++p) {
+              auto expected = inputs[p];
+              ntt.ComputeForward(expected.data(), expected.data(), 1, 1);
+              for (auto& x : outputs[p]) {
+                ASSERT_LT(x, ModFactorBound(modulus, output_mod_factor));
+                x %= modulus;
+              }
+              AssertEqual(outputs[p], expected);
+            }
+          }
+
+          for (uint64_t output_mod_factor : {1, 2}) {
+            ntt.ComputeInverseMulti(result.data(), operand.data(), num_polys,
+                                    1, output_mod_factor);
+            for (size_t p = 0; p < num_polys; ++p) {
+              AlignedVector64<uint64_t> expected(N);
+              ntt.ComputeInverse(expected.data(), inputs[p].data(), 1, 1);
+              for (auto& x : outputs[p]) {
+                ASSERT_LT(x, ModFactorBound(modulus, output_mod_factor));
+                x %= modulus;
+              }
+              AssertEqual(outputs[p], expected);
+            }
+          }
+
+          // In-place round trip, with lazy intermediate values
+          auto in_place = inputs;
+          for (size_t p = 0; p < num_polys; ++p) {
+            result[p] = in_place[p].data();
+          }
+          ntt.ComputeForwardMulti(result.data(), result.data(), num_polys, 1,
+                                  4);
+          for (auto& x : in_place) {
+            for (auto& y : x) {
+              y %= 2 * modulus;
+            }
+          }
+          ntt.ComputeInverseMulti(result.data(), result.data(), num_polys, 2,
+                                  1);
+          for (size_t p = 0; p < num_polys; ++p) {
+            AssertEqual(in_place[p], inputs[p]);
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(NTT, bit_reverse_permute) {
+  for (uint64_t N = 1; N <= (1ULL << 16); N <<= 1) {
+    std::vector<uint64_t> input(N);
+    for (size_t i = 0; i < N; ++i) {
+      input[i] = i;
+    }
+    std::vector<uint64_t> expected(N);
+    for (size_t i = 0; i < N; ++i) {
+      expected[i] = ReverseBits(i, Log2(N));
+    }
+
+    std::vector<uint64_t> output(N, 0);
+    BitReversePermute(output.data(), input.data(), N);
+    AssertEqual(output, expected);
+    BitReversePermute(output.data(), output.data(), N);
+    AssertEqual(output, input);
+
+    BitReversePermuteNative(output.data(), input.data(), N);
+    AssertEqual(output, expected);
+    BitReversePermuteNative(output.data(), output.data(), N);
+    AssertEqual(output, input);
+  }
+}
+
+TEST(NTT, natural_order) {
+  for (uint64_t N : {2, 4, 8, 64, 1024, 8192}) {
+    for (size_t modulus_bits : {30, 50, 60}) {
+      uint64_t modulus = GeneratePrimes(1, modulus_bits, true, N)[0];
+      NTT ntt(N, modulus);
+
+      auto input = GenerateInsecureUniformIntRandomValues(N, 0, modulus);
+      std::vector<uint64_t> expected(N, 0);
+      ntt.ComputeForward(expected.data(), input.data(), 1, 1);
+      BitReversePermute(expected.data(), expected.data(), N);
+
+      std::vector<uint64_t> output(N, 0);
+      ntt.ComputeForwardNatural(output.data(), input.data(), 1, 1);
+      AssertEqual(output, expected);
+      ntt.ComputeInverseNatural(output.data(), output.data(), 1, 1);
+      AssertEqual(output, input);
+
+      // In-place, with lazy inputs and outputs
+      for (size_t i = 0; i < N; ++i) {
+        output[i] = input[i] + (i % 4) * modulus;
+      }
+      ntt.ComputeForwardNatural(output.data(), output.data(), 4, 4);
+      for (size_t i = 0; i < N; ++i) {
+        ASSERT_LT(output[i], 4 * modulus);
+        ASSERT_EQ(output[i] % modulus, expected[i]);
+      }
+      for (size_t i = 0; i < N; ++i) {
+        output[i] = expected[i] + (i % 2) * modulus;
+      }
+      std::vector<uint64_t> inverse(N, 0);
+      ntt.ComputeInverseNatural(inverse.data(), output.data(), 2, 2);
+      for (size_t i = 0; i < N; ++i) {
+        ASSERT_LT(inverse[i], 2 * modulus);
+        ASSERT_EQ(inverse[i] % modulus, input[i]);
+      }
+
+      // Stockham transforms, which ComputeForwardNatural may not dispatch to
+      std::vector<uint64_t> W(N, 1);
+      std::vector<uint64_t> W_inv(N, 1);
+      uint64_t psi = ntt.GetMinimalRootOfUnity();
+      uint64_t psi_inv = InverseMod(psi, modulus);
+      for (size_t i = 1; i < N; ++i) {
+        W[i] = MultiplyMod(W[i - 1], psi, modulus);
+        W_inv[i] = MultiplyMod(W_inv[i - 1], psi_inv, modulus);
+      }
+      std::vector<uint64_t> W_precon(N);
+      std::vector<uint64_t> W_inv_precon(N);
+      for (size_t i = 0; i < N; ++i) {
+        W_precon[i] = MultiplyFactor(W[i], 64, modulus).BarrettFactor();
+        W_inv_precon[i] = MultiplyFactor(W_inv[i], 64, modulus).BarrettFactor();
+      }
+      std::vector<uint64_t> scratch(N);
+      ForwardTransformToNaturalStockham(output.data(), input.data(),
+                                        scratch.data(), N, modulus, W.data(),
+                                        W_precon.data(), 1, 1);
+      AssertEqual(output, expected);
+      InverseTransformFromNaturalStockham(output.data(), output.data(),
+                                          scratch.data(), N, modulus,
+                                          W_inv.data(), W_inv_precon.data(),
+                                          1, 1);
+      AssertEqual(output, input);
+    }
+  }
+}
+
+namespace {
+
+// Returns a prime q of about modulus_bits bits with q == 1 mod n but q != 1
+// mod 2n, i.e. which supports the cyclic but not the negacyclic NTT of degree n
+uint64_t GenerateCyclicPrime(uint64_t n, size_t modulus_bits) {
+  uint64_t k = ((1ULL << (modulus_bits - 1)) / n) | 1;
+  while (!IsPrime(k * n + 1)) {
+    k += 2;
+  }
+  return k * n + 1;
+}
+
+}  // namespace
+
+TEST(NTT, cyclic) {
+  for (uint64_t N : {2, 8, 64, 1024, 4096}) {
+    for (size_t modulus_bits : {30, 50, 60}) {
+      uint64_t modulus = GenerateCyclicPrime(N, modulus_bits);
+      NTT ntt = NTT::CreateCyclic(N, modulus);
+      ASSERT_TRUE(ntt.IsCyclic());
+      uint64_t w = ntt.GetMinimalRootOfUnity();
+      ASSERT_TRUE(IsPrimitiveRoot(w, N, modulus));
+      ntt.SetTwiddleMode(NTT::TwiddleMode::Compact);
+      EXPECT_EQ(ntt.GetTwiddleMode(), NTT::TwiddleMode::Full);
+
+      // Evaluations at w^bitrev(i)
+      auto input = GenerateInsecureUniformIntRandomValues(N, 0, modulus);
+      std::vector<uint64_t> output(N, 0);
+      ntt.ComputeForward(output.data(), input.data(), 1, 1);
+      for (uint64_t i : {uint64_t(0), uint64_t(1), N / 2, N - 1}) {
+        uint64_t x = PowMod(w, ReverseBits(i, Log2(N)), modulus);
+        uint64_t expected = 0;
+        for (size_t j = N; j-- > 0;) {
+          expected = AddUIntMod(MultiplyMod(expected, x, modulus), input[j],
+                                modulus);
+        }
+        ASSERT_EQ(output[i], expected);
+      }
+      std::vector<uint64_t> expected = output;
+
+      std::vector<uint64_t> inverse(N, 0);
+      ntt.ComputeInverse(inverse.data(), output.data(), 1, 1);
+      AssertEqual(inverse, input);
+
+      // Lazy inputs and outputs
+      for (size_t i = 0; i < N; ++i) {
+        output[i] = input[i] + (i % 4) * modulus;
+      }
+      ntt.ComputeForward(output.data(), output.data(), 4, 4);
+      for (size_t i = 0; i < N; ++i) {
+        ASSERT_LT(output[i], 4 * modulus);
+        ASSERT_EQ(output[i] % modulus, expected[i]);
+      }
+      for (size_t i = 0; i < N; ++i) {
+        output[i] = expected[i] + (i % 2) * modulus;
+      }
+      ntt.ComputeInverse(output.data(), output.data(), 2, 2);
+      for (size_t i = 0; i < N; ++i) {
+        ASSERT_LT(output[i], 2 * modulus);
+        ASSERT_EQ(output[i] % modulus, input[i]);
+      }
+
+      // Evaluations at w^i
+      ntt.ComputeForwardNatural(output.data(), input.data(), 1, 1);
+      BitReversePermute(output.data(), output.data(), N);
+      AssertEqual(output, expected);
+
+      // Cyclic convolution
+      if (N <= 1024) {
+        auto y = GenerateInsecureUniformIntRandomValues(N, 0, modulus);
+        std::vector<uint64_t> exp_product(N, 0);
+        for (size_t i = 0; i < N; ++i) {
+          for (size_t j = 0; j < N; ++j) {
+            uint64_t k = (i + j) % N;
+            exp_product[k] = AddUIntMod(
+                exp_product[k], MultiplyMod(input[i], y[j], modulus), modulus);
+          }
+        }
+        ntt.Multiply(output.data(), input.data(), y.data(), 1, 1);
+        AssertEqual(output, exp_product);
+      }
+
+      // Sub-NTTs and serialized NTTs are cyclic
+      NTT sub_ntt = ntt.CreateSubNTT(N / 2);
+      EXPECT_TRUE(sub_ntt.IsCyclic() || N == 2);
+      uint64_t w_squared = MultiplyMod(w, w, modulus);
+      NTT exp_sub_ntt = (N == 2)
+                            ? NTT(1, modulus, modulus - 1)
+                            : NTT::CreateCyclic(N / 2, modulus, w_squared);
+      std::vector<uint64_t> sub_output(N / 2, 0);
+      std::vector<uint64_t> exp_sub_output(N / 2, 0);
+      sub_ntt.ComputeForward(sub_output.data(), input.data(), 1, 1);
+      exp_sub_ntt.ComputeForward(exp_sub_output.data(), input.data(), 1, 1);
+      AssertEqual(sub_output, exp_sub_output);
+
+      std::stringstream stream;
+      ntt.Serialize(stream);
+      std::string bytes = stream.str();
+      AlignedVector64<uint64_t> buffer(bytes.size() / sizeof(uint64_t));
+      std::memcpy(buffer.data(), bytes.data(), bytes.size());
+      NTT loaded_ntt = NTT::Deserialize(buffer.data(), bytes.size());
+      EXPECT_TRUE(loaded_ntt.IsCyclic());
+      loaded_ntt.ComputeForward(output.data(), input.data(), 1, 1);
+      AssertEqual(output, expected);
+
+      ntt.SetTwiddleMode(NTT::TwiddleMode::Montgomery);
+      EXPECT_EQ(ntt.GetTwiddleMode(), NTT::TwiddleMode::Montgomery);
+      ntt.ComputeForward(output.data(), input.data(), 1, 1);
+      AssertEqual(output, expected);
+      ntt.ComputeInverse(output.data(), output.data(), 1, 1);
+      AssertEqual(output, input);
+    }
+  }
+}
+
 // Test different parts of the public API
 TEST_P(DegreeModulusInputOutput, API) {
   uint64_t N = std::get<0>(GetParam());
@@ -403,6 +1834,85 @@ INSTANTIATE_TEST_SUITE_P(
                                   12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22,
                                   23, 24, 25, 26, 27, 28, 29, 30, 31, 32})));
 
+// Parameters = (degree, number of moduli, number of threads)
+class NttRNSTest : public ::testing::TestWithParam<
+                       std::tuple<uint64_t, uint64_t, uint64_t>> {
+ protected:
+  void SetUp() override {
+    m_N = std::get<0>(GetParam());
+    m_num_moduli = std::get<1>(GetParam());
+    SetNumThreads(std::get<2>(GetParam()));
+    m_moduli = GeneratePrimes(m_num_moduli, 50, true, m_N);
+    for (uint64_t modulus : m_moduli) {
+      m_ntts.emplace_back(m_N, modulus);
+    }
+    for (auto& ntt : m_ntts) {
+      m_ntt_ptrs.push_back(&ntt);
+    }
+  }
+
+  void TearDown() override { SetNumThreads(0); }
+
+ public:
+  uint64_t m_N;
+  uint64_t m_num_moduli;
+  std::vector<uint64_t> m_moduli;
+  std::vector<NTT> m_ntts;
+  std::vector<NTT*> m_ntt_ptrs;
+};
+
+TEST_P(NttRNSTest, Forward) {
+  std::vector<uint64_t> input(m_N * m_num_moduli);
+  for (size_t i = 0; i < m_num_moduli; ++i) {
+    auto limb = GenerateInsecureUniformIntRandomValues(m_N, 0, m_moduli[i]);
+    std::copy(limb.begin(), limb.end(), input.begin() + i * m_N);
+  }
+  std::vector<uint64_t> exp_output(m_N * m_num_moduli);
+  for (size_t i = 0; i < m_num_moduli; ++i) {
+    m_ntts[i].ComputeForward(&exp_output[i * m_N], &input[i * m_N], 1, 1);
+  }
+
+  std::vector<uint64_t> output(m_N * m_num_moduli);
+  ComputeForwardRNS(output.data(), input.data(), m_ntt_ptrs.data(),
+                    m_num_moduli, 1, 1);
+  AssertEqual(output, exp_output);
+
+  // In-place
+  ComputeForwardRNS(input.data(), input.data(), m_ntt_ptrs.data(),
+                    m_num_moduli, 1, 1);
+  AssertEqual(input, exp_output);
+}
+
+TEST_P(NttRNSTest, Inverse) {
+  std::vector<uint64_t> input(m_N * m_num_moduli);
+  for (size_t i = 0; i < m_num_moduli; ++i) {
+    auto limb =
+        GenerateInsecureUniformIntRandomValues(m_N, 0, 2 * m_moduli[i]);
+    std::copy(limb.begin(), limb.end(), input.begin() + i * m_N);
+  }
+  std::vector<uint64_t> exp_output(m_N * m_num_moduli);
+  for (size_t i = 0; i < m_num_moduli; ++i) {
+    m_ntts[i].ComputeInverse(&exp_output[i * m_N], &input[i * m_N], 2, 1);
+  }
+
+  std::vector<uint64_t> output(m_N * m_num_moduli);
+  ComputeInverseRNS(output.data(), input.data(), m_ntt_ptrs.data(),
+                    m_num_moduli, 2, 1);
+  AssertEqual(output, exp_output);
+
+  // In-place
+  ComputeInverseRNS(input.data(), input.data(), m_ntt_ptrs.data(),
+                    m_num_moduli, 2, 1);
+  AssertEqual(input, exp_output);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    NTT, NttRNSTest,
+    ::testing::Combine(::testing::ValuesIn(std::vector<uint64_t>{
+                           1 << 3, 1 << 10, 1 << 12}),
+                       ::testing::ValuesIn(std::vector<uint64_t>{1, 3, 8}),
+                       ::testing::ValuesIn(std::vector<uint64_t>{1, 4})));
+
 class NttNativeTest : public DegreeModulusBoolTest {};
 
 TEST_P(NttNativeTest, ForwardZeros) {
@@ -107,6 +107,17 @@ TEST(NumberTheory, MultiplyModPreCon) {
                         mf1152921504605798401.BarrettFactor(), modulus));
   ASSERT_EQ(1ULL, MultiplyMod(2305843009211596800ULL, 2305843009211596800ULL,
                               mf2305843009211596800.BarrettFactor(), modulus));
+
+  // Largest 64-bit prime
+  modulus = 0xFFFFFFFFFFFFFFC5ULL;
+  MultiplyFactor mf_minus_one(modulus - 1, 64, modulus);
+  MultiplyFactor mf2(2, 64, modulus);
+  ASSERT_EQ(1ULL, MultiplyMod(modulus - 1, modulus - 1,
+                              mf_minus_one.BarrettFactor(), modulus));
+  ASSERT_EQ(modulus - 2,
+            MultiplyMod(modulus - 1, 2, mf2.BarrettFactor(), modulus));
+  ASSERT_EQ(modulus - 2, MultiplyMod(2, modulus - 1,
+                                     mf_minus_one.BarrettFactor(), modulus));
 }
 
 TEST(NumberTheory, PowMod) {
@@ -216,6 +227,13 @@ TEST(NumberTheory, InverseMod) {
 
   input = 4, modulus = 19;
   ASSERT_EQ(5ULL, InverseMod(input, modulus));
+
+  modulus = 0xFFFFFFFFFFFFFFC5ULL;
+  input = modulus - 1;
+  ASSERT_EQ(modulus - 1, InverseMod(input, modulus));
+
+  input = 2;
+  ASSERT_EQ(modulus / 2 + 1, InverseMod(input, modulus));
 }
 
 TEST(NumberTheory, ReverseBits64) {
@@ -328,10 +346,12 @@ TEST(NumberTheory, IsPrime) {
   ASSERT_TRUE(IsPrime(36893488147419103ULL));
   ASSERT_TRUE(IsPrime(0xffffffffffc0001ULL));
   ASSERT_TRUE(IsPrime(0xffffee001));
+  ASSERT_TRUE(IsPrime(0xFFFFFFFFFFFFFFC5ULL));
 
   ASSERT_FALSE(IsPrime(72307ULL * 59399ULL));
   ASSERT_FALSE(IsPrime(2305843009211596802ULL));
   ASSERT_FALSE(IsPrime(36893488147419107ULL));
+  ASSERT_FALSE(IsPrime(0xFFFFFFFFFFFFFFFFULL));
 }
 
 TEST(NumberTheory, GeneratePrimes) {
@@ -355,6 +375,19 @@ TEST(NumberTheory, GeneratePrimes) {
       ASSERT_TRUE(prime >= (1ULL << bit_size));
     }
   }
+  for (int bit_size = 62; bit_size <= 63; ++bit_size) {
+    for (bool prefer_small_primes : {false, true}) {
+      std::vector<uint64_t> primes =
+          GeneratePrimes(2, bit_size, prefer_small_primes, 4096);
+      ASSERT_EQ(primes.size(), 2);
+      for (const auto& prime : primes) {
+        ASSERT_EQ(prime % 8192, 1);
+        ASSERT_TRUE(IsPrime(prime));
+        ASSERT_TRUE(bit_size == 63 || prime <= (1ULL << (bit_size + 1)));
+        ASSERT_TRUE(prime >= (1ULL << bit_size));
+      }
+    }
+  }
 }
 
 TEST(NumberTheory, AddUInt64) {
@@ -405,6 +438,13 @@ TEST(NumberTheory, AddUIntMod) {
     EXPECT_EQ(1, AddUIntMod(modulus - 1, 2, modulus));
     EXPECT_EQ(modulus - 4, AddUIntMod(modulus - 1, modulus - 3, modulus));
   }
+
+  {
+    uint64_t modulus = 0xFFFFFFFFFFFFFFC5ULL;
+    EXPECT_EQ(10, AddUIntMod(3, 7, modulus));
+    EXPECT_EQ(0, AddUIntMod(modulus - 1, 1, modulus));
+    EXPECT_EQ(modulus - 4, AddUIntMod(modulus - 1, modulus - 3, modulus));
+  }
 }
 
 TEST(NumberTheory, SubUIntMod) {
@@ -430,6 +470,13 @@ TEST(NumberTheory, SubUIntMod) {
     EXPECT_EQ(3, SubUIntMod(2, modulus - 1, modulus));
     EXPECT_EQ(2, SubUIntMod(modulus - 1, modulus - 3, modulus));
   }
+
+  {
+    uint64_t modulus = 0xFFFFFFFFFFFFFFC5ULL;
+    EXPECT_EQ(modulus - 4, SubUIntMod(3, 7, modulus));
+    EXPECT_EQ(3, SubUIntMod(2, modulus - 1, modulus));
+    EXPECT_EQ(2, SubUIntMod(modulus - 1, modulus - 3, modulus));
+  }
 }
 
 TEST(NumberTheory, DivideUInt128UInt64Lo) {
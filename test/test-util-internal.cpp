@@ -3,11 +3,15 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <stdexcept>
+#include <thread>
 #include <vector>
 
 #include "hexl/util/aligned-allocator.hpp"
 #include "ntt/ntt-internal.hpp"
 #include "test/test-util.hpp"
+#include "util/thread-pool.hpp"
 
 namespace intel {
 namespace hexl {
@@ -81,5 +85,40 @@ TEST(GenerateInsecureUniformRealRandomValues, 1_plus_2_exp_minus_14) {
                           [&](double_t x) { return x = min_value; }));
 }
 
+TEST(ThreadPool, set_num_threads_in_task) {
+  for (size_t num_threads : {1, 4}) {
+    ThreadPool pool(num_threads);
+    std::atomic<size_t> num_throws{0};
+    pool.ParallelFor(8, [&](size_t) {
+      try {
+        pool.SetNumThreads(2);
+      } catch (const std::logic_error&) {
+        ++num_throws;
+      }
+    });
+    EXPECT_EQ(num_throws, 8);
+    EXPECT_EQ(pool.GetNumThreads(), num_threads);
+
+    pool.SetNumThreads(2);
+    EXPECT_EQ(pool.GetNumThreads(), 2);
+  }
+}
+
+TEST(ThreadPool, get_num_threads_concurrent) {
+  ThreadPool pool(2);
+  std::atomic<bool> done{false};
+  std::thread reader([&]() {
+    while (!done) {
+      size_t num_threads = pool.GetNumThreads();
+      EXPECT_TRUE(num_threads == 2 || num_threads == 3);
+    }
+  });
+  for (size_t i = 0; i < 20; ++i) {
+    pool.SetNumThreads(2 + (i % 2));
+  }
+  done = true;
+  reader.join();
+}
+
 }  // namespace hexl
 }  // namespace intel